@@ -0,0 +1,594 @@
+/*****************************************************************
+ * MiniConsole V3 - Host BSP stand-in
+ *
+ * System, touch panel, audio, video and USB entries, call
+ * statistics and application runner.
+ *******************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "BSP_Host.h"
+
+#define HOST_AUDIO_CHANNELS		16
+
+Host_ConfigTypeDef		Host_Config = { .rootdir = ".", .frames = 0, .vsync_hz = 0, .quiet = 0 };
+Host_CallStatTypeDef	Host_CallStat[HOST_SLOT_NO];
+Host_FrameStatTypeDef	Host_FrameStat;
+
+static BSP_Driver_TypeDef		host_drv;
+static LCD_TP_HandleTypeDef		host_hlcdtp;
+static IMU_HandleTypeDef		host_himu;
+static INPUTS_HandleTypeDef		host_hinputs;
+
+BSP_Driver_TypeDef * BSP = &host_drv;
+
+static uint64_t	host_t0;
+static jmp_buf	host_exit;
+static uint8_t	host_running = 0;
+
+static struct {
+	uint8_t		master_l;
+	uint8_t		master_r;
+	uint8_t		vol_l[HOST_AUDIO_CHANNELS];
+	uint8_t		vol_r[HOST_AUDIO_CHANNELS];
+	uint8_t		linked[HOST_AUDIO_CHANNELS];
+	uint8_t		playing[HOST_AUDIO_CHANNELS];
+	void *		callback[AUDIO_STATUS_COUNT];
+} host_audio;
+
+
+// Time measurement
+
+uint64_t Host_GetNs(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t Host_GetCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+
+// System functions
+
+static uint8_t HOST_PWR_Restart(void) {
+	if (!Host_Config.quiet) printf("[host] PWR_Restart\n");
+	if (host_running) longjmp(host_exit, 1);
+	return BSP_OK;
+}
+
+static uint8_t HOST_PWR_ShutDown(void) {
+	if (!Host_Config.quiet) printf("[host] PWR_ShutDown\n");
+	if (host_running) longjmp(host_exit, 1);
+	return BSP_OK;
+}
+
+static void HOST_Delay(uint32_t delay) {
+	struct timespec ts = { .tv_sec = delay / 1000, .tv_nsec = (long)(delay % 1000) * 1000000l };
+	nanosleep(&ts, NULL);
+}
+
+static uint32_t HOST_GetTick(void) {
+	return (uint32_t)((Host_GetNs() - host_t0) / 1000000ull);
+}
+
+static uint8_t HOST_RTC_GetDate(uint16_t * pyear, uint8_t * pmonth, uint8_t * pday, uint8_t * pweekday) {
+	time_t t = time(NULL);
+	struct tm tm;
+	localtime_r(&t, &tm);
+	*pyear = (uint16_t)(tm.tm_year + 1900);
+	*pmonth = (uint8_t)(tm.tm_mon + 1);
+	*pday = (uint8_t)tm.tm_mday;
+	*pweekday = (uint8_t)(tm.tm_wday == 0 ? 7 : tm.tm_wday);
+	return BSP_OK;
+}
+
+static uint8_t HOST_RTC_GetTime(uint8_t * phour, uint8_t * pminute, uint8_t * psecond) {
+	time_t t = time(NULL);
+	struct tm tm;
+	localtime_r(&t, &tm);
+	*phour = (uint8_t)tm.tm_hour;
+	*pminute = (uint8_t)tm.tm_min;
+	*psecond = (uint8_t)tm.tm_sec;
+	return BSP_OK;
+}
+
+static int32_t HOST_RTC_GetUnixTimestamp(void) {
+	return (int32_t)time(NULL);
+}
+
+static uint8_t HOST_Serial_Transmit(uint8_t * pData, uint32_t Size) {
+	if (!Host_Config.quiet) fwrite(pData, 1, Size, stdout);
+	return BSP_OK;
+}
+
+
+// Touch panel
+
+static uint8_t HOST_LCD_TP_RegisterArea(uint8_t areaid, uint16_t x, uint16_t y, uint16_t width, uint16_t height, void* callback) {
+	if (areaid >= LCD_TP_AREA_NO) return BSP_ERROR;
+	TP_AREA * area = &host_hlcdtp.touch_areas[areaid];
+	area->x = (int16_t)x;
+	area->y = (int16_t)y;
+	area->w = width;
+	area->h = height;
+	area->callback = callback;
+	area->active = 1;
+	return BSP_OK;
+}
+
+static uint8_t HOST_LCD_TP_RemoveArea(uint8_t areaid) {
+	if (areaid >= LCD_TP_AREA_NO) return BSP_ERROR;
+	host_hlcdtp.touch_areas[areaid].active = 0;
+	return BSP_OK;
+}
+
+static uint8_t HOST_LCD_TP_RemoveAreaRange(uint8_t aid_start, uint8_t aid_stop) {
+	if ((aid_start > aid_stop) || (aid_stop >= LCD_TP_AREA_NO)) return BSP_ERROR;
+	for (uint8_t i = aid_start; i <= aid_stop; i++) host_hlcdtp.touch_areas[i].active = 0;
+	return BSP_OK;
+}
+
+static uint8_t HOST_LCD_TP_RemoveAllAreas(void) {
+	for (uint8_t i = 0; i < LCD_TP_AREA_NO; i++) host_hlcdtp.touch_areas[i].active = 0;
+	return BSP_OK;
+}
+
+static uint8_t HOST_LCD_TP_Enable(void) {
+	host_hlcdtp.enabled = 1;
+	return BSP_OK;
+}
+
+static uint8_t HOST_LCD_TP_Disable(void) {
+	host_hlcdtp.enabled = 0;
+	return BSP_OK;
+}
+
+
+// Video (not supported on host)
+
+static uint8_t HOST_Video_Init(char * filename, uint8_t * pVideoBuffer, uint32_t VideoBufferSize) {
+	(void)filename; (void)pVideoBuffer; (void)VideoBufferSize;
+	return BSP_ERROR;
+}
+
+static uint8_t HOST_Video_Error(void) { return BSP_ERROR; }
+static uint8_t HOST_Video_Frame(uint32_t frame) { (void)frame; return BSP_ERROR; }
+static uint8_t HOST_Video_Volume(uint8_t vol) { (void)vol; return BSP_ERROR; }
+static uint8_t HOST_Video_Draw(int16_t x, int16_t y) { (void)x; (void)y; return BSP_ERROR; }
+static uint32_t HOST_Video_Zero(void) { return 0; }
+
+HOST_WRAP(uint8_t, Video_Init, (char * filename, uint8_t * pVideoBuffer, uint32_t VideoBufferSize), (filename, pVideoBuffer, VideoBufferSize))
+#define HOST_Video_GetFrame			HOST_Video_Error
+#define HOST_Video_DeInit			HOST_Video_Error
+#define HOST_Video_Seek				HOST_Video_Frame
+#define HOST_Video_Rev				HOST_Video_Frame
+#define HOST_Video_Fwd				HOST_Video_Frame
+#define HOST_Video_Play				HOST_Video_Error
+#define HOST_Video_Stop				HOST_Video_Error
+#define HOST_Video_Pause			HOST_Video_Error
+#define HOST_Video_SetVolume		HOST_Video_Volume
+#define HOST_Video_DrawFrame		HOST_Video_Draw
+#define HOST_Video_DrawFrameC		HOST_Video_Draw
+#define HOST_Video_GetTotalFrames	HOST_Video_Zero
+#define HOST_Video_GetCurrentFrame	HOST_Video_Zero
+#define HOST_Video_GetWidth			HOST_Video_Zero
+#define HOST_Video_GetHeight		HOST_Video_Zero
+#define HOST_Video_GetFrameRate		HOST_Video_Zero
+
+
+// Audio (state only, no sound output)
+
+static uint8_t HOST_Audio_SetMasterVolume(uint8_t volume) {
+	host_audio.master_l = volume;
+	host_audio.master_r = volume;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_GetMasterVolume(void) {
+	return (uint8_t)(((uint16_t)host_audio.master_l + host_audio.master_r) / 2);
+}
+
+static uint8_t HOST_Audio_GetMasterVolumeL(void) {
+	return host_audio.master_l;
+}
+
+static uint8_t HOST_Audio_GetMasterVolumeR(void) {
+	return host_audio.master_r;
+}
+
+static uint8_t HOST_Audio_SetMasterVolumeLR(uint8_t volume_L, uint8_t volume_R) {
+	host_audio.master_l = volume_L;
+	host_audio.master_r = volume_R;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_IncMasterVolume(uint8_t delta) {
+	host_audio.master_l = (host_audio.master_l + delta > 255) ? 255 : host_audio.master_l + delta;
+	host_audio.master_r = (host_audio.master_r + delta > 255) ? 255 : host_audio.master_r + delta;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_DecMasterVolume(uint8_t delta) {
+	host_audio.master_l = (host_audio.master_l < delta) ? 0 : host_audio.master_l - delta;
+	host_audio.master_r = (host_audio.master_r < delta) ? 0 : host_audio.master_r - delta;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_SetChannelVolumeLR(uint8_t chno, uint8_t volume_L, uint8_t volume_R) {
+	if (chno >= HOST_AUDIO_CHANNELS) return BSP_ERROR;
+	host_audio.vol_l[chno] = volume_L;
+	host_audio.vol_r[chno] = volume_R;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_SetChannelVolume(uint8_t chno, uint8_t volume) {
+	return HOST_Audio_SetChannelVolumeLR(chno, volume, volume);
+}
+
+static uint8_t HOST_Audio_IncChannelVolume(uint8_t chno, uint8_t delta) {
+	if (chno >= HOST_AUDIO_CHANNELS) return BSP_ERROR;
+	uint8_t l = (host_audio.vol_l[chno] + delta > 255) ? 255 : host_audio.vol_l[chno] + delta;
+	uint8_t r = (host_audio.vol_r[chno] + delta > 255) ? 255 : host_audio.vol_r[chno] + delta;
+	return HOST_Audio_SetChannelVolumeLR(chno, l, r);
+}
+
+static uint8_t HOST_Audio_DecChannelVolume(uint8_t chno, uint8_t delta) {
+	if (chno >= HOST_AUDIO_CHANNELS) return BSP_ERROR;
+	uint8_t l = (host_audio.vol_l[chno] < delta) ? 0 : host_audio.vol_l[chno] - delta;
+	uint8_t r = (host_audio.vol_r[chno] < delta) ? 0 : host_audio.vol_r[chno] - delta;
+	return HOST_Audio_SetChannelVolumeLR(chno, l, r);
+}
+
+static uint8_t HOST_Audio_Link(uint8_t chno, void * addr) {
+	if ((chno >= HOST_AUDIO_CHANNELS) || (addr == NULL)) return BSP_ERROR;
+	host_audio.linked[chno] = 1;
+	host_audio.playing[chno] = 0;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_LinkSourceMID(uint8_t chno, void * sfaddr, uint32_t sfsize, void * addr, uint32_t size) {
+	(void)sfaddr; (void)sfsize; (void)size;
+	return HOST_Audio_Link(chno, addr);
+}
+
+static uint8_t HOST_Audio_LinkSourceMP3(uint8_t chno, void * addr, uint32_t size) {
+	(void)size;
+	return HOST_Audio_Link(chno, addr);
+}
+
+static uint8_t HOST_Audio_LinkSourceMOD(uint8_t chno, void * addr, uint32_t size) {
+	(void)size;
+	return HOST_Audio_Link(chno, addr);
+}
+
+static uint8_t HOST_Audio_LinkSourceRAW(uint8_t chno, void * addr, uint32_t size, uint8_t chn, uint8_t bitformat, uint16_t freq) {
+	(void)size; (void)chn; (void)bitformat; (void)freq;
+	return HOST_Audio_Link(chno, addr);
+}
+
+static uint8_t HOST_Audio_ChannelPLay(uint8_t chno, uint8_t repeat) {
+	(void)repeat;
+	if ((chno >= HOST_AUDIO_CHANNELS) || (!host_audio.linked[chno])) return BSP_ERROR;
+	host_audio.playing[chno] = 1;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_ChannelStop(uint8_t chno) {
+	if (chno >= HOST_AUDIO_CHANNELS) return BSP_ERROR;
+	host_audio.playing[chno] = 0;
+	return BSP_OK;
+}
+
+static uint8_t HOST_Audio_ChannelPause(uint8_t chno) {
+	return HOST_Audio_ChannelStop(chno);
+}
+
+static uint8_t HOST_Audio_RegisterStatusCallback(uint8_t status, void* callback) {
+	if (status >= AUDIO_STATUS_COUNT) return BSP_ERROR;
+	host_audio.callback[status] = callback;
+	return BSP_OK;
+}
+
+// Emulates audio interrupt reporting status (calls registered callback on calling thread)
+void Host_AudioStatus(uint8_t status) {
+	if ((status < AUDIO_STATUS_COUNT) && (host_audio.callback[status])) ((void (*)(void))host_audio.callback[status])();
+}
+
+static uint32_t HOST_Audio_GetStatusParam(uint8_t index) {
+	(void)index;
+	return 0;
+}
+
+static uint8_t HOST_Audio_GetFreeChannel(void) {
+	for (uint8_t i = 0; i < HOST_AUDIO_CHANNELS; i++) if (!host_audio.playing[i]) return i;
+	return 0xFF;
+}
+
+
+// USB (not connected on host unless Host_Config.cdc_file is set - CDC output then goes to file)
+static FILE * host_cdc = NULL;
+
+static uint8_t HOST_USB_Ok(void) { return BSP_OK; }
+static uint8_t HOST_USB_IsConnected(void) { return (Host_Config.cdc_file != NULL); }
+static void HOST_USB_Task(void) { }
+static void HOST_USB_RegCb(void * cb) { (void)cb; }
+static void HOST_USB_CDC_RegCbRxChar(void * cb, char ch) { (void)cb; (void)ch; }
+static uint32_t HOST_USB_CDC_DataAvailable(void) { return 0; }
+static uint32_t HOST_USB_CDC_Read(void * buf, uint32_t bufsize) { (void)buf; (void)bufsize; return 0; }
+static uint32_t HOST_USB_CDC_Write(void * buf, uint32_t bufsize) {
+	if (Host_Config.cdc_file == NULL) return bufsize;
+	if ((host_cdc == NULL) && ((host_cdc = fopen(Host_Config.cdc_file, "wb")) == NULL)) return 0;
+	return (uint32_t)fwrite(buf, 1, bufsize, host_cdc);
+}
+
+static uint32_t HOST_USB_CDC_WriteFlush(void) {
+	if (host_cdc) fflush(host_cdc);
+	return 0;
+}
+static void HOST_USB_CDC_ReadFlush(void) { }
+static void HOST_USB_HID_Mouse(uint8_t buttons, int8_t dx, int8_t dy, int8_t scrl_dx, int8_t scrl_dy) {
+	(void)buttons; (void)dx; (void)dy; (void)scrl_dx; (void)scrl_dy;
+}
+static void HOST_USB_HID_Keyboard(uint8_t modifier, uint8_t * pkeycodes, uint8_t keycount) {
+	(void)modifier; (void)pkeycodes; (void)keycount;
+}
+static void HOST_USB_HID_Gamepad(uint32_t buttons, uint8_t hat, int8_t x, int8_t y, int8_t z, int8_t rx, int8_t ry, int8_t rz) {
+	(void)buttons; (void)hat; (void)x; (void)y; (void)z; (void)rx; (void)ry; (void)rz;
+}
+static void HOST_USB_HID_Ctrl(uint16_t command) { (void)command; }
+
+#define HOST_USB_MSC_Init		HOST_USB_Ok
+#define HOST_USB_CDC_Init		HOST_USB_Ok
+#define HOST_USB_HID_Init		HOST_USB_Ok
+#define HOST_USB_Disconnect		HOST_USB_Ok
+#define HOST_USB_CDC_RegCbRx	HOST_USB_RegCb
+#define HOST_USB_CDC_RegCbTx	HOST_USB_RegCb
+#define HOST_USB_HID_RegCbLeds	HOST_USB_RegCb
+
+
+// Wrappers
+
+HOST_WRAP(uint8_t, PWR_Restart, (void), ())
+HOST_WRAP(uint8_t, PWR_ShutDown, (void), ())
+HOST_WRAP_V(Delay, (uint32_t delay), (delay))
+HOST_WRAP(uint32_t, GetTick, (void), ())
+HOST_WRAP(uint8_t, RTC_GetDate, (uint16_t * pyear, uint8_t * pmonth, uint8_t * pday, uint8_t * pweekday), (pyear, pmonth, pday, pweekday))
+HOST_WRAP(uint8_t, RTC_GetTime, (uint8_t * phour, uint8_t * pminute, uint8_t * psecond), (phour, pminute, psecond))
+HOST_WRAP(int32_t, RTC_GetUnixTimestamp, (void), ())
+HOST_WRAP(uint8_t, Serial_Transmit, (uint8_t * pData, uint32_t Size), (pData, Size))
+
+HOST_WRAP(uint8_t, LCD_TP_RegisterArea, (uint8_t areaid, uint16_t x, uint16_t y, uint16_t width, uint16_t height, void* callback), (areaid, x, y, width, height, callback))
+HOST_WRAP(uint8_t, LCD_TP_RemoveArea, (uint8_t areaid), (areaid))
+HOST_WRAP(uint8_t, LCD_TP_RemoveAreaRange, (uint8_t aid_start, uint8_t aid_stop), (aid_start, aid_stop))
+HOST_WRAP(uint8_t, LCD_TP_RemoveAllAreas, (void), ())
+HOST_WRAP(uint8_t, LCD_TP_Enable, (void), ())
+HOST_WRAP(uint8_t, LCD_TP_Disable, (void), ())
+
+HOST_WRAP(uint8_t, Video_GetFrame, (void), ())
+HOST_WRAP(uint8_t, Video_DeInit, (void), ())
+HOST_WRAP(uint8_t, Video_Seek, (uint32_t frame), (frame))
+HOST_WRAP(uint8_t, Video_Rev, (uint32_t delta), (delta))
+HOST_WRAP(uint8_t, Video_Fwd, (uint32_t delta), (delta))
+HOST_WRAP(uint8_t, Video_Play, (void), ())
+HOST_WRAP(uint8_t, Video_Stop, (void), ())
+HOST_WRAP(uint8_t, Video_Pause, (void), ())
+HOST_WRAP(uint8_t, Video_SetVolume, (uint8_t vol), (vol))
+HOST_WRAP(uint8_t, Video_DrawFrame, (int16_t x, int16_t y), (x, y))
+HOST_WRAP(uint8_t, Video_DrawFrameC, (int16_t x, int16_t y), (x, y))
+HOST_WRAP(uint32_t, Video_GetTotalFrames, (void), ())
+HOST_WRAP(uint32_t, Video_GetCurrentFrame, (void), ())
+HOST_WRAP(uint32_t, Video_GetWidth, (void), ())
+HOST_WRAP(uint32_t, Video_GetHeight, (void), ())
+HOST_WRAP(uint32_t, Video_GetFrameRate, (void), ())
+
+HOST_WRAP(uint8_t, Audio_SetMasterVolume, (uint8_t volume), (volume))
+HOST_WRAP(uint8_t, Audio_GetMasterVolume, (void), ())
+HOST_WRAP(uint8_t, Audio_GetMasterVolumeL, (void), ())
+HOST_WRAP(uint8_t, Audio_GetMasterVolumeR, (void), ())
+HOST_WRAP(uint8_t, Audio_SetMasterVolumeLR, (uint8_t volume_L, uint8_t volume_R), (volume_L, volume_R))
+HOST_WRAP(uint8_t, Audio_IncMasterVolume, (uint8_t delta), (delta))
+HOST_WRAP(uint8_t, Audio_DecMasterVolume, (uint8_t delta), (delta))
+HOST_WRAP(uint8_t, Audio_SetChannelVolume, (uint8_t chno, uint8_t volume), (chno, volume))
+HOST_WRAP(uint8_t, Audio_SetChannelVolumeLR, (uint8_t chno, uint8_t volume_L, uint8_t volume_R), (chno, volume_L, volume_R))
+HOST_WRAP(uint8_t, Audio_IncChannelVolume, (uint8_t chno, uint8_t delta), (chno, delta))
+HOST_WRAP(uint8_t, Audio_DecChannelVolume, (uint8_t chno, uint8_t delta), (chno, delta))
+HOST_WRAP(uint8_t, Audio_LinkSourceMID, (uint8_t chno, void * sfaddr, uint32_t sfsize, void * addr, uint32_t size), (chno, sfaddr, sfsize, addr, size))
+HOST_WRAP(uint8_t, Audio_LinkSourceMP3, (uint8_t chno, void * addr, uint32_t size), (chno, addr, size))
+HOST_WRAP(uint8_t, Audio_LinkSourceMOD, (uint8_t chno, void * addr, uint32_t size), (chno, addr, size))
+HOST_WRAP(uint8_t, Audio_LinkSourceRAW, (uint8_t chno, void * addr, uint32_t size, uint8_t chn, uint8_t bitformat, uint16_t freq), (chno, addr, size, chn, bitformat, freq))
+HOST_WRAP(uint8_t, Audio_ChannelPLay, (uint8_t chno, uint8_t repeat), (chno, repeat))
+HOST_WRAP(uint8_t, Audio_ChannelStop, (uint8_t chno), (chno))
+HOST_WRAP(uint8_t, Audio_ChannelPause, (uint8_t chno), (chno))
+HOST_WRAP(uint8_t, Audio_RegisterStatusCallback, (uint8_t status, void* callback), (status, callback))
+HOST_WRAP(uint32_t, Audio_GetStatusParam, (uint8_t index), (index))
+HOST_WRAP(uint8_t, Audio_GetFreeChannel, (void), ())
+
+HOST_WRAP(uint8_t, USB_MSC_Init, (void), ())
+HOST_WRAP(uint8_t, USB_CDC_Init, (void), ())
+HOST_WRAP(uint8_t, USB_HID_Init, (void), ())
+HOST_WRAP(uint8_t, USB_Disconnect, (void), ())
+HOST_WRAP_V(USB_Task, (void), ())
+HOST_WRAP(uint8_t, USB_IsConnected, (void), ())
+HOST_WRAP_V(USB_CDC_RegCbRx, (void * cb), (cb))
+HOST_WRAP_V(USB_CDC_RegCbRxChar, (void * cb, char ch), (cb, ch))
+HOST_WRAP_V(USB_CDC_RegCbTx, (void * cb), (cb))
+HOST_WRAP(uint32_t, USB_CDC_DataAvailable, (void), ())
+HOST_WRAP(uint32_t, USB_CDC_Read, (void * buf, uint32_t bufsize), (buf, bufsize))
+HOST_WRAP(uint32_t, USB_CDC_Write, (void * buf, uint32_t bufsize), (buf, bufsize))
+HOST_WRAP(uint32_t, USB_CDC_WriteFlush, (void), ())
+HOST_WRAP_V(USB_CDC_ReadFlush, (void), ())
+HOST_WRAP_V(USB_HID_RegCbLeds, (void * cb), (cb))
+HOST_WRAP_V(USB_HID_Mouse, (uint8_t buttons, int8_t dx, int8_t dy, int8_t scrl_dx, int8_t scrl_dy), (buttons, dx, dy, scrl_dx, scrl_dy))
+HOST_WRAP_V(USB_HID_Keyboard, (uint8_t modifier, uint8_t * pkeycodes, uint8_t keycount), (modifier, pkeycodes, keycount))
+HOST_WRAP_V(USB_HID_Gamepad, (uint32_t buttons, uint8_t hat, int8_t x, int8_t y, int8_t z, int8_t rx, int8_t ry, int8_t rz), (buttons, hat, x, y, z, rx, ry, rz))
+HOST_WRAP_V(USB_HID_Ctrl, (uint16_t command), (command))
+
+
+// Host API
+
+void Host_Init(void) {
+	memset(&host_drv, 0, sizeof(host_drv));
+	memset(&host_audio, 0, sizeof(host_audio));
+	host_t0 = Host_GetNs();
+
+	host_drv.hlcdtp = &host_hlcdtp;
+	host_drv.himu = &host_himu;
+	host_drv.hinputs = &host_hinputs;
+
+	HOST_BIND(&host_drv, PWR_Restart);
+	HOST_BIND(&host_drv, PWR_ShutDown);
+	HOST_BIND(&host_drv, Delay);
+	HOST_BIND(&host_drv, GetTick);
+	HOST_BIND(&host_drv, RTC_GetDate);
+	HOST_BIND(&host_drv, RTC_GetTime);
+	HOST_BIND(&host_drv, RTC_GetUnixTimestamp);
+	HOST_BIND(&host_drv, Serial_Transmit);
+
+	HOST_BIND(&host_drv, LCD_TP_RegisterArea);
+	HOST_BIND(&host_drv, LCD_TP_RemoveArea);
+	HOST_BIND(&host_drv, LCD_TP_RemoveAreaRange);
+	HOST_BIND(&host_drv, LCD_TP_RemoveAllAreas);
+	HOST_BIND(&host_drv, LCD_TP_Enable);
+	HOST_BIND(&host_drv, LCD_TP_Disable);
+
+	HOST_BIND(&host_drv, Video_Init);
+	HOST_BIND(&host_drv, Video_GetFrame);
+	HOST_BIND(&host_drv, Video_DeInit);
+	HOST_BIND(&host_drv, Video_Seek);
+	HOST_BIND(&host_drv, Video_Rev);
+	HOST_BIND(&host_drv, Video_Fwd);
+	HOST_BIND(&host_drv, Video_Play);
+	HOST_BIND(&host_drv, Video_Stop);
+	HOST_BIND(&host_drv, Video_Pause);
+	HOST_BIND(&host_drv, Video_SetVolume);
+	HOST_BIND(&host_drv, Video_DrawFrame);
+	HOST_BIND(&host_drv, Video_DrawFrameC);
+	HOST_BIND(&host_drv, Video_GetTotalFrames);
+	HOST_BIND(&host_drv, Video_GetCurrentFrame);
+	HOST_BIND(&host_drv, Video_GetWidth);
+	HOST_BIND(&host_drv, Video_GetHeight);
+	HOST_BIND(&host_drv, Video_GetFrameRate);
+
+	HOST_BIND(&host_drv, Audio_SetMasterVolume);
+	HOST_BIND(&host_drv, Audio_GetMasterVolume);
+	HOST_BIND(&host_drv, Audio_GetMasterVolumeL);
+	HOST_BIND(&host_drv, Audio_GetMasterVolumeR);
+	HOST_BIND(&host_drv, Audio_SetMasterVolumeLR);
+	HOST_BIND(&host_drv, Audio_IncMasterVolume);
+	HOST_BIND(&host_drv, Audio_DecMasterVolume);
+	HOST_BIND(&host_drv, Audio_SetChannelVolume);
+	HOST_BIND(&host_drv, Audio_SetChannelVolumeLR);
+	HOST_BIND(&host_drv, Audio_IncChannelVolume);
+	HOST_BIND(&host_drv, Audio_DecChannelVolume);
+	HOST_BIND(&host_drv, Audio_LinkSourceMID);
+	HOST_BIND(&host_drv, Audio_LinkSourceMP3);
+	HOST_BIND(&host_drv, Audio_LinkSourceMOD);
+	HOST_BIND(&host_drv, Audio_LinkSourceRAW);
+	HOST_BIND(&host_drv, Audio_ChannelPLay);
+	HOST_BIND(&host_drv, Audio_ChannelStop);
+	HOST_BIND(&host_drv, Audio_ChannelPause);
+	HOST_BIND(&host_drv, Audio_RegisterStatusCallback);
+	HOST_BIND(&host_drv, Audio_GetStatusParam);
+	HOST_BIND(&host_drv, Audio_GetFreeChannel);
+
+	HOST_BIND(&host_drv, USB_MSC_Init);
+	HOST_BIND(&host_drv, USB_CDC_Init);
+	HOST_BIND(&host_drv, USB_HID_Init);
+	HOST_BIND(&host_drv, USB_Disconnect);
+	HOST_BIND(&host_drv, USB_Task);
+	HOST_BIND(&host_drv, USB_IsConnected);
+	HOST_BIND(&host_drv, USB_CDC_RegCbRx);
+	HOST_BIND(&host_drv, USB_CDC_RegCbRxChar);
+	HOST_BIND(&host_drv, USB_CDC_RegCbTx);
+	HOST_BIND(&host_drv, USB_CDC_DataAvailable);
+	HOST_BIND(&host_drv, USB_CDC_Read);
+	HOST_BIND(&host_drv, USB_CDC_Write);
+	HOST_BIND(&host_drv, USB_CDC_WriteFlush);
+	HOST_BIND(&host_drv, USB_CDC_ReadFlush);
+	HOST_BIND(&host_drv, USB_HID_RegCbLeds);
+	HOST_BIND(&host_drv, USB_HID_Mouse);
+	HOST_BIND(&host_drv, USB_HID_Keyboard);
+	HOST_BIND(&host_drv, USB_HID_Gamepad);
+	HOST_BIND(&host_drv, USB_HID_Ctrl);
+
+	Host_LCD_Bind(&host_drv);
+	Host_FS_Bind(&host_drv);
+
+	Host_ResetStats();
+}
+
+void Host_ResetStats(void) {
+	for (uint32_t i = 0; i < HOST_SLOT_NO; i++) {
+		Host_CallStat[i].calls = 0;
+		Host_CallStat[i].ns = 0;
+		Host_CallStat[i].cycles = 0;
+	}
+	memset(&Host_FrameStat, 0, sizeof(Host_FrameStat));
+	Host_FrameStat.frame_ns_min = UINT64_MAX;
+}
+
+// Called by LCD_FrameReady - terminates application loop after configured number of frames
+void Host_FrameDone(void) {
+	if ((host_running) && (Host_Config.frames) && (Host_FrameStat.frames >= Host_Config.frames)) longjmp(host_exit, 1);
+}
+
+uint8_t Host_Run(void (*init)(void), void (*main)(void)) {
+	if (setjmp(host_exit)) {
+		host_running = 0;
+		return BSP_OK;
+	}
+	host_running = 1;
+	if (init) init();
+	Host_ResetStats();
+	if (main) main();
+	host_running = 0;
+	return BSP_OK;
+}
+
+static int Host_CompareStat(const void * a, const void * b) {
+	const Host_CallStatTypeDef * sa = *(const Host_CallStatTypeDef * const *)a;
+	const Host_CallStatTypeDef * sb = *(const Host_CallStatTypeDef * const *)b;
+	if (sa->ns == sb->ns) return 0;
+	return (sa->ns < sb->ns) ? 1 : -1;
+}
+
+void Host_PrintStats(void) {
+	Host_CallStatTypeDef * list[HOST_SLOT_NO];
+	uint32_t cnt = 0;
+
+	for (uint32_t i = 0; i < HOST_SLOT_NO; i++) if (Host_CallStat[i].calls) list[cnt++] = &Host_CallStat[i];
+	qsort(list, cnt, sizeof(list[0]), Host_CompareStat);
+
+	printf("%-28s %10s %12s %12s %12s\n", "call", "count", "total [us]", "avg [ns]", "avg [cyc]");
+	for (uint32_t i = 0; i < cnt; i++) {
+		printf("%-28s %10llu %12.1f %12llu %12llu\n", list[i]->name,
+				(unsigned long long)list[i]->calls,
+				(double)list[i]->ns / 1000.0,
+				(unsigned long long)(list[i]->ns / list[i]->calls),
+				(unsigned long long)(list[i]->cycles / list[i]->calls));
+	}
+
+	if (Host_FrameStat.frames) {
+		printf("frames: %u  avg: %.3f ms  min: %.3f ms  max: %.3f ms\n", Host_FrameStat.frames,
+				(double)Host_FrameStat.frame_ns_total / Host_FrameStat.frames / 1e6,
+				(double)Host_FrameStat.frame_ns_min / 1e6,
+				(double)Host_FrameStat.frame_ns_max / 1e6);
+		printf("frame buffer traffic per frame: written %llu B, read %llu B\n",
+				(unsigned long long)(Host_FrameStat.fb_bytes_written / Host_FrameStat.frames),
+				(unsigned long long)(Host_FrameStat.fb_bytes_read / Host_FrameStat.frames));
+	}
+}
@@ -0,0 +1,114 @@
+/*****************************************************************
+ * MiniConsole V3 - Host BSP stand-in
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Software implementation of BSP_Driver_TypeDef for Linux builds.
+ *
+ * Every jump table entry is routed through a wrapper that counts
+ * calls, wall time and CPU cycles, so app_main frame cost and
+ * individual G2D/Res/FATFS calls can be measured off target.
+ *
+ * Host specific assumptions (firmware sources are not available):
+ * 	- frame buffers are allocated on the heap (one per buffer mode),
+ * 	  pixel layout follows DMA2D (RGB888 stored as B,G,R bytes),
+ * 	- G2D_Color returns colour in native format of selected mode,
+ * 	  for ARGB8888 and RGB888 alpha is kept in bits 31..24,
+ * 	- sources of *Blend bitmap/buffer functions are ARGB8888,
+ * 	  sources of non blending functions are in native format,
+ * 	- icons are {uint16 width, uint16 height, A8 mask[w*h]},
+ * 	- JPEG and Video functions are counted but do not decode,
+ * 	- audio status callbacks are void (*)(void), called only by
+ * 	  Host_AudioStatus (no audio output),
+ * 	- "0:/" in FATFS paths maps to Host_Config.rootdir.
+ *******************************************************************/
+
+#ifndef HOST_BSP_HOST_H_
+#define HOST_BSP_HOST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "BSP_Driver.h"
+
+#define HOST_SLOT_NO		(sizeof(BSP_Driver_TypeDef) / sizeof(void *))
+#define HOST_SLOT(name)		(offsetof(BSP_Driver_TypeDef, name) / sizeof(void *))
+
+typedef struct {
+	const char *	rootdir;		// Host directory representing "0:/"
+	uint32_t		frames;			// Number of frames after which Host_Run returns (0 - unlimited)
+	uint32_t		vsync_hz;		// Simulated refresh rate for LCD_GetEditPermission (0 - unthrottled)
+	uint8_t			quiet;			// Suppress Serial_Transmit output
+	const char *	cdc_file;		// File receiving USB_CDC_Write data (USB reported as connected)
+} Host_ConfigTypeDef;
+
+typedef struct {
+	const char *	name;
+	uint64_t		calls;
+	uint64_t		ns;
+	uint64_t		cycles;
+} Host_CallStatTypeDef;
+
+typedef struct {
+	uint32_t		frames;
+	uint64_t		frame_ns_total;
+	uint64_t		frame_ns_min;
+	uint64_t		frame_ns_max;
+	uint64_t		fb_bytes_written;	// Bytes written into frame buffers (all calls)
+	uint64_t		fb_bytes_read;		// Bytes read from frame buffers (blending, copies)
+} Host_FrameStatTypeDef;
+
+extern Host_ConfigTypeDef		Host_Config;
+extern Host_CallStatTypeDef		Host_CallStat[HOST_SLOT_NO];
+extern Host_FrameStatTypeDef	Host_FrameStat;
+
+// Host API
+void Host_Init(void);
+uint8_t Host_Run(void (*init)(void), void (*main)(void));
+void Host_ResetStats(void);
+void Host_PrintStats(void);
+uint64_t Host_GetNs(void);
+uint64_t Host_GetCycles(void);
+uint8_t Host_SaveFrame(const char * filename);
+void * Host_GetShownFrameAddr(void);
+void Host_AudioStatus(uint8_t status);
+
+uint8_t Host_LCD_GetColorMode(void);
+uint8_t Host_LCD_GetBpp(void);
+
+// Internal - shared between host modules
+void Host_LCD_Bind(BSP_Driver_TypeDef * drv);
+void Host_FS_Bind(BSP_Driver_TypeDef * drv);
+void Host_FrameDone(void);
+uint8_t Host_ResolvePath(const char * path, char * out, uint32_t outsize);
+
+static inline void Host_Account(uint32_t slot, uint64_t t0, uint64_t c0) {
+	Host_CallStat[slot].calls++;
+	Host_CallStat[slot].ns += Host_GetNs() - t0;
+	Host_CallStat[slot].cycles += Host_GetCycles() - c0;
+}
+
+// Wrappers measuring every call made through the jump table
+#define HOST_WRAP(ret, fn, params, args) \
+	static ret W_##fn params { \
+		uint64_t t0 = Host_GetNs(), c0 = Host_GetCycles(); \
+		ret r = HOST_##fn args; \
+		Host_Account(HOST_SLOT(fn), t0, c0); \
+		return r; \
+	}
+
+#define HOST_WRAP_V(fn, params, args) \
+	static void W_##fn params { \
+		uint64_t t0 = Host_GetNs(), c0 = Host_GetCycles(); \
+		HOST_##fn args; \
+		Host_Account(HOST_SLOT(fn), t0, c0); \
+	}
+
+#define HOST_BIND(drv, fn) \
+	do { (drv)->fn = W_##fn; Host_CallStat[HOST_SLOT(fn)].name = #fn; } while (0)
+
+#endif /* HOST_BSP_HOST_H_ */
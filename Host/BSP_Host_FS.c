@@ -0,0 +1,494 @@
+/*****************************************************************
+ * MiniConsole V3 - Host BSP stand-in
+ *
+ * FATFS functions backed by local directory and resource memory
+ * manager (Res_*) backed by heap allocated region.
+ *******************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <time.h>
+#include <unistd.h>
+
+// FATFS DIR structure clashes with POSIX DIR from dirent.h
+#define DIR FF_DIR
+#include "BSP_Host.h"
+
+#define HOST_FS_MAX_FILES	16
+#define HOST_FS_MAX_DIRS	8
+#define HOST_PATH_MAX		512
+
+#define RES_ALIGN			32
+#define RES_HDR_SIZE		RES_ALIGN
+
+typedef struct {
+	FIL *		fp;
+	FILE *		f;
+} Host_FileTypeDef;
+
+typedef struct {
+	DIR *		dp;
+	void *		d;
+	char		path[HOST_PATH_MAX];
+} Host_DirTypeDef;
+
+static Host_FileTypeDef	host_files[HOST_FS_MAX_FILES];
+static Host_DirTypeDef	host_dirs[HOST_FS_MAX_DIRS];
+static char				host_homedir[HOST_PATH_MAX] = "0:/";
+
+// Resource block header (placed directly before payload)
+typedef struct {
+	uint32_t	size;		// Block size including header
+	uint32_t	used;		// Requested payload size (0 - free block)
+} Host_ResBlockTypeDef;
+
+static uint8_t *	res_base = NULL;
+static uint32_t		res_size = 0;
+
+
+// Path handling
+
+// Converts FATFS path into host path ("0:/" -> rootdir, relative paths -> home directory)
+uint8_t Host_ResolvePath(const char * path, char * out, uint32_t outsize) {
+	char tmp[HOST_PATH_MAX];
+	if (path == NULL) return BSP_ERROR;
+
+	if ((path[0] >= '0') && (path[0] <= '9') && (path[1] == ':')) {
+		snprintf(tmp, sizeof(tmp), "%s", path + 2);
+	} else if (path[0] == '/') {
+		snprintf(tmp, sizeof(tmp), "%s", path);
+	} else {
+		const char * home = host_homedir + 2;
+		snprintf(tmp, sizeof(tmp), "%s%s%s", home, (home[strlen(home) - 1] == '/') ? "" : "/", path);
+	}
+	if ((uint32_t)snprintf(out, outsize, "%s%s%s", Host_Config.rootdir, (tmp[0] == '/') ? "" : "/", tmp) >= outsize) return BSP_ERROR;
+	return BSP_OK;
+}
+
+static FRESULT errno_to_fresult(int err) {
+	switch (err) {
+	case ENOENT:	return FR_NO_FILE;
+	case ENOTDIR:	return FR_NO_PATH;
+	case EEXIST:	return FR_EXIST;
+	case EACCES:
+	case EPERM:		return FR_DENIED;
+	case EROFS:		return FR_WRITE_PROTECTED;
+	case EMFILE:	return FR_TOO_MANY_OPEN_FILES;
+	case ENAMETOOLONG: return FR_INVALID_NAME;
+	default:		return FR_DISK_ERR;
+	}
+}
+
+static Host_FileTypeDef * file_get(FIL * fp) {
+	for (uint32_t i = 0; i < HOST_FS_MAX_FILES; i++) if ((host_files[i].fp == fp) && (host_files[i].f)) return &host_files[i];
+	return NULL;
+}
+
+static uint8_t HOST_SetHomeDir(char * homeDir) {
+	if (homeDir == NULL) return BSP_ERROR;
+	if ((homeDir[0] >= '0') && (homeDir[0] <= '9') && (homeDir[1] == ':')) snprintf(host_homedir, sizeof(host_homedir), "%s", homeDir);
+	else snprintf(host_homedir, sizeof(host_homedir), "0:%s%s", (homeDir[0] == '/') ? "" : "/", homeDir);
+	return BSP_OK;
+}
+
+
+// FATFS - files
+
+static FRESULT HOST_f_open(FIL* fp, const TCHAR* path, BYTE mode) {
+	char hpath[HOST_PATH_MAX];
+	const char * fmode;
+	struct stat st;
+
+	if (fp == NULL) return FR_INVALID_OBJECT;
+	if (Host_ResolvePath(path, hpath, sizeof(hpath)) != BSP_OK) return FR_INVALID_NAME;
+
+	Host_FileTypeDef * slot = NULL;
+	for (uint32_t i = 0; i < HOST_FS_MAX_FILES; i++) {
+		if ((host_files[i].fp == fp) && (host_files[i].f)) {
+			fclose(host_files[i].f);
+			host_files[i].f = NULL;
+		}
+		if ((slot == NULL) && (host_files[i].f == NULL)) slot = &host_files[i];
+	}
+	if (slot == NULL) return FR_TOO_MANY_OPEN_FILES;
+
+	uint8_t exists = (stat(hpath, &st) == 0);
+	if ((mode & FA_CREATE_NEW) && (exists)) return FR_EXIST;
+	if ((!exists) && !(mode & (FA_CREATE_NEW | FA_CREATE_ALWAYS | FA_OPEN_ALWAYS))) return FR_NO_FILE;
+
+	if (mode & FA_CREATE_ALWAYS) fmode = (mode & FA_READ) ? "w+b" : "wb";
+	else if (!exists) fmode = (mode & FA_READ) ? "w+b" : "wb";
+	else if (mode & FA_WRITE) fmode = "r+b";
+	else fmode = "rb";
+
+	FILE * f = fopen(hpath, fmode);
+	if (f == NULL) return errno_to_fresult(errno);
+
+	memset(fp, 0, sizeof(FIL) - FF_MAX_SS);
+	fp->flag = mode;
+	fseek(f, 0, SEEK_END);
+	fp->obj.objsize = (FSIZE_t)ftell(f);
+	if ((mode & FA_OPEN_APPEND) == FA_OPEN_APPEND) {
+		fp->fptr = fp->obj.objsize;
+	} else {
+		fseek(f, 0, SEEK_SET);
+	}
+	slot->fp = fp;
+	slot->f = f;
+	return FR_OK;
+}
+
+static FRESULT HOST_f_close(FIL* fp) {
+	Host_FileTypeDef * hf = file_get(fp);
+	if (hf == NULL) return FR_INVALID_OBJECT;
+	fclose(hf->f);
+	hf->f = NULL;
+	hf->fp = NULL;
+	return FR_OK;
+}
+
+static FRESULT HOST_f_read(FIL* fp, void* buff, UINT btr, UINT* br) {
+	Host_FileTypeDef * hf = file_get(fp);
+	if (br) *br = 0;
+	if (hf == NULL) return FR_INVALID_OBJECT;
+	size_t n = fread(buff, 1, btr, hf->f);
+	if ((n < btr) && (ferror(hf->f))) return FR_DISK_ERR;
+	fp->fptr += n;
+	if (br) *br = (UINT)n;
+	return FR_OK;
+}
+
+static FRESULT HOST_f_write(FIL* fp, const void* buff, UINT btw, UINT* bw) {
+	Host_FileTypeDef * hf = file_get(fp);
+	if (bw) *bw = 0;
+	if (hf == NULL) return FR_INVALID_OBJECT;
+	if (!(fp->flag & FA_WRITE)) return FR_DENIED;
+	size_t n = fwrite(buff, 1, btw, hf->f);
+	fp->fptr += n;
+	if (fp->fptr > fp->obj.objsize) fp->obj.objsize = fp->fptr;
+	if (bw) *bw = (UINT)n;
+	return (n == btw) ? FR_OK : FR_DISK_ERR;
+}
+
+static FRESULT HOST_f_lseek(FIL* fp, FSIZE_t ofs) {
+	Host_FileTypeDef * hf = file_get(fp);
+	if (hf == NULL) return FR_INVALID_OBJECT;
+	if ((ofs > fp->obj.objsize) && !(fp->flag & FA_WRITE)) ofs = fp->obj.objsize;
+	if (fseek(hf->f, (long)ofs, SEEK_SET) != 0) return FR_DISK_ERR;
+	fp->fptr = ofs;
+	return FR_OK;
+}
+
+static FRESULT HOST_f_truncate(FIL* fp) {
+	Host_FileTypeDef * hf = file_get(fp);
+	if (hf == NULL) return FR_INVALID_OBJECT;
+	fflush(hf->f);
+	if (ftruncate(fileno(hf->f), (off_t)fp->fptr) != 0) return FR_DISK_ERR;
+	fp->obj.objsize = fp->fptr;
+	return FR_OK;
+}
+
+static FRESULT HOST_f_sync(FIL* fp) {
+	Host_FileTypeDef * hf = file_get(fp);
+	if (hf == NULL) return FR_INVALID_OBJECT;
+	fflush(hf->f);
+	return FR_OK;
+}
+
+
+// FATFS - directories
+
+static void fill_info(const char * hpath, const char * name, FILINFO * fno) {
+	struct stat st;
+	memset(fno, 0, sizeof(FILINFO));
+	snprintf(fno->fname, sizeof(fno->fname), "%s", name);
+	snprintf(fno->altname, sizeof(fno->altname), "%.12s", name);
+	if (stat(hpath, &st) != 0) return;
+	fno->fsize = S_ISDIR(st.st_mode) ? 0 : (FSIZE_t)st.st_size;
+	fno->fattrib = S_ISDIR(st.st_mode) ? AM_DIR : AM_ARC;
+	struct tm tm;
+	localtime_r(&st.st_mtime, &tm);
+	fno->fdate = (WORD)(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday);
+	fno->ftime = (WORD)((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2));
+}
+
+static FRESULT HOST_f_opendir(DIR* dp, const TCHAR* path) {
+	char hpath[HOST_PATH_MAX];
+	if (dp == NULL) return FR_INVALID_OBJECT;
+	if (Host_ResolvePath(path, hpath, sizeof(hpath)) != BSP_OK) return FR_INVALID_NAME;
+	for (uint32_t i = 0; i < HOST_FS_MAX_DIRS; i++) {
+		if (host_dirs[i].d != NULL) continue;
+		host_dirs[i].d = opendir(hpath);
+		if (host_dirs[i].d == NULL) return FR_NO_PATH;
+		host_dirs[i].dp = dp;
+		snprintf(host_dirs[i].path, sizeof(host_dirs[i].path), "%s", hpath);
+		memset(dp, 0, sizeof(DIR));
+		return FR_OK;
+	}
+	return FR_TOO_MANY_OPEN_FILES;
+}
+
+static FRESULT HOST_f_closedir(DIR* dp) {
+	for (uint32_t i = 0; i < HOST_FS_MAX_DIRS; i++) {
+		if ((host_dirs[i].dp != dp) || (host_dirs[i].d == NULL)) continue;
+		closedir(host_dirs[i].d);
+		host_dirs[i].d = NULL;
+		host_dirs[i].dp = NULL;
+		return FR_OK;
+	}
+	return FR_INVALID_OBJECT;
+}
+
+static FRESULT HOST_f_readdir(DIR* dp, FILINFO* fno) {
+	for (uint32_t i = 0; i < HOST_FS_MAX_DIRS; i++) {
+		if ((host_dirs[i].dp != dp) || (host_dirs[i].d == NULL)) continue;
+		struct dirent * de;
+		do {
+			de = readdir(host_dirs[i].d);
+		} while ((de) && ((strcmp(de->d_name, ".") == 0) || (strcmp(de->d_name, "..") == 0)));
+		if (de == NULL) {
+			memset(fno, 0, sizeof(FILINFO));
+			return FR_OK;
+		}
+		char hpath[HOST_PATH_MAX * 2];
+		snprintf(hpath, sizeof(hpath), "%s/%s", host_dirs[i].path, de->d_name);
+		fill_info(hpath, de->d_name, fno);
+		dp->dptr++;
+		return FR_OK;
+	}
+	return FR_INVALID_OBJECT;
+}
+
+static FRESULT HOST_f_mkdir(const TCHAR* path) {
+	char hpath[HOST_PATH_MAX];
+	if (Host_ResolvePath(path, hpath, sizeof(hpath)) != BSP_OK) return FR_INVALID_NAME;
+	return (mkdir(hpath, 0777) == 0) ? FR_OK : errno_to_fresult(errno);
+}
+
+static FRESULT HOST_f_unlink(const TCHAR* path) {
+	char hpath[HOST_PATH_MAX];
+	if (Host_ResolvePath(path, hpath, sizeof(hpath)) != BSP_OK) return FR_INVALID_NAME;
+	return (remove(hpath) == 0) ? FR_OK : errno_to_fresult(errno);
+}
+
+static FRESULT HOST_f_rename(const TCHAR* path_old, const TCHAR* path_new) {
+	char hold[HOST_PATH_MAX], hnew[HOST_PATH_MAX];
+	if (Host_ResolvePath(path_old, hold, sizeof(hold)) != BSP_OK) return FR_INVALID_NAME;
+	if (Host_ResolvePath(path_new, hnew, sizeof(hnew)) != BSP_OK) return FR_INVALID_NAME;
+	return (rename(hold, hnew) == 0) ? FR_OK : errno_to_fresult(errno);
+}
+
+static FRESULT HOST_f_stat(const TCHAR* path, FILINFO* fno) {
+	char hpath[HOST_PATH_MAX];
+	struct stat st;
+	if (Host_ResolvePath(path, hpath, sizeof(hpath)) != BSP_OK) return FR_INVALID_NAME;
+	if (stat(hpath, &st) != 0) return errno_to_fresult(errno);
+	const char * name = strrchr(hpath, '/');
+	if (fno) fill_info(hpath, (name) ? name + 1 : hpath, fno);
+	return FR_OK;
+}
+
+static FRESULT HOST_f_getfree(const TCHAR* path, DWORD* nclst, FATFS** fatfs) {
+	static FATFS fs;
+	char hpath[HOST_PATH_MAX];
+	struct statvfs sv;
+	if (Host_ResolvePath(path, hpath, sizeof(hpath)) != BSP_OK) return FR_INVALID_NAME;
+	if (statvfs(hpath, &sv) != 0) return FR_NOT_READY;
+	memset(&fs, 0, sizeof(fs));
+	fs.fs_type = FS_EXFAT;
+	fs.ssize = 512;
+	fs.csize = 64;
+	fs.n_fatent = (DWORD)((uint64_t)sv.f_blocks * sv.f_frsize / (512 * 64)) + 2;
+	if (nclst) *nclst = (DWORD)((uint64_t)sv.f_bavail * sv.f_frsize / (512 * 64));
+	if (fatfs) *fatfs = &fs;
+	return FR_OK;
+}
+
+static FRESULT HOST_f_getlabel(const TCHAR* path, TCHAR* label, DWORD* vsn) {
+	(void)path;
+	if (label) strcpy(label, "HOST");
+	if (vsn) *vsn = 0x484F5354;
+	return FR_OK;
+}
+
+static int HOST_f_putc(TCHAR c, FIL* fp) {
+	UINT bw;
+	return (HOST_f_write(fp, &c, 1, &bw) == FR_OK) ? 1 : -1;
+}
+
+static int HOST_f_puts(const TCHAR* str, FIL* cp) {
+	UINT bw;
+	UINT len = (UINT)strlen(str);
+	return (HOST_f_write(cp, str, len, &bw) == FR_OK) ? (int)bw : -1;
+}
+
+static TCHAR* HOST_f_gets(TCHAR* buff, int len, FIL* fp) {
+	Host_FileTypeDef * hf = file_get(fp);
+	if (hf == NULL) return NULL;
+	if (fgets(buff, len, hf->f) == NULL) return NULL;
+	fp->fptr += strlen(buff);
+	return buff;
+}
+
+// Variadic - measured directly instead of through HOST_WRAP
+static int W_f_printf(FIL* fp, const TCHAR* str, ...) {
+	uint64_t t0 = Host_GetNs(), c0 = Host_GetCycles();
+	char buf[1024];
+	va_list ap;
+	va_start(ap, str);
+	int n = vsnprintf(buf, sizeof(buf), str, ap);
+	va_end(ap);
+	if (n > (int)sizeof(buf) - 1) n = sizeof(buf) - 1;
+	UINT bw = 0;
+	if ((n > 0) && (HOST_f_write(fp, buf, (UINT)n, &bw) != FR_OK)) n = -1;
+	Host_Account(HOST_SLOT(f_printf), t0, c0);
+	return n;
+}
+
+
+// Resources - first fit allocator over heap region
+
+static uint8_t HOST_Res_Init(void * resAddr, uint32_t resSize) {
+	(void)resAddr;		// Address of SDRAM region is not valid on host
+	free(res_base);
+	res_size = resSize & ~(uint32_t)(RES_ALIGN - 1);
+	res_base = aligned_alloc(RES_ALIGN, res_size);
+	if (res_base == NULL) {
+		res_size = 0;
+		return BSP_ERROR;
+	}
+	Host_ResBlockTypeDef * blk = (Host_ResBlockTypeDef *)res_base;
+	blk->size = res_size;
+	blk->used = 0;
+	return BSP_OK;
+}
+
+static void * HOST_Res_Alloc(uint32_t resSize) {
+	if ((res_base == NULL) || (resSize == 0)) return NULL;
+	uint32_t need = ((resSize + RES_ALIGN - 1) & ~(uint32_t)(RES_ALIGN - 1)) + RES_HDR_SIZE;
+	uint32_t ofs = 0;
+	while (ofs < res_size) {
+		Host_ResBlockTypeDef * blk = (Host_ResBlockTypeDef *)(res_base + ofs);
+		if ((blk->used == 0) && (blk->size >= need)) {
+			if (blk->size - need >= 2 * RES_HDR_SIZE) {
+				Host_ResBlockTypeDef * next = (Host_ResBlockTypeDef *)(res_base + ofs + need);
+				next->size = blk->size - need;
+				next->used = 0;
+				blk->size = need;
+			}
+			blk->used = resSize;
+			return res_base + ofs + RES_HDR_SIZE;
+		}
+		ofs += blk->size;
+	}
+	return NULL;
+}
+
+static uint8_t HOST_Res_Free(void * objAddr) {
+	if ((res_base == NULL) || ((uint8_t *)objAddr < res_base + RES_HDR_SIZE) || ((uint8_t *)objAddr >= res_base + res_size)) return BSP_ERROR;
+	Host_ResBlockTypeDef * blk = (Host_ResBlockTypeDef *)((uint8_t *)objAddr - RES_HDR_SIZE);
+	if (blk->used == 0) return BSP_ERROR;
+	blk->used = 0;
+
+	// Merge neighbouring free blocks
+	uint32_t ofs = 0;
+	while (ofs < res_size) {
+		Host_ResBlockTypeDef * cur = (Host_ResBlockTypeDef *)(res_base + ofs);
+		if (cur->used == 0) {
+			while (ofs + cur->size < res_size) {
+				Host_ResBlockTypeDef * next = (Host_ResBlockTypeDef *)(res_base + ofs + cur->size);
+				if (next->used) break;
+				cur->size += next->size;
+			}
+		}
+		ofs += cur->size;
+	}
+	return BSP_OK;
+}
+
+static uint32_t HOST_Res_GetSize(void * objAddr) {
+	if ((res_base == NULL) || ((uint8_t *)objAddr < res_base + RES_HDR_SIZE) || ((uint8_t *)objAddr >= res_base + res_size)) return 0;
+	return ((Host_ResBlockTypeDef *)((uint8_t *)objAddr - RES_HDR_SIZE))->used;
+}
+
+static void* HOST_Res_Load(char *filename) {
+	FIL fp;
+	UINT br;
+	if (HOST_f_open(&fp, filename, FA_READ) != FR_OK) return NULL;
+	uint32_t size = (uint32_t)fp.obj.objsize;
+	void * obj = HOST_Res_Alloc(size ? size : 1);
+	if ((obj == NULL) || (HOST_f_read(&fp, obj, size, &br) != FR_OK) || (br != size)) {
+		if (obj) HOST_Res_Free(obj);
+		HOST_f_close(&fp);
+		return NULL;
+	}
+	HOST_f_close(&fp);
+	return obj;
+}
+
+
+// Wrappers
+
+HOST_WRAP(uint8_t, SetHomeDir, (char * homeDir), (homeDir))
+HOST_WRAP(FRESULT, f_open, (FIL* fp, const TCHAR* path, BYTE mode), (fp, path, mode))
+HOST_WRAP(FRESULT, f_close, (FIL* fp), (fp))
+HOST_WRAP(FRESULT, f_read, (FIL* fp, void* buff, UINT btr, UINT* br), (fp, buff, btr, br))
+HOST_WRAP(FRESULT, f_write, (FIL* fp, const void* buff, UINT btw, UINT* bw), (fp, buff, btw, bw))
+HOST_WRAP(FRESULT, f_lseek, (FIL* fp, FSIZE_t ofs), (fp, ofs))
+HOST_WRAP(FRESULT, f_truncate, (FIL* fp), (fp))
+HOST_WRAP(FRESULT, f_sync, (FIL* fp), (fp))
+HOST_WRAP(FRESULT, f_opendir, (DIR* dp, const TCHAR* path), (dp, path))
+HOST_WRAP(FRESULT, f_closedir, (DIR* dp), (dp))
+HOST_WRAP(FRESULT, f_readdir, (DIR* dp, FILINFO* fno), (dp, fno))
+HOST_WRAP(FRESULT, f_mkdir, (const TCHAR* path), (path))
+HOST_WRAP(FRESULT, f_unlink, (const TCHAR* path), (path))
+HOST_WRAP(FRESULT, f_rename, (const TCHAR* path_old, const TCHAR* path_new), (path_old, path_new))
+HOST_WRAP(FRESULT, f_stat, (const TCHAR* path, FILINFO* fno), (path, fno))
+HOST_WRAP(FRESULT, f_getfree, (const TCHAR* path, DWORD* nclst, FATFS** fatfs), (path, nclst, fatfs))
+HOST_WRAP(FRESULT, f_getlabel, (const TCHAR* path, TCHAR* label, DWORD* vsn), (path, label, vsn))
+HOST_WRAP(int, f_putc, (TCHAR c, FIL* fp), (c, fp))
+HOST_WRAP(int, f_puts, (const TCHAR* str, FIL* cp), (str, cp))
+HOST_WRAP(TCHAR*, f_gets, (TCHAR* buff, int len, FIL* fp), (buff, len, fp))
+
+HOST_WRAP(uint8_t, Res_Init, (void * resAddr, uint32_t resSize), (resAddr, resSize))
+HOST_WRAP(void*, Res_Alloc, (uint32_t resSize), (resSize))
+HOST_WRAP(uint8_t, Res_Free, (void * objAddr), (objAddr))
+HOST_WRAP(void*, Res_Load, (char *filename), (filename))
+HOST_WRAP(uint32_t, Res_GetSize, (void * objAddr), (objAddr))
+
+void Host_FS_Bind(BSP_Driver_TypeDef * drv) {
+	HOST_BIND(drv, SetHomeDir);
+	HOST_BIND(drv, f_open);
+	HOST_BIND(drv, f_close);
+	HOST_BIND(drv, f_read);
+	HOST_BIND(drv, f_write);
+	HOST_BIND(drv, f_lseek);
+	HOST_BIND(drv, f_truncate);
+	HOST_BIND(drv, f_sync);
+	HOST_BIND(drv, f_opendir);
+	HOST_BIND(drv, f_closedir);
+	HOST_BIND(drv, f_readdir);
+	HOST_BIND(drv, f_mkdir);
+	HOST_BIND(drv, f_unlink);
+	HOST_BIND(drv, f_rename);
+	HOST_BIND(drv, f_stat);
+	HOST_BIND(drv, f_getfree);
+	HOST_BIND(drv, f_getlabel);
+	HOST_BIND(drv, f_putc);
+	HOST_BIND(drv, f_puts);
+	HOST_BIND(drv, f_printf);
+	HOST_BIND(drv, f_gets);
+
+	HOST_BIND(drv, Res_Init);
+	HOST_BIND(drv, Res_Alloc);
+	HOST_BIND(drv, Res_Free);
+	HOST_BIND(drv, Res_Load);
+	HOST_BIND(drv, Res_GetSize);
+}
@@ -0,0 +1,782 @@
+/*****************************************************************
+ * MiniConsole V3 - Host BSP stand-in
+ *
+ * LCD and G2D library rendered by CPU into in-memory frame buffers.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "BSP_Host.h"
+
+#define LCD_PIXELS		(LCD_WIDTH * LCD_HEIGHT)
+
+static struct {
+	uint8_t		mode;
+	uint8_t		bpp;
+	uint8_t		bufmode;
+	uint8_t *	buf[LCD_BUFFER_MODE_TRIPLE];
+	uint8_t *	cache;
+	uint8_t		edit;
+	uint8_t		shown;
+	uint32_t	bgcolor;
+	uint32_t	clut[256];
+	uint8_t		permission;
+	uint64_t	next_vsync_ns;
+	uint64_t	frame_start_ns;
+	uint64_t	last_ready_ns;
+	uint32_t	frametime;
+	uint8_t		backlight;
+	uint8_t		backlight_on;
+} lcd;
+
+static const uint8_t mode_bpp[7] = { 0, 1, 2, 3, 2, 2, 4 };
+
+
+// Pixel access
+
+uint8_t Host_LCD_GetColorMode(void) {
+	return lcd.mode;
+}
+
+uint8_t Host_LCD_GetBpp(void) {
+	return lcd.bpp;
+}
+
+static inline uint8_t * px_addr(uint8_t * frame, int32_t x, int32_t y) {
+	return frame + ((uint32_t)y * LCD_WIDTH + (uint32_t)x) * lcd.bpp;
+}
+
+static inline uint32_t px_get(const uint8_t * p) {
+	switch (lcd.mode) {
+	case LCD_COLOR_MODE_ARGB8888:	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	case LCD_COLOR_MODE_RGB888:		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+	case LCD_COLOR_MODE_L8:			return p[0];
+	default:						return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+	}
+}
+
+static inline void px_set(uint8_t * p, uint32_t c) {
+	switch (lcd.mode) {
+	case LCD_COLOR_MODE_ARGB8888:	p[3] = (uint8_t)(c >> 24); /* fall through */
+	case LCD_COLOR_MODE_RGB888:		p[2] = (uint8_t)(c >> 16); p[1] = (uint8_t)(c >> 8); p[0] = (uint8_t)c; break;
+	case LCD_COLOR_MODE_L8:			p[0] = (uint8_t)c; break;
+	default:						p[1] = (uint8_t)(c >> 8); p[0] = (uint8_t)c; break;
+	}
+}
+
+// Native colour -> ARGB8888
+static uint32_t to_argb(uint32_t c) {
+	uint32_t a, r, g, b;
+	switch (lcd.mode) {
+	case LCD_COLOR_MODE_ARGB8888:
+	case LCD_COLOR_MODE_RGB888:
+		return c;
+	case LCD_COLOR_MODE_ARGB4444:
+		a = (c >> 12) & 0x0F; r = (c >> 8) & 0x0F; g = (c >> 4) & 0x0F; b = c & 0x0F;
+		return (a * 17) << 24 | (r * 17) << 16 | (g * 17) << 8 | (b * 17);
+	case LCD_COLOR_MODE_ARGB1555:
+		a = (c & 0x8000) ? 255 : 0; r = (c >> 10) & 0x1F; g = (c >> 5) & 0x1F; b = c & 0x1F;
+		return a << 24 | ((r << 3) | (r >> 2)) << 16 | ((g << 3) | (g >> 2)) << 8 | ((b << 3) | (b >> 2));
+	case LCD_COLOR_MODE_AL88:
+		return ((c & 0xFF00) << 16) | (lcd.clut[c & 0xFF] & 0xFFFFFF);
+	case LCD_COLOR_MODE_L8:
+		return 0xFF000000 | (lcd.clut[c & 0xFF] & 0xFFFFFF);
+	}
+	return c;
+}
+
+// ARGB8888 -> native colour (L8 and AL88 keep index from source colour)
+static uint32_t from_argb(uint32_t argb, uint32_t index) {
+	uint32_t a = argb >> 24, r = (argb >> 16) & 0xFF, g = (argb >> 8) & 0xFF, b = argb & 0xFF;
+	switch (lcd.mode) {
+	case LCD_COLOR_MODE_ARGB8888:
+	case LCD_COLOR_MODE_RGB888:		return argb;
+	case LCD_COLOR_MODE_ARGB4444:	return (a >> 4) << 12 | (r >> 4) << 8 | (g >> 4) << 4 | (b >> 4);
+	case LCD_COLOR_MODE_ARGB1555:	return (a >= 128 ? 0x8000 : 0) | (r >> 3) << 10 | (g >> 3) << 5 | (b >> 3);
+	case LCD_COLOR_MODE_AL88:		return (a << 8) | (index & 0xFF);
+	case LCD_COLOR_MODE_L8:			return index & 0xFF;
+	}
+	return argb;
+}
+
+static inline uint8_t color_alpha(uint32_t c) {
+	return (uint8_t)(to_argb(c) >> 24);
+}
+
+static inline uint8_t in_frame(int32_t x, int32_t y) {
+	return (lcd.buf[0] != NULL) && (x >= 0) && (y >= 0) && (x < LCD_WIDTH) && (y < LCD_HEIGHT);
+}
+
+static inline void put(int32_t x, int32_t y, uint32_t c) {
+	if (!in_frame(x, y)) return;
+	px_set(px_addr(lcd.buf[lcd.edit], x, y), c);
+	Host_FrameStat.fb_bytes_written += lcd.bpp;
+}
+
+// Blends ARGB8888 colour (with additional alpha) over pixel. Index is used for CLUT modes.
+static inline void blend(int32_t x, int32_t y, uint32_t argb, uint32_t alpha, uint32_t index) {
+	if (!in_frame(x, y)) return;
+	uint32_t a = ((argb >> 24) * alpha + 127) / 255;
+	if (a == 0) return;
+	uint8_t * p = px_addr(lcd.buf[lcd.edit], x, y);
+	if (a < 255) {
+		if ((lcd.mode == LCD_COLOR_MODE_L8) && (a < 128)) return;
+		uint32_t d = to_argb(px_get(p));
+		uint32_t na = 255 - a;
+		uint32_t r = ((((argb >> 16) & 0xFF) * a) + (((d >> 16) & 0xFF) * na) + 127) / 255;
+		uint32_t g = ((((argb >> 8) & 0xFF) * a) + (((d >> 8) & 0xFF) * na) + 127) / 255;
+		uint32_t b = (((argb & 0xFF) * a) + ((d & 0xFF) * na) + 127) / 255;
+		uint32_t oa = a + (((d >> 24) * na + 127) / 255);
+		if ((lcd.mode == LCD_COLOR_MODE_AL88) && (a < 128)) index = px_get(p);
+		argb = oa << 24 | r << 16 | g << 8 | b;
+		Host_FrameStat.fb_bytes_read += lcd.bpp;
+	} else {
+		argb |= 0xFF000000;
+	}
+	px_set(p, from_argb(argb, index));
+	Host_FrameStat.fb_bytes_written += lcd.bpp;
+}
+
+static void fill_span(int32_t x, int32_t y, int32_t len, uint32_t c) {
+	if ((lcd.buf[0] == NULL) || (y < 0) || (y >= LCD_HEIGHT)) return;
+	if (x < 0) { len += x; x = 0; }
+	if (x + len > LCD_WIDTH) len = LCD_WIDTH - x;
+	if (len <= 0) return;
+	uint8_t * p = px_addr(lcd.buf[lcd.edit], x, y);
+	for (int32_t i = 0; i < len; i++, p += lcd.bpp) px_set(p, c);
+	Host_FrameStat.fb_bytes_written += (uint64_t)len * lcd.bpp;
+}
+
+static void blend_span(int32_t x, int32_t y, int32_t len, uint32_t c) {
+	uint32_t argb = to_argb(c);
+	for (int32_t i = 0; i < len; i++) blend(x + i, y, argb, 255, c);
+}
+
+
+// LCD library
+
+static void HOST_LCD_Init(uint8_t color_mode, uint8_t buffer_mode, uint32_t bgcolor, uint32_t *clut) {
+	if ((color_mode < LCD_COLOR_MODE_L8) || (color_mode > LCD_COLOR_MODE_ARGB8888)) return;
+	if ((buffer_mode != LCD_BUFFER_MODE_DOUBLE) && (buffer_mode != LCD_BUFFER_MODE_TRIPLE)) return;
+
+	for (uint8_t i = 0; i < LCD_BUFFER_MODE_TRIPLE; i++) {
+		free(lcd.buf[i]);
+		lcd.buf[i] = NULL;
+	}
+	free(lcd.cache);
+
+	lcd.mode = color_mode;
+	lcd.bpp = mode_bpp[color_mode];
+	lcd.bufmode = buffer_mode;
+	lcd.bgcolor = bgcolor;
+	for (uint32_t i = 0; i < 256; i++) lcd.clut[i] = (clut) ? clut[i] : (i << 16 | i << 8 | i);
+	for (uint8_t i = 0; i < buffer_mode; i++) lcd.buf[i] = calloc(LCD_PIXELS, lcd.bpp);
+	lcd.cache = calloc(LCD_PIXELS, lcd.bpp);
+	lcd.edit = 0;
+	lcd.shown = buffer_mode - 1;
+	lcd.permission = 1;
+	lcd.frame_start_ns = 0;
+	lcd.last_ready_ns = 0;
+	lcd.frametime = 0;
+	lcd.backlight = 100;
+	lcd.backlight_on = 1;
+
+	for (uint8_t i = 0; i < buffer_mode; i++) {
+		lcd.edit = i;
+		for (int32_t y = 0; y < LCD_HEIGHT; y++) fill_span(0, y, LCD_WIDTH, bgcolor);
+	}
+	lcd.edit = 0;
+}
+
+static void HOST_LCD_FrameReady(void) {
+	uint64_t now = Host_GetNs();
+
+	if (lcd.frame_start_ns == 0) lcd.frame_start_ns = now;
+	uint64_t cost = now - lcd.frame_start_ns;
+	Host_FrameStat.frames++;
+	Host_FrameStat.frame_ns_total += cost;
+	if (cost < Host_FrameStat.frame_ns_min) Host_FrameStat.frame_ns_min = cost;
+	if (cost > Host_FrameStat.frame_ns_max) Host_FrameStat.frame_ns_max = cost;
+	if (lcd.last_ready_ns) lcd.frametime = (uint32_t)((now - lcd.last_ready_ns + 500000) / 1000000);
+	lcd.last_ready_ns = now;
+	lcd.frame_start_ns = 0;
+
+	if (lcd.bufmode) {
+		lcd.shown = lcd.edit;
+		lcd.edit = (uint8_t)((lcd.edit + 1) % lcd.bufmode);
+	}
+
+	if (Host_Config.vsync_hz) {
+		uint64_t period = 1000000000ull / Host_Config.vsync_hz;
+		lcd.next_vsync_ns = ((now / period) + 1) * period;
+		lcd.permission = 0;
+	} else {
+		lcd.permission = 1;
+	}
+
+	Host_FrameDone();
+}
+
+static uint8_t HOST_LCD_GetEditPermission(void) {
+	if ((!lcd.permission) && (Host_GetNs() >= lcd.next_vsync_ns)) lcd.permission = 1;
+	if ((lcd.permission) && (lcd.frame_start_ns == 0)) lcd.frame_start_ns = Host_GetNs();
+	return lcd.permission;
+}
+
+static void HOST_LCD_SetBackLight(uint8_t value, uint8_t dimspeed) {
+	(void)dimspeed;
+	lcd.backlight = value;
+}
+
+static uint8_t HOST_LCD_GetBackLight(void) {
+	return lcd.backlight;
+}
+
+static void HOST_LCD_BacklLightOff(void) {
+	lcd.backlight_on = 0;
+}
+
+static void HOST_LCD_BackLightOn(void) {
+	lcd.backlight_on = 1;
+}
+
+static uint32_t HOST_LCD_GetFrameTime(void) {
+	return lcd.frametime;
+}
+
+static void HOST_LCD_UpdateCLUT(uint32_t *clut) {
+	if (clut == NULL) return;
+	memcpy(lcd.clut, clut, sizeof(lcd.clut));
+}
+
+static void * HOST_LCD_GetEditFrameAddr(void) {
+	return lcd.buf[lcd.edit];
+}
+
+static void HOST_LCD_SetDisplayWindow(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+	(void)x; (void)y; (void)width; (void)height;
+}
+
+void * Host_GetShownFrameAddr(void) {
+	return lcd.buf[lcd.shown];
+}
+
+// Saves last shown frame as binary PPM
+uint8_t Host_SaveFrame(const char * filename) {
+	if (lcd.buf[0] == NULL) return BSP_ERROR;
+	FILE * f = fopen(filename, "wb");
+	if (f == NULL) return BSP_ERROR;
+	fprintf(f, "P6\n%d %d\n255\n", LCD_WIDTH, LCD_HEIGHT);
+	uint8_t * frame = lcd.buf[lcd.shown];
+	for (uint32_t i = 0; i < LCD_PIXELS; i++) {
+		uint32_t c = to_argb(px_get(frame + i * lcd.bpp));
+		uint8_t rgb[3] = { (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c };
+		fwrite(rgb, 1, 3, f);
+	}
+	fclose(f);
+	return BSP_OK;
+}
+
+
+// G2D library - frame operations
+
+static void HOST_G2D_FillFrame(uint32_t color) {
+	for (int32_t y = 0; y < LCD_HEIGHT; y++) fill_span(0, y, LCD_WIDTH, color);
+}
+
+static void HOST_G2D_ClearFrame(void) {
+	HOST_G2D_FillFrame(lcd.bgcolor);
+}
+
+static void HOST_G2D_CopyScrollPrevFrame(int16_t dx, int16_t dy) {
+	if ((lcd.buf[0] == NULL) || (lcd.edit == lcd.shown)) return;
+	int32_t w = LCD_WIDTH - abs(dx);
+	if (w <= 0) return;
+	int32_t sx = (dx < 0) ? -dx : 0;
+	int32_t tx = (dx > 0) ? dx : 0;
+	for (int32_t y = 0; y < LCD_HEIGHT; y++) {
+		int32_t sy = y - dy;
+		if ((sy < 0) || (sy >= LCD_HEIGHT)) continue;
+		memcpy(px_addr(lcd.buf[lcd.edit], tx, y), px_addr(lcd.buf[lcd.shown], sx, sy), (size_t)w * lcd.bpp);
+		Host_FrameStat.fb_bytes_written += (uint64_t)w * lcd.bpp;
+		Host_FrameStat.fb_bytes_read += (uint64_t)w * lcd.bpp;
+	}
+}
+
+static void HOST_G2D_CopyPrevFrame(void) {
+	HOST_G2D_CopyScrollPrevFrame(0, 0);
+}
+
+static void HOST_G2D_CacheFrame(void) {
+	if (lcd.buf[0] == NULL) return;
+	memcpy(lcd.cache, lcd.buf[lcd.edit], (size_t)LCD_PIXELS * lcd.bpp);
+	Host_FrameStat.fb_bytes_read += (uint64_t)LCD_PIXELS * lcd.bpp;
+}
+
+static void HOST_G2D_RestoreFrame(void) {
+	if (lcd.buf[0] == NULL) return;
+	memcpy(lcd.buf[lcd.edit], lcd.cache, (size_t)LCD_PIXELS * lcd.bpp);
+	Host_FrameStat.fb_bytes_written += (uint64_t)LCD_PIXELS * lcd.bpp;
+}
+
+
+// G2D library - primitives
+
+static void HOST_G2D_DrawPixel(int16_t x, int16_t y, uint32_t color) {
+	put(x, y, color);
+}
+
+static void HOST_G2D_DrawHLine(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	fill_span(x, y, length, color);
+}
+
+static void HOST_G2D_DrawHLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	blend_span(x, y, length, color);
+}
+
+static void HOST_G2D_DrawVLine(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	for (int32_t i = 0; i < length; i++) put(x, y + i, color);
+}
+
+static void HOST_G2D_DrawVLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	uint32_t argb = to_argb(color);
+	for (int32_t i = 0; i < length; i++) blend(x, y + i, argb, 255, color);
+}
+
+static void HOST_G2D_DrawLine(int16_t X1, int16_t Y1, int16_t X2, int16_t Y2, uint32_t color) {
+	int32_t x = X1, y = Y1;
+	int32_t dx = abs(X2 - X1), sx = (X1 < X2) ? 1 : -1;
+	int32_t dy = -abs(Y2 - Y1), sy = (Y1 < Y2) ? 1 : -1;
+	int32_t err = dx + dy;
+	while (1) {
+		put(x, y, color);
+		if ((x == X2) && (y == Y2)) break;
+		int32_t e2 = 2 * err;
+		if (e2 >= dy) { err += dy; x += sx; }
+		if (e2 <= dx) { err += dx; y += sy; }
+	}
+}
+
+static void HOST_G2D_DrawRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	if ((width == 0) || (height == 0)) return;
+	fill_span(x, y, width, color);
+	fill_span(x, y + height - 1, width, color);
+	HOST_G2D_DrawVLine(x, y + 1, (int16_t)(height - 2), color);
+	HOST_G2D_DrawVLine((int16_t)(x + width - 1), y + 1, (int16_t)(height - 2), color);
+}
+
+static void HOST_G2D_DrawFillRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	for (int32_t i = 0; i < height; i++) fill_span(x, y + i, width, color);
+}
+
+static void HOST_G2D_DrawFillRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	for (int32_t i = 0; i < height; i++) blend_span(x, y + i, width, color);
+}
+
+static void HOST_G2D_DrawCircle(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	int32_t cx = r, cy = 0, err = 1 - (int32_t)r;
+	while (cx >= cy) {
+		put(x + cx, y + cy, color); put(x - cx, y + cy, color);
+		put(x + cx, y - cy, color); put(x - cx, y - cy, color);
+		put(x + cy, y + cx, color); put(x - cy, y + cx, color);
+		put(x + cy, y - cx, color); put(x - cy, y - cx, color);
+		cy++;
+		if (err < 0) {
+			err += 2 * cy + 1;
+		} else {
+			cx--;
+			err += 2 * (cy - cx) + 1;
+		}
+	}
+}
+
+// Filled circle drawn as spans, every row exactly once (safe for blending)
+static void fill_circle(int16_t x, int16_t y, uint16_t r, uint32_t color, void (*span)(int32_t, int32_t, int32_t, uint32_t)) {
+	int32_t rr = (int32_t)r * r;
+	for (int32_t dy = -(int32_t)r; dy <= (int32_t)r; dy++) {
+		int32_t dx = (int32_t)sqrt((double)(rr - dy * dy));
+		span(x - dx, y + dy, 2 * dx + 1, color);
+	}
+}
+
+static void HOST_G2D_DrawFillCircle(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	fill_circle(x, y, r, color, fill_span);
+}
+
+static void HOST_G2D_DrawFillCircleBlend(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	fill_circle(x, y, r, color, blend_span);
+}
+
+// Horizontal inset of rounded corner at given row
+static int32_t corner_inset(int32_t row, int32_t height, int32_t radius) {
+	int32_t d = -1;
+	if (row < radius) d = radius - row;
+	if (row >= height - radius) d = row - (height - radius - 1);
+	if (d < 0) return 0;
+	return radius - (int32_t)sqrt((double)(radius * radius - (d - 1) * (d - 1)));
+}
+
+static void HOST_G2D_DrawRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	if ((width == 0) || (height == 0)) return;
+	if (radius > width / 2) radius = width / 2;
+	if (radius > height / 2) radius = height / 2;
+	int32_t prev = corner_inset(0, height, radius);
+	fill_span(x + prev, y, width - 2 * prev, color);
+	fill_span(x + prev, y + height - 1, width - 2 * prev, color);
+	for (int32_t row = 1; row < height - 1; row++) {
+		int32_t in = corner_inset(row, height, radius);
+		int32_t ref = (row < height / 2) ? corner_inset(row - 1, height, radius) : corner_inset(row + 1, height, radius);
+		int32_t len = (ref > in) ? ref - in : 1;
+		fill_span(x + in, y + row, len, color);
+		fill_span(x + width - in - len, y + row, len, color);
+	}
+}
+
+static void fill_round_rect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color, void (*span)(int32_t, int32_t, int32_t, uint32_t)) {
+	if (radius > width / 2) radius = width / 2;
+	if (radius > height / 2) radius = height / 2;
+	for (int32_t row = 0; row < height; row++) {
+		int32_t in = corner_inset(row, height, radius);
+		span(x + in, y + row, width - 2 * in, color);
+	}
+}
+
+static void HOST_G2D_DrawFillRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	fill_round_rect(x, y, width, height, radius, color, fill_span);
+}
+
+static void HOST_G2D_DrawFillRoundRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	fill_round_rect(x, y, width, height, radius, color, blend_span);
+}
+
+
+// G2D library - text
+//
+// Font layout: [height][space width][95 x uint16 offsets for '!'..'~' + end]
+// Glyph: [width][stream], stream is decoded row by row (width x height):
+//  00nnnnnn - n transparent pixels, 11nnnnnn - n opaque pixels,
+//  otherwise four pixels with 2-bit alpha (msb first).
+
+#define FONT_FIRST_CHAR		33
+#define FONT_LAST_CHAR		126
+
+static uint16_t draw_text(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, uint32_t bgcolor, uint8_t opaque) {
+	if ((font == NULL) || (str == NULL)) return 0;
+	uint8_t height = font[0];
+	uint32_t argb = to_argb(color);
+	int32_t cx = x;
+
+	for (; *str; str++) {
+		uint8_t ch = (uint8_t)*str;
+		if ((ch < FONT_FIRST_CHAR) || (ch > FONT_LAST_CHAR)) {
+			if (opaque) for (int32_t i = 0; i < height; i++) fill_span(cx, y + i, font[1], bgcolor);
+			cx += font[1];
+			continue;
+		}
+		uint32_t idx = ch - FONT_FIRST_CHAR;
+		const uint8_t * glyph = font + (font[2 + 2 * idx] | (font[3 + 2 * idx] << 8));
+		const uint8_t * end = font + (font[4 + 2 * idx] | (font[5 + 2 * idx] << 8));
+		uint8_t width = glyph[0];
+		uint32_t total = (uint32_t)width * height;
+		uint32_t pos = 0;
+
+		if (opaque) for (int32_t i = 0; i < height; i++) fill_span(cx, y + i, width, bgcolor);
+
+		for (const uint8_t * p = glyph + 1; (p < end) && (pos < total); p++) {
+			uint8_t op = *p >> 6;
+			if (op == 0) {
+				pos += *p & 0x3F;
+			} else if (op == 3) {
+				for (uint32_t n = *p & 0x3F; n && (pos < total); n--, pos++) {
+					if (opaque) put(cx + (int32_t)(pos % width), y + (int32_t)(pos / width), color);
+					else blend(cx + (int32_t)(pos % width), y + (int32_t)(pos / width), argb, 255, color);
+				}
+			} else {
+				for (int32_t s = 6; (s >= 0) && (pos < total); s -= 2, pos++) {
+					uint32_t level = (*p >> s) & 0x03;
+					if (level == 0) continue;
+					int32_t px = cx + (int32_t)(pos % width), py = y + (int32_t)(pos / width);
+					if (opaque) blend(px, py, argb | 0xFF000000, level * 85, color);
+					else blend(px, py, argb, level * 85, color);
+				}
+			}
+		}
+		cx += width;
+	}
+	return (uint16_t)(cx - x);
+}
+
+static uint16_t HOST_G2D_Text(int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color, uint32_t bgcolor) {
+	return draw_text(x, y, font, str, color, bgcolor, 1);
+}
+
+static uint16_t HOST_G2D_TextBlend(int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color) {
+	return draw_text(x, y, font, str, color, 0, 0);
+}
+
+static uint8_t HOST_G2D_GetTextHeight(const uint8_t *font) {
+	return (font) ? font[0] : 0;
+}
+
+
+// G2D library - bitmaps, icons and buffers
+
+static void copy_native(const uint8_t * src, uint32_t stride, int32_t x, int32_t y, int32_t width, int32_t height) {
+	if ((src == NULL) || (lcd.buf[0] == NULL)) return;
+	for (int32_t j = 0; j < height; j++) {
+		int32_t ty = y + j;
+		if ((ty < 0) || (ty >= LCD_HEIGHT)) continue;
+		int32_t i0 = (x < 0) ? -x : 0;
+		int32_t i1 = (x + width > LCD_WIDTH) ? LCD_WIDTH - x : width;
+		if (i1 <= i0) return;
+		memcpy(px_addr(lcd.buf[lcd.edit], x + i0, ty), src + ((uint32_t)j * stride + (uint32_t)i0) * lcd.bpp, (size_t)(i1 - i0) * lcd.bpp);
+		Host_FrameStat.fb_bytes_written += (uint64_t)(i1 - i0) * lcd.bpp;
+	}
+}
+
+static void copy_argb_blend(const uint8_t * src, uint32_t stride, int32_t x, int32_t y, int32_t width, int32_t height, uint8_t alpha) {
+	if (src == NULL) return;
+	const uint32_t * s = (const uint32_t *)src;
+	for (int32_t j = 0; j < height; j++) {
+		for (int32_t i = 0; i < width; i++) {
+			uint32_t c = s[(uint32_t)j * stride + (uint32_t)i];
+			blend(x + i, y + j, c, alpha, c);
+		}
+	}
+}
+
+static void HOST_G2D_DrawBitmap(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height) {
+	copy_native(sourcedata, (uint32_t)width, x, y, width, height);
+}
+
+static void HOST_G2D_DrawBitmapC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height) {
+	copy_native(sourcedata, (uint32_t)width, x - width / 2, y - height / 2, width, height);
+}
+
+static void HOST_G2D_DrawBitmapBlend(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha) {
+	copy_argb_blend(sourcedata, (uint32_t)width, x, y, width, height, alpha);
+}
+
+static void HOST_G2D_DrawBitmapBlendC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha) {
+	copy_argb_blend(sourcedata, (uint32_t)width, x - width / 2, y - height / 2, width, height, alpha);
+}
+
+static void HOST_G2D_DrawBitmapRotateC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, float angle) {
+	if ((sourcedata == NULL) || (lcd.buf[0] == NULL)) return;
+	const uint8_t * src = sourcedata;
+	float s = sinf(angle * (float)M_PI / 180.0f), c = cosf(angle * (float)M_PI / 180.0f);
+	int32_t half = (int32_t)ceilf(sqrtf((float)(width * width + height * height)) / 2.0f);
+	for (int32_t dy = -half; dy <= half; dy++) {
+		for (int32_t dx = -half; dx <= half; dx++) {
+			int32_t sx = (int32_t)floorf(c * dx + s * dy + width / 2.0f);
+			int32_t sy = (int32_t)floorf(-s * dx + c * dy + height / 2.0f);
+			if ((sx < 0) || (sy < 0) || (sx >= width) || (sy >= height)) continue;
+			put(x + dx, y + dy, px_get(src + ((uint32_t)sy * (uint32_t)width + (uint32_t)sx) * lcd.bpp));
+		}
+	}
+}
+
+static void HOST_G2D_DrawBitmapRotate(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, float angle) {
+	HOST_G2D_DrawBitmapRotateC(sourcedata, x + width / 2, y + height / 2, width, height, angle);
+}
+
+static uint16_t HOST_G2D_GetIconWidth(const void * iconsource) {
+	return (iconsource) ? ((const uint16_t *)iconsource)[0] : 0;
+}
+
+static uint16_t HOST_G2D_GetIconHeight(const void * iconsource) {
+	return (iconsource) ? ((const uint16_t *)iconsource)[1] : 0;
+}
+
+static void draw_icon(const void * iconsource, int32_t x, int32_t y, uint32_t color, uint32_t bgcolor, uint8_t opaque) {
+	if (iconsource == NULL) return;
+	uint16_t w = HOST_G2D_GetIconWidth(iconsource), h = HOST_G2D_GetIconHeight(iconsource);
+	const uint8_t * mask = (const uint8_t *)iconsource + 4;
+	uint32_t argb = to_argb(color);
+	for (int32_t j = 0; j < h; j++) {
+		if (opaque) fill_span(x, y + j, w, bgcolor);
+		for (int32_t i = 0; i < w; i++) {
+			uint8_t a = mask[j * w + i];
+			if (a == 0) continue;
+			if (opaque) blend(x + i, y + j, argb | 0xFF000000, a, color);
+			else blend(x + i, y + j, argb, a, color);
+		}
+	}
+}
+
+static void HOST_G2D_DrawIcon(const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor) {
+	draw_icon(iconsource, x, y, color, bgcolor, 1);
+}
+
+static void HOST_G2D_DrawIconC(const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor) {
+	draw_icon(iconsource, x - HOST_G2D_GetIconWidth(iconsource) / 2, y - HOST_G2D_GetIconHeight(iconsource) / 2, color, bgcolor, 1);
+}
+
+static void HOST_G2D_DrawIconBlend(const void * iconsource, int16_t x, int16_t y, uint32_t color) {
+	draw_icon(iconsource, x, y, color, 0, 0);
+}
+
+static void HOST_G2D_DrawIconBlendC(const void * iconsource, int16_t x, int16_t y, uint32_t color) {
+	draw_icon(iconsource, x - HOST_G2D_GetIconWidth(iconsource) / 2, y - HOST_G2D_GetIconHeight(iconsource) / 2, color, 0, 0);
+}
+
+// JPEG decoding is not available on host - calls are only counted
+static void HOST_G2D_DrawJPEG(const void * jpeg_addr, uint32_t jpeg_size, int16_t x, int16_t y) {
+	(void)jpeg_addr; (void)jpeg_size; (void)x; (void)y;
+}
+
+static void HOST_G2D_DrawLastJPEG(int16_t x, int16_t y) {
+	(void)x; (void)y;
+}
+
+static void HOST_G2D_DecodeJPEG(const void * jpeg_addr, uint32_t jpeg_size) {
+	(void)jpeg_addr; (void)jpeg_size;
+}
+
+#define HOST_G2D_DrawJPEGC			HOST_G2D_DrawJPEG
+#define HOST_G2D_DrawLastJPEGC		HOST_G2D_DrawLastJPEG
+
+static uint32_t HOST_G2D_Color(uint32_t color, uint8_t alpha) {
+	if (lcd.mode == LCD_COLOR_MODE_L8) return color & 0xFF;
+	if (lcd.mode == LCD_COLOR_MODE_AL88) return (color & 0xFF) | ((uint32_t)alpha << 8);
+	return from_argb(((uint32_t)alpha << 24) | (color & 0xFFFFFF), 0);
+}
+
+static uint32_t HOST_G2D_Alpha(uint32_t color, uint8_t alpha) {
+	if (lcd.mode == LCD_COLOR_MODE_L8) return color;
+	if (lcd.mode == LCD_COLOR_MODE_AL88) return (color & 0xFF) | ((uint32_t)alpha << 8);
+	return from_argb((to_argb(color) & 0xFFFFFF) | ((uint32_t)alpha << 24), 0);
+}
+
+static void HOST_G2D_CopyBuf(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height) {
+	copy_native(src_addr, (uint32_t)width + offsline_src, x_dest, y_dest, width, height);
+	Host_FrameStat.fb_bytes_read += (uint64_t)width * height * lcd.bpp;
+}
+
+static void HOST_G2D_CopyBufBlend(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height, uint8_t alpha) {
+	copy_argb_blend(src_addr, (uint32_t)width + offsline_src, x_dest, y_dest, width, height, alpha);
+}
+
+
+// Wrappers
+
+HOST_WRAP_V(LCD_Init, (uint8_t color_mode, uint8_t buffer_mode, uint32_t bgcolor, uint32_t *clut), (color_mode, buffer_mode, bgcolor, clut))
+HOST_WRAP_V(LCD_FrameReady, (void), ())
+HOST_WRAP(uint8_t, LCD_GetEditPermission, (void), ())
+HOST_WRAP_V(LCD_SetBackLight, (uint8_t value, uint8_t dimspeed), (value, dimspeed))
+HOST_WRAP(uint8_t, LCD_GetBackLight, (void), ())
+HOST_WRAP_V(LCD_BacklLightOff, (void), ())
+HOST_WRAP_V(LCD_BackLightOn, (void), ())
+HOST_WRAP(uint32_t, LCD_GetFrameTime, (void), ())
+HOST_WRAP_V(LCD_UpdateCLUT, (uint32_t *clut), (clut))
+HOST_WRAP(void *, LCD_GetEditFrameAddr, (void), ())
+HOST_WRAP_V(LCD_SetDisplayWindow, (uint16_t x, uint16_t y, uint16_t width, uint16_t height), (x, y, width, height))
+
+HOST_WRAP_V(G2D_ClearFrame, (void), ())
+HOST_WRAP_V(G2D_FillFrame, (uint32_t color), (color))
+HOST_WRAP_V(G2D_CopyPrevFrame, (void), ())
+HOST_WRAP_V(G2D_CopyScrollPrevFrame, (int16_t dx, int16_t dy), (dx, dy))
+HOST_WRAP_V(G2D_DrawPixel, (int16_t x, int16_t y, uint32_t color), (x, y, color))
+HOST_WRAP_V(G2D_DrawHLine, (int16_t x, int16_t y, int16_t length, uint32_t color), (x, y, length, color))
+HOST_WRAP_V(G2D_DrawHLineBlend, (int16_t x, int16_t y, int16_t length, uint32_t color), (x, y, length, color))
+HOST_WRAP_V(G2D_DrawVLine, (int16_t x, int16_t y, int16_t length, uint32_t color), (x, y, length, color))
+HOST_WRAP_V(G2D_DrawVLineBlend, (int16_t x, int16_t y, int16_t length, uint32_t color), (x, y, length, color))
+HOST_WRAP_V(G2D_DrawLine, (int16_t X1, int16_t Y1, int16_t X2, int16_t Y2, uint32_t color), (X1, Y1, X2, Y2, color))
+HOST_WRAP_V(G2D_DrawRect, (int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color), (x, y, width, height, color))
+HOST_WRAP_V(G2D_DrawFillRect, (int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color), (x, y, width, height, color))
+HOST_WRAP_V(G2D_DrawFillRectBlend, (int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color), (x, y, width, height, color))
+HOST_WRAP_V(G2D_DrawCircle, (int16_t x, int16_t y, uint16_t r, uint32_t color), (x, y, r, color))
+HOST_WRAP_V(G2D_DrawFillCircle, (int16_t x, int16_t y, uint16_t r, uint32_t color), (x, y, r, color))
+HOST_WRAP_V(G2D_DrawFillCircleBlend, (int16_t x, int16_t y, uint16_t r, uint32_t color), (x, y, r, color))
+HOST_WRAP_V(G2D_DrawRoundRect, (int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color), (x, y, width, height, radius, color))
+HOST_WRAP_V(G2D_DrawFillRoundRect, (int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color), (x, y, width, height, radius, color))
+HOST_WRAP_V(G2D_DrawFillRoundRectBlend, (int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color), (x, y, width, height, radius, color))
+HOST_WRAP(uint16_t, G2D_Text, (int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color, uint32_t bgcolor), (x, y, font, str, color, bgcolor))
+HOST_WRAP(uint16_t, G2D_TextBlend, (int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color), (x, y, font, str, color))
+HOST_WRAP(uint8_t, G2D_GetTextHeight, (const uint8_t *font), (font))
+HOST_WRAP_V(G2D_DrawBitmapBlend, (const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha), (sourcedata, x, y, width, height, alpha))
+HOST_WRAP_V(G2D_DrawBitmapBlendC, (const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha), (sourcedata, x, y, width, height, alpha))
+HOST_WRAP_V(G2D_DrawBitmap, (const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height), (sourcedata, x, y, width, height))
+HOST_WRAP_V(G2D_DrawBitmapC, (const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height), (sourcedata, x, y, width, height))
+HOST_WRAP_V(G2D_DrawBitmapRotate, (const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, float angle), (sourcedata, x, y, width, height, angle))
+HOST_WRAP_V(G2D_DrawBitmapRotateC, (const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, float angle), (sourcedata, x, y, width, height, angle))
+HOST_WRAP_V(G2D_DrawIcon, (const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor), (iconsource, x, y, color, bgcolor))
+HOST_WRAP_V(G2D_DrawIconC, (const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor), (iconsource, x, y, color, bgcolor))
+HOST_WRAP_V(G2D_DrawIconBlend, (const void * iconsource, int16_t x, int16_t y, uint32_t color), (iconsource, x, y, color))
+HOST_WRAP_V(G2D_DrawIconBlendC, (const void * iconsource, int16_t x, int16_t y, uint32_t color), (iconsource, x, y, color))
+HOST_WRAP(uint16_t, G2D_GetIconHeight, (const void * iconsource), (iconsource))
+HOST_WRAP(uint16_t, G2D_GetIconWidth, (const void * iconsource), (iconsource))
+HOST_WRAP_V(G2D_DrawJPEG, (const void * jpeg_addr, uint32_t jpeg_size, int16_t x, int16_t y), (jpeg_addr, jpeg_size, x, y))
+HOST_WRAP_V(G2D_DrawJPEGC, (const void * jpeg_addr, uint32_t jpeg_size, int16_t x, int16_t y), (jpeg_addr, jpeg_size, x, y))
+HOST_WRAP_V(G2D_DrawLastJPEG, (int16_t x, int16_t y), (x, y))
+HOST_WRAP_V(G2D_DrawLastJPEGC, (int16_t x, int16_t y), (x, y))
+HOST_WRAP_V(G2D_DecodeJPEG, (const void * jpeg_addr, uint32_t jpeg_size), (jpeg_addr, jpeg_size))
+HOST_WRAP(uint32_t, G2D_Color, (uint32_t color, uint8_t alpha), (color, alpha))
+HOST_WRAP(uint32_t, G2D_Alpha, (uint32_t color, uint8_t alpha), (color, alpha))
+HOST_WRAP_V(G2D_CopyBuf, (const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height), (src_addr, offsline_src, x_dest, y_dest, width, height))
+HOST_WRAP_V(G2D_CopyBufBlend, (const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height, uint8_t alpha), (src_addr, offsline_src, x_dest, y_dest, width, height, alpha))
+HOST_WRAP_V(G2D_CacheFrame, (void), ())
+HOST_WRAP_V(G2D_RestoreFrame, (void), ())
+
+void Host_LCD_Bind(BSP_Driver_TypeDef * drv) {
+	HOST_BIND(drv, LCD_Init);
+	HOST_BIND(drv, LCD_FrameReady);
+	HOST_BIND(drv, LCD_GetEditPermission);
+	HOST_BIND(drv, LCD_SetBackLight);
+	HOST_BIND(drv, LCD_GetBackLight);
+	HOST_BIND(drv, LCD_BacklLightOff);
+	HOST_BIND(drv, LCD_BackLightOn);
+	HOST_BIND(drv, LCD_GetFrameTime);
+	HOST_BIND(drv, LCD_UpdateCLUT);
+	HOST_BIND(drv, LCD_GetEditFrameAddr);
+	HOST_BIND(drv, LCD_SetDisplayWindow);
+
+	HOST_BIND(drv, G2D_ClearFrame);
+	HOST_BIND(drv, G2D_FillFrame);
+	HOST_BIND(drv, G2D_CopyPrevFrame);
+	HOST_BIND(drv, G2D_CopyScrollPrevFrame);
+	HOST_BIND(drv, G2D_DrawPixel);
+	HOST_BIND(drv, G2D_DrawHLine);
+	HOST_BIND(drv, G2D_DrawHLineBlend);
+	HOST_BIND(drv, G2D_DrawVLine);
+	HOST_BIND(drv, G2D_DrawVLineBlend);
+	HOST_BIND(drv, G2D_DrawLine);
+	HOST_BIND(drv, G2D_DrawRect);
+	HOST_BIND(drv, G2D_DrawFillRect);
+	HOST_BIND(drv, G2D_DrawFillRectBlend);
+	HOST_BIND(drv, G2D_DrawCircle);
+	HOST_BIND(drv, G2D_DrawFillCircle);
+	HOST_BIND(drv, G2D_DrawFillCircleBlend);
+	HOST_BIND(drv, G2D_DrawRoundRect);
+	HOST_BIND(drv, G2D_DrawFillRoundRect);
+	HOST_BIND(drv, G2D_DrawFillRoundRectBlend);
+	HOST_BIND(drv, G2D_Text);
+	HOST_BIND(drv, G2D_TextBlend);
+	HOST_BIND(drv, G2D_GetTextHeight);
+	HOST_BIND(drv, G2D_DrawBitmapBlend);
+	HOST_BIND(drv, G2D_DrawBitmapBlendC);
+	HOST_BIND(drv, G2D_DrawBitmap);
+	HOST_BIND(drv, G2D_DrawBitmapC);
+	HOST_BIND(drv, G2D_DrawBitmapRotate);
+	HOST_BIND(drv, G2D_DrawBitmapRotateC);
+	HOST_BIND(drv, G2D_DrawIcon);
+	HOST_BIND(drv, G2D_DrawIconC);
+	HOST_BIND(drv, G2D_DrawIconBlend);
+	HOST_BIND(drv, G2D_DrawIconBlendC);
+	HOST_BIND(drv, G2D_GetIconHeight);
+	HOST_BIND(drv, G2D_GetIconWidth);
+	HOST_BIND(drv, G2D_DrawJPEG);
+	HOST_BIND(drv, G2D_DrawJPEGC);
+	HOST_BIND(drv, G2D_DrawLastJPEG);
+	HOST_BIND(drv, G2D_DrawLastJPEGC);
+	HOST_BIND(drv, G2D_DecodeJPEG);
+	HOST_BIND(drv, G2D_Color);
+	HOST_BIND(drv, G2D_Alpha);
+	HOST_BIND(drv, G2D_CopyBuf);
+	HOST_BIND(drv, G2D_CopyBufBlend);
+	HOST_BIND(drv, G2D_CacheFrame);
+	HOST_BIND(drv, G2D_RestoreFrame);
+}
@@ -0,0 +1,195 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * v1 (ASCII) versus v2 (Unicode) fonts.
+ *
+ *   bench_font2 [-n iterations] [-k chars]
+ *
+ * Checks that v2 font generated from v1 font decodes and draws
+ * bit-exact, then measures text width (per character cost of byte
+ * loop, UTF-8 decoding, page table lookup and kerning) and codepoint
+ * lookup of v1 and v2 fonts.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BSP_Host.h"
+#include "Font.h"
+#include "fonts.h"
+#include "../Tools/font2_enc.h"
+
+#define FB_SIZE		(800 * 480 * 4)
+
+static volatile uint32_t sink;
+
+// Width loop of v1 format as it was before UTF-8 support
+static uint16_t width_bytes(const uint8_t *font, const char *str) {
+	uint16_t w = 0;
+	for (; *str; str++) {
+		uint8_t c = (uint8_t)*str;
+		if ((c < FONT_FIRST_CHAR) || (c > FONT_LAST_CHAR)) { w += font[1]; continue; }
+		uint32_t idx = c - FONT_FIRST_CHAR;
+		w += font[(uint16_t)(font[2 + 2 * idx] | (font[3 + 2 * idx] << 8))];
+	}
+	return w;
+}
+
+static double ns_per_char(uint16_t (*fn)(const uint8_t *, const char *), const uint8_t *font, const char *str, size_t chars, int iters) {
+	uint64_t best = ~0ull;
+	for (int i = 0; i < iters; i++) {
+		uint64_t t = Host_GetNs();
+		sink += fn(font, str);
+		t = Host_GetNs() - t;
+		if (t < best) best = t;
+	}
+	return (double)best / (double)chars;
+}
+
+static double ns_per_lookup(const uint8_t *font, const uint32_t *cp, size_t n, int iters) {
+	uint64_t best = ~0ull;
+	for (int i = 0; i < iters; i++) {
+		uint64_t t = Host_GetNs();
+		uint32_t s = 0;
+		for (size_t k = 0; k < n; k++) s += Font_GetCodepointWidth(font, cp[k]);
+		t = Host_GetNs() - t;
+		sink += s;
+		if (t < best) best = t;
+	}
+	return (double)best / (double)n;
+}
+
+static int check_exact(const char * name, const uint8_t *v1, const uint8_t *v2, uint8_t *fb_a) {
+	static uint8_t m1[FONT_MAX_GLYPH_PIXELS], m2[FONT_MAX_GLYPH_PIXELS];
+	const char * text = "The quick brown fox jumps over the lazy dog! 0123456789 {[(<@#$%&*>)]}";
+	int errors = 0;
+
+	for (uint32_t c = ' '; c <= FONT_LAST_CHAR; c++) {
+		uint8_t w1 = Font_DecodeCodepoint(v1, c, m1);
+		uint8_t w2 = Font_DecodeCodepoint(v2, c, m2);
+		if ((w1 != w2) || (memcmp(m1, m2, (size_t)w1 * Font_GetHeight(v1)))) errors++;
+	}
+
+	// G2D_TextBlend (v1) versus glyph by glyph G2D_DrawIconBlend (v2)
+	uint8_t * fb = BSP->LCD_GetEditFrameAddr();
+	BSP->G2D_FillFrame(0xFF203040);
+	uint16_t w1 = Font_TextBlend(4, 4, v1, text, 0xC0FFE080);
+	memcpy(fb_a, fb, FB_SIZE);
+	BSP->G2D_FillFrame(0xFF203040);
+	uint16_t w2 = Font_TextBlend(4, 4, v2, text, 0xC0FFE080);
+	uint32_t diff = 0;
+	for (uint32_t i = 0; i < FB_SIZE; i++) if (fb[i] != fb_a[i]) diff++;
+
+	printf("%-16s glyphs %s, text width %u/%u, framebuffer %s (%u bytes differ)\n", name, errors ? "DIFFER" : "exact", w1, w2, diff ? "DIFFERS" : "exact", diff);
+	return errors + (diff != 0) + (w1 != w2);
+}
+
+int main(int argc, char ** argv) {
+	int iters = 50;
+	size_t chars = 64 * 1024;
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) iters = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-k") == 0) && (i + 1 < argc)) chars = (size_t)atol(argv[++i]);
+	}
+	if (chars < 64) chars = 64;
+
+	Host_Config.quiet = 1;
+	Host_Init();
+	BSP->LCD_Init(LCD_COLOR_MODE_ARGB8888, LCD_BUFFER_MODE_DOUBLE, 0, NULL);
+	uint8_t * fb_a = malloc(FB_SIZE);
+
+	// Plain conversions
+	const uint8_t * v1_fonts[] = { FONT_12_verdana, FONT_16_verdana, FONT_26_verdana, FONT_64_verdana, FONT_16_yikes };
+	const char * v1_names[] = { "FONT_12_verdana", "FONT_16_verdana", "FONT_26_verdana", "FONT_64_verdana", "FONT_16_yikes" };
+	int errors = 0;
+	for (uint32_t i = 0; i < sizeof(v1_fonts) / sizeof(v1_fonts[0]); i++) {
+		F2_FONT f;
+		size_t size;
+		f2_init(&f, v1_fonts[i][0], v1_fonts[i][1]);
+		f2_import_v1(&f, v1_fonts[i]);
+		uint8_t * v2 = f2_build(&f, &size, NULL);
+		errors += check_exact(v1_names[i], v1_fonts[i], v2, fb_a);
+		free(v2);
+		f2_free(&f);
+	}
+
+	// Extended font: Latin-1 letters borrowing ASCII glyphs, Greek page and kerning pairs
+	F2_FONT f;
+	size_t size;
+	uint32_t pages;
+	const uint8_t * v1 = FONT_16_verdana;
+	f2_init(&f, v1[0], v1[1]);
+	f2_import_v1(&f, v1);
+	for (uint32_t c = 0xC0; c <= 0xFF; c++) {
+		uint32_t base = (c < 0xE0) ? 'A' + (c - 0xC0) % 26 : 'a' + (c - 0xE0) % 26;
+		F2_GLYPH * g = f2_find(&f, base);
+		f2_add_raw(&f, c, g->data, g->size);
+	}
+	for (uint32_t c = 0x391; c <= 0x3C9; c++) {
+		F2_GLYPH * g = f2_find(&f, 'A' + (c % 26));
+		f2_add_raw(&f, c, g->data, g->size);
+	}
+	const char * pairs[] = { "AV", "VA", "To", "Ta", "Te", "Yo", "LT", "WA", "AW", "rn", "ov", "vo" };
+	for (uint32_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) f2_add_kern(&f, pairs[i][0], pairs[i][1], -1);
+	uint8_t * v2 = f2_build(&f, &size, &pages);
+	printf("\nextended font: %u glyphs, %u pages, %u kerning pairs, %zu bytes (v1 %zu)\n", f.glyphs, pages, v2[6] | (v2[7] << 8), size, sizeof(FONT_16_verdana));
+
+	// ASCII and mixed UTF-8 text
+	const char * words_ascii[] = { "AVATAR ", "Today ", "lorem ", "ipsum ", "WAVE ", "dolor ", "sit ", "amet, " };
+	const char * words_utf8[] = { "\xC3\xA9t\xC3\xA9 ", "na\xC3\xAFve ", "\xCE\xB1\xCE\xB2\xCE\xB3 ", "Stra\xC3\x9F" "e ", "ASCII ", "\xC3\xA0 la ", "\xCE\xA9mega ", "text " };
+	char * ascii = malloc(chars + 16);
+	char * utf8 = malloc(chars * 2 + 16);
+	size_t n = 0, m = 0, utf8_chars = 0;
+	for (uint32_t w = 0; n < chars; w++) {
+		const char * s = words_ascii[w % 8];
+		while (*s && (n < chars)) ascii[n++] = *s++;
+	}
+	ascii[n] = 0;
+	for (uint32_t w = 0; utf8_chars < chars; w++) {
+		const char * s = words_utf8[w % 8];
+		size_t len = strlen(s);
+		memcpy(utf8 + m, s, len);
+		m += len;
+		for (const char * p = s; *p; utf8_chars++) Font_UTF8Next(&p);
+	}
+	utf8[m] = 0;
+
+	printf("\ntext width (%zu characters)           ns/char\n", chars);
+	printf("  v1 byte loop (before UTF-8)           %6.2f\n", ns_per_char(width_bytes, v1, ascii, chars, iters));
+	printf("  v1 Font_GetTextWidth, ASCII           %6.2f\n", ns_per_char(Font_GetTextWidth, v1, ascii, chars, iters));
+	printf("  v2 Font_GetTextWidth, ASCII + kerning %6.2f\n", ns_per_char(Font_GetTextWidth, v2, ascii, chars, iters));
+	printf("  v2 Font_GetTextWidth, UTF-8 + kerning %6.2f\n", ns_per_char(Font_GetTextWidth, v2, utf8, utf8_chars, iters));
+	char line[1001];
+	memcpy(line, ascii, 1000);
+	line[1000] = 0;
+	if (Font_GetTextWidth(v1, line) != width_bytes(v1, line)) {
+		printf("  v1 width DIFFERS from byte loop\n");
+		errors++;
+	}
+
+	// Codepoint lookup
+	uint32_t * cp = malloc(chars * sizeof(uint32_t));
+	uint32_t seed = 1;
+	for (size_t i = 0; i < chars; i++) {
+		seed = seed * 1103515245 + 12345;
+		cp[i] = FONT_FIRST_CHAR + (seed >> 16) % (FONT_LAST_CHAR - FONT_FIRST_CHAR + 1);
+	}
+	printf("\nlookup (Font_GetCodepointWidth)       ns/lookup\n");
+	printf("  v1 ASCII                              %6.2f\n", ns_per_lookup(v1, cp, chars, iters));
+	printf("  v2 ASCII                              %6.2f\n", ns_per_lookup(v2, cp, chars, iters));
+	for (size_t i = 0; i < chars; i++) {
+		seed = seed * 1103515245 + 12345;
+		cp[i] = ((seed >> 16) & 1) ? 0xC0 + (seed >> 17) % 64 : 0x391 + (seed >> 17) % 57;
+	}
+	printf("  v2 Latin-1 / Greek                    %6.2f\n", ns_per_lookup(v2, cp, chars, iters));
+
+	printf("\n%s\n", errors ? "v2 conversion NOT bit-exact" : "v2 conversion bit-exact");
+	free(cp);
+	free(ascii);
+	free(utf8);
+	free(v2);
+	free(fb_a);
+	f2_free(&f);
+	return errors ? 1 : 0;
+}
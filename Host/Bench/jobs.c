@@ -0,0 +1,169 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Dual core job rings (Job.h) with CM4 emulated by pthread.
+ *
+ *   bench_jobs [-n jobs] [-s bytes] [-b batch]
+ *
+ * Main thread acts as CM7 - posts up to batch jobs, then collects
+ * completions. Worker thread acts as CM4 - runs JOB_WorkerPoll in
+ * loop. Each job computes FNV-1a hash of its input and writes
+ * result to output buffer; results and completion order (FIFO) are
+ * verified. Reports throughput and average round trip.
+ * Before worker thread starts, CM7 fallback is checked: main thread
+ * posts more jobs than completion ring holds and runs them with
+ * JOB_WorkerPoll itself (worker must not wait for full ring).
+ * Build with OPT="-O1 -fsanitize=thread" to check for data races.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "BSP_Host.h"
+#include "Job.h"
+
+#define JOB_HASH		1
+#define JOB_UNKNOWN		2
+
+static int stop = 0;
+
+static uint32_t fnv(const uint8_t * p, uint32_t n, uint32_t seed) {
+	uint32_t h = 2166136261u ^ seed;
+	for (uint32_t i = 0; i < n; i++) h = (h ^ p[i]) * 16777619u;
+	return h;
+}
+
+static int32_t hash_job(JOB_DESC * job) {
+	uint32_t h = fnv(job->in, job->in_size, job->arg);
+	memcpy(job->out, &h, sizeof(h));
+	return (int32_t)(h & 0x7FFFFFFF);
+}
+
+static void * worker(void * arg) {
+	(void)arg;
+	JOB_RegisterHandler(JOB_HASH, hash_job);
+	while (!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+		if (!JOB_WorkerPoll()) sched_yield();
+	}
+	return NULL;
+}
+
+static uint32_t cm7_post(uint8_t * in, uint32_t size, uint32_t * out, uint32_t posted, uint32_t total) {
+	while (posted < total) {
+		JOB_DESC job = { .type = JOB_HASH, .in = in, .in_size = size,
+						 .out = &out[(posted % JOB_RING_SIZE) * (JOB_CACHE_LINE / 4)], .out_size = JOB_CACHE_LINE, .arg = posted };
+		if (JOB_Post(&job) != BSP_OK) break;
+		posted++;
+	}
+	return posted;
+}
+
+// CM4 not running - CM7 posts, runs and collects jobs on one thread. Each round fills
+// completion ring and posts more requests before collecting. Returns number of errors.
+static uint32_t cm7_only(uint8_t * in, uint32_t size, uint32_t * out) {
+	uint32_t posted = 0, collected = 0, errors = 0, full = 0, total = JOB_RING_SIZE * 4 + 5;
+	JOB_RegisterHandler(JOB_HASH, hash_job);
+	JOB_Init();
+	while (collected < total) {
+		uint32_t run = 0;
+		posted = cm7_post(in, size, out, posted, total);
+		while (JOB_WorkerPoll()) run++;
+		posted = cm7_post(in, size, out, posted, total);
+		while (JOB_WorkerPoll()) run++;			// Returns 0 at full completion ring
+		if (JOB_GetStats()->executed < posted) full++;
+
+		JOB_DESC done;
+		uint32_t got = 0;
+		while (JOB_Poll(&done)) {
+			uint32_t n = done.arg;
+			if ((n != collected) || (done.result != (int32_t)(fnv(in, size, n) & 0x7FFFFFFF))) errors++;
+			collected++;
+			got++;
+		}
+		if ((run == 0) && (got == 0)) {
+			errors++;
+			break;
+		}
+	}
+	if (full == 0) errors++;
+	printf("CM7 only: %u of %u jobs collected, completion ring full %u times, errors %u\n", collected, total, full, errors);
+	return errors;
+}
+
+int main(int argc, char ** argv) {
+	uint32_t jobs = 200000;
+	uint32_t size = 256;
+	uint32_t batch = JOB_RING_SIZE;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:s:b:")) != -1) {
+		switch (opt) {
+		case 'n': jobs = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 's': size = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'b': batch = (uint32_t)strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-n jobs] [-s bytes] [-b batch]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	Host_Config.quiet = 1;
+	Host_Init();
+
+	uint8_t * in = malloc(size);
+	for (uint32_t i = 0; i < size; i++) in[i] = (uint8_t)(i * 7 + 3);
+	uint32_t * out = aligned_alloc(JOB_CACHE_LINE, (size_t)JOB_RING_SIZE * JOB_CACHE_LINE);
+	uint64_t * t_post = calloc(jobs, sizeof(uint64_t));
+
+	uint32_t cm7_errors = cm7_only(in, size, out);
+	JOB_Init();
+
+	pthread_t th;
+	pthread_create(&th, NULL, worker, NULL);
+
+	uint32_t posted = 0, collected = 0, errors = 0, unknown = 0;
+	uint64_t latency = 0;
+	uint64_t t0 = Host_GetNs();
+
+	// One job of unknown type checks worker error path
+	JOB_DESC probe = { .type = JOB_UNKNOWN };
+	JOB_Post(&probe);
+	while (!JOB_Poll(&probe)) sched_yield();
+	if ((probe.flags & JOB_FLAG_NOHANDLER) && (probe.result == -1)) unknown = 1;
+
+	while (collected < jobs) {
+		while ((posted < jobs) && (JOB_InFlight() < batch)) {
+			JOB_DESC job = { .type = JOB_HASH, .flags = JOB_FLAG_CLEAN_IN | JOB_FLAG_INV_OUT, .in = in, .in_size = size,
+							 .out = &out[(posted % JOB_RING_SIZE) * (JOB_CACHE_LINE / 4)], .out_size = JOB_CACHE_LINE, .arg = posted };
+			t_post[posted] = Host_GetNs();
+			if (JOB_Post(&job) != BSP_OK) break;
+			posted++;
+		}
+
+		JOB_DESC done;
+		uint8_t any = 0;
+		while (JOB_Poll(&done)) {
+			uint32_t n = done.arg;
+			uint32_t expect = fnv(in, size, n);
+			if ((n != collected) || (done.id != n + 1) || (*(uint32_t *)done.out != expect) || (done.result != (int32_t)(expect & 0x7FFFFFFF))) errors++;
+			latency += Host_GetNs() - t_post[n];
+			collected++;
+			any = 1;
+		}
+		if (!any) sched_yield();
+	}
+
+	double s = (Host_GetNs() - t0) / 1e9;
+	__atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+	pthread_join(th, NULL);
+
+	const JOB_STATS * st = JOB_GetStats();
+	printf("jobs %u x %u bytes, batch %u\n", jobs, size, batch);
+	printf("  throughput   %.0f jobs/s (%.1f MB/s)\n", jobs / s, jobs * (double)size / s / 1e6);
+	printf("  round trip   %.2f us avg\n", latency / (double)jobs / 1000.0);
+	printf("  posted %u, completed %u, executed %u, ring full %u, peak in flight %u\n", st->posted, st->completed, st->executed, st->full, st->peak);
+	printf("  unknown type %s, errors %u\n", (unknown) ? "reported" : "NOT REPORTED", errors);
+	return ((errors) || (cm7_errors) || (!unknown)) ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Fixed timestep loop (Loop_Step) against simulated vsync.
+ *
+ *   bench_loop [-v vsync_hz] [-f frames] [-t tick_hz] [-r render_us] [-s slow_us]
+ *              [-u max_updates] [-k det_ticks] [-d]
+ *
+ * Every 4th frame costs slow_us instead of render_us. Report shows
+ * simulation rate (should stay at tick_hz), skipped frames and
+ * dropped ticks. With -d loop runs in deterministic mode twice and
+ * checks that simulation state matches between runs and that no tick
+ * was dropped (det_ticks above max_updates are carried over).
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "BSP_Host.h"
+#include "Loop.h"
+
+static uint32_t render_us = 4000;
+static uint32_t slow_us = 40000;
+static uint32_t frame_no = 0;
+static uint32_t state = 1;				// Simulation state (LCG advanced per tick)
+static uint64_t alpha_sum = 0;
+
+static void spin_us(uint32_t us) {
+	uint64_t end = Host_GetNs() + (uint64_t)us * 1000;
+	while (Host_GetNs() < end) continue;
+}
+
+static void update(uint32_t tick) {
+	state = state * 1664525u + 1013904223u + tick;
+}
+
+static void render(uint32_t alpha) {
+	alpha_sum += alpha;
+	spin_us(((frame_no++ % 4) == 3) ? slow_us : render_us);
+}
+
+static LOOP_CONFIG cfg = { .tick_hz = 120, .max_updates = 8, .max_skip = 2, .budget_ms = 20, .det_ticks = 2, .update = update, .render = render };
+
+static void bench_init(void) {
+	BSP->LCD_Init(LCD_COLOR_MODE_RGB888, LCD_BUFFER_MODE_DOUBLE, 0, NULL);
+	state = 1;
+	frame_no = 0;
+	alpha_sum = 0;
+	Loop_Init(&cfg);
+}
+
+static void bench_main(void) {
+	Loop_Run();
+}
+
+static void run(const char * title) {
+	Host_Init();
+	uint64_t t0 = Host_GetNs();
+	Host_Run(bench_init, bench_main);
+	double wall_s = (Host_GetNs() - t0) / 1e9;
+
+	const LOOP_STATS * s = Loop_GetStats();
+	printf("%s\n", title);
+	printf("  frames %u, skipped %u, ticks %u, dropped ticks %u, peak updates %u\n", s->frames, s->skipped, s->ticks, s->dropped_ticks, s->peak_updates);
+	printf("  wall %.3f s, simulation %.3f s (%.1f ticks/s), %.1f fps\n", wall_s, Loop_GetTimeMs() / 1000.0, s->ticks / wall_s, s->frames / wall_s);
+	printf("  state 0x%08x, avg alpha %.3f\n", state, (s->frames) ? (double)alpha_sum / s->frames / LOOP_ALPHA_ONE : 0.0);
+}
+
+int main(int argc, char ** argv) {
+	int opt;
+	uint8_t det = 0;
+
+	Host_Config.vsync_hz = 60;
+	Host_Config.frames = 120;
+	Host_Config.quiet = 1;
+
+	while ((opt = getopt(argc, argv, "v:f:t:r:s:u:k:d")) != -1) {
+		switch (opt) {
+		case 'v': Host_Config.vsync_hz = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'f': Host_Config.frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 't': cfg.tick_hz = (uint16_t)strtoul(optarg, NULL, 0); break;
+		case 'r': render_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 's': slow_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'u': cfg.max_updates = (uint8_t)strtoul(optarg, NULL, 0); break;
+		case 'k': cfg.det_ticks = (uint8_t)strtoul(optarg, NULL, 0); break;
+		case 'd': det = 1; break;
+		default:
+			fprintf(stderr, "usage: %s [-v vsync_hz] [-f frames] [-t tick_hz] [-r render_us] [-s slow_us] [-u max_updates] [-k det_ticks] [-d]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (!det) {
+		run("real time");
+		return 0;
+	}
+
+	cfg.deterministic = 1;
+	run("deterministic run 1");
+	uint32_t first = state;
+	run("deterministic run 2");
+	uint32_t dropped = Loop_GetStats()->dropped_ticks;
+	printf("replay %s, dropped ticks %u\n", (state == first) ? "matches" : "DIFFERS", dropped);
+	return ((state == first) && (dropped == 0)) ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Particle engine (Particle.h) - SoA fixed-point update and direct
+ * blend pass into frame versus one G2D_DrawFillRectBlend call per
+ * particle.
+ *
+ *   bench_particles [-f frames] [-a] [-o frame.ppm]
+ *
+ * For 256 to PART_MAX particles (explosions, sparks and snow kept
+ * at full capacity) report shows update and draw time, particles
+ * per millisecond of update + draw, and draw time of the same
+ * particles with G2D call per particle. Every frame both outputs
+ * are compared bit-exactly. Frame is RGB888 (-a ARGB8888).
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BSP_Host.h"
+#include "Particle.h"
+
+typedef struct {
+	PART_CONFIG		cfg;
+	uint8_t			share;			// Part of pool in 1/8
+	uint8_t			burst;			// Refilled in bursts at random position (else continuously)
+} EFFECT;
+
+static const EFFECT effects[] = {
+	{ { .color = 0xFFA020, .alpha0 = 255, .alpha1 = 0, .size = 2, .life_min = 20, .life_max = 50,
+		.speed_min = PART_FX(0.5), .speed_max = PART_FX(4), .spread = 128, .drag = 5, .gravity_y = PART_FX(0.04) }, 3, 1 },
+	{ { .color = 0xFFFFC0, .alpha0 = 255, .alpha1 = 64, .size = 1, .life_min = 10, .life_max = 30,
+		.speed_min = PART_FX(3), .speed_max = PART_FX(6), .angle = 192, .spread = 20, .gravity_y = PART_FX(0.15) }, 1, 0 },
+	{ { .color = 0xFFFFFF, .alpha0 = 200, .alpha1 = 200, .size = 3, .life_min = 300, .life_max = 600,
+		.speed_min = PART_FX(0.3), .speed_max = PART_FX(1.2), .angle = 64, .spread = 16, .radius = 255 }, 4, 0 },
+};
+#define EFFECT_NO		(sizeof(effects) / sizeof(effects[0]))
+
+static PART_EMITTER em[EFFECT_NO];
+static uint32_t rng = 0x9E3779B9u;
+
+static uint32_t rnd(uint32_t n) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng % n;
+}
+
+static uint16_t cap[EFFECT_NO];
+
+static void setup(uint8_t mode, uint32_t n) {
+	PART_Init(mode, 12345);
+	for (uint8_t i = 0; i < EFFECT_NO; i++) {
+		cap[i] = (uint16_t)(n * effects[i].share / 8);
+		em[i] = PART_AddEmitter(&effects[i].cfg, cap[i]);
+	}
+}
+
+// Keeps effects near capacity: explosions when mostly burnt out, sparks from fountain, snow along top edge
+static void emit(uint32_t frame) {
+	if (PART_GetCount(em[0]) < cap[0] / 4) PART_Emit(em[0], (int16_t)rnd(LCD_WIDTH), (int16_t)rnd(LCD_HEIGHT), cap[0]);
+	PART_Emit(em[1], (int16_t)(LCD_WIDTH / 2 + (int32_t)(frame % 200) - 100), LCD_HEIGHT - 40, (uint16_t)(cap[1] / 10 + 1));
+	while ((PART_GetCount(em[2]) < cap[2]) && (PART_Emit(em[2], (int16_t)rnd(LCD_WIDTH), (int16_t)rnd(LCD_HEIGHT / 4), 16))) continue;
+}
+
+// Same particles with one G2D call each
+static uint32_t draw_g2d(void) {
+	uint32_t calls = 0;
+	for (uint8_t i = 0; i < EFFECT_NO; i++) {
+		const PART_CONFIG * c = &effects[i].cfg;
+		for (uint16_t k = 0; k < PART_GetCount(em[i]); k++) {
+			int16_t x, y;
+			uint8_t a;
+			PART_Get(em[i], k, &x, &y, &a);
+			if (a == 0) continue;
+			BSP->G2D_DrawFillRectBlend((int16_t)(x - c->size / 2), (int16_t)(y - c->size / 2), c->size, c->size, (uint32_t)a << 24 | (c->color & 0xFFFFFF));
+			calls++;
+		}
+	}
+	return calls;
+}
+
+int main(int argc, char ** argv) {
+	uint32_t frames = 120;
+	uint8_t mode = LCD_COLOR_MODE_RGB888;
+	const char * out = NULL;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "f:ao:")) != -1) {
+		switch (opt) {
+		case 'f': frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'a': mode = LCD_COLOR_MODE_ARGB8888; break;
+		case 'o': out = optarg; break;
+		default:
+			fprintf(stderr, "usage: bench_particles [-f frames] [-a] [-o frame.ppm]\n");
+			return 1;
+		}
+	}
+	if (frames == 0) frames = 1;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	Host_Config.quiet = 1;
+	Host_Init();
+	BSP->LCD_Init(mode, LCD_BUFFER_MODE_DOUBLE, 0xFF000000, NULL);
+	uint32_t size = LCD_WIDTH * LCD_HEIGHT * Host_LCD_GetBpp();
+	uint8_t * ref = malloc(size);
+	uint32_t mismatch = 0;
+
+	printf("frame %s, %u frames, pool %u particles (%u bytes)\n\n", (mode == LCD_COLOR_MODE_RGB888) ? "RGB888" : "ARGB8888",
+		frames, PART_MAX, PART_MAX * 12);
+	printf("%6s %6s | %9s %9s %9s %9s | %9s %6s | %6s\n", "pool", "alive", "update ms", "draw ms", "upd p/ms", "all p/ms",
+		"g2d ms", "calls", "draw");
+	for (uint32_t n = 256; n <= PART_MAX; n *= 2) {
+		setup(mode, n);
+		double t_upd = 0, t_draw = 0, t_g2d = 0;
+		uint64_t alive = 0, calls = 0;
+		for (uint32_t f = 0; f < frames; f++) {
+			emit(f);
+			uint64_t t = Host_GetNs();
+			PART_Update();
+			t_upd += (Host_GetNs() - t) / 1e6;
+			alive += PART_GetStats()->alive;
+
+			BSP->G2D_FillFrame(0xFF182030);
+			t = Host_GetNs();
+			PART_Draw();
+			t_draw += (Host_GetNs() - t) / 1e6;
+			memcpy(ref, BSP->LCD_GetEditFrameAddr(), size);
+
+			BSP->G2D_FillFrame(0xFF182030);
+			t = Host_GetNs();
+			calls += draw_g2d();
+			t_g2d += (Host_GetNs() - t) / 1e6;
+			if (memcmp(ref, BSP->LCD_GetEditFrameAddr(), size) != 0) mismatch++;
+		}
+		double avg = (double)alive / frames;
+		printf("%6u %6.0f | %9.4f %9.4f %9.0f %9.0f | %9.4f %6llu | %5.1fx\n", n, avg, t_upd / frames, t_draw / frames,
+			avg / (t_upd / frames), avg / ((t_upd + t_draw) / frames), t_g2d / frames, (unsigned long long)(calls / frames), t_g2d / t_draw);
+	}
+	printf("\ndirect blend pass %s G2D_DrawFillRectBlend per particle\n", (mismatch) ? "DIFFERS from" : "bit-exact with");
+
+	if (out) {
+		BSP->G2D_FillFrame(0xFF182030);
+		PART_Draw();
+		BSP->LCD_FrameReady();
+		Host_SaveFrame(out);
+	}
+	free(ref);
+	return (mismatch) ? 1 : 0;
+}
@@ -0,0 +1,274 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Pixel kernels (PixKernel.h) versus scalar per-channel reference.
+ *
+ *   bench_pixkernel [-n pixels] [-r repeats]
+ *
+ * Every kernel of every supported colour mode is run over span of
+ * pixels (source with transparent, opaque and translucent pixels
+ * like sprites) and reported in MPix/s next to reference doing one
+ * channel at a time with division by 255 and mode test per pixel.
+ * Results are compared bit-exactly (also with odd length and
+ * unaligned start), and Blend is checked against G2D_CopyBufBlend
+ * in frame of the same colour mode.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BSP_Host.h"
+#include "PixKernel.h"
+
+enum { K_FILL, K_FILLBLEND, K_BLEND, K_BLENDPM, K_ADD, K_FROM, K_TO, K_PREMUL, K_NO };
+static const char * kname[K_NO] = { "Fill", "FillBlend", "Blend", "BlendPM", "Add", "FromARGB", "ToARGB", "Premultiply" };
+
+static const struct {
+	uint8_t			mode;
+	const char *	name;
+} modes[] = {
+	{ LCD_COLOR_MODE_ARGB8888, "ARGB8888" },
+	{ LCD_COLOR_MODE_RGB888, "RGB888" },
+	{ LCD_COLOR_MODE_ARGB4444, "ARGB4444" },
+	{ LCD_COLOR_MODE_ARGB1555, "ARGB1555" },
+};
+#define MODE_NO			(sizeof(modes) / sizeof(modes[0]))
+
+#define FILL_COLOR		0xC0FF8020
+#define ALPHA			200
+
+
+// Scalar reference
+
+static uint8_t ref_bpp(uint8_t mode) {
+	return (mode == LCD_COLOR_MODE_ARGB8888) ? 4 : (mode == LCD_COLOR_MODE_RGB888) ? 3 : 2;
+}
+
+static uint32_t ref_load(uint8_t mode, const uint8_t * p) {
+	uint32_t c, a, r, g, b;
+	switch (mode) {
+	case LCD_COLOR_MODE_ARGB8888:
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	case LCD_COLOR_MODE_RGB888:
+		return 0xFF000000 | (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+	case LCD_COLOR_MODE_ARGB4444:
+		c = (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+		a = (c >> 12) & 0x0F; r = (c >> 8) & 0x0F; g = (c >> 4) & 0x0F; b = c & 0x0F;
+		return (a * 17) << 24 | (r * 17) << 16 | (g * 17) << 8 | (b * 17);
+	default:
+		c = (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+		a = (c & 0x8000) ? 255 : 0; r = (c >> 10) & 0x1F; g = (c >> 5) & 0x1F; b = c & 0x1F;
+		return a << 24 | ((r << 3) | (r >> 2)) << 16 | ((g << 3) | (g >> 2)) << 8 | ((b << 3) | (b >> 2));
+	}
+}
+
+static void ref_store(uint8_t mode, uint8_t * p, uint32_t c) {
+	uint32_t a = c >> 24, r = (c >> 16) & 0xFF, g = (c >> 8) & 0xFF, b = c & 0xFF;
+	switch (mode) {
+	case LCD_COLOR_MODE_ARGB8888:	p[3] = (uint8_t)a; /* fall through */
+	case LCD_COLOR_MODE_RGB888:		p[2] = (uint8_t)r; p[1] = (uint8_t)g; p[0] = (uint8_t)b; return;
+	case LCD_COLOR_MODE_ARGB4444:	c = (a >> 4) << 12 | (r >> 4) << 8 | (g >> 4) << 4 | (b >> 4); break;
+	default:						c = (a >= 128 ? 0x8000 : 0) | (r >> 3) << 10 | (g >> 3) << 5 | (b >> 3); break;
+	}
+	p[0] = (uint8_t)c;
+	p[1] = (uint8_t)(c >> 8);
+}
+
+static uint32_t ch(uint32_t c, uint8_t shift) {
+	return (c >> shift) & 0xFF;
+}
+
+static uint32_t ref_over(uint32_t d, uint32_t s, uint32_t a) {
+	uint32_t na = 255 - a, r = 0;
+	for (uint8_t sh = 0; sh < 24; sh += 8) r |= ((ch(s, sh) * a + ch(d, sh) * na + 127) / 255) << sh;
+	return r | (a + (ch(d, 24) * na + 127) / 255) << 24;
+}
+
+static uint32_t ref_scale(uint32_t c, uint32_t a) {
+	uint32_t r = 0;
+	for (uint8_t sh = 0; sh < 32; sh += 8) r |= ((ch(c, sh) * a + 127) / 255) << sh;
+	return r;
+}
+
+static void ref_kernel(uint8_t k, uint8_t mode, uint8_t * dst, const uint32_t * src, uint32_t n) {
+	uint8_t bpp = ref_bpp(mode);
+	for (uint32_t i = 0; i < n; i++, dst += bpp) {
+		uint32_t s = src[i], d, a, r;
+		switch (k) {
+		case K_FILL:
+			ref_store(mode, dst, FILL_COLOR);
+			break;
+		case K_FILLBLEND:
+			ref_store(mode, dst, ref_over(ref_load(mode, dst), FILL_COLOR, FILL_COLOR >> 24));
+			break;
+		case K_BLEND:
+			a = ((s >> 24) * ALPHA + 127) / 255;
+			if (a == 0) break;
+			ref_store(mode, dst, (a == 255) ? s | 0xFF000000 : ref_over(ref_load(mode, dst), s, a));
+			break;
+		case K_BLENDPM:
+			s = ref_scale(s, ALPHA);
+			if (s == 0) break;
+			d = ref_scale(ref_load(mode, dst), 255 - (s >> 24));
+			r = 0;
+			for (uint8_t sh = 0; sh < 32; sh += 8) r |= ((ch(s, sh) + ch(d, sh) > 255) ? 255 : ch(s, sh) + ch(d, sh)) << sh;
+			ref_store(mode, dst, r);
+			break;
+		case K_ADD:
+			a = ((s >> 24) * ALPHA + 127) / 255;
+			if (a == 0) break;
+			d = ref_load(mode, dst);
+			r = (ch(d, 24) + a > 255) ? 0xFF000000 : (ch(d, 24) + a) << 24;
+			for (uint8_t sh = 0; sh < 24; sh += 8) {
+				uint32_t v = ch(d, sh) + (ch(s, sh) * a + 127) / 255;
+				r |= ((v > 255) ? 255 : v) << sh;
+			}
+			ref_store(mode, dst, r);
+			break;
+		case K_FROM:
+			ref_store(mode, dst, s);
+			break;
+		case K_TO:
+			((uint32_t *)src)[i] = ref_load(mode, dst);
+			break;
+		case K_PREMUL:
+			((uint32_t *)dst)[0] = (s & 0xFF000000) | (ref_scale(s, s >> 24) & 0xFFFFFF);
+			break;
+		}
+	}
+}
+
+static void pk_kernel(uint8_t k, const PK_KERNELS * pk, uint8_t * dst, uint32_t * src, uint32_t n) {
+	switch (k) {
+	case K_FILL:		pk->Fill(dst, n, FILL_COLOR); break;
+	case K_FILLBLEND:	pk->FillBlend(dst, n, FILL_COLOR); break;
+	case K_BLEND:		pk->Blend(dst, src, n, ALPHA); break;
+	case K_BLENDPM:		pk->BlendPM(dst, src, n, ALPHA); break;
+	case K_ADD:			pk->Add(dst, src, n, ALPHA); break;
+	case K_FROM:		pk->FromARGB(dst, src, n); break;
+	case K_TO:			pk->ToARGB(src, dst, n); break;
+	case K_PREMUL:		PK_Premultiply((uint32_t *)dst, src, n); break;
+	}
+}
+
+
+static uint32_t rng = 0x9E3779B9u;
+
+static uint32_t rnd(void) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+// Sprite-like source: transparent, opaque and translucent runs (premultiplied for BlendPM)
+static void make_src(uint32_t * src, uint32_t n, uint8_t premul) {
+	uint32_t a = 0;
+	for (uint32_t i = 0; i < n; i++) {
+		if ((i & 15) == 0) a = (uint32_t[]){ 0, 255, 255, 128 }[rnd() & 3];
+		uint32_t c = (rnd() & 0xFFFFFF) | ((a == 128) ? (rnd() & 0xFF) : a) << 24;
+		src[i] = (premul) ? (c & 0xFF000000) | (ref_scale(c, c >> 24) & 0xFFFFFF) : c;
+	}
+}
+
+static void make_dst(uint8_t * dst, uint32_t bytes) {
+	for (uint32_t i = 0; i < bytes; i++) dst[i] = (uint8_t)rnd();
+}
+
+// Bit-exact check with given start offset (pixels) and length
+static uint8_t check(uint8_t k, uint8_t m, uint32_t off, uint32_t n, uint8_t * a, uint8_t * b, uint32_t * src, uint32_t * src2) {
+	const PK_KERNELS * pk = PK_GetKernels(modes[m].mode);
+	uint8_t bpp = (k == K_PREMUL) ? 4 : pk->bpp;
+	make_dst(a, (n + off) * bpp);
+	memcpy(b, a, (n + off) * bpp);
+	make_src(src, n, k == K_BLENDPM);
+	memcpy(src2, src, n * 4);
+	ref_kernel(k, (k == K_PREMUL) ? LCD_COLOR_MODE_ARGB8888 : modes[m].mode, a + off * bpp, src, n);
+	pk_kernel(k, pk, b + off * bpp, src2, n);
+	return (memcmp(a, b, (n + off) * bpp) == 0) && (memcmp(src, src2, n * 4) == 0);
+}
+
+// Blend into frame by G2D_CopyBufBlend and by kernel line by line
+static uint8_t check_g2d(uint8_t m) {
+	const PK_KERNELS * pk = PK_GetKernels(modes[m].mode);
+	const uint16_t w = 200, h = 100, x = 37, y = 21;
+	uint32_t * src = malloc(w * h * 4);
+	uint32_t size = LCD_WIDTH * LCD_HEIGHT * pk->bpp;
+	uint8_t * copy = malloc(size), ok;
+
+	BSP->LCD_Init(modes[m].mode, LCD_BUFFER_MODE_DOUBLE, 0xFF000000, NULL);
+	uint8_t * frame = BSP->LCD_GetEditFrameAddr();
+	make_dst(frame, size);
+	make_src(src, w * h, 0);
+	memcpy(copy, frame, size);
+	BSP->G2D_CopyBufBlend(src, 0, x, y, w, h, ALPHA);
+	for (uint16_t j = 0; j < h; j++) pk->Blend(copy + ((y + j) * LCD_WIDTH + x) * pk->bpp, src + j * w, w, ALPHA);
+	ok = (memcmp(copy, frame, size) == 0);
+	free(copy);
+	free(src);
+	return ok;
+}
+
+int main(int argc, char ** argv) {
+	uint32_t n = 256 * 1024, repeats = 20;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+		switch (opt) {
+		case 'n': n = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'r': repeats = (uint32_t)strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: bench_pixkernel [-n pixels] [-r repeats]\n");
+			return 1;
+		}
+	}
+	if (n < 64) n = 64;
+	if (repeats == 0) repeats = 1;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	Host_Config.quiet = 1;
+	Host_Init();
+	uint8_t * a = malloc((n + 4) * 4), * b = malloc((n + 4) * 4);
+	uint32_t * src = malloc(n * 4), * src2 = malloc(n * 4);
+	uint32_t fails = 0;
+
+	printf("%u pixels x %u, alpha %u\n\n", n, repeats, ALPHA);
+	printf("%-9s %-12s | %10s %10s | %7s | %s\n", "mode", "kernel", "ref MPix/s", "PK MPix/s", "speedup", "exact");
+	for (uint8_t m = 0; m < MODE_NO; m++) {
+		for (uint8_t k = 0; k < K_NO; k++) {
+			if ((k == K_PREMUL) && (m > 0)) continue;
+			uint8_t ok = check(k, m, 0, n, a, b, src, src2) && check(k, m, 1, n - 3, a, b, src, src2) && check(k, m, 3, 61, a, b, src, src2);
+			fails += !ok;
+
+			// Timing (destination is reused - blending kernels keep blending over previous result)
+			const PK_KERNELS * pk = PK_GetKernels(modes[m].mode);
+			uint8_t rmode = (k == K_PREMUL) ? LCD_COLOR_MODE_ARGB8888 : modes[m].mode;
+			make_src(src, n, k == K_BLENDPM);
+			memcpy(src2, src, n * 4);
+			uint64_t t = Host_GetNs();
+			for (uint32_t r = 0; r < repeats; r++) ref_kernel(k, rmode, a, src, n);
+			double t_ref = (double)(Host_GetNs() - t);
+			t = Host_GetNs();
+			for (uint32_t r = 0; r < repeats; r++) pk_kernel(k, pk, b, src2, n);
+			double t_pk = (double)(Host_GetNs() - t);
+			double px = (double)n * repeats * 1e3;
+			printf("%-9s %-12s | %10.1f %10.1f | %6.1fx | %s\n", (k == K_PREMUL) ? "-" : modes[m].name, kname[k],
+				px / t_ref, px / t_pk, t_ref / t_pk, (ok) ? "yes" : "NO");
+		}
+	}
+
+	printf("\nBlend vs G2D_CopyBufBlend:");
+	for (uint8_t m = 0; m < MODE_NO; m++) {
+		uint8_t ok = check_g2d(m);
+		fails += !ok;
+		printf(" %s %s", modes[m].name, (ok) ? "bit-exact" : "DIFFERS");
+	}
+	printf("\n");
+
+	free(a);
+	free(b);
+	free(src);
+	free(src2);
+	return (fails) ? 1 : 0;
+}
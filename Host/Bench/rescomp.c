@@ -0,0 +1,141 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Compressed (RC_Load) versus raw (Res_Load) resource loading.
+ *
+ *   bench_rescomp [-d dir] [-n iterations] [-s sd_MBps] [file ...]
+ *
+ * Without files synthetic image-like data is generated. Host reads
+ * come from page cache, so load time on device is also estimated as
+ * decode time + file size / SD card throughput.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "BSP_Host.h"
+#include "ResCompress.h"
+#include "../Tools/rc_enc.h"
+
+static uint8_t * read_all(const char * path, size_t * n) {
+	FILE * f = fopen(path, "rb");
+	if (f == NULL) return NULL;
+	fseek(f, 0, SEEK_END);
+	*n = (size_t)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t * buf = malloc(*n + 1);
+	if (fread(buf, 1, *n, f) != *n) { free(buf); buf = NULL; }
+	fclose(f);
+	return buf;
+}
+
+static void write_all(const char * path, const void * data, size_t n) {
+	FILE * f = fopen(path, "wb");
+	if (f) { fwrite(data, 1, n, f); fclose(f); }
+}
+
+// 320x200 RGB888 gradient with flat areas and noise - similar to UI artwork
+static uint8_t * synth_image(size_t * n) {
+	*n = 320 * 200 * 3;
+	uint8_t * p = malloc(*n);
+	uint32_t seed = 1;
+	for (uint32_t y = 0; y < 200; y++) {
+		for (uint32_t x = 0; x < 320; x++) {
+			uint8_t * px = p + (y * 320 + x) * 3;
+			seed = seed * 1103515245 + 12345;
+			uint8_t noise = ((x / 40 + y / 25) & 1) ? (uint8_t)((seed >> 16) & 0x07) : 0;
+			px[0] = (uint8_t)(x * 255 / 319) ^ noise;
+			px[1] = (uint8_t)(((x / 32) & 1) ? 0x40 : 0xC0);
+			px[2] = (uint8_t)(y * 255 / 199);
+		}
+	}
+	return p;
+}
+
+static void bench(const char * dir, const char * name, const uint8_t * raw, size_t n, int iters, double sd_mbps) {
+	char path[512], lz[512], rel[300];
+	size_t csize;
+	uint8_t * comp = malloc(rc_bound(n));
+
+	csize = rc_compress(raw, n, comp);
+	snprintf(path, sizeof(path), "%s/%s.raw", dir, name);
+	snprintf(lz, sizeof(lz), "%s/%s.lz", dir, name);
+	write_all(path, raw, n);
+	write_all(lz, comp, csize);
+
+	// Raw load
+	uint64_t t_raw = ~0ull, t_lz = ~0ull, t_dec = ~0ull;
+	for (int i = 0; i < iters; i++) {
+		snprintf(rel, sizeof(rel), "%s.raw", name);
+		uint64_t t = Host_GetNs();
+		void * d = BSP->Res_Load(rel);
+		t = Host_GetNs() - t;
+		if (t < t_raw) t_raw = t;
+		if ((d == NULL) || memcmp(d, raw, n)) { printf("%s: raw load failed\n", name); return; }
+		BSP->Res_Free(d);
+
+		snprintf(rel, sizeof(rel), "%s.lz", name);
+		t = Host_GetNs();
+		d = RC_Load(rel);
+		t = Host_GetNs() - t;
+		if (t < t_lz) t_lz = t;
+		if ((d == NULL) || memcmp(d, raw, n)) { printf("%s: compressed load failed\n", name); return; }
+
+		t = Host_GetNs();
+		RC_Decode(comp, (uint32_t)csize, d, (uint32_t)n);
+		t = Host_GetNs() - t;
+		if (t < t_dec) t_dec = t;
+		BSP->Res_Free(d);
+	}
+
+	double mb = (double)n / 1e6;
+	double sd_raw = (double)n / (sd_mbps * 1e6) * 1e3;
+	double sd_lz = (double)csize / (sd_mbps * 1e6) * 1e3 + (double)t_dec / 1e6;
+	printf("%-16s %9zu %9zu %6.1f%% | %8.1f %8.1f %8.1f | %8.2f %8.2f\n", name, n, csize, 100.0 * (double)csize / (double)n,
+		mb / ((double)t_raw / 1e9), mb / ((double)t_lz / 1e9), mb / ((double)t_dec / 1e9), sd_raw, sd_lz);
+	free(comp);
+}
+
+int main(int argc, char ** argv) {
+	const char * dir = "/tmp/mc_bench";
+	int iters = 20;
+	double sd_mbps = 20.0;
+	int i = 1;
+
+	for (; i < argc; i++) {
+		if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) dir = argv[++i];
+		else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) iters = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) sd_mbps = atof(argv[++i]);
+		else break;
+	}
+
+	mkdir(dir, 0755);
+	Host_Config.rootdir = dir;
+	Host_Config.quiet = 1;
+	Host_Init();
+	void * mem = malloc(64 * 1024 * 1024);
+	BSP->Res_Init(mem, 64 * 1024 * 1024);
+	BSP->SetHomeDir("0:/");
+
+	printf("%-16s %9s %9s %7s | %8s %8s %8s | %8s %8s\n", "resource", "raw [B]", "lz [B]", "ratio",
+		"Res MB/s", "RC MB/s", "dec MB/s", "SD raw", "SD lz");
+	printf("%-16s %9s %9s %7s | %8s %8s %8s | %5.0f MB/s [ms]\n", "", "", "", "", "(host)", "(host)", "", sd_mbps);
+
+	if (i == argc) {
+		size_t n;
+		uint8_t * img = synth_image(&n);
+		bench(dir, "synthetic", img, n, iters, sd_mbps);
+		free(img);
+	}
+	for (; i < argc; i++) {
+		size_t n;
+		uint8_t * data = read_all(argv[i], &n);
+		if (data == NULL) { fprintf(stderr, "bench_rescomp: can not read %s\n", argv[i]); continue; }
+		const char * base = strrchr(argv[i], '/');
+		bench(dir, (base) ? base + 1 : argv[i], data, n, iters, sd_mbps);
+		free(data);
+	}
+	return 0;
+}
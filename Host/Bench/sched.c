@@ -0,0 +1,90 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Frame scheduler (Sched_WaitEditPermission) against simulated vsync.
+ *
+ *   bench_sched [-v vsync_hz] [-f frames] [-r render_us] [-j jitter_us] [-t task_us] [-m min_us]
+ *
+ * Each frame burns render_us (+ random jitter) of CPU time as
+ * rendering. Background task does work units of task_us and asks to
+ * be started only when min_us is left. Report shows how much of
+ * slack was used by task, how much was slept and how often deadline
+ * (predicted edit window) was missed.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "BSP_Host.h"
+#include "Sched.h"
+
+static uint32_t render_us = 8000;
+static uint32_t jitter_us = 4000;
+static uint32_t task_us = 250;
+static uint32_t min_us = 300;
+static uint32_t units = 0;
+
+static void spin_us(uint32_t us) {
+	uint64_t end = Host_GetNs() + (uint64_t)us * 1000;
+	while (Host_GetNs() < end) continue;
+}
+
+static uint8_t background(void * arg) {
+	(void)arg;
+	spin_us(task_us);
+	units++;
+	return SCHED_MORE;
+}
+
+static void bench_init(void) {
+	BSP->LCD_Init(LCD_COLOR_MODE_RGB888, LCD_BUFFER_MODE_DOUBLE, 0, NULL);
+	Sched_AddTask(background, NULL, min_us);
+}
+
+static void bench_main(void) {
+	while (1) {
+		Sched_WaitEditPermission();
+		spin_us(render_us + ((jitter_us) ? (uint32_t)rand() % jitter_us : 0));
+		BSP->LCD_FrameReady();
+	}
+}
+
+int main(int argc, char ** argv) {
+	int opt;
+
+	Host_Config.vsync_hz = 60;
+	Host_Config.frames = 120;
+	Host_Config.quiet = 1;
+
+	while ((opt = getopt(argc, argv, "v:f:r:j:t:m:")) != -1) {
+		switch (opt) {
+		case 'v': Host_Config.vsync_hz = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'f': Host_Config.frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'r': render_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'j': jitter_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 't': task_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'm': min_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-v vsync_hz] [-f frames] [-r render_us] [-j jitter_us] [-t task_us] [-m min_us]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	Host_Init();
+	uint64_t t0 = Host_GetNs();
+	Host_Run(bench_init, bench_main);
+	double wall_ms = (Host_GetNs() - t0) / 1e6;
+
+	const SCHED_STATS * s = Sched_GetStats();
+	uint32_t frames = (s->frames) ? s->frames : 1;
+	printf("vsync %u Hz, render %u+%u us, task unit %u us (min %u us)\n", Host_Config.vsync_hz, render_us, jitter_us, task_us, min_us);
+	printf("  frames          %u (%.1f fps)\n", s->frames, s->frames * 1000.0 / wall_ms);
+	printf("  period estimate %u us\n", s->period_us);
+	printf("  slack / frame   %.0f us\n", (double)s->slack_total / frames);
+	printf("  used / frame    %.0f us (%.1f%% of slack)\n", (double)s->used_total / frames, (s->slack_total) ? 100.0 * s->used_total / s->slack_total : 0.0);
+	printf("  sleep / frame   %.0f us\n", (double)s->idle_total / frames);
+	printf("  task runs       %u (%u units)\n", s->task_runs, units);
+	printf("  deadline misses %u, late frames %u, frames without slack %u\n", s->deadline_misses, s->late_frames, s->no_slack);
+	printf("  frame time      %.2f ms avg\n", wall_ms / frames);
+	return 0;
+}
@@ -0,0 +1,123 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * SDF text (SDF_TextBlend / SDF_TextStyled) versus packed bitmap
+ * fonts (G2D_TextBlend).
+ *
+ *   bench_sdf [-l line] [-s spread] [-n iterations] [-o frame.ppm]
+ *
+ * SDF font is built from FONT_64_verdana. For every bitmap size of
+ * verdana the report shows draw time per glyph of both paths and
+ * difference of SDF coverage against the bitmap font of that size
+ * (mean absolute alpha error, share of pixels off by more than 1/4).
+ * With -o sample frame is saved.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BSP_Host.h"
+#include "Font.h"
+#include "SDF.h"
+#include "fonts.h"
+#include "../Tools/sdf_enc.h"
+
+static const char * text = "The quick brown fox jumps over the lazy dog 0123456789";
+
+static double time_ns(uint16_t (*draw)(const uint8_t *, uint16_t, uint32_t), const uint8_t * font, uint16_t size, int iters) {
+	uint64_t best = ~0ull;
+	for (int i = 0; i < iters; i++) {
+		uint64_t t = Host_GetNs();
+		draw(font, size, 0xFFFFFFFF);
+		t = Host_GetNs() - t;
+		if (t < best) best = t;
+	}
+	return (double)best;
+}
+
+static const SDF_STYLE style = { 0xFFFFFFFF, 0xFF000000, 2, 0xC0FF8000, 3 };
+
+static uint16_t draw_bitmap(const uint8_t * font, uint16_t size, uint32_t color) { return BSP->G2D_TextBlend(0, 100, font, (char *)text, color); }
+static uint16_t draw_sdf(const uint8_t * font, uint16_t size, uint32_t color) { return SDF_TextBlend(0, 100, font, text, size, color); }
+static uint16_t draw_styled(const uint8_t * font, uint16_t size, uint32_t color) { return SDF_TextStyled(0, 100, font, text, size, &style); }
+
+// Coverage difference over glyph cells '!'..'~'
+static void compare(const uint8_t * bitmap, const uint8_t * sdf, double * mae, double * bad) {
+	static uint8_t bm[256 * 64], sm[SDF_MAX_WIDTH * 128];
+	uint8_t h = bitmap[0];
+	uint16_t pad = ((uint32_t)sdf[3] * h + sdf[2] / 2) / sdf[2];
+	uint64_t sum = 0, off = 0, n = 0;
+
+	for (uint32_t c = FONT_FIRST_CHAR; c <= FONT_LAST_CHAR; c++) {
+		uint8_t w = Font_DecodeGlyph(bitmap, (char)c, bm);
+		uint16_t sh;
+		uint16_t sw = SDF_RenderMask(sdf, c, h, sm, &sh);
+		for (uint32_t y = 0; y < h; y++) {
+			for (uint32_t x = 0; x < w; x++) {
+				uint32_t sx = x + pad, sy = y + pad;
+				int a = ((sx < sw) && (sy < sh)) ? sm[sy * sw + sx] : 0;
+				int e = abs(a - bm[y * w + x]);
+				sum += e;
+				off += (e > 64);
+				n++;
+			}
+		}
+	}
+	*mae = (double)sum / n / 255.0 * 100.0;
+	*bad = (double)off / n * 100.0;
+}
+
+int main(int argc, char ** argv) {
+	int line = 20, spread = 3, iters = 50;
+	const char * frame = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-l") == 0) && (i + 1 < argc)) line = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) spread = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) iters = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) frame = argv[++i];
+	}
+
+	Host_Config.quiet = 1;
+	Host_Init();
+	BSP->LCD_Init(LCD_COLOR_MODE_ARGB8888, LCD_BUFFER_MODE_DOUBLE, 0, NULL);
+
+	size_t size;
+	uint8_t * sdf = sdf_build(FONT_64_verdana, (uint8_t)line, (uint8_t)spread, &size);
+	const uint8_t * bitmaps[] = { FONT_12_verdana, FONT_14_verdana, FONT_16_verdana, FONT_18_verdana, FONT_20_verdana, FONT_22_verdana,
+		FONT_24_verdana, FONT_26_verdana, FONT_28_verdana, FONT_36_verdana, FONT_64_verdana };
+	size_t bitmap_size = sizeof(FONT_12_verdana) + sizeof(FONT_14_verdana) + sizeof(FONT_16_verdana) + sizeof(FONT_18_verdana) + sizeof(FONT_20_verdana)
+		+ sizeof(FONT_22_verdana) + sizeof(FONT_24_verdana) + sizeof(FONT_26_verdana) + sizeof(FONT_28_verdana) + sizeof(FONT_36_verdana) + sizeof(FONT_64_verdana);
+	uint32_t glyphs = 0;
+	for (const char * p = text; *p; p++) glyphs += (*p != ' ');
+
+	printf("SDF font: line %d, spread %d, %zu bytes (11 verdana bitmap fonts: %zu bytes)\n\n", line, spread, size, bitmap_size);
+	printf("size | bitmap ns/gl | sdf ns/gl  ratio | styled ns/gl | width bmp/sdf | alpha err  >1/4\n");
+	for (uint32_t i = 0; i < sizeof(bitmaps) / sizeof(bitmaps[0]); i++) {
+		const uint8_t * bm = bitmaps[i];
+		uint16_t h = bm[0];
+		double t_bm = time_ns(draw_bitmap, bm, h, iters) / glyphs;
+		double t_sdf = time_ns(draw_sdf, sdf, h, iters) / glyphs;
+		double t_st = time_ns(draw_styled, sdf, h, iters) / glyphs;
+		double mae, bad;
+		compare(bm, sdf, &mae, &bad);
+		printf("%4u | %12.0f | %9.0f %6.2f | %12.0f | %6u/%-6u | %8.2f%% %5.1f%%\n", h, t_bm, t_sdf, t_sdf / t_bm, t_st,
+			Font_GetTextWidth(bm, text), SDF_GetTextWidth(sdf, text, h), mae, bad);
+	}
+
+	if (frame) {
+		BSP->G2D_FillFrame(0xFF203050);
+		int16_t y = 4;
+		for (uint16_t s = 12; y + s < 360; s += s / 3) {
+			SDF_TextBlend(4, y, sdf, "SDF text at any size 0123", s, 0xFFFFFFFF);
+			y += s;
+		}
+		SDF_TextStyled(4, 370, sdf, "Outline + glow", 72, &style);
+		BSP->LCD_FrameReady();
+		Host_SaveFrame(frame);
+		printf("\nsample frame saved to %s\n", frame);
+	}
+
+	free(sdf);
+	return 0;
+}
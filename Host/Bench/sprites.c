@@ -0,0 +1,317 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Sprite atlas and batched drawing (Sprite.h) versus one
+ * G2D_DrawBitmapBlend per sprite from separate images.
+ *
+ *   bench_sprites [-f frames] [-a] [-d dir] [-o frame.ppm]
+ *
+ * Three sprite sheets (one compressed) are written to dir, loaded
+ * with SPR_AtlasLoad and packed into two 512x512 pages. Then 64 to
+ * 1024 moving sprites in 4 layers over world larger than screen are
+ * drawn for given number of frames by both paths. Report shows
+ * frame time, culled sprites, DMA2D transfers, source runs and
+ * blended pixels, and checks that atlas frame is bit-exact with
+ * reference drawn in the same order. Frame is RGB888 (-a ARGB8888).
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "BSP_Host.h"
+#include "Sprite.h"
+#include "rc_enc.h"
+
+#define LAYERS			4
+#define WORLD_W			(LCD_WIDTH * 3 / 2)
+#define WORLD_H			(LCD_HEIGHT * 3 / 2)
+#define MAX_N			SPR_MAX_SPRITES
+
+typedef struct {
+	const char *	name;
+	uint16_t		fw;				// Frame size
+	uint16_t		fh;
+	uint16_t		cols;
+	uint16_t		rows;
+	uint8_t			compress;
+	SPR_ID			first;
+} SHEET;
+
+static SHEET sheets[] = {
+	{ "ships.img",		32, 32, 4, 4, 0, 0 },
+	{ "rocks.img",		48, 48, 8, 2, 0, 0 },
+	{ "shots.img",		16, 16, 16, 1, 1, 0 },
+};
+#define SHEET_NO		(sizeof(sheets) / sizeof(sheets[0]))
+
+typedef struct {
+	int32_t		x, y;				// World position
+	int16_t		vx, vy;
+	uint8_t		sheet;
+	uint8_t		anim;
+	uint8_t		layer;
+	uint8_t		alpha;
+} OBJ;
+
+static uint32_t * image[SHEET_NO];	// Untrimmed frames for baseline (frame after frame)
+static OBJ obj[MAX_N];
+static uint32_t rng = 0x9E3779B9u;
+
+static uint32_t rnd(uint32_t n) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng % n;
+}
+
+// Frame (c, r) of sheet s: shape inside frame with transparent margin depending on sheet
+static uint32_t sheet_pixel(uint8_t s, uint16_t c, uint16_t r, int x, int y) {
+	const SHEET * sh = &sheets[s];
+	int cx = sh->fw / 2, cy = sh->fh / 2;
+	int dx = x - cx, dy = y - cy;
+	uint32_t rgb = (uint32_t)(c * 40 + 60) << 16 | (uint32_t)(r * 60 + 80) << 8 | (uint32_t)(s * 80 + 40);
+	if (s == 0) {
+		int rad = 10 + (c + r) % 5;
+		int d = dx * dx + dy * dy;
+		if (d >= rad * rad) return 0;
+		return ((d > (rad - 2) * (rad - 2)) ? 0x80u : 0xFFu) << 24 | rgb;
+	}
+	if (s == 1) {
+		int rad = 14 + ((x * 7 + y * 3 + c) % 6);
+		if (abs(dx) + abs(dy) >= rad + 4 * (c % 3)) return 0;
+		return 0xFF000000 | rgb;
+	}
+	int rad = 2 + c % 4;
+	if ((abs(dx) > rad) || (abs(dy) > rad)) return 0;
+	return (uint32_t)(255 - 40 * (abs(dx) + abs(dy)) / (rad + 1)) << 24 | rgb;
+}
+
+static void write_sheets(const char * dir) {
+	for (uint8_t s = 0; s < SHEET_NO; s++) {
+		const SHEET * sh = &sheets[s];
+		uint16_t w = sh->fw * sh->cols, h = sh->fh * sh->rows;
+		size_t size = 4 + (size_t)w * h * 4;
+		uint8_t * img = malloc(size);
+		uint16_t hdr[2] = { w, h };
+		memcpy(img, hdr, 4);
+		uint32_t * px = (uint32_t *)(img + 4);
+		image[s] = malloc((size_t)w * h * 4);
+		for (uint16_t r = 0; r < sh->rows; r++) {
+			for (uint16_t c = 0; c < sh->cols; c++) {
+				uint32_t * frame = image[s] + (size_t)(r * sh->cols + c) * sh->fw * sh->fh;
+				for (int y = 0; y < sh->fh; y++) {
+					for (int x = 0; x < sh->fw; x++) {
+						uint32_t p = sheet_pixel(s, c, r, x, y);
+						px[(size_t)(r * sh->fh + y) * w + c * sh->fw + x] = p;
+						frame[y * sh->fw + x] = p;
+					}
+				}
+			}
+		}
+
+		uint8_t * out = img;
+		if (sh->compress) {
+			out = malloc(rc_bound(size));
+			size = rc_compress(img, size, out);
+		}
+		char path[512];
+		snprintf(path, sizeof(path), "%s/%s", dir, sh->name);
+		FILE * f = fopen(path, "wb");
+		if ((f == NULL) || (fwrite(out, 1, size, f) != size)) { fprintf(stderr, "bench_sprites: can not write %s\n", path); exit(1); }
+		fclose(f);
+		if (out != img) free(out);
+		free(img);
+	}
+}
+
+static void spawn(uint32_t n) {
+	rng = 0x9E3779B9u;
+	for (uint32_t i = 0; i < n; i++) {
+		OBJ * o = &obj[i];
+		o->sheet = (uint8_t)rnd(SHEET_NO);
+		o->x = (int32_t)rnd(WORLD_W);
+		o->y = (int32_t)rnd(WORLD_H);
+		o->vx = (int16_t)rnd(9) - 4;
+		o->vy = (int16_t)rnd(9) - 4;
+		o->anim = (uint8_t)rnd(256);
+		o->layer = (uint8_t)rnd(LAYERS);
+		o->alpha = (rnd(4) == 0) ? 160 : 255;
+	}
+}
+
+// Screen position of object at given frame (camera in centre of world)
+static void position(const OBJ * o, uint32_t frame, int16_t * x, int16_t * y) {
+	int32_t wx = (o->x + o->vx * (int32_t)frame) % WORLD_W;
+	int32_t wy = (o->y + o->vy * (int32_t)frame) % WORLD_H;
+	if (wx < 0) wx += WORLD_W;
+	if (wy < 0) wy += WORLD_H;
+	*x = (int16_t)(wx - (WORLD_W - LCD_WIDTH) / 2);
+	*y = (int16_t)(wy - (WORLD_H - LCD_HEIGHT) / 2);
+}
+
+static uint16_t frame_index(const OBJ * o, uint32_t frame) {
+	const SHEET * sh = &sheets[o->sheet];
+	return (uint16_t)((o->anim + frame / 4) % (sh->cols * sh->rows));
+}
+
+// Atlas path
+static void draw_atlas(uint32_t n, uint32_t frame) {
+	SPR_Begin();
+	for (uint32_t i = 0; i < n; i++) {
+		int16_t x, y;
+		position(&obj[i], frame, &x, &y);
+		SPR_Draw(sheets[obj[i].sheet].first + frame_index(&obj[i], frame), x, y, obj[i].layer, obj[i].alpha);
+	}
+	SPR_End();
+}
+
+// Baseline - layer by layer, every sprite from its own untrimmed image
+static uint32_t draw_direct(uint32_t n, uint32_t frame, uint64_t * pixels) {
+	uint32_t calls = 0;
+	for (uint8_t l = 0; l < LAYERS; l++) {
+		for (uint32_t i = 0; i < n; i++) {
+			const OBJ * o = &obj[i];
+			if (o->layer != l) continue;
+			const SHEET * sh = &sheets[o->sheet];
+			int16_t x, y;
+			position(o, frame, &x, &y);
+			BSP->G2D_DrawBitmapBlend(image[o->sheet] + (size_t)frame_index(o, frame) * sh->fw * sh->fh, x, y, sh->fw, sh->fh, o->alpha);
+			*pixels += (uint32_t)sh->fw * sh->fh;
+			calls++;
+		}
+	}
+	return calls;
+}
+
+// Reference for bit-exact check - baseline drawing in order of SPR_End (layer, page, frame, queue)
+static uint32_t ref_key(uint32_t i, uint32_t frame) {
+	SPR_ID id = sheets[obj[i].sheet].first + frame_index(&obj[i], frame);
+	return (uint32_t)obj[i].layer << 24 | (uint32_t)SPR_GetFrame(id)->page << 16 | id;
+}
+
+static uint32_t ref_frame;
+
+static int ref_cmp(const void * a, const void * b) {
+	uint32_t ia = *(const uint32_t *)a, ib = *(const uint32_t *)b;
+	uint32_t ka = ref_key(ia, ref_frame), kb = ref_key(ib, ref_frame);
+	if (ka != kb) return (ka < kb) ? -1 : 1;
+	return (ia < ib) ? -1 : (ia > ib);
+}
+
+static void draw_reference(uint32_t n, uint32_t frame) {
+	static uint32_t order[MAX_N];
+	for (uint32_t i = 0; i < n; i++) order[i] = i;
+	ref_frame = frame;
+	qsort(order, n, sizeof(uint32_t), ref_cmp);
+	for (uint32_t k = 0; k < n; k++) {
+		const OBJ * o = &obj[order[k]];
+		const SHEET * sh = &sheets[o->sheet];
+		int16_t x, y;
+		position(o, frame, &x, &y);
+		BSP->G2D_DrawBitmapBlend(image[o->sheet] + (size_t)frame_index(o, frame) * sh->fw * sh->fh, x, y, sh->fw, sh->fh, o->alpha);
+	}
+}
+
+int main(int argc, char ** argv) {
+	uint32_t frames = 60;
+	uint8_t mode = LCD_COLOR_MODE_RGB888;
+	const char * out = NULL;
+	char tmp[] = "/tmp/mc_sprites_XXXXXX";
+	const char * dir = NULL;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "f:ad:o:")) != -1) {
+		switch (opt) {
+		case 'f': frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'a': mode = LCD_COLOR_MODE_ARGB8888; break;
+		case 'd': dir = optarg; break;
+		case 'o': out = optarg; break;
+		default:
+			fprintf(stderr, "usage: bench_sprites [-f frames] [-a] [-d dir] [-o frame.ppm]\n");
+			return 1;
+		}
+	}
+	if (frames == 0) frames = 1;
+	if (dir == NULL) dir = mkdtemp(tmp);
+	else mkdir(dir, 0755);
+	if (dir == NULL) { fprintf(stderr, "bench_sprites: can not create directory\n"); return 1; }
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	write_sheets(dir);
+	Host_Config.rootdir = dir;
+	Host_Config.quiet = 1;
+	Host_Init();
+	void * mem = malloc(16 * 1024 * 1024);
+	BSP->Res_Init(mem, 16 * 1024 * 1024);
+	BSP->LCD_Init(mode, LCD_BUFFER_MODE_DOUBLE, 0xFF000000, NULL);
+
+	// Atlas
+	uint64_t t = Host_GetNs();
+	if (SPR_AtlasInit(NULL, 512, 512, 2) != BSP_OK) { fprintf(stderr, "bench_sprites: can not allocate atlas\n"); return 1; }
+	for (uint8_t s = 0; s < SHEET_NO; s++) {
+		char path[64];
+		snprintf(path, sizeof(path), "0:/%s", sheets[s].name);
+		sheets[s].first = SPR_AtlasLoad(path, sheets[s].fw, sheets[s].fh);
+		if (sheets[s].first == SPR_INVALID) { fprintf(stderr, "bench_sprites: can not load %s\n", path); return 1; }
+	}
+	t = Host_GetNs() - t;
+	uint32_t raw = 0;
+	for (uint8_t s = 0; s < SHEET_NO; s++) raw += (uint32_t)sheets[s].fw * sheets[s].fh * sheets[s].cols * sheets[s].rows;
+	const SPR_STATS * st = SPR_GetStats();
+	printf("atlas: %u frames, %u px untrimmed, %u px trimmed (%.1f%%), %.1f%% of %u px pages used, load+pack %.2f ms\n",
+		st->atlas_frames, raw, st->atlas_used, 100.0 * st->atlas_used / raw, 100.0 * st->atlas_used / st->atlas_area, st->atlas_area, t / 1e6);
+	printf("frame %s, %u frames, world %ux%u\n\n", (mode == LCD_COLOR_MODE_RGB888) ? "RGB888" : "ARGB8888", frames, WORLD_W, WORLD_H);
+
+	uint32_t size = LCD_WIDTH * LCD_HEIGHT * Host_LCD_GetBpp();
+	uint8_t * ref = malloc(size);
+	uint32_t mismatch = 0;
+
+	printf("%6s | %9s %9s %9s | %9s %7s %7s %7s %9s | %6s\n", "sprites", "direct ms", "calls", "Mpx", "atlas ms", "culled", "drawn", "runs", "Mpx", "speed");
+	for (uint32_t n = 64; n <= MAX_N; n *= 2) {
+		spawn(n);
+		double ms_direct = 0, ms_atlas = 0;
+		uint64_t px_direct = 0, px_atlas = 0, culled = 0, drawn = 0, runs = 0;
+		uint32_t calls = 0;
+		for (uint32_t f = 0; f < frames; f++) {
+			BSP->G2D_FillFrame(0xFF203040);
+			t = Host_GetNs();
+			calls += draw_direct(n, f, &px_direct);
+			ms_direct += (Host_GetNs() - t) / 1e6;
+
+			BSP->G2D_FillFrame(0xFF203040);
+			t = Host_GetNs();
+			draw_atlas(n, f);
+			ms_atlas += (Host_GetNs() - t) / 1e6;
+			culled += st->culled;
+			drawn += st->drawn;
+			runs += st->batches;
+			px_atlas += st->pixels;
+
+			if (f == 0) {
+				memcpy(ref, BSP->LCD_GetEditFrameAddr(), size);
+				BSP->G2D_FillFrame(0xFF203040);
+				draw_reference(n, f);
+				if (memcmp(ref, BSP->LCD_GetEditFrameAddr(), size) != 0) mismatch++;
+			}
+		}
+		printf("%6u | %9.3f %9u %9.2f | %9.3f %7llu %7llu %7llu %9.2f | %5.2fx\n", n,
+			ms_direct / frames, calls / frames, px_direct / 1e6 / frames,
+			ms_atlas / frames, (unsigned long long)(culled / frames), (unsigned long long)(drawn / frames), (unsigned long long)(runs / frames), px_atlas / 1e6 / frames,
+			ms_direct / ms_atlas);
+	}
+	printf("\natlas frames %s reference\n", (mismatch) ? "DIFFER from" : "bit-exact with");
+
+	if (out) {
+		spawn(512);
+		BSP->G2D_FillFrame(0xFF203040);
+		draw_atlas(512, 0);
+		BSP->LCD_FrameReady();
+		Host_SaveFrame(out);
+	}
+	SPR_AtlasRelease();
+	free(ref);
+	free(mem);
+	return (mismatch) ? 1 : 0;
+}
@@ -0,0 +1,245 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Tiled rendering of display list (TileRender) versus direct G2D
+ * calls into frame buffer.
+ *
+ *   bench_tiled [-f frames] [-p] [-o frame.ppm]
+ *
+ * Scene of about 200 commands (tiled background, panels, sprites,
+ * icons, shapes, v1 and UTF-8 text, buffer copies) is drawn by both
+ * paths for every frame, colour mode (ARGB8888, RGB888) and tile
+ * size. Report shows frame buffer bytes written / read per frame,
+ * draw time, overdraw and tile counts, and checks that both frames
+ * are bit-exact. With -p scene has no full screen background, so
+ * tiles are read from frame first. With -o last tiled frame is
+ * saved.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BSP_Host.h"
+#include "DisplayList.h"
+#include "TileRender.h"
+#include "Font.h"
+#include "fonts.h"
+#include "../Tools/font2_enc.h"
+
+#define SPRITE_SIZE		32
+#define ICON_SIZE		24
+#define BUF_W			96
+#define BUF_H			40
+#define BUF_OFFS		8
+
+static uint32_t sprite[SPRITE_SIZE * SPRITE_SIZE];
+static uint8_t icon[4 + ICON_SIZE * ICON_SIZE] __attribute__((aligned(4)));
+static uint8_t bitmap[ICON_SIZE * ICON_SIZE * 4];
+static uint8_t buffer[(BUF_W + BUF_OFFS) * BUF_H * 4];
+static uint32_t argb_buffer[(BUF_W + BUF_OFFS) * BUF_H];
+static uint8_t * font_v2;
+static uint8_t partial = 0;
+
+static uint32_t rng;
+
+static uint32_t rnd(uint32_t n) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng % n;
+}
+
+// Native colour of frame format (RGB888 keeps alpha byte like G2D_Color)
+static void put_native(uint8_t * p, uint8_t bpp, uint32_t c) {
+	for (uint8_t i = 0; i < bpp; i++) p[i] = (uint8_t)(c >> (8 * i));
+}
+
+static void make_assets(uint8_t bpp) {
+	for (int y = 0; y < SPRITE_SIZE; y++) {
+		for (int x = 0; x < SPRITE_SIZE; x++) {
+			int dx = 2 * x - SPRITE_SIZE + 1, dy = 2 * y - SPRITE_SIZE + 1;
+			int d = dx * dx + dy * dy, r = SPRITE_SIZE * SPRITE_SIZE;
+			uint32_t a = (d >= r) ? 0 : (d > r / 2) ? 255 * (r - d) * 2 / r : 255;
+			sprite[y * SPRITE_SIZE + x] = a << 24 | (uint32_t)(x * 8) << 16 | (uint32_t)(y * 8) << 8 | 0x80;
+		}
+	}
+	((uint16_t *)icon)[0] = ICON_SIZE;
+	((uint16_t *)icon)[1] = ICON_SIZE;
+	for (int i = 0; i < ICON_SIZE * ICON_SIZE; i++) {
+		int x = i % ICON_SIZE, y = i / ICON_SIZE;
+		icon[4 + i] = ((x + y) % 8 < 4) ? 255 : (uint8_t)(x * 10);
+		put_native(bitmap + i * bpp, bpp, 0xFF000000 | (uint32_t)(x * 10) << 16 | (uint32_t)(y * 10));
+	}
+	for (int i = 0; i < (BUF_W + BUF_OFFS) * BUF_H; i++) {
+		put_native(buffer + i * bpp, bpp, 0xFF000000 | (uint32_t)(i * 2654435761u >> 8));
+		argb_buffer[i] = (uint32_t)((i % 7) * 36) << 24 | 0x40C0FF;
+	}
+}
+
+static void make_font(void) {
+	F2_FONT f;
+	size_t size;
+	const uint8_t * v1 = FONT_20_verdana;
+	f2_init(&f, v1[0], v1[1]);
+	f2_import_v1(&f, v1);
+	for (uint32_t c = 0xC0; c <= 0xFF; c++) {
+		F2_GLYPH * g = f2_find(&f, (c < 0xE0) ? 'A' + (c - 0xC0) % 26 : 'a' + (c - 0xE0) % 26);
+		f2_add_raw(&f, c, g->data, g->size);
+	}
+	f2_add_kern(&f, 'A', 'V', -2);
+	f2_add_kern(&f, 'T', 'o', -2);
+	font_v2 = f2_build(&f, &size, NULL);
+	f2_free(&f);
+}
+
+static void scene(uint32_t frame) {
+	rng = 0x9E3779B9u;
+	if (!partial) DL_FillFrame(0xFF101820);
+
+	// Tiled background
+	for (int y = 0; y < 6; y++) {
+		for (int x = 0; x < 10; x++) {
+			if (partial && ((x + y) & 1)) continue;
+			DL_DrawFillRect(x * 80 + 2, y * 80 + 2, 76, 76, 0xFF000000 | (uint32_t)(x * 20) << 16 | (uint32_t)(y * 30) << 8 | 0x40);
+		}
+	}
+	DL_DrawFillRoundRect(20, 20, 300, 120, 16, 0xFF304060);
+	DL_DrawFillRoundRectBlend(480, 300, 300, 160, 24, 0xA0206040);
+	DL_DrawFillRectBlend(40, 340, 380, 100, 0x80000000);
+
+	// Shapes
+	DL_DrawLine(0, 0, 799, 479, 0xFFFF0000);
+	DL_DrawLine(799, 0, 0, 479, 0xFF00FF00);
+	DL_DrawLine(100, 250 + (int)(frame % 50), 700, 200, 0xFFFFFF00);
+	DL_DrawRect(10, 10, 780, 460, 0xFFFFFFFF);
+	DL_DrawRoundRect(470, 290, 320, 180, 30, 0xFFFFC000);
+	DL_DrawCircle(600, 120, 90, 0xFF00FFFF);
+	DL_DrawFillCircle(200 + frame * 3 % 400, 240, 40, 0xFFC03030);
+	DL_DrawFillCircleBlend(400, 240, 70, 0x6060A0FF);
+	DL_DrawHLine(0, 150, 800, 0xFF808080);
+	DL_DrawHLineBlend(0, 152, 800, 0x80FFFFFF);
+	DL_DrawVLine(400, 0, 480, 0xFF808080);
+	DL_DrawVLineBlend(402, 0, 480, 0x80FFFFFF);
+	for (int i = 0; i < 40; i++) DL_DrawPixel(rnd(800), rnd(480), 0xFFFFFFFF);
+
+	// Sprites, icons, bitmaps and buffers
+	for (int i = 0; i < 60; i++) {
+		int x = (int)rnd(800 + SPRITE_SIZE) - SPRITE_SIZE + (int)(frame * (i % 5));
+		DL_DrawBitmapBlend(sprite, (int16_t)(x % 832 - SPRITE_SIZE), (int16_t)rnd(480 + SPRITE_SIZE) - SPRITE_SIZE / 2, SPRITE_SIZE, SPRITE_SIZE, (uint8_t)(128 + i * 2));
+	}
+	for (int i = 0; i < 12; i++) {
+		DL_DrawIconBlend(icon, (int16_t)rnd(780), (int16_t)rnd(460), 0xC0FFFF00);
+		DL_DrawIcon(icon, (int16_t)rnd(780), (int16_t)rnd(460), 0xFF00FF80, 0xFF202020);
+		DL_DrawBitmap(bitmap, (int16_t)rnd(780), (int16_t)rnd(460), ICON_SIZE, ICON_SIZE);
+	}
+	DL_CopyBuf(buffer, BUF_OFFS, 650, 20, BUF_W, BUF_H);
+	DL_CopyBufBlend(argb_buffer, BUF_OFFS, 620, 50, BUF_W, BUF_H, 200);
+
+	// Text
+	DL_TextBlend(30, 30, FONT_26_verdana, "Tiled renderer", 0xFFFFFFFF);
+	DL_Text(30, 70, FONT_16_verdana, "Opaque text on background", 0x80FFE000, 0xFF000040);
+	DL_TextBlend(30, 100, FONT_12_verdana, "Small text with half alpha", 0x80FFFFFF);
+	char score[32];
+	snprintf(score, sizeof(score), "SCORE %06u", (unsigned)(frame * 125));
+	DL_TextBlend(560, 440, FONT_20_verdana, score, 0xFFFFFFFF);
+	DL_TextBlend(60, 360, font_v2, "AVATAR Today \xC3\xA9t\xC3\xA9 na\xC3\xAFve", 0xFFFFFFFF);
+	DL_Text(60, 400, font_v2, "To \xC3\x80 la carte", 0xFF000000, 0xFFE0E0E0);
+	DL_TextBlend(36, 440, FONT_64_verdana, "64", 0xA0FF8080);
+}
+
+typedef struct {
+	double		ms;
+	uint64_t	written;
+	uint64_t	read;
+} RESULT;
+
+static void prefill(void) {
+	BSP->G2D_FillFrame(0xFF405060);
+	DL_Invalidate();
+}
+
+static void render(uint8_t tiled, uint32_t frame, RESULT * r) {
+	prefill();
+	DL_SetTiled(tiled);
+	uint64_t w = Host_FrameStat.fb_bytes_written, rd = Host_FrameStat.fb_bytes_read;
+	uint64_t t = Host_GetNs();
+	DL_Begin();
+	scene(frame);
+	DL_End();
+	t = Host_GetNs() - t;
+	if ((r->ms == 0) || (t / 1e6 < r->ms)) r->ms = t / 1e6;
+	r->written += Host_FrameStat.fb_bytes_written - w;
+	r->read += Host_FrameStat.fb_bytes_read - rd;
+}
+
+int main(int argc, char ** argv) {
+	uint32_t frames = 20;
+	const char * out = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc)) frames = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-p") == 0) partial = 1;
+		else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) out = argv[++i];
+	}
+	if (frames == 0) frames = 1;
+
+	Host_Config.quiet = 1;
+	Host_Init();
+	make_font();
+
+	const uint8_t modes[] = { LCD_COLOR_MODE_ARGB8888, LCD_COLOR_MODE_RGB888 };
+	const uint16_t tiles[][2] = { { 64, 64 }, { 128, 32 }, { 32, 32 }, { 256, 16 } };
+	int errors = 0;
+
+	printf("%s scene, %u frames, values per frame\n\n", (partial) ? "partial" : "full", frames);
+	printf("mode     tile    | direct: KB wr  KB rd     ms | tiled: KB wr  KB rd     ms  overdraw  tiles loaded skipped | exact\n");
+	for (uint32_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+		uint8_t bpp = (modes[m] == LCD_COLOR_MODE_ARGB8888) ? 4 : 3;
+		uint32_t size = LCD_WIDTH * LCD_HEIGHT * bpp;
+		uint8_t * ref = malloc(size);
+		BSP->LCD_Init(modes[m], LCD_BUFFER_MODE_DOUBLE, 0xFF000000, NULL);
+		make_assets(bpp);
+
+		for (uint32_t t = 0; t < sizeof(tiles) / sizeof(tiles[0]); t++) {
+			if (TR_Init(modes[m], 0xFF000000, tiles[t][0], tiles[t][1]) != BSP_OK) continue;
+			RESULT direct = { 0 }, tiled = { 0 };
+			TR_STATS sum = { 0 };
+			uint32_t mismatch = 0;
+
+			for (uint32_t f = 0; f < frames; f++) {
+				render(0, f, &direct);
+				memcpy(ref, BSP->LCD_GetEditFrameAddr(), size);
+				render(1, f, &tiled);
+				const TR_STATS * s = TR_GetStats();
+				sum.fb_written += s->fb_written;
+				sum.fb_read += s->fb_read;
+				sum.pixels += s->pixels;
+				sum.area += s->area;
+				sum.tiles += s->tiles;
+				sum.loaded += s->loaded;
+				sum.skipped += s->skipped;
+				sum.fallbacks += s->fallbacks;
+				if (memcmp(ref, BSP->LCD_GetEditFrameAddr(), size) != 0) mismatch++;
+			}
+			errors += (mismatch != 0) + (sum.fallbacks != 0);
+
+			char tile[16];
+			snprintf(tile, sizeof(tile), "%ux%u", tiles[t][0], tiles[t][1]);
+			printf("%-8s %-7s | %13.0f %6.0f %6.2f | %12.0f %6.0f %6.2f %8.2f  %5u %6u %7u | %s\n",
+				(bpp == 4) ? "ARGB8888" : "RGB888", tile,
+				direct.written / 1024.0 / frames, direct.read / 1024.0 / frames, direct.ms,
+				sum.fb_written / 1024.0 / frames, sum.fb_read / 1024.0 / frames, tiled.ms,
+				(double)sum.pixels / sum.area, sum.tiles / frames, sum.loaded / frames, sum.skipped / frames,
+				(mismatch) ? "NO" : "yes");
+		}
+		free(ref);
+	}
+
+	if (out) {
+		BSP->LCD_FrameReady();
+		Host_SaveFrame(out);
+		printf("\nlast tiled frame saved to %s\n", out);
+	}
+	free(font_v2);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,325 @@
+/*****************************************************************
+ * MiniConsole V3 - Host benchmark
+ *
+ * Tile map drawn with scroll reuse (TileMap.h) versus full redraw
+ * of the same map every frame.
+ *
+ *   bench_tilemap [-f frames] [-a] [-c chunk] [-d dir] [-o frame.ppm]
+ *
+ * World of 1024 x 256 cells (16 x 16 pixels, 2 layers, animated
+ * water, empty sky chunks) is written as resource pack and streamed
+ * by 32 x 32 cell chunks (-c 8 / 16 / 64). Each camera path is drawn with scroll
+ * reuse and with TM_Refresh before every frame, with 24 blended
+ * sprites drawn over map and passed to TM_Invalidate. Report shows
+ * map draw time, tiles drawn, frame buffer bytes written / read per
+ * frame and chunk loads of both runs (stalls - chunks not
+ * prefetched by TM_Stream) and log records. Every reused frame is compared with
+ * full redraw of the same camera position. Frame is RGB888 (-a
+ * ARGB8888).
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "BSP_Host.h"
+#include "TileMap.h"
+#include "Log.h"
+#include "tm_enc.h"
+
+#define MAP_W			1024
+#define MAP_H			256
+#define TILE			16
+#define SET_COLS		16
+#define SET_ROWS		4
+#define SKY_ROWS		40			// Empty cells on top of map (background colour)
+#define SPRITES			24
+#define SPRITE_SIZE		24
+
+#define T_GRASS			1			// 1..8 opaque ground
+#define T_WATER			9			// 9..12 animated water
+#define T_TREE			17			// 17..32 decorations with alpha
+
+typedef struct {
+	char *		name;
+	uint8_t *	data;
+	size_t		size;
+} ENTRY;
+
+static ENTRY entries[512];
+static uint32_t entry_count;
+static uint16_t chunk = 32;
+
+typedef struct {
+	const char *	name;
+	int32_t			vx;			// Camera speed [pixels / frame]
+	int32_t			vy;
+} PATH;
+
+static const PATH paths[] = {
+	{ "static",		0, 0 },
+	{ "pan 1px",	1, 0 },
+	{ "pan 4px",	4, 0 },
+	{ "diag 3,2",	3, 2 },
+	{ "vert 6px",	0, 6 },
+	{ "fast 16px",	16, 3 },
+};
+#define PATH_NO		(sizeof(paths) / sizeof(paths[0]))
+
+static uint32_t rng;
+
+static uint32_t rnd(uint32_t n) {
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng % n;
+}
+
+static uint32_t tile_pixel(uint32_t t, int x, int y) {
+	if (t < T_WATER) return 0xFF000000 | (uint32_t)(40 + t * 10) << 16 | (uint32_t)(120 + ((x * 3 + y * 5 + t) % 7) * 8) << 8 | 30;
+	if (t < T_TREE) {
+		int wave = (x + (int)(t - T_WATER) * 4 + (y / 4) * 3) % 16;
+		return 0xFF000000 | (uint32_t)(20 + wave * 4) << 16 | (uint32_t)(60 + wave * 6) << 8 | 200;
+	}
+	int dx = 2 * x - TILE + 1, dy = 2 * y - TILE + 1, r = 6 + (int)(t % 4) * 2;
+	int d = dx * dx + dy * dy;
+	if (d >= r * r) return 0;
+	return ((d > (r - 3) * (r - 3)) ? 0x90u : 0xFFu) << 24 | (uint32_t)(t * 7) << 16 | (uint32_t)(100 + t * 4) << 8 | 40;
+}
+
+static void emit_entry(const char * name, const void * data, size_t size, void * ctx) {
+	ENTRY * e = &entries[entry_count++];
+	e->name = strdup(name);
+	e->data = malloc(size);
+	memcpy(e->data, data, size);
+	e->size = size;
+}
+
+static int cmp_hash(const void * a, const void * b) {
+	uint32_t x = RP_Hash(((const ENTRY *)a)->name), y = RP_Hash(((const ENTRY *)b)->name);
+	return (x < y) ? -1 : (x > y);
+}
+
+// Uncompressed pack in format of Inc/ResPack.h (entries sorted by hash, names in same order)
+static void write_pack(const char * path) {
+	qsort(entries, entry_count, sizeof(ENTRY), cmp_hash);
+	RP_HEADER hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = RP_MAGIC;
+	hdr.version = RP_VERSION;
+	hdr.count = (uint16_t)entry_count;
+	hdr.toc_offset = sizeof(RP_HEADER);
+	hdr.names_offset = hdr.toc_offset + entry_count * sizeof(RP_ENTRY);
+	for (uint32_t i = 0; i < entry_count; i++) hdr.names_size += (uint32_t)strlen(entries[i].name) + 1;
+	hdr.data_offset = (hdr.names_offset + hdr.names_size + RP_ALIGN - 1) & ~(RP_ALIGN - 1);
+
+	FILE * f = fopen(path, "wb");
+	if (f == NULL) { fprintf(stderr, "bench_tilemap: can not write %s\n", path); exit(1); }
+	fwrite(&hdr, sizeof(hdr), 1, f);
+	uint32_t pos = hdr.data_offset, name = 0;
+	for (uint32_t i = 0; i < entry_count; i++) {
+		RP_ENTRY e;
+		memset(&e, 0, sizeof(e));
+		e.hash = RP_Hash(entries[i].name);
+		e.offset = pos;
+		e.size = (uint32_t)entries[i].size;
+		e.raw_size = e.size;
+		e.name = name;
+		e.codec = RP_CODEC_NONE;
+		fwrite(&e, sizeof(e), 1, f);
+		name += (uint32_t)strlen(entries[i].name) + 1;
+		pos = (pos + e.size + RP_ALIGN - 1) & ~(RP_ALIGN - 1);
+	}
+	for (uint32_t i = 0; i < entry_count; i++) fwrite(entries[i].name, 1, strlen(entries[i].name) + 1, f);
+	for (uint32_t i = 0; i < entry_count; i++) {
+		fseek(f, 0, SEEK_END);
+		while ((uint32_t)ftell(f) % RP_ALIGN) fputc(0, f);
+		fwrite(entries[i].data, 1, entries[i].size, f);
+		free(entries[i].data);
+		free(entries[i].name);
+	}
+	fclose(f);
+}
+
+static void make_world(const char * dir) {
+	static uint16_t ground[MAP_W * MAP_H], deco[MAP_W * MAP_H];
+	uint32_t sw = SET_COLS * TILE, sh = SET_ROWS * TILE;
+	size_t set_size = 4 + (size_t)sw * sh * 4;
+	uint8_t * set = malloc(set_size);
+	uint16_t dim[2] = { (uint16_t)sw, (uint16_t)sh };
+	memcpy(set, dim, 4);
+	uint32_t * px = (uint32_t *)(set + 4);
+	for (uint32_t t = 1; t <= SET_COLS * SET_ROWS; t++) {
+		for (int y = 0; y < TILE; y++) {
+			for (int x = 0; x < TILE; x++) px[(((t - 1) / SET_COLS) * TILE + y) * sw + ((t - 1) % SET_COLS) * TILE + x] = tile_pixel(t, x, y);
+		}
+	}
+
+	rng = 0x2545F491u;
+	for (uint32_t y = 0; y < MAP_H; y++) {
+		for (uint32_t x = 0; x < MAP_W; x++) {
+			uint32_t i = y * MAP_W + x;
+			ground[i] = deco[i] = TM_EMPTY;
+			if (y < SKY_ROWS) continue;
+			uint32_t lake = ((x / 24) * 7 + (y / 16) * 13) % 9;
+			ground[i] = (lake == 0) ? T_WATER : (uint16_t)(T_GRASS + rnd(8));
+			if ((lake != 0) && (rnd(12) == 0)) deco[i] = (uint16_t)(T_TREE + rnd(16));
+		}
+	}
+
+	TM_HEADER hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TM_MAGIC;
+	hdr.version = TM_VERSION;
+	hdr.layers = 2;
+	hdr.chunk = chunk;
+	hdr.width = MAP_W;
+	hdr.height = MAP_H;
+	hdr.tile_w = TILE;
+	hdr.tile_h = TILE;
+	hdr.bgcolor = 0xFF6080C0;
+	hdr.anims = 1;
+	TM_ANIM anim = { T_WATER, 4, 8 };
+	const uint16_t * layers[2] = { ground, deco };
+	uint32_t chunks = tm_encode("world", &hdr, &anim, layers, set, set_size, emit_entry, NULL);
+	free(set);
+
+	char path[512];
+	snprintf(path, sizeof(path), "%s/world.pak", dir);
+	write_pack(path);
+	printf("map %ux%u cells of %ux%u px, 2 layers, %u of %u chunks in pack (%u bytes each)\n", MAP_W, MAP_H, TILE, TILE,
+		chunks, (MAP_W / chunk) * (MAP_H / chunk), chunk * chunk * 2 * 2);
+}
+
+typedef struct {
+	double		ms;
+	uint64_t	tiles;
+	uint64_t	pixels;
+	uint64_t	written;
+	uint64_t	read;
+	uint32_t	full;
+} RESULT;
+
+// Camera follows path with bounce at map edges
+static void camera(const PATH * p, uint32_t f, int32_t * x, int32_t * y) {
+	int32_t wx = MAP_W * TILE - LCD_WIDTH, wy = MAP_H * TILE - LCD_HEIGHT;
+	int32_t cx = 200 + p->vx * (int32_t)f, cy = SKY_ROWS * TILE - LCD_HEIGHT / 4 + p->vy * (int32_t)f;
+	cx %= 2 * wx;
+	cy %= 2 * wy;
+	*x = (cx > wx) ? 2 * wx - cx : cx;
+	*y = (cy > wy) ? 2 * wy - cy : cy;
+}
+
+static void sprites(uint32_t f) {
+	rng = 0x9E3779B9u;
+	for (int i = 0; i < SPRITES; i++) {
+		int16_t x = (int16_t)((rnd(LCD_WIDTH) + f * (1 + i % 3)) % (LCD_WIDTH + SPRITE_SIZE)) - SPRITE_SIZE / 2;
+		int16_t y = (int16_t)((rnd(LCD_HEIGHT) + f * (i % 2)) % LCD_HEIGHT) - SPRITE_SIZE / 2;
+		BSP->G2D_DrawFillRectBlend(x, y, SPRITE_SIZE, SPRITE_SIZE, 0xA0FF4020 + (uint32_t)i * 0x0800);
+		TM_Invalidate(x, y, SPRITE_SIZE, SPRITE_SIZE);
+	}
+}
+
+static uint32_t run(const PATH * p, uint8_t reuse, uint32_t frames, RESULT * r, uint8_t * ref, uint32_t size) {
+	uint32_t mismatch = 0;
+	memset(r, 0, sizeof(RESULT));
+	TM_Refresh();
+	for (uint32_t f = 0; f < frames; f++) {
+		int32_t x, y;
+		camera(p, f, &x, &y);
+		TM_Tick();
+		if (!reuse) TM_Refresh();
+
+		uint64_t w = Host_FrameStat.fb_bytes_written, rd = Host_FrameStat.fb_bytes_read;
+		uint64_t t = Host_GetNs();
+		TM_Draw(x, y);
+		r->ms += (Host_GetNs() - t) / 1e6;
+		r->written += Host_FrameStat.fb_bytes_written - w;
+		r->read += Host_FrameStat.fb_bytes_read - rd;
+		const TM_STATS * st = TM_GetStats();
+		r->tiles += st->tiles + st->fills;
+		r->pixels += st->pixels;
+		r->full += st->full;
+
+		if ((reuse) && (ref)) {
+			memcpy(ref, BSP->LCD_GetEditFrameAddr(), size);
+			TM_Refresh();
+			TM_Draw(x, y);
+			if (memcmp(ref, BSP->LCD_GetEditFrameAddr(), size) != 0) mismatch++;
+		}
+
+		sprites(f);
+		BSP->LCD_FrameReady();
+		TM_Stream(2);
+	}
+	return mismatch;
+}
+
+int main(int argc, char ** argv) {
+	uint32_t frames = 240;
+	uint8_t mode = LCD_COLOR_MODE_RGB888;
+	const char * out = NULL;
+	char tmp[] = "/tmp/mc_tilemap_XXXXXX";
+	const char * dir = NULL;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "f:ac:d:o:")) != -1) {
+		switch (opt) {
+		case 'f': frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'a': mode = LCD_COLOR_MODE_ARGB8888; break;
+		case 'c': chunk = (uint16_t)strtoul(optarg, NULL, 0); break;
+		case 'd': dir = optarg; break;
+		case 'o': out = optarg; break;
+		default:
+			fprintf(stderr, "usage: bench_tilemap [-f frames] [-a] [-c chunk] [-d dir] [-o frame.ppm]\n");
+			return 1;
+		}
+	}
+	if (frames == 0) frames = 1;
+	if ((chunk != 8) && (chunk != 16) && (chunk != 64)) chunk = 32;
+	if (dir == NULL) dir = mkdtemp(tmp);
+	else mkdir(dir, 0755);
+	if (dir == NULL) { fprintf(stderr, "bench_tilemap: can not create directory\n"); return 1; }
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	make_world(dir);
+	Host_Config.rootdir = dir;
+	Host_Config.quiet = 1;
+	Host_Init();
+	void * mem = malloc(16 * 1024 * 1024);
+	BSP->Res_Init(mem, 16 * 1024 * 1024);
+	BSP->LCD_Init(mode, LCD_BUFFER_MODE_DOUBLE, 0xFF000000, NULL);
+
+	static RP_PACK pack;
+	if (RP_Open(&pack, "0:/world.pak") != BSP_OK) { fprintf(stderr, "bench_tilemap: can not open pack\n"); return 1; }
+	if (TM_Open(&pack, "world", mode) != BSP_OK) { fprintf(stderr, "bench_tilemap: can not open map\n"); return 1; }
+	printf("frame %s, %u frames per path, %u sprites\n\n", (mode == LCD_COLOR_MODE_RGB888) ? "RGB888" : "ARGB8888", frames, SPRITES);
+
+	uint32_t size = LCD_WIDTH * LCD_HEIGHT * Host_LCD_GetBpp();
+	uint8_t * ref = malloc(size);
+	uint32_t mismatch = 0;
+
+	printf("%-10s | %8s %7s %8s %8s | %8s %7s %8s %8s %5s | %5s %6s %6s %5s\n", "path", "full ms", "tiles", "KB wr", "KB rd",
+		"reuse ms", "tiles", "KB wr", "KB rd", "full", "speed", "loads", "stalls", "log");
+	for (uint8_t i = 0; i < PATH_NO; i++) {
+		RESULT full, reuse;
+		const TM_STATS * st = TM_GetStats();
+		uint32_t loads = st->loads, stalls = st->stalls, logs = LOG_GetStats()->records + LOG_GetStats()->dropped;
+		run(&paths[i], 0, frames, &full, NULL, size);
+		mismatch += run(&paths[i], 1, frames, &reuse, ref, size);
+		printf("%-10s | %8.3f %7llu %8.1f %8.1f | %8.3f %7llu %8.1f %8.1f %5u | %4.1fx %6u %6u %5u\n", paths[i].name,
+			full.ms / frames, (unsigned long long)(full.tiles / frames), full.written / 1024.0 / frames, full.read / 1024.0 / frames,
+			reuse.ms / frames, (unsigned long long)(reuse.tiles / frames), reuse.written / 1024.0 / frames, reuse.read / 1024.0 / frames, reuse.full,
+			full.ms / reuse.ms, st->loads - loads, st->stalls - stalls, LOG_GetStats()->records + LOG_GetStats()->dropped - logs);
+	}
+	printf("\nchunks resident %u of %u slots, reused frames %s full redraw\n", TM_GetStats()->resident, TM_MAX_CHUNKS,
+		(mismatch) ? "DIFFER from" : "bit-exact with");
+
+	if (out) Host_SaveFrame(out);
+	TM_Close();
+	RP_Close(&pack);
+	free(ref);
+	free(mem);
+	return (mismatch) ? 1 : 0;
+}
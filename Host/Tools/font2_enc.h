@@ -0,0 +1,209 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Builder of v2 (Unicode) fonts (Inc/Font.h). Glyphs are added as
+ * A8 masks (quantised to 2-bit alpha) or as ready pixel streams of
+ * v1 fonts, which keeps imported glyphs bit-exact.
+ *******************************************************************/
+
+#ifndef FONT2_ENC_H_
+#define FONT2_ENC_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Font.h"
+
+typedef struct {
+	uint32_t	cp;
+	uint8_t *	data;				// Advance width followed by pixel stream
+	uint32_t	size;
+} F2_GLYPH;
+
+typedef struct {
+	uint32_t	left;				// Codepoints
+	uint32_t	right;
+	int8_t		adj;
+} F2_KERN;
+
+typedef struct {
+	uint8_t		height;
+	uint8_t		space;
+	F2_GLYPH *	glyph;
+	uint32_t	glyphs;
+	F2_KERN *	kern;
+	uint32_t	kerns;
+} F2_FONT;
+
+static inline void f2_init(F2_FONT * f, uint8_t height, uint8_t space) {
+	memset(f, 0, sizeof(*f));
+	f->height = height;
+	f->space = space;
+}
+
+static inline void f2_free(F2_FONT * f) {
+	for (uint32_t i = 0; i < f->glyphs; i++) free(f->glyph[i].data);
+	free(f->glyph);
+	free(f->kern);
+	memset(f, 0, sizeof(*f));
+}
+
+static inline F2_GLYPH * f2_find(F2_FONT * f, uint32_t cp) {
+	for (uint32_t i = 0; i < f->glyphs; i++) if (f->glyph[i].cp == cp) return &f->glyph[i];
+	return NULL;
+}
+
+// Adds glyph from encoded data (advance width + pixel stream). Returns 0 if codepoint exists or is outside BMP.
+static inline int f2_add_raw(F2_FONT * f, uint32_t cp, const uint8_t * data, uint32_t size) {
+	if ((cp > 0xFFFF) || (cp == ' ') || (f2_find(f, cp)) || (f->glyphs >= 0xFFFF)) return 0;
+	f->glyph = realloc(f->glyph, (f->glyphs + 1) * sizeof(F2_GLYPH));
+	F2_GLYPH * g = &f->glyph[f->glyphs++];
+	g->cp = cp;
+	g->size = size;
+	g->data = malloc(size);
+	memcpy(g->data, data, size);
+	return 1;
+}
+
+// Encodes A8 mask (width x height of font). Runs of transparent / opaque pixels
+// become run bytes, other pixels go in groups of four (group must start with 1 or 2 level).
+static inline int f2_add_mask(F2_FONT * f, uint32_t cp, uint8_t width, const uint8_t * mask) {
+	uint32_t total = (uint32_t)width * f->height;
+	uint8_t * buf = malloc(1 + total);
+	uint32_t n = 0, pos = 0;
+
+	buf[n++] = width;
+	while (pos < total) {
+		uint8_t level = (mask[pos] + 42) / 85;
+		if ((level == 0) || (level == 3)) {
+			uint32_t run = 0;
+			while ((pos + run < total) && (run < 63) && ((mask[pos + run] + 42) / 85 == level)) run++;
+			buf[n++] = (uint8_t)((level << 6) | run);
+			pos += run;
+		} else {
+			uint8_t b = 0;
+			for (uint32_t k = 0; k < 4; k++) {
+				uint8_t l = (pos + k < total) ? (mask[pos + k] + 42) / 85 : 0;
+				b |= (uint8_t)(l << (6 - 2 * k));
+			}
+			buf[n++] = b;
+			pos += 4;
+		}
+	}
+	int r = f2_add_raw(f, cp, buf, n);
+	free(buf);
+	return r;
+}
+
+// Imports glyphs '!'..'~' of v1 font unchanged
+static inline void f2_import_v1(F2_FONT * f, const uint8_t * font) {
+	for (uint32_t c = FONT_FIRST_CHAR; c <= FONT_LAST_CHAR; c++) {
+		uint32_t idx = c - FONT_FIRST_CHAR;
+		uint16_t start = (uint16_t)(font[2 + 2 * idx] | (font[3 + 2 * idx] << 8));
+		uint16_t end = (uint16_t)(font[4 + 2 * idx] | (font[5 + 2 * idx] << 8));
+		f2_add_raw(f, c, font + start, end - start);
+	}
+}
+
+static inline void f2_add_kern(F2_FONT * f, uint32_t left, uint32_t right, int8_t adj) {
+	for (uint32_t i = 0; i < f->kerns; i++) {
+		if ((f->kern[i].left == left) && (f->kern[i].right == right)) {
+			f->kern[i].adj = adj;
+			return;
+		}
+	}
+	f->kern = realloc(f->kern, (f->kerns + 1) * sizeof(F2_KERN));
+	f->kern[f->kerns].left = left;
+	f->kern[f->kerns].right = right;
+	f->kern[f->kerns].adj = adj;
+	f->kerns++;
+}
+
+static inline int f2_cmp_glyph(const void * a, const void * b) {
+	uint32_t x = ((const F2_GLYPH *)a)->cp, y = ((const F2_GLYPH *)b)->cp;
+	return (x > y) - (x < y);
+}
+
+static inline int f2_cmp_key(const void * a, const void * b) {
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+static inline void f2_put16(uint8_t * p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void f2_put32(uint8_t * p, uint32_t v) { f2_put16(p, v); f2_put16(p + 2, v >> 16); }
+
+static inline int32_t f2_index(const F2_FONT * f, uint32_t cp) {
+	for (uint32_t i = 0; i < f->glyphs; i++) if (f->glyph[i].cp == cp) return (int32_t)i;
+	return -1;
+}
+
+// Builds font image (malloc). Pairs with glyphs missing in font are dropped.
+static inline uint8_t * f2_build(F2_FONT * f, size_t * size, uint32_t * pages_out) {
+	uint16_t dir[256];
+	uint32_t pages = 0;
+
+	qsort(f->glyph, f->glyphs, sizeof(F2_GLYPH), f2_cmp_glyph);
+	memset(dir, 0, sizeof(dir));
+	for (uint32_t i = 0; i < f->glyphs; i++) {
+		uint32_t p = f->glyph[i].cp >> 8;
+		if (dir[p] == 0) dir[p] = (uint16_t)++pages;
+	}
+
+	// Kerning keys with adjustments in upper bits while sorting
+	uint64_t * keys = malloc((f->kerns + 1) * sizeof(uint64_t));
+	uint32_t kerns = 0;
+	for (uint32_t i = 0; i < f->kerns; i++) {
+		int32_t l = f2_index(f, f->kern[i].left), r = f2_index(f, f->kern[i].right);
+		if ((l < 0) || (r < 0) || (f->kern[i].adj == 0)) continue;
+		keys[kerns++] = ((uint64_t)(uint8_t)f->kern[i].adj << 32) | ((uint32_t)l << 16) | (uint32_t)r;
+	}
+	uint32_t * sorted = malloc((kerns + 1) * sizeof(uint32_t));
+	for (uint32_t i = 0; i < kerns; i++) sorted[i] = (uint32_t)keys[i];
+	qsort(sorted, kerns, sizeof(uint32_t), f2_cmp_key);
+
+	uint32_t off_pages = FONT_V2_HEADER + 512;
+	uint32_t off_glyphs = off_pages + pages * 512;
+	uint32_t off_kern = off_glyphs + (f->glyphs + 1) * 4;
+	uint32_t off_data = off_kern + kerns * 5;
+	uint32_t data_size = 0;
+	for (uint32_t i = 0; i < f->glyphs; i++) data_size += f->glyph[i].size;
+
+	size_t n = off_data + data_size;
+	uint8_t * out = calloc(1, n);
+	out[0] = 0;
+	out[1] = FONT_V2_VERSION;
+	out[2] = f->height;
+	out[3] = f->space;
+	f2_put16(out + 4, f->glyphs);
+	f2_put16(out + 6, kerns);
+	f2_put32(out + 8, off_pages);
+	f2_put32(out + 12, off_glyphs);
+	f2_put32(out + 16, off_kern);
+	f2_put32(out + 20, (uint32_t)n);
+	for (uint32_t p = 0; p < 256; p++) f2_put16(out + FONT_V2_HEADER + 2 * p, dir[p]);
+
+	uint32_t pos = off_data;
+	for (uint32_t i = 0; i < f->glyphs; i++) {
+		uint32_t cp = f->glyph[i].cp;
+		f2_put16(out + off_pages + (dir[cp >> 8] - 1) * 512 + 2 * (cp & 0xFF), i + 1);
+		f2_put32(out + off_glyphs + 4 * i, pos);
+		memcpy(out + pos, f->glyph[i].data, f->glyph[i].size);
+		pos += f->glyph[i].size;
+	}
+	f2_put32(out + off_glyphs + 4 * f->glyphs, pos);
+
+	for (uint32_t i = 0; i < kerns; i++) {
+		f2_put32(out + off_kern + 4 * i, sorted[i]);
+		for (uint32_t k = 0; k < kerns; k++) {
+			if ((uint32_t)keys[k] == sorted[i]) out[off_kern + 4 * kerns + i] = (uint8_t)(keys[k] >> 32);
+		}
+	}
+
+	free(keys);
+	free(sorted);
+	*size = n;
+	if (pages_out) *pages_out = pages;
+	return out;
+}
+
+#endif /* FONT2_ENC_H_ */
@@ -0,0 +1,50 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Fonts from Src/fonts.c by name (fontexport, fontgen).
+ *******************************************************************/
+
+#ifndef FONT_LIST_H_
+#define FONT_LIST_H_
+
+#include "../../Src/fonts.c"
+
+typedef struct {
+	const char *	name;
+	const uint8_t *	data;
+	size_t			size;
+} FONT_ENTRY;
+
+static const FONT_ENTRY fonts[] = {
+	{ "FONT_12_verdana", FONT_12_verdana, sizeof(FONT_12_verdana) },
+	{ "FONT_14_verdana", FONT_14_verdana, sizeof(FONT_14_verdana) },
+	{ "FONT_16_verdana", FONT_16_verdana, sizeof(FONT_16_verdana) },
+	{ "FONT_18_verdana", FONT_18_verdana, sizeof(FONT_18_verdana) },
+	{ "FONT_20_verdana", FONT_20_verdana, sizeof(FONT_20_verdana) },
+	{ "FONT_22_verdana", FONT_22_verdana, sizeof(FONT_22_verdana) },
+	{ "FONT_24_verdana", FONT_24_verdana, sizeof(FONT_24_verdana) },
+	{ "FONT_26_verdana", FONT_26_verdana, sizeof(FONT_26_verdana) },
+	{ "FONT_28_verdana", FONT_28_verdana, sizeof(FONT_28_verdana) },
+	{ "FONT_36_verdana", FONT_36_verdana, sizeof(FONT_36_verdana) },
+	{ "FONT_64_verdana", FONT_64_verdana, sizeof(FONT_64_verdana) },
+	{ "FONT_12_yikes", FONT_12_yikes, sizeof(FONT_12_yikes) },
+	{ "FONT_14_yikes", FONT_14_yikes, sizeof(FONT_14_yikes) },
+	{ "FONT_16_yikes", FONT_16_yikes, sizeof(FONT_16_yikes) },
+	{ "FONT_18_yikes", FONT_18_yikes, sizeof(FONT_18_yikes) },
+	{ "FONT_20_yikes", FONT_20_yikes, sizeof(FONT_20_yikes) },
+	{ "FONT_22_yikes", FONT_22_yikes, sizeof(FONT_22_yikes) },
+	{ "FONT_24_yikes", FONT_24_yikes, sizeof(FONT_24_yikes) },
+	{ "FONT_26_yikes", FONT_26_yikes, sizeof(FONT_26_yikes) },
+	{ "FONT_28_yikes", FONT_28_yikes, sizeof(FONT_28_yikes) },
+	{ "FONT_36_yikes", FONT_36_yikes, sizeof(FONT_36_yikes) },
+	{ "FONT_64_yikes", FONT_64_yikes, sizeof(FONT_64_yikes) },
+};
+
+#define FONT_COUNT	(sizeof(fonts) / sizeof(fonts[0]))
+
+static inline const FONT_ENTRY * font_by_name(const char * name) {
+	for (size_t i = 0; i < FONT_COUNT; i++) if (strcmp(fonts[i].name, name) == 0) return &fonts[i];
+	return NULL;
+}
+
+#endif /* FONT_LIST_H_ */
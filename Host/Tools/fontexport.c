@@ -0,0 +1,70 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Exports fonts from Src/fonts.c to files for FontReg_AddFile, so
+ * fonts do not have to be linked into flash.
+ *
+ *   fontexport [-z] [-o dir] [FONT_name ...]
+ *
+ * -z compresses files into RC_Load container. Without names all
+ * fonts are exported. Prints size table.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BSP_Driver.h"
+#include "rc_enc.h"
+#include "font_list.h"
+
+int main(int argc, char ** argv) {
+	const char * dir = ".";
+	uint8_t compress = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "zo:")) != -1) {
+		switch (opt) {
+		case 'z': compress = 1; break;
+		case 'o': dir = optarg; break;
+		default:
+			fprintf(stderr, "usage: fontexport [-z] [-o dir] [FONT_name ...]\n");
+			return 1;
+		}
+	}
+
+	size_t total_raw = 0, total_file = 0;
+	int written = 0;
+	printf("%-18s %8s %8s %6s %5s\n", "font", "raw", "file", "ratio", "px");
+	for (size_t i = 0; i < FONT_COUNT; i++) {
+		if (optind < argc) {
+			int found = 0;
+			for (int a = optind; a < argc; a++) if (strcmp(argv[a], fonts[i].name) == 0) found = 1;
+			if (!found) continue;
+		}
+
+		const uint8_t * out = fonts[i].data;
+		size_t size = fonts[i].size;
+		uint8_t * buf = NULL;
+		if (compress) {
+			buf = malloc(rc_bound(size));
+			size = rc_compress(fonts[i].data, size, buf);
+			out = buf;
+		}
+
+		char path[512];
+		snprintf(path, sizeof(path), "%s/%s.fnt", dir, fonts[i].name);
+		FILE * f = fopen(path, "wb");
+		if ((f == NULL) || (fwrite(out, 1, size, f) != size)) { fprintf(stderr, "fontexport: can not write %s\n", path); return 1; }
+		fclose(f);
+		free(buf);
+
+		printf("%-18s %8zu %8zu %5.1f%% %5u\n", fonts[i].name, fonts[i].size, size, 100.0 * (double)size / (double)fonts[i].size, fonts[i].data[0]);
+		total_raw += fonts[i].size;
+		total_file += size;
+		written++;
+	}
+	if (written == 0) { fprintf(stderr, "fontexport: no matching fonts\n"); return 1; }
+	printf("%-18s %8zu %8zu %5.1f%%\n", "total", total_raw, total_file, 100.0 * (double)total_file / (double)total_raw);
+	return 0;
+}
@@ -0,0 +1,232 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Generates v2 (Unicode) fonts (Inc/Font.h).
+ *
+ *   fontgen [-f FONT_name] [-b file.bdf] [-k kerning.txt]
+ *           [-r first-last] [-z] [-c name] -o out
+ *
+ * -f imports ASCII glyphs of font from Src/fonts.c (bit-exact),
+ * -b adds glyphs of BDF bitmap font (may be repeated, first font
+ *    providing codepoint wins), -r limits codepoints taken from BDF
+ *    (hex, e.g. -r 00A0-017F, may be repeated),
+ * -k reads kerning pairs, one per line: "left right adjustment",
+ *    where left / right are characters (UTF-8) or U+XXXX,
+ * -z compresses output into RC_Load container (for FontReg_AddFile),
+ * -c writes C array with given name instead of binary file.
+ *
+ * Line height comes from -f font, otherwise from first BDF
+ * (FONT_ASCENT + FONT_DESCENT). BDF glyphs are placed on ascent
+ * baseline and centred vertically in line of other height.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BSP_Driver.h"
+#include "rc_enc.h"
+#include "font2_enc.h"
+#include "font_list.h"
+
+#define MAX_RANGES	32
+
+static uint32_t range_lo[MAX_RANGES], range_hi[MAX_RANGES];
+static uint32_t ranges = 0;
+
+static int in_range(uint32_t cp) {
+	if (ranges == 0) return 1;
+	for (uint32_t i = 0; i < ranges; i++) if ((cp >= range_lo[i]) && (cp <= range_hi[i])) return 1;
+	return 0;
+}
+
+static int hexval(char c) {
+	if ((c >= '0') && (c <= '9')) return c - '0';
+	if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+	if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+	return -1;
+}
+
+// Reads BDF font. Glyph masks are placed at baseline (ascent) and shifted by row_off.
+static int load_bdf(F2_FONT * f, const char * path, int * height_io) {
+	FILE * in = fopen(path, "r");
+	char line[1024];
+	int ascent = -1, descent = -1;
+	int32_t cp = -1;
+	int dwidth = 0, bw = 0, bh = 0, bx = 0, by = 0;
+	int row = -1, row_off = 0;
+	int added = 0;
+	uint8_t * mask = NULL;
+
+	if (in == NULL) { fprintf(stderr, "fontgen: can not read %s\n", path); return -1; }
+
+	while (fgets(line, sizeof(line), in)) {
+		if (sscanf(line, "FONT_ASCENT %d", &ascent) == 1) continue;
+		if (sscanf(line, "FONT_DESCENT %d", &descent) == 1) continue;
+		if (strncmp(line, "STARTCHAR", 9) == 0) {
+			cp = -1; dwidth = 0; bw = bh = bx = by = 0; row = -1;
+			continue;
+		}
+		if (sscanf(line, "ENCODING %d", &cp) == 1) continue;
+		if (sscanf(line, "DWIDTH %d", &dwidth) == 1) continue;
+		if (sscanf(line, "BBX %d %d %d %d", &bw, &bh, &bx, &by) == 4) continue;
+		if (strncmp(line, "BITMAP", 6) == 0) {
+			if ((ascent < 0) || (descent < 0)) { fprintf(stderr, "fontgen: %s: missing FONT_ASCENT / FONT_DESCENT\n", path); fclose(in); return -1; }
+			if (*height_io == 0) {
+				// First BDF sets line height
+				if (ascent + descent > 255) { fprintf(stderr, "fontgen: %s: font too high\n", path); fclose(in); return -1; }
+				*height_io = ascent + descent;
+				f->height = (uint8_t)*height_io;
+			}
+			row_off = (*height_io - (ascent + descent)) / 2;
+			if (dwidth < 1) dwidth = bx + bw;
+			if (dwidth > 255) dwidth = 255;
+			mask = calloc((size_t)dwidth * *height_io + 1, 1);
+			row = 0;
+			continue;
+		}
+		if (strncmp(line, "ENDCHAR", 7) == 0) {
+			if ((mask) && (cp > ' ') && (in_range((uint32_t)cp))) added += f2_add_mask(f, (uint32_t)cp, (uint8_t)dwidth, mask);
+			free(mask);
+			mask = NULL;
+			row = -1;
+			continue;
+		}
+		if ((row >= 0) && (mask)) {
+			// Row of bitmap, msb first
+			int y = row_off + ascent - (by + bh) + row;
+			for (int c = 0; (c < bw) && (hexval(line[c / 4]) >= 0); c++) {
+				int x = bx + c;
+				if ((hexval(line[c / 4]) >> (3 - (c & 3))) & 1) {
+					if ((x >= 0) && (x < dwidth) && (y >= 0) && (y < *height_io)) mask[y * dwidth + x] = 0xFF;
+				}
+			}
+			row++;
+		}
+	}
+	free(mask);
+	fclose(in);
+	return added;
+}
+
+// Single character (UTF-8) or U+XXXX
+static uint32_t parse_cp(const char * s) {
+	if ((s[0] == 'U') && (s[1] == '+') && (s[2])) return (uint32_t)strtoul(s + 2, NULL, 16);
+	const char * p = s;
+	return Font_UTF8Next(&p);
+}
+
+static int load_kerning(F2_FONT * f, const char * path) {
+	FILE * in = fopen(path, "r");
+	char line[256], l[64], r[64];
+	int adj, n = 0;
+
+	if (in == NULL) { fprintf(stderr, "fontgen: can not read %s\n", path); return -1; }
+	while (fgets(line, sizeof(line), in)) {
+		if ((line[0] == '#') || (sscanf(line, "%63s %63s %d", l, r, &adj) != 3)) continue;
+		if ((adj < -128) || (adj > 127)) continue;
+		f2_add_kern(f, parse_cp(l), parse_cp(r), (int8_t)adj);
+		n++;
+	}
+	fclose(in);
+	return n;
+}
+
+static int write_c(const char * path, const char * name, const uint8_t * data, size_t n) {
+	FILE * out = fopen(path, "w");
+	if (out == NULL) return 0;
+	fprintf(out, "// Generated by fontgen - v2 font, %zu bytes\n\n#include <stdint.h>\n\n", n);
+	fprintf(out, "const uint8_t %s[%zu] __attribute__((aligned(4))) = {", name, n);
+	for (size_t i = 0; i < n; i++) fprintf(out, "%s0x%02X,", (i % 16) ? " " : "\n\t", data[i]);
+	fprintf(out, "\n};\n");
+	fclose(out);
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	const char * out_path = NULL;
+	const char * base = NULL;
+	const char * kern_path = NULL;
+	const char * cname = NULL;
+	const char * bdf[16];
+	uint32_t bdfs = 0;
+	uint8_t compress = 0;
+	int height = 0, space = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "o:f:b:k:r:zc:")) != -1) {
+		switch (opt) {
+		case 'o': out_path = optarg; break;
+		case 'f': base = optarg; break;
+		case 'b': if (bdfs < 16) bdf[bdfs++] = optarg; break;
+		case 'k': kern_path = optarg; break;
+		case 'z': compress = 1; break;
+		case 'c': cname = optarg; break;
+		case 'r':
+			if ((ranges < MAX_RANGES) && (sscanf(optarg, "%x-%x", &range_lo[ranges], &range_hi[ranges]) == 2)) ranges++;
+			break;
+		default:
+			out_path = NULL;
+			optind = argc;
+			break;
+		}
+	}
+	if ((out_path == NULL) || ((base == NULL) && (bdfs == 0))) {
+		fprintf(stderr, "usage: fontgen [-f FONT_name] [-b file.bdf] [-k kerning.txt] [-r first-last] [-z] [-c name] -o out\n");
+		return 1;
+	}
+
+	F2_FONT f;
+	f2_init(&f, 0, 0);
+
+	if (base) {
+		const FONT_ENTRY * e = font_by_name(base);
+		if (e == NULL) { fprintf(stderr, "fontgen: unknown font %s\n", base); return 1; }
+		height = e->data[0];
+		space = e->data[1];
+		f.height = (uint8_t)height;
+		f2_import_v1(&f, e->data);
+	}
+	for (uint32_t i = 0; i < bdfs; i++) {
+		int n = load_bdf(&f, bdf[i], &height);
+		if (n < 0) return 1;
+		printf("%s: %d glyphs\n", bdf[i], n);
+	}
+	// Space advance of BDF only fonts - width of digit zero or half of height
+	if (space == 0) {
+		F2_GLYPH * g = f2_find(&f, '0');
+		space = (g) ? g->data[0] : (height + 1) / 2;
+	}
+	f.space = (uint8_t)space;
+	if (kern_path) {
+		int n = load_kerning(&f, kern_path);
+		if (n < 0) return 1;
+	}
+
+	size_t size;
+	uint32_t pages;
+	uint8_t * font = f2_build(&f, &size, &pages);
+	uint8_t * out = font;
+	size_t out_size = size;
+	if (compress) {
+		out = malloc(rc_bound(size));
+		out_size = rc_compress(font, size, out);
+	}
+
+	if (cname) {
+		if (!write_c(out_path, cname, out, out_size)) { fprintf(stderr, "fontgen: can not write %s\n", out_path); return 1; }
+	} else {
+		FILE * fo = fopen(out_path, "wb");
+		if ((fo == NULL) || (fwrite(out, 1, out_size, fo) != out_size)) { fprintf(stderr, "fontgen: can not write %s\n", out_path); return 1; }
+		fclose(fo);
+	}
+
+	printf("%s: height %u, %u glyphs, %u pages, %u kerning pairs, %zu bytes", out_path, f.height, f.glyphs, pages, font[6] | (font[7] << 8), size);
+	if (compress) printf(" (%zu compressed)", out_size);
+	printf("\n");
+
+	if (out != font) free(out);
+	free(font);
+	f2_free(&f);
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Converts PAM (P7, RGB_ALPHA or RGB) or PPM (P6) image to image
+ * file for SPR_AtlasLoad ([u16 w][u16 h][ARGB8888 pixels]).
+ *
+ *   imgconv [-k rrggbb] [-z] [-c name] input output
+ *
+ * -k makes pixels of given colour transparent (colour key of images
+ * without alpha), -z compresses file into RC_Load container, -c
+ * writes C array of given name instead of binary file.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "rc_enc.h"
+
+// Next header token (skips whitespace and comments)
+static int token(FILE * f, char * out, size_t size) {
+	int c = fgetc(f);
+	size_t n = 0;
+	for (;;) {
+		while ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n')) c = fgetc(f);
+		if (c != '#') break;
+		while ((c != '\n') && (c != EOF)) c = fgetc(f);
+	}
+	while ((c != EOF) && (c != ' ') && (c != '\t') && (c != '\r') && (c != '\n')) {
+		if (n + 1 < size) out[n++] = (char)c;
+		c = fgetc(f);
+	}
+	out[n] = 0;
+	return (n > 0);
+}
+
+static uint32_t * read_image(const char * path, uint32_t * w, uint32_t * h) {
+	FILE * f = fopen(path, "rb");
+	char t[64];
+	uint32_t depth = 3, maxval = 0;
+	*w = *h = 0;
+
+	if ((f == NULL) || (!token(f, t, sizeof(t)))) { fprintf(stderr, "imgconv: can not read %s\n", path); if (f) fclose(f); return NULL; }
+	if (strcmp(t, "P6") == 0) {
+		if (token(f, t, sizeof(t))) *w = (uint32_t)atoi(t);
+		if (token(f, t, sizeof(t))) *h = (uint32_t)atoi(t);
+		if (token(f, t, sizeof(t))) maxval = (uint32_t)atoi(t);
+	} else if (strcmp(t, "P7") == 0) {
+		while (token(f, t, sizeof(t)) && (strcmp(t, "ENDHDR") != 0)) {
+			char v[64];
+			if (!token(f, v, sizeof(v))) break;
+			if (strcmp(t, "WIDTH") == 0) *w = (uint32_t)atoi(v);
+			else if (strcmp(t, "HEIGHT") == 0) *h = (uint32_t)atoi(v);
+			else if (strcmp(t, "DEPTH") == 0) depth = (uint32_t)atoi(v);
+			else if (strcmp(t, "MAXVAL") == 0) maxval = (uint32_t)atoi(v);
+		}
+	}
+	if ((*w == 0) || (*h == 0) || (*w > 0xFFFF) || (*h > 0xFFFF) || (maxval != 255) || ((depth != 3) && (depth != 4))) {
+		fprintf(stderr, "imgconv: %s is not 8-bit PPM / PAM RGB or RGBA\n", path);
+		fclose(f);
+		return NULL;
+	}
+
+	size_t n = (size_t)*w * *h;
+	uint8_t * raw = malloc(n * depth);
+	uint32_t * argb = malloc(n * 4);
+	if (fread(raw, depth, n, f) != n) {
+		fprintf(stderr, "imgconv: %s is truncated\n", path);
+		free(raw);
+		free(argb);
+		fclose(f);
+		return NULL;
+	}
+	fclose(f);
+	for (size_t i = 0; i < n; i++) {
+		const uint8_t * p = raw + i * depth;
+		uint32_t a = (depth == 4) ? p[3] : 255;
+		argb[i] = a << 24 | (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+	}
+	free(raw);
+	return argb;
+}
+
+int main(int argc, char ** argv) {
+	const char * cname = NULL;
+	uint8_t compress = 0, keyed = 0;
+	uint32_t key = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "k:zc:")) != -1) {
+		switch (opt) {
+		case 'k': key = (uint32_t)strtoul(optarg, NULL, 16) & 0xFFFFFF; keyed = 1; break;
+		case 'z': compress = 1; break;
+		case 'c': cname = optarg; break;
+		default: optind = argc; break;
+		}
+	}
+	if (argc - optind != 2) {
+		fprintf(stderr, "usage: imgconv [-k rrggbb] [-z] [-c name] input output\n");
+		return 1;
+	}
+
+	uint32_t w, h;
+	uint32_t * argb = read_image(argv[optind], &w, &h);
+	if (argb == NULL) return 1;
+
+	size_t n = (size_t)w * h, transparent = 0;
+	size_t size = 4 + n * 4;
+	uint8_t * img = malloc(size);
+	uint16_t hdr[2] = { (uint16_t)w, (uint16_t)h };
+	memcpy(img, hdr, 4);
+	for (size_t i = 0; i < n; i++) {
+		if ((keyed) && ((argb[i] & 0xFFFFFF) == key)) argb[i] = 0;
+		if ((argb[i] >> 24) == 0) transparent++;
+	}
+	memcpy(img + 4, argb, n * 4);
+	free(argb);
+
+	const uint8_t * out = img;
+	uint8_t * buf = NULL;
+	if (compress) {
+		buf = malloc(rc_bound(size));
+		size = rc_compress(img, size, buf);
+		out = buf;
+	}
+
+	FILE * f = fopen(argv[optind + 1], (cname) ? "w" : "wb");
+	if (f == NULL) { fprintf(stderr, "imgconv: can not write %s\n", argv[optind + 1]); return 1; }
+	if (cname) {
+		fprintf(f, "// %s - %ux%u ARGB8888 image for SPR_AtlasLoad / SPR_AtlasAdd\n", argv[optind], w, h);
+		fprintf(f, "const uint8_t %s[%zu] __attribute__((aligned(4))) = {", cname, size);
+		for (size_t i = 0; i < size; i++) fprintf(f, "%s0x%02X,", (i % 16) ? " " : "\n\t", out[i]);
+		fprintf(f, "\n};\n");
+	} else if (fwrite(out, 1, size, f) != size) {
+		fprintf(stderr, "imgconv: can not write %s\n", argv[optind + 1]);
+		return 1;
+	}
+	fclose(f);
+
+	printf("%s: %ux%u, %zu%% transparent, %zu bytes%s\n", argv[optind + 1], w, h, 100 * transparent / n, size, (compress) ? " (compressed)" : "");
+	free(img);
+	free(buf);
+	return 0;
+}
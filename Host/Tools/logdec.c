@@ -0,0 +1,117 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Decodes binary log stream (Inc/Log.h, LOG_FORMAT_BINARY)
+ * captured from USB CDC or serial port to text. Deferred records
+ * are formatted here with format strings sent by device on first use.
+ *
+ *   logdec log.bin [out.txt]
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BSP_Driver.h"
+#include "Log.h"
+
+#define HDR_TYPE(h)		(((h) >> 28) & 0x07)
+#define HDR_LEVEL(h)	(((h) >> 26) & 0x03)
+#define HDR_CAT(h)		(((h) >> 18) & 0xFF)
+#define HDR_NARGS(h)	(((h) >> 14) & 0x0F)
+#define HDR_WORDS(h)	((h) & 0x3FFF)
+
+static char * formats[LOG_MAX_FORMATS];
+static const char level_char[4] = {'E', 'W', 'I', 'D'};
+static const char * const cat_name[8] = {"APP", "GFX", "RES", "AUD", "SYS", "CAT5", "CAT6", "OUT"};
+
+static void prefix(FILE * out, uint32_t header, uint32_t tick) {
+	uint8_t cat = HDR_CAT(header);
+	uint8_t c = 0;
+	while ((c < 7) && !(cat & (1 << c))) c++;
+	fprintf(out, "%5u.%03u %c %s: ", tick / 1000, tick % 1000, level_char[HDR_LEVEL(header)], cat_name[c]);
+}
+
+// Same conversion rules as LOG_Format in Src/Log.c (32-bit integer arguments)
+static void format(FILE * out, const char * fmt, const uint32_t * args, uint32_t nargs) {
+	uint32_t arg = 0;
+	char spec[16];
+
+	while (*fmt) {
+		if (*fmt != '%') { fputc(*fmt++, out); continue; }
+		if (fmt[1] == '%') { fputc('%', out); fmt += 2; continue; }
+
+		size_t n = 0;
+		spec[n++] = *fmt++;
+		while ((*fmt) && strchr("-+ #0123456789.", *fmt) && (n < sizeof(spec) - 2)) spec[n++] = *fmt++;
+		while ((*fmt) && strchr("hlzjt", *fmt)) fmt++;
+		if (!*fmt) break;
+		char conv = *fmt++;
+		spec[n++] = conv;
+		spec[n] = 0;
+
+		uint32_t v = (arg < nargs) ? args[arg] : 0;
+		arg++;
+		switch (conv) {
+		case 'd': case 'i':				fprintf(out, spec, (int)(int32_t)v); break;
+		case 'u': case 'x': case 'X': case 'o':	fprintf(out, spec, (unsigned int)v); break;
+		case 'c':						fprintf(out, spec, (int)(uint8_t)v); break;
+		default:						fprintf(out, "<%%%c?>", conv); break;
+		}
+	}
+}
+
+int main(int argc, char ** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: logdec log.bin [out.txt]\n");
+		return 1;
+	}
+	FILE * f = fopen(argv[1], "rb");
+	if (f == NULL) { fprintf(stderr, "logdec: can not read %s\n", argv[1]); return 1; }
+	FILE * out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+	if (out == NULL) { fprintf(stderr, "logdec: can not write %s\n", argv[2]); return 1; }
+
+	uint32_t rec[0x4000];
+	uint32_t records = 0, dropped = 0;
+
+	while (fread(rec, 4, 1, f) == 1) {
+		uint32_t header = rec[0];
+		uint32_t words = HDR_WORDS(header);
+		if ((words < 2) || (fread(&rec[1], 4, words - 1, f) != words - 1)) break;
+
+		switch (HDR_TYPE(header)) {
+		case LOG_REC_FORMAT:
+			if ((words < 3) || (rec[1] >= LOG_MAX_FORMATS) || (rec[2] > (words - 3) * 4)) break;
+			free(formats[rec[1]]);
+			formats[rec[1]] = calloc(1, rec[2] + 1);
+			memcpy(formats[rec[1]], &rec[3], rec[2]);
+			break;
+		case LOG_REC_DEFERRED:
+			if (words < 3) break;
+			prefix(out, header, rec[1]);
+			if ((rec[2] < LOG_MAX_FORMATS) && (formats[rec[2]])) format(out, formats[rec[2]], &rec[3], HDR_NARGS(header));
+			else fprintf(out, "<unknown format %u>", rec[2]);
+			fputc('\n', out);
+			records++;
+			break;
+		case LOG_REC_TEXT:
+			if ((words < 3) || (rec[2] > (words - 3) * 4)) break;
+			if (HDR_CAT(header) != LOG_CAT_STDOUT) prefix(out, header, rec[1]);
+			fwrite(&rec[3], 1, rec[2], out);
+			if ((HDR_CAT(header) != LOG_CAT_STDOUT) && ((rec[2] == 0) || (((char *)&rec[3])[rec[2] - 1] != '\n'))) fputc('\n', out);
+			records++;
+			break;
+		case LOG_REC_DROPPED:
+			fprintf(out, "[log] %u records dropped\n", rec[1]);
+			dropped += rec[1];
+			break;
+		default:
+			fprintf(stderr, "logdec: unknown record 0x%08x\n", header);
+			break;
+		}
+	}
+
+	fprintf(stderr, "logdec: %u records, %u dropped\n", records, dropped);
+	fclose(f);
+	if (out != stdout) fclose(out);
+	return 0;
+}
@@ -0,0 +1,96 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Greedy LZ4 block encoder used by packing tools. Output is decoded
+ * on device by LZ4_DecodeBlock (Src/Lz4.c).
+ *******************************************************************/
+
+#ifndef LZ4_ENC_H_
+#define LZ4_ENC_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LZ4_ENC_HASH_BITS	16
+#define LZ4_ENC_MINMATCH	4
+#define LZ4_ENC_LASTLITERALS	5
+#define LZ4_ENC_MFLIMIT		12
+
+// Worst case size of compressed block
+static inline size_t lz4_bound(size_t n) {
+	return n + n / 255 + 16;
+}
+
+static inline uint32_t lz4_read32(const uint8_t * p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t v) {
+	return (v * 2654435761u) >> (32 - LZ4_ENC_HASH_BITS);
+}
+
+static inline uint8_t * lz4_put_len(uint8_t * op, size_t len) {
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (uint8_t)len;
+	return op;
+}
+
+static inline uint8_t * lz4_put_seq(uint8_t * op, const uint8_t * lit, size_t lit_len, size_t offset, size_t match_len) {
+	uint8_t * token = op++;
+	*token = (uint8_t)(((lit_len >= 15) ? 15 : lit_len) << 4);
+	if (lit_len >= 15) op = lz4_put_len(op, lit_len - 15);
+	memcpy(op, lit, lit_len);
+	op += lit_len;
+	if (match_len == 0) return op;
+
+	*op++ = (uint8_t)(offset & 0xFF);
+	*op++ = (uint8_t)(offset >> 8);
+	match_len -= LZ4_ENC_MINMATCH;
+	*token |= (uint8_t)((match_len >= 15) ? 15 : match_len);
+	if (match_len >= 15) op = lz4_put_len(op, match_len - 15);
+	return op;
+}
+
+// Compresses src into dst (at least lz4_bound(n) bytes). Returns compressed size.
+static inline size_t lz4_compress(const uint8_t * src, size_t n, uint8_t * dst) {
+	uint32_t * table = calloc(1u << LZ4_ENC_HASH_BITS, sizeof(uint32_t));
+	uint8_t * op = dst;
+	size_t ip = 0, anchor = 0;
+
+	if (n > LZ4_ENC_MFLIMIT) {
+		size_t ilimit = n - LZ4_ENC_MFLIMIT;
+		size_t mlimit = n - LZ4_ENC_LASTLITERALS;
+		while (ip <= ilimit) {
+			uint32_t seq = lz4_read32(src + ip);
+			uint32_t h = lz4_hash(seq);
+			size_t ref = table[h];
+			table[h] = (uint32_t)ip + 1;
+			if ((ref == 0) || (ip - (ref - 1) > 65535) || (lz4_read32(src + ref - 1) != seq)) {
+				ip++;
+				continue;
+			}
+			ref--;
+			size_t ml = LZ4_ENC_MINMATCH;
+			while ((ip + ml < mlimit) && (src[ref + ml] == src[ip + ml])) ml++;
+			while ((ip > anchor) && (ref > 0) && (src[ip - 1] == src[ref - 1])) {
+				ip--;
+				ref--;
+				ml++;
+			}
+			op = lz4_put_seq(op, src + anchor, ip - anchor, ip - ref, ml);
+			ip += ml;
+			anchor = ip;
+		}
+	}
+	op = lz4_put_seq(op, src + anchor, n - anchor, 0, 0);
+	free(table);
+	return (size_t)(op - dst);
+}
+
+#endif /* LZ4_ENC_H_ */
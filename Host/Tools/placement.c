@@ -0,0 +1,368 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Profile guided ITCM/DTCM placement. Ranks functions and data by
+ * hotness, selects what fits into free ITCM/DTCM and writes report
+ * and (optionally) copy of linker script with selected input
+ * sections assigned to .itc_mram/.dtc_mram.
+ *
+ *   placement -n syms.txt [-p profile.txt]... [-T app.ld -o placed.ld]
+ *             [-i itcm_bytes] [-d dtcm_bytes] [-k keep_free] [-s stall_pct]
+ *             [-x symbol]... [-R]
+ *
+ *   syms.txt    - arm-none-eabi-nm -S --defined-only app.elf
+ *                 (app must be built with -ffunction-sections -fdata-sections)
+ *   profile.txt - any mix of lines:
+ *                 "prof frame <cycles> <frames>"   from PROF_Dump (log output,
+ *                 "prof zone <name> <cycles> <n>"  prefixes are ignored)
+ *                 "0x<pc> [count]"                 PC samples (SWV statistical
+ *                                                  profiling, gdb sampling)
+ *                 "<symbol> <weight>"              code samples or data hint
+ *                 "data <symbol> <weight>"         data access weight hint
+ *   -R          - allow read-only data in DTCM (default off, fonts and
+ *                 images are read by DMA2D which can not access DTCM)
+ *
+ * Code share of CPU time is taken from PC samples (samples / total) or,
+ * when there are no samples, from zones named after functions (zone
+ * cycles / frame cycles, zones are inclusive, so leaf zones give best
+ * results). Estimated fetch
+ * stall saving = moved share * stall_pct, where stall_pct is part of
+ * QSPI code execution time spent waiting for instruction fetch
+ * (measure by timing zone with code in QSPI and in ITCM, default 25%).
+ *
+ * Linker script copy moves .itc_mram and .dtc_mram before .text, so
+ * their input section patterns take precedence over *(.text*) and
+ * *(.data*). Startup copy routine is unchanged.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define ITCM_BASE		0x00000000u
+#define ITCM_SIZE		(64u * 1024u)
+#define DTCM_BASE		0x20000000u
+#define DTCM_SIZE		(128u * 1024u)
+#define FUNC_OVERHEAD	12				// Alignment and long branch veneer per moved function
+#define MAX_EXCLUDE		64
+
+typedef struct {
+	char		name[256];
+	uint32_t	addr;
+	uint32_t	size;
+	char		type;					// nm type (lower case)
+	uint8_t		code;
+	uint8_t		in_tcm;
+	uint8_t		selected;
+	double		samples;
+	double		zone_share;
+	double		data_weight;
+	double		share;					// Estimated CPU time share (code)
+} SYM;
+
+static SYM * syms = NULL;
+static size_t nsyms = 0;
+static double total_samples = 0;
+static double frame_cycles = 0;
+static uint32_t unmatched = 0;
+static const char * exclude[MAX_EXCLUDE];
+static int nexclude = 0;
+
+static int by_addr(const void * a, const void * b) {
+	const SYM * sa = a, * sb = b;
+	return (sa->addr > sb->addr) - (sa->addr < sb->addr);
+}
+
+static SYM * find_name(const char * name) {
+	for (size_t i = 0; i < nsyms; i++) if (strcmp(syms[i].name, name) == 0) return &syms[i];
+	return NULL;
+}
+
+// Code symbol containing address (syms sorted by address)
+static SYM * find_addr(uint32_t addr) {
+	size_t lo = 0, hi = nsyms;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (syms[mid].addr <= addr) lo = mid + 1; else hi = mid;
+	}
+	for (size_t i = lo; i-- > 0;) {
+		if (!syms[i].code) continue;
+		if (addr < syms[i].addr + syms[i].size) return &syms[i];
+		break;
+	}
+	return NULL;
+}
+
+static int load_syms(const char * path) {
+	FILE * f = fopen(path, "r");
+	if (f == NULL) return -1;
+	char line[512];
+	size_t cap = 0;
+
+	while (fgets(line, sizeof(line), f)) {
+		char a[32], s[32], t[8], name[256];
+		if (sscanf(line, "%31s %31s %7s %255s", a, s, t, name) != 4) continue;	// Symbols without size are skipped
+		char type = (char)tolower((unsigned char)t[0]);
+		if (!strchr("tdbr", type)) continue;
+		uint32_t size = (uint32_t)strtoul(s, NULL, 16);
+		if (size == 0) continue;
+
+		if (nsyms == cap) {
+			cap = (cap) ? cap * 2 : 1024;
+			syms = realloc(syms, cap * sizeof(SYM));
+		}
+		SYM * y = &syms[nsyms++];
+		memset(y, 0, sizeof(SYM));
+		snprintf(y->name, sizeof(y->name), "%s", name);
+		y->addr = (uint32_t)strtoul(a, NULL, 16);
+		y->size = size;
+		y->type = type;
+		y->code = (type == 't');
+		y->in_tcm = ((y->addr - ITCM_BASE) < ITCM_SIZE) || ((y->addr - DTCM_BASE) < DTCM_SIZE);
+	}
+	fclose(f);
+	qsort(syms, nsyms, sizeof(SYM), by_addr);
+	return 0;
+}
+
+static int load_profile(const char * path) {
+	FILE * f = fopen(path, "r");
+	if (f == NULL) return -1;
+	char line[512];
+
+	while (fgets(line, sizeof(line), f)) {
+		char name[256];
+		double v = 0;
+		char * p;
+
+		if ((p = strstr(line, "prof frame ")) != NULL) {
+			if (sscanf(p + 11, "%lf", &v) == 1) frame_cycles = v;
+		} else if ((p = strstr(line, "prof zone ")) != NULL) {
+			if (sscanf(p + 10, "%255s %lf", name, &v) == 2) {
+				SYM * y = find_name(name);
+				if ((y) && (y->code)) y->zone_share = v; else unmatched++;
+			}
+		} else if (sscanf(line, " data %255s %lf", name, &v) == 2) {
+			SYM * y = find_name(name);
+			if ((y) && (!y->code)) y->data_weight += v; else unmatched++;
+		} else if ((sscanf(line, " %255s", name) == 1) && (name[0] == '0') && (name[1] == 'x')) {
+			uint32_t pc = (uint32_t)strtoul(name, NULL, 16) & ~1u;
+			if (sscanf(line, " %*s %lf", &v) != 1) v = 1;
+			SYM * y = find_addr(pc);
+			total_samples += v;
+			if (y) y->samples += v; else unmatched++;
+		} else if (sscanf(line, " %255s %lf", name, &v) == 2) {
+			SYM * y = find_name(name);
+			if (y == NULL) unmatched++;
+			else if (y->code) { y->samples += v; total_samples += v; }
+			else y->data_weight += v;
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+static uint8_t excluded(const char * name) {
+	for (int i = 0; i < nexclude; i++) if (strcmp(exclude[i], name) == 0) return 1;
+	return 0;
+}
+
+static double code_density(const SYM * y) { return y->share / (y->size + FUNC_OVERHEAD); }
+static double data_density(const SYM * y) { return y->data_weight / y->size; }
+
+static int by_code_density(const void * a, const void * b) {
+	double da = code_density(*(SYM * const *)a), db = code_density(*(SYM * const *)b);
+	return (da < db) - (da > db);
+}
+
+static int by_data_density(const void * a, const void * b) {
+	double da = data_density(*(SYM * const *)a), db = data_density(*(SYM * const *)b);
+	return (da < db) - (da > db);
+}
+
+static const char * section_of(const SYM * y) {
+	switch (y->type) {
+	case 't': return ".text";
+	case 'd': return ".data";
+	case 'b': return ".bss";
+	default: return ".rodata";
+	}
+}
+
+// Copies linker script moving TCM output sections before .text with selected input sections added
+static int write_script(const char * in_path, const char * out_path) {
+	FILE * f = fopen(in_path, "r");
+	if (f == NULL) return -1;
+	char ** lines = NULL;
+	size_t n = 0, cap = 0;
+	char buf[1024];
+	while (fgets(buf, sizeof(buf), f)) {
+		if (n == cap) { cap = (cap) ? cap * 2 : 256; lines = realloc(lines, cap * sizeof(char *)); }
+		lines[n++] = strdup(buf);
+	}
+	fclose(f);
+
+	// Locate blocks: "_si...= LOADADDR(.x)" line, optional comment, ".x : {" ... "} >REGION"
+	const char * sect[2] = {".itc_mram", ".dtc_mram"};
+	const char * pattern[2] = {"*(.itc_mram)", "*(.dtc_mram)"};
+	size_t start[2], end[2], text = n;
+	for (int k = 0; k < 2; k++) {
+		char key[64];
+		start[k] = end[k] = n;
+		snprintf(key, sizeof(key), "LOADADDR(%s)", sect[k]);
+		for (size_t i = 0; i < n; i++) if (strstr(lines[i], key)) { start[k] = i; break; }
+		snprintf(key, sizeof(key), "%s :", sect[k]);
+		for (size_t i = start[k]; i < n; i++) {
+			if ((end[k] == n) && strstr(lines[i], key)) end[k] = i;
+			if ((end[k] != n) && (lines[i][strspn(lines[i], " \t")] == '}')) { end[k] = i; break; }
+		}
+		if ((start[k] == n) || (end[k] == n)) { fprintf(stderr, "placement: %s block not found in %s\n", sect[k], in_path); return -1; }
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (strncmp(lines[i] + strspn(lines[i], " \t"), ".text :", 7) == 0) { text = i; break; }
+	}
+	if ((text == n) || (text > start[0]) || (text > start[1])) { fprintf(stderr, "placement: .text must precede TCM sections in %s\n", in_path); return -1; }
+
+	FILE * o = fopen(out_path, "w");
+	if (o == NULL) return -1;
+	for (size_t i = 0; i < n; i++) {
+		if (i == text) {
+			fprintf(o, "  /* TCM sections generated by placement tool - placed before .text so */\n");
+			fprintf(o, "  /* selected input sections are not taken by *(.text*) and *(.data*)  */\n");
+			for (int k = 0; k < 2; k++) {
+				for (size_t j = start[k]; j <= end[k]; j++) {
+					fputs(lines[j], o);
+					if (strstr(lines[j], pattern[k])) {
+						for (size_t s = 0; s < nsyms; s++) {
+							if ((!syms[s].selected) || (syms[s].code != (k == 0))) continue;
+							fprintf(o, "  \t*(%s.%s)\n", section_of(&syms[s]), syms[s].name);
+						}
+					}
+				}
+				fputs("\n", o);
+			}
+		}
+		if (((i >= start[0]) && (i <= end[0])) || ((i >= start[1]) && (i <= end[1]))) continue;
+		fputs(lines[i], o);
+	}
+	fclose(o);
+	for (size_t i = 0; i < n; i++) free(lines[i]);
+	free(lines);
+	return 0;
+}
+
+int main(int argc, char ** argv) {
+	const char * nm_path = NULL, * ld_in = NULL, * ld_out = NULL;
+	const char * profiles[16];
+	int nprof = 0;
+	uint32_t itcm = ITCM_SIZE, dtcm = DTCM_SIZE, keep = 1024;
+	double stall_pct = 25;
+	uint8_t allow_ro = 0;
+
+	for (int i = 1; i < argc; i++) {
+		const char * a = argv[i];
+		const char * v = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if ((a[0] != '-') || (a[1] == 0) || (a[2] != 0)) goto usage;
+		if (a[1] == 'R') { allow_ro = 1; continue; }
+		if (v == NULL) goto usage;
+		i++;
+		switch (a[1]) {
+		case 'n': nm_path = v; break;
+		case 'p': if (nprof < 16) profiles[nprof++] = v; break;
+		case 'T': ld_in = v; break;
+		case 'o': ld_out = v; break;
+		case 'i': itcm = (uint32_t)strtoul(v, NULL, 0); break;
+		case 'd': dtcm = (uint32_t)strtoul(v, NULL, 0); break;
+		case 'k': keep = (uint32_t)strtoul(v, NULL, 0); break;
+		case 's': stall_pct = atof(v); break;
+		case 'x': if (nexclude < MAX_EXCLUDE) exclude[nexclude++] = v; break;
+		default: goto usage;
+		}
+	}
+	if ((nm_path == NULL) || ((ld_in == NULL) != (ld_out == NULL))) goto usage;
+
+	if (load_syms(nm_path)) { fprintf(stderr, "placement: can not read %s\n", nm_path); return 1; }
+	for (int i = 0; i < nprof; i++) {
+		if (load_profile(profiles[i])) { fprintf(stderr, "placement: can not read %s\n", profiles[i]); return 1; }
+	}
+
+	// Space already taken by ITC_MRAM/DTC_MRAM objects
+	uint32_t itcm_used = 0, dtcm_used = 0;
+	for (size_t i = 0; i < nsyms; i++) {
+		if ((syms[i].addr - ITCM_BASE) < ITCM_SIZE) itcm_used += syms[i].size;
+		if ((syms[i].addr - DTCM_BASE) < DTCM_SIZE) dtcm_used += syms[i].size;
+	}
+	int64_t itcm_free = (int64_t)itcm - itcm_used - keep;
+	int64_t dtcm_free = (int64_t)dtcm - dtcm_used - keep;
+
+	// Rank candidates
+	SYM ** code = malloc(nsyms * sizeof(SYM *));
+	SYM ** data = malloc(nsyms * sizeof(SYM *));
+	size_t ncode = 0, ndata = 0;
+	for (size_t i = 0; i < nsyms; i++) {
+		SYM * y = &syms[i];
+		if (total_samples > 0) y->share = y->samples / total_samples;
+		else if (frame_cycles > 0) y->share = y->zone_share / frame_cycles;
+		if ((y->in_tcm) || excluded(y->name)) continue;
+		if ((y->code) && (y->share > 0)) code[ncode++] = y;
+		if ((!y->code) && (y->data_weight > 0) && ((y->type != 'r') || (allow_ro))) data[ndata++] = y;
+	}
+	qsort(code, ncode, sizeof(SYM *), by_code_density);
+	qsort(data, ndata, sizeof(SYM *), by_data_density);
+
+	uint32_t itcm_add = 0, dtcm_add = 0, nsel_code = 0, nsel_data = 0;
+	double moved_share = 0, hot_share = 0;
+	for (size_t i = 0; i < ncode; i++) {
+		uint32_t need = code[i]->size + FUNC_OVERHEAD;
+		hot_share += code[i]->share;
+		if (itcm_add + need > itcm_free) continue;
+		code[i]->selected = 1;
+		itcm_add += need;
+		moved_share += code[i]->share;
+		nsel_code++;
+	}
+	for (size_t i = 0; i < ndata; i++) {
+		uint32_t need = (data[i]->size + 3) & ~3u;
+		if (dtcm_add + need > dtcm_free) continue;
+		data[i]->selected = 1;
+		dtcm_add += need;
+		nsel_data++;
+	}
+
+	// Report
+	printf("Placement report\n");
+	printf("  symbols %zu, PC samples %.0f, frame %.0f cycles, unmatched profile entries %u\n", nsyms, total_samples, frame_cycles, unmatched);
+	printf("  ITCM %u B: used %u, reserve %u, selected %u B in %u functions\n", itcm, itcm_used, keep, itcm_add, nsel_code);
+	printf("  DTCM %u B: used %u, reserve %u, selected %u B in %u objects\n\n", dtcm, dtcm_used, keep, dtcm_add, nsel_data);
+
+	printf("  %-40s %8s %8s %10s  %s\n", "function", "size", "share%", "share/KB", "placement");
+	for (size_t i = 0; i < ncode; i++) {
+		SYM * y = code[i];
+		printf("  %-40.40s %8u %8.2f %10.3f  %s\n", y->name, y->size, y->share * 100, y->share * 100 * 1024 / y->size, (y->selected) ? "ITCM" : "QSPI (no space)");
+	}
+	if (ndata) {
+		printf("\n  %-40s %8s %8s %10s  %s\n", "data", "size", "weight", "weight/KB", "placement");
+		for (size_t i = 0; i < ndata; i++) {
+			SYM * y = data[i];
+			printf("  %-40.40s %8u %8.0f %10.1f  %s\n", y->name, y->size, y->data_weight, y->data_weight * 1024 / y->size, (y->selected) ? "DTCM" : "AXI SRAM (no space)");
+		}
+	}
+
+	printf("\n  hot code share in QSPI   %.1f%% of CPU time\n", hot_share * 100);
+	printf("  moved to ITCM            %.1f%% of CPU time\n", moved_share * 100);
+	printf("  est. fetch stalls saved  %.1f%% of CPU time (stall_pct %.0f%%)", moved_share * stall_pct, stall_pct);
+	if (frame_cycles > 0) printf(", %.0f cycles/frame", moved_share * stall_pct / 100 * frame_cycles);
+	printf("\n");
+
+	if (ld_out) {
+		if (write_script(ld_in, ld_out)) { fprintf(stderr, "placement: can not write %s\n", ld_out); return 1; }
+		printf("\n  linker script written to %s\n", ld_out);
+	}
+	return 0;
+
+usage:
+	fprintf(stderr, "usage: placement -n syms.txt [-p profile.txt]... [-T app.ld -o placed.ld] [-i itcm] [-d dtcm] [-k keep] [-s stall_pct] [-x symbol]... [-R]\n");
+	return 1;
+}
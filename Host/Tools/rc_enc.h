@@ -0,0 +1,50 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Writer of compressed resource containers (Inc/ResCompress.h).
+ *******************************************************************/
+
+#ifndef RC_ENC_H_
+#define RC_ENC_H_
+
+#include "ResCompress.h"
+#include "lz4_enc.h"
+
+// Worst case container size
+static inline size_t rc_bound(size_t n) {
+	return sizeof(RC_HEADER) + n + (n / RC_BLOCK_SIZE + 1) * 4;
+}
+
+// Builds container in dst (at least rc_bound(n) bytes). Returns container size.
+static inline size_t rc_compress(const uint8_t * src, size_t n, uint8_t * dst) {
+	RC_HEADER hdr;
+	uint8_t * block = malloc(lz4_bound(RC_BLOCK_SIZE));
+	size_t pos = sizeof(RC_HEADER);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = RC_MAGIC;
+	hdr.version = RC_VERSION;
+	hdr.raw_size = (uint32_t)n;
+	hdr.block_size = RC_BLOCK_SIZE;
+	memcpy(dst, &hdr, sizeof(hdr));
+
+	for (size_t i = 0; i < n; i += RC_BLOCK_SIZE) {
+		size_t raw = (n - i > RC_BLOCK_SIZE) ? RC_BLOCK_SIZE : n - i;
+		size_t csize = lz4_compress(src + i, raw, block);
+		uint32_t bsize;
+		if (csize < raw) {
+			bsize = (uint32_t)csize;
+			memcpy(dst + pos + 4, block, csize);
+		} else {
+			bsize = (uint32_t)raw | RC_BLOCK_STORED;
+			memcpy(dst + pos + 4, src + i, raw);
+			csize = raw;
+		}
+		memcpy(dst + pos, &bsize, 4);
+		pos += 4 + csize;
+	}
+	free(block);
+	return pos;
+}
+
+#endif /* RC_ENC_H_ */
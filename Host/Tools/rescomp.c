@@ -0,0 +1,37 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Compresses resource into container loaded by RC_Load.
+ *
+ *   rescomp input output
+ *******************************************************************/
+
+#include <stdio.h>
+#include "BSP_Driver.h"
+#include "rc_enc.h"
+
+int main(int argc, char ** argv) {
+	if (argc != 3) {
+		fprintf(stderr, "usage: rescomp input output\n");
+		return 1;
+	}
+
+	FILE * f = fopen(argv[1], "rb");
+	if (f == NULL) { fprintf(stderr, "rescomp: can not read %s\n", argv[1]); return 1; }
+	fseek(f, 0, SEEK_END);
+	long n = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t * src = malloc((n > 0) ? (size_t)n : 1);
+	if (fread(src, 1, (size_t)n, f) != (size_t)n) { fprintf(stderr, "rescomp: read error\n"); return 1; }
+	fclose(f);
+
+	uint8_t * dst = malloc(rc_bound((size_t)n));
+	size_t size = rc_compress(src, (size_t)n, dst);
+
+	f = fopen(argv[2], "wb");
+	if ((f == NULL) || (fwrite(dst, 1, size, f) != size)) { fprintf(stderr, "rescomp: can not write %s\n", argv[2]); return 1; }
+	fclose(f);
+
+	printf("%s: %ld -> %zu bytes (%.1f%%)\n", argv[2], n, size, (n) ? 100.0 * (double)size / (double)n : 0.0);
+	return 0;
+}
@@ -0,0 +1,198 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Resource pack builder (format described in Inc/ResPack.h).
+ *
+ *   respack -o out.pak [-g group] [-z | -Z] file ... [-g group] file ...
+ *
+ *   -g n	- group id for following files (default 0)
+ *   -z		- try LZ4 compression for following files
+ *   -Z		- store following files uncompressed (default)
+ *   -l		- list contents of existing pack (respack -l pack.pak)
+ *
+ * Entry name is file name without directory.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "BSP_Driver.h"
+#include "ResPack.h"
+#include "lz4_enc.h"
+
+typedef struct {
+	const char *	path;
+	const char *	name;
+	uint16_t		group;
+	uint8_t			compress;
+	uint32_t		order;
+	uint8_t *		data;			// Stored payload
+	RP_ENTRY		e;
+} Entry;
+
+// Same as RP_Hash (device side)
+static uint32_t hash_name(const char * name) {
+	uint32_t h = 2166136261u;
+	for (; *name; name++) h = (h ^ (uint8_t)tolower((uint8_t)*name)) * 16777619u;
+	return h;
+}
+
+static uint8_t * read_file(const char * path, uint32_t * size) {
+	FILE * f = fopen(path, "rb");
+	if (f == NULL) return NULL;
+	fseek(f, 0, SEEK_END);
+	long n = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t * buf = malloc((n > 0) ? (size_t)n : 1);
+	if ((buf == NULL) || (fread(buf, 1, (size_t)n, f) != (size_t)n)) {
+		fclose(f);
+		free(buf);
+		return NULL;
+	}
+	fclose(f);
+	*size = (uint32_t)n;
+	return buf;
+}
+
+static int cmp_payload(const void * a, const void * b) {
+	const Entry * x = a, * y = b;
+	if (x->group != y->group) return (x->group < y->group) ? -1 : 1;
+	return (x->order < y->order) ? -1 : (x->order > y->order);
+}
+
+static int cmp_toc(const void * a, const void * b) {
+	const Entry * x = *(const Entry * const *)a, * y = *(const Entry * const *)b;
+	if (x->e.hash != y->e.hash) return (x->e.hash < y->e.hash) ? -1 : 1;
+	return strcmp(x->name, y->name);
+}
+
+static int list_pack(const char * path) {
+	uint32_t size;
+	uint8_t * buf = read_file(path, &size);
+	if (buf == NULL) { fprintf(stderr, "respack: can not read %s\n", path); return 1; }
+	RP_HEADER * h = (RP_HEADER *)buf;
+	if ((size < sizeof(RP_HEADER)) || (h->magic != RP_MAGIC)) { fprintf(stderr, "respack: %s is not a pack\n", path); return 1; }
+	RP_ENTRY * toc = (RP_ENTRY *)(buf + h->toc_offset);
+	printf("%-32s %5s %10s %10s %10s %s\n", "name", "group", "offset", "size", "raw", "codec");
+	for (uint32_t i = 0; i < h->count; i++) {
+		printf("%-32s %5u %10u %10u %10u %s\n", (char *)buf + h->names_offset + toc[i].name, toc[i].group,
+			toc[i].offset, toc[i].size, toc[i].raw_size, (toc[i].codec == RP_CODEC_LZ4) ? "lz4" : "none");
+	}
+	free(buf);
+	return 0;
+}
+
+int main(int argc, char ** argv) {
+	const char * out = NULL;
+	uint16_t group = 0;
+	uint8_t compress = 0;
+	Entry * ent = calloc((size_t)argc, sizeof(Entry));
+	uint32_t count = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-l") == 0) && (i + 1 < argc)) return list_pack(argv[i + 1]);
+		else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) out = argv[++i];
+		else if ((strcmp(argv[i], "-g") == 0) && (i + 1 < argc)) group = (uint16_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-z") == 0) compress = 1;
+		else if (strcmp(argv[i], "-Z") == 0) compress = 0;
+		else if (argv[i][0] == '-') { fprintf(stderr, "respack: unknown option %s\n", argv[i]); return 1; }
+		else {
+			Entry * e = &ent[count];
+			const char * slash = strrchr(argv[i], '/');
+			e->path = argv[i];
+			e->name = (slash) ? slash + 1 : argv[i];
+			e->group = group;
+			e->compress = compress;
+			e->order = count++;
+		}
+	}
+	if ((out == NULL) || (count == 0) || (count > 0xFFFF)) {
+		fprintf(stderr, "usage: respack -o out.pak [-g group] [-z|-Z] file ...\n       respack -l pack.pak\n");
+		return 1;
+	}
+
+	// Load and optionally compress payloads
+	uint32_t names_size = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		Entry * e = &ent[i];
+		for (uint32_t j = 0; j < i; j++) {
+			if (hash_name(ent[j].name) == hash_name(e->name) && (strcasecmp(ent[j].name, e->name) == 0)) {
+				fprintf(stderr, "respack: duplicate name %s\n", e->name);
+				return 1;
+			}
+		}
+		uint32_t size;
+		uint8_t * raw = read_file(e->path, &size);
+		if (raw == NULL) { fprintf(stderr, "respack: can not read %s\n", e->path); return 1; }
+		e->data = raw;
+		e->e.size = size;
+		e->e.raw_size = size;
+		e->e.codec = RP_CODEC_NONE;
+		if (e->compress && size) {
+			uint8_t * comp = malloc(lz4_bound(size));
+			size_t csize = lz4_compress(raw, size, comp);
+			// Keep compressed only when it saves at least 1/8
+			if (csize < size - size / 8) {
+				free(raw);
+				e->data = comp;
+				e->e.size = (uint32_t)csize;
+				e->e.codec = RP_CODEC_LZ4;
+			} else {
+				free(comp);
+			}
+		}
+		e->e.hash = hash_name(e->name);
+		e->e.group = e->group;
+		e->e.name = names_size;
+		names_size += (uint32_t)strlen(e->name) + 1;
+	}
+
+	// Payloads grouped by group id, TOC sorted by hash
+	qsort(ent, count, sizeof(Entry), cmp_payload);
+	Entry ** toc = malloc(count * sizeof(Entry *));
+	for (uint32_t i = 0; i < count; i++) toc[i] = &ent[i];
+
+	RP_HEADER hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = RP_MAGIC;
+	hdr.version = RP_VERSION;
+	hdr.count = (uint16_t)count;
+	hdr.toc_offset = sizeof(RP_HEADER);
+	hdr.names_offset = hdr.toc_offset + count * sizeof(RP_ENTRY);
+	hdr.names_size = names_size;
+	hdr.data_offset = (hdr.names_offset + names_size + RP_ALIGN - 1) & ~(RP_ALIGN - 1);
+
+	uint32_t pos = hdr.data_offset;
+	for (uint32_t i = 0; i < count; i++) {
+		ent[i].e.offset = pos;
+		pos = (pos + ent[i].e.size + RP_ALIGN - 1) & ~(RP_ALIGN - 1);
+	}
+	qsort(toc, count, sizeof(Entry *), cmp_toc);
+
+	FILE * f = fopen(out, "wb");
+	if (f == NULL) { fprintf(stderr, "respack: can not create %s\n", out); return 1; }
+	fwrite(&hdr, sizeof(hdr), 1, f);
+	for (uint32_t i = 0; i < count; i++) fwrite(&toc[i]->e, sizeof(RP_ENTRY), 1, f);
+	// Names in original order (offsets were assigned before sorting)
+	char * names = calloc(1, names_size);
+	for (uint32_t i = 0; i < count; i++) strcpy(names + ent[i].e.name, ent[i].name);
+	fwrite(names, 1, names_size, f);
+
+	static const uint8_t pad[RP_ALIGN];
+	uint64_t raw_total = 0, stored_total = 0;
+	fwrite(pad, 1, hdr.data_offset - (hdr.names_offset + names_size), f);
+	for (uint32_t i = 0; i < count; i++) {
+		fwrite(ent[i].data, 1, ent[i].e.size, f);
+		uint32_t end = ent[i].e.offset + ent[i].e.size;
+		uint32_t next = (end + RP_ALIGN - 1) & ~(RP_ALIGN - 1);
+		fwrite(pad, 1, next - end, f);
+		raw_total += ent[i].e.raw_size;
+		stored_total += ent[i].e.size;
+	}
+	fclose(f);
+
+	printf("%s: %u entries, %llu bytes raw, %llu bytes stored, %u bytes total\n", out, count,
+		(unsigned long long)raw_total, (unsigned long long)stored_total, pos);
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Builder of signed distance field fonts (Inc/SDF.h) from v1
+ * bitmap fonts. Distance is measured in source pixels with edge
+ * position refined by 2-bit coverage of edge pixels, then scaled
+ * to field resolution.
+ *******************************************************************/
+
+#ifndef SDF_ENC_H_
+#define SDF_ENC_H_
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Font.h"
+#include "SDF.h"
+
+// Decodes glyph of v1 font into A8 mask (advance width x height). Returns advance width.
+static inline uint8_t sdf_decode_v1(const uint8_t * font, uint32_t c, uint8_t * mask) {
+	uint32_t idx = c - FONT_FIRST_CHAR;
+	const uint8_t * p = font + (font[2 + 2 * idx] | (font[3 + 2 * idx] << 8));
+	const uint8_t * end = font + (font[4 + 2 * idx] | (font[5 + 2 * idx] << 8));
+	uint8_t w = *p++;
+	uint32_t total = (uint32_t)w * font[0], pos = 0;
+
+	for (; (p < end) && (pos < total); p++) {
+		uint8_t op = *p >> 6;
+		uint32_t n = ((op == 0) || (op == 3)) ? (*p & 0x3Fu) : 4;
+		for (uint32_t k = 0; (k < n) && (pos < total); k++) {
+			mask[pos++] = (op == 0) ? 0 : (op == 3) ? 255 : ((*p >> (6 - 2 * k)) & 3) * 85;
+		}
+	}
+	while (pos < total) mask[pos++] = 0;
+	return w;
+}
+
+// Signed distance (source pixels, inside positive) of point (x, y) to glyph edge, limited to r
+static inline double sdf_distance(const uint8_t * mask, int w, int h, double x, double y, double r) {
+	int cx = (int)floor(x), cy = (int)floor(y);
+	int inside = (cx >= 0) && (cy >= 0) && (cx < w) && (cy < h) && (mask[cy * w + cx] >= 128);
+	int ri = (int)ceil(r) + 1;
+	double best = r;
+
+	for (int qy = cy - ri; qy <= cy + ri; qy++) {
+		for (int qx = cx - ri; qx <= cx + ri; qx++) {
+			int a = ((qx >= 0) && (qy >= 0) && (qx < w) && (qy < h)) ? mask[qy * w + qx] : 0;
+			double dx = x - (qx + 0.5), dy = y - (qy + 0.5);
+			double d = sqrt(dx * dx + dy * dy);
+			// Edge lies 0.5 px from centre of full pixel, at centre of half covered one
+			if ((inside) && (a < 255)) d = d - 0.5 + a / 255.0;
+			else if ((!inside) && (a > 0)) d = d + 0.5 - a / 255.0;
+			else continue;
+			if (d < best) best = d;
+		}
+	}
+	if (best < 0) best = 0;
+	return (inside) ? best : -best;
+}
+
+// Builds SDF font (malloc) with field line height and spread (field pixels)
+static inline uint8_t * sdf_build(const uint8_t * v1, uint8_t line, uint8_t spread, size_t * size) {
+	uint8_t src_h = v1[0];
+	uint32_t count = FONT_LAST_CHAR - FONT_FIRST_CHAR + 1;
+	double f = (double)src_h / line;
+	uint8_t * mask = malloc(256 * src_h);
+	uint32_t fh = line + 2 * spread;
+
+	// Glyph widths first - field data follows glyph table
+	uint8_t fw[FONT_LAST_CHAR - FONT_FIRST_CHAR + 1];
+	uint8_t sw[FONT_LAST_CHAR - FONT_FIRST_CHAR + 1];
+	uint32_t total = SDF_HEADER + SDF_GLYPH_ENTRY * count;
+	for (uint32_t i = 0; i < count; i++) {
+		sw[i] = sdf_decode_v1(v1, FONT_FIRST_CHAR + i, mask);
+		uint32_t w = (uint32_t)lround(sw[i] / f) + 2 * spread;
+		fw[i] = (uint8_t)((w < 2) ? 2 : (w > 255) ? 255 : w);
+		total += fw[i] * fh;
+	}
+
+	uint8_t * out = calloc(1, total);
+	uint16_t space = (uint16_t)lround(v1[1] * 16.0 / f);
+	uint16_t first = FONT_FIRST_CHAR;
+	out[0] = 0;
+	out[1] = SDF_VERSION;
+	out[2] = line;
+	out[3] = spread;
+	memcpy(out + 4, &first, 2);
+	memcpy(out + 6, &count, 2);
+	memcpy(out + 8, &space, 2);
+	memcpy(out + 12, &total, 4);
+
+	uint32_t pos = SDF_HEADER + SDF_GLYPH_ENTRY * count;
+	for (uint32_t i = 0; i < count; i++) {
+		uint8_t * e = out + SDF_HEADER + SDF_GLYPH_ENTRY * i;
+		uint16_t adv = (uint16_t)lround(sw[i] * 16.0 / f);
+		memcpy(e, &pos, 4);
+		memcpy(e + 4, &adv, 2);
+		e[6] = fw[i];
+
+		sdf_decode_v1(v1, FONT_FIRST_CHAR + i, mask);
+		for (uint32_t y = 0; y < fh; y++) {
+			for (uint32_t x = 0; x < fw[i]; x++) {
+				double sx = ((double)x - spread + 0.5) * f;
+				double sy = ((double)y - spread + 0.5) * f;
+				double d = sdf_distance(mask, sw[i], src_h, sx, sy, spread * f) / f;
+				long v = lround(SDF_EDGE + d * 127.0 / spread);
+				out[pos + y * fw[i] + x] = (uint8_t)((v < 1) ? 1 : (v > 255) ? 255 : v);
+			}
+		}
+		pos += fw[i] * fh;
+	}
+
+	free(mask);
+	*size = total;
+	return out;
+}
+
+#endif /* SDF_ENC_H_ */
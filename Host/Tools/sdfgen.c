@@ -0,0 +1,92 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Generates signed distance field font (Inc/SDF.h) from bitmap
+ * font in Src/fonts.c.
+ *
+ *   sdfgen [-f FONT_name] [-l line] [-s spread] [-z] [-c name] -o out
+ *
+ * -f source font (default FONT_64_verdana, largest gives best field),
+ * -l line height of field in pixels (default 20),
+ * -s spread in field pixels (default 3) - limits outline + glow to
+ *    spread x size / line output pixels,
+ * -z compresses output into RC_Load container,
+ * -c writes C array with given name instead of binary file.
+ * Prints field size against bitmap fonts of the same face.
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BSP_Driver.h"
+#include "rc_enc.h"
+#include "sdf_enc.h"
+#include "font_list.h"
+
+int main(int argc, char ** argv) {
+	const char * out_path = NULL;
+	const char * src = "FONT_64_verdana";
+	const char * cname = NULL;
+	int line = 20, spread = 3;
+	uint8_t compress = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "o:f:l:s:zc:")) != -1) {
+		switch (opt) {
+		case 'o': out_path = optarg; break;
+		case 'f': src = optarg; break;
+		case 'l': line = atoi(optarg); break;
+		case 's': spread = atoi(optarg); break;
+		case 'z': compress = 1; break;
+		case 'c': cname = optarg; break;
+		default: out_path = NULL; optind = argc; break;
+		}
+	}
+	if ((out_path == NULL) || (line < 4) || (line > 128) || (spread < 1) || (spread > 16)) {
+		fprintf(stderr, "usage: sdfgen [-f FONT_name] [-l line] [-s spread] [-z] [-c name] -o out\n");
+		return 1;
+	}
+
+	const FONT_ENTRY * e = font_by_name(src);
+	if (e == NULL) { fprintf(stderr, "sdfgen: unknown font %s\n", src); return 1; }
+
+	size_t size;
+	uint8_t * font = sdf_build(e->data, (uint8_t)line, (uint8_t)spread, &size);
+	uint8_t * out = font;
+	size_t out_size = size;
+	if (compress) {
+		out = malloc(rc_bound(size));
+		out_size = rc_compress(font, size, out);
+	}
+
+	FILE * fo = fopen(out_path, (cname) ? "w" : "wb");
+	if (fo == NULL) { fprintf(stderr, "sdfgen: can not write %s\n", out_path); return 1; }
+	if (cname) {
+		fprintf(fo, "// Generated by sdfgen from %s - line %d, spread %d, %zu bytes\n\n#include <stdint.h>\n\n", src, line, spread, out_size);
+		fprintf(fo, "const uint8_t %s[%zu] __attribute__((aligned(4))) = {", cname, out_size);
+		for (size_t i = 0; i < out_size; i++) fprintf(fo, "%s0x%02X,", (i % 16) ? " " : "\n\t", out[i]);
+		fprintf(fo, "\n};\n");
+	} else if (fwrite(out, 1, out_size, fo) != out_size) {
+		fprintf(stderr, "sdfgen: can not write %s\n", out_path);
+		return 1;
+	}
+	fclose(fo);
+
+	// Bitmap fonts of same face (name suffix after size)
+	const char * face = strrchr(src, '_');
+	size_t face_size = 0;
+	int faces = 0;
+	for (size_t i = 0; i < FONT_COUNT; i++) {
+		const char * f = strrchr(fonts[i].name, '_');
+		if ((face) && (f) && (strcmp(f, face) == 0)) { face_size += fonts[i].size; faces++; }
+	}
+
+	printf("%s: line %d, spread %d, %zu bytes", out_path, line, spread, size);
+	if (compress) printf(" (%zu compressed)", out_size);
+	printf(", %d bitmap sizes of face: %zu bytes\n", faces, face_size);
+
+	if (out != font) free(out);
+	free(font);
+	return 0;
+}
@@ -0,0 +1,59 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Splits tile map into pack entries of Inc/TileMap.h (header with
+ * animations, tileset, chunks). Entries are passed to callback, so
+ * they can be written as files for respack or into pack directly.
+ *******************************************************************/
+
+#ifndef TM_ENC_H_
+#define TM_ENC_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "TileMap.h"
+
+typedef void (* TM_EMIT)(const char * name, const void * data, size_t size, void * ctx);
+
+// layers[l] - hdr->width x hdr->height tiles of layer l. Chunks with all tiles empty are
+// not emitted (TM_Open treats them as empty). Returns number of chunks emitted.
+static inline uint32_t tm_encode(const char * name, const TM_HEADER * hdr, const TM_ANIM * anims,
+		const uint16_t * const * layers, const uint8_t * tileset, size_t tileset_size, TM_EMIT emit, void * ctx) {
+	char entry[256];
+	size_t hsize = sizeof(TM_HEADER) + hdr->anims * sizeof(TM_ANIM);
+	uint8_t * head = malloc(hsize);
+	memcpy(head, hdr, sizeof(TM_HEADER));
+	memcpy(head + sizeof(TM_HEADER), anims, hdr->anims * sizeof(TM_ANIM));
+	emit(name, head, hsize, ctx);
+	free(head);
+
+	snprintf(entry, sizeof(entry), "%s.tiles", name);
+	emit(entry, tileset, tileset_size, ctx);
+
+	uint32_t n = hdr->chunk, cells = n * n, emitted = 0;
+	uint16_t * chunk = malloc(cells * hdr->layers * 2);
+	for (uint32_t cy = 0; cy * n < hdr->height; cy++) {
+		for (uint32_t cx = 0; cx * n < hdr->width; cx++) {
+			uint32_t used = 0;
+			for (uint32_t l = 0; l < hdr->layers; l++) {
+				for (uint32_t y = 0; y < n; y++) {
+					for (uint32_t x = 0; x < n; x++) {
+						uint32_t tx = cx * n + x, ty = cy * n + y;
+						uint16_t t = ((tx < hdr->width) && (ty < hdr->height)) ? layers[l][ty * hdr->width + tx] : TM_EMPTY;
+						chunk[l * cells + y * n + x] = t;
+						used |= t;
+					}
+				}
+			}
+			if (!used) continue;
+			snprintf(entry, sizeof(entry), "%s.%u.%u", name, cx, cy);
+			emit(entry, chunk, cells * hdr->layers * 2, ctx);
+			emitted++;
+		}
+	}
+	free(chunk);
+	return emitted;
+}
+
+#endif /* TM_ENC_H_ */
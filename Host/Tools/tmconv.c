@@ -0,0 +1,156 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Converts tile map layers exported as CSV (e.g. Tiled "CSV" layer
+ * format, 0 - empty, 1 - first tile) and tileset image (imgconv) to
+ * entries for TM_Open, written as files for respack.
+ *
+ *   tmconv -n name -t tileset.img [-s 16x16] [-c 32] [-b aarrggbb]
+ *          [-a tile:frames:ticks ...] [-o dir] layer.csv ...
+ *
+ * Layers are listed from bottom. -c sets chunk size in cells (power
+ * of 2), -a adds animation of consecutive tiles. Pack then with:
+ *   respack -o world.pak -z dir/name dir/name.tiles dir/name.*.*
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BSP_Driver.h"
+#include "tm_enc.h"
+
+static uint8_t * read_file(const char * path, size_t * size) {
+	FILE * f = fopen(path, "rb");
+	if (f == NULL) return NULL;
+	fseek(f, 0, SEEK_END);
+	*size = (size_t)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t * data = malloc(*size + 1);
+	if (fread(data, 1, *size, f) != *size) { free(data); data = NULL; }
+	else data[*size] = 0;
+	fclose(f);
+	return data;
+}
+
+// Reads CSV layer, sets width / height from first layer and checks following ones
+static uint16_t * read_csv(const char * path, uint16_t * width, uint16_t * height) {
+	size_t size;
+	char * text = (char *)read_file(path, &size);
+	if (text == NULL) { fprintf(stderr, "tmconv: can not read %s\n", path); return NULL; }
+
+	size_t cap = 1024, n = 0;
+	uint32_t w = 0, h = 0, row = 0;
+	uint16_t * tiles = malloc(cap * 2);
+	for (char * p = text; *p;) {
+		if ((*p >= '0') && (*p <= '9')) {
+			unsigned long v = strtoul(p, &p, 10);
+			if (n == cap) tiles = realloc(tiles, (cap *= 2) * 2);
+			tiles[n++] = (uint16_t)v;
+			row++;
+		} else {
+			if ((*p == '\n') && (row)) {
+				if (w == 0) w = row;
+				if (row != w) { fprintf(stderr, "tmconv: %s row %u has %u tiles (expected %u)\n", path, h + 1, row, w); free(text); free(tiles); return NULL; }
+				h++;
+				row = 0;
+			}
+			p++;
+		}
+	}
+	if (row) {
+		if (w == 0) w = row;
+		if (row != w) { fprintf(stderr, "tmconv: %s last row has %u tiles\n", path, row); free(text); free(tiles); return NULL; }
+		h++;
+	}
+	free(text);
+	if ((w == 0) || (w > 0xFFFF) || (h > 0xFFFF) || ((*width) && ((w != *width) || (h != *height)))) {
+		fprintf(stderr, "tmconv: %s has size %ux%u\n", path, w, h);
+		free(tiles);
+		return NULL;
+	}
+	*width = (uint16_t)w;
+	*height = (uint16_t)h;
+	return tiles;
+}
+
+static void emit_file(const char * name, const void * data, size_t size, void * ctx) {
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", (const char *)ctx, name);
+	FILE * f = fopen(path, "wb");
+	if ((f == NULL) || (fwrite(data, 1, size, f) != size)) { fprintf(stderr, "tmconv: can not write %s\n", path); exit(1); }
+	fclose(f);
+}
+
+int main(int argc, char ** argv) {
+	const char * name = NULL, * tileset = NULL, * dir = ".";
+	TM_HEADER hdr;
+	TM_ANIM anim[TM_MAX_ANIMS];
+	int opt;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TM_MAGIC;
+	hdr.version = TM_VERSION;
+	hdr.chunk = 32;
+	hdr.tile_w = 16;
+	hdr.tile_h = 16;
+	hdr.bgcolor = 0xFF000000;
+	while ((opt = getopt(argc, argv, "n:t:s:c:b:a:o:")) != -1) {
+		unsigned a, b, c;
+		switch (opt) {
+		case 'n': name = optarg; break;
+		case 't': tileset = optarg; break;
+		case 's':
+			if (sscanf(optarg, "%ux%u", &a, &b) != 2) goto usage;
+			hdr.tile_w = (uint16_t)a;
+			hdr.tile_h = (uint16_t)b;
+			break;
+		case 'c': hdr.chunk = (uint8_t)atoi(optarg); break;
+		case 'b': hdr.bgcolor = (uint32_t)strtoul(optarg, NULL, 16); break;
+		case 'a':
+			if ((sscanf(optarg, "%u:%u:%u", &a, &b, &c) != 3) || (hdr.anims == TM_MAX_ANIMS)) goto usage;
+			anim[hdr.anims].tile = (uint16_t)a;
+			anim[hdr.anims].frames = (uint8_t)b;
+			anim[hdr.anims].ticks = (uint8_t)c;
+			hdr.anims++;
+			break;
+		case 'o': dir = optarg; break;
+		default: goto usage;
+		}
+	}
+	hdr.layers = (uint8_t)(argc - optind);
+	if ((name == NULL) || (tileset == NULL) || (hdr.layers == 0) || (hdr.layers > TM_MAX_LAYERS) ||
+		(hdr.chunk == 0) || (hdr.chunk & (hdr.chunk - 1)) || (hdr.tile_w == 0) || (hdr.tile_h == 0)) goto usage;
+
+	size_t set_size;
+	uint8_t * set = read_file(tileset, &set_size);
+	uint16_t set_w = 0, set_h = 0;
+	if (set) {
+		memcpy(&set_w, set, 2);
+		memcpy(&set_h, set + 2, 2);
+	}
+	if ((set == NULL) || (set_size < 4 + (size_t)set_w * set_h * 4) || (set_w < hdr.tile_w) || (set_h < hdr.tile_h)) {
+		fprintf(stderr, "tmconv: %s is not uncompressed imgconv image\n", tileset);
+		return 1;
+	}
+	uint32_t tiles = (uint32_t)(set_w / hdr.tile_w) * (set_h / hdr.tile_h);
+
+	uint16_t * layers[TM_MAX_LAYERS];
+	for (uint8_t l = 0; l < hdr.layers; l++) {
+		layers[l] = read_csv(argv[optind + l], &hdr.width, &hdr.height);
+		if (layers[l] == NULL) return 1;
+		for (uint32_t i = 0; i < (uint32_t)hdr.width * hdr.height; i++) {
+			if (layers[l][i] > tiles) { fprintf(stderr, "tmconv: %s uses tile %u, tileset has %u\n", argv[optind + l], layers[l][i], tiles); return 1; }
+		}
+	}
+
+	uint32_t chunks = tm_encode(name, &hdr, anim, (const uint16_t * const *)layers, set, set_size, emit_file, (void *)dir);
+	uint32_t all = (uint32_t)((hdr.width + hdr.chunk - 1) / hdr.chunk) * ((hdr.height + hdr.chunk - 1) / hdr.chunk);
+	printf("%s: %ux%u cells, %u layers, %u tiles, %u of %u chunks (%u bytes each), %u anims\n", name, hdr.width, hdr.height,
+		hdr.layers, tiles, chunks, all, hdr.chunk * hdr.chunk * hdr.layers * 2, hdr.anims);
+	return 0;
+
+usage:
+	fprintf(stderr, "usage: tmconv -n name -t tileset.img [-s 16x16] [-c 32] [-b aarrggbb] [-a tile:frames:ticks ...] [-o dir] layer.csv ...\n");
+	return 1;
+}
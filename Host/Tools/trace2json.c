@@ -0,0 +1,117 @@
+/*****************************************************************
+ * MiniConsole V3 - Host tools
+ *
+ * Converts binary trace stream (Inc/Trace.h) captured from USB CDC
+ * to Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ *   trace2json trace.bin [out.json]
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BSP_Driver.h"
+#include "Trace.h"
+
+static char names[256][256];
+static FILE * out;
+static uint8_t first = 1;
+
+static const char * name_of(uint8_t id) {
+	static char tmp[16];
+	if (names[id][0]) return names[id];
+	snprintf(tmp, sizeof(tmp), "id%u", id);
+	return tmp;
+}
+
+static void emit(const char * fmt_name, const char * ph, double ts, const char * extra) {
+	fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":0%s}", (first) ? "" : ",", fmt_name, ph, ts, extra);
+	first = 0;
+}
+
+int main(int argc, char ** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: trace2json trace.bin [out.json]\n");
+		return 1;
+	}
+	FILE * f = fopen(argv[1], "rb");
+	if (f == NULL) { fprintf(stderr, "trace2json: can not read %s\n", argv[1]); return 1; }
+	out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+	if (out == NULL) { fprintf(stderr, "trace2json: can not write %s\n", argv[2]); return 1; }
+
+	double cycles_per_us = 1.0;
+	uint64_t base = 0;				// Added to 32-bit timestamps after wrap
+	uint32_t last = 0;
+	uint8_t started = 0;
+	uint32_t records = 0, dropped = 0, underruns = 0;
+	uint32_t w[2];
+	char extra[96];
+
+	fprintf(out, "{\"traceEvents\":[");
+	while (fread(w, 4, 2, f) == 2) {
+		uint8_t type = w[0] & 0xFF;
+		uint8_t id = (w[0] >> 8) & 0xFF;
+		uint16_t aux = w[0] >> 16;
+		uint32_t value = 0;
+
+		if (type == TRACE_REC_NAME) {
+			uint32_t words = (aux + 3u) / 4u;
+			char buf[260] = { 0 };
+			if (fread(buf, 4, words, f) != words) break;
+			memcpy(names[id], buf, aux);
+			names[id][aux] = 0;
+			continue;
+		}
+		if ((type == TRACE_REC_COUNTER) || (type == TRACE_REC_EVENT) || (type == TRACE_REC_DROPPED)) {
+			if (fread(&value, 4, 1, f) != 1) break;
+		}
+		if (type == TRACE_REC_START) {
+			cycles_per_us = (w[1]) ? (double)w[1] : 1.0;
+			base = 0;
+			last = 0;
+			started = 1;
+			continue;
+		}
+		if (!started) continue;
+
+		// Timestamps are 32-bit cycle counter - assume stream is in time order
+		if (w[1] < last) base += 0x100000000ull;
+		last = w[1];
+		double ts = (double)(base + w[1]) / cycles_per_us;
+		records++;
+
+		switch (type) {
+		case TRACE_REC_BEGIN:	emit(name_of(id), "B", ts, ""); break;
+		case TRACE_REC_END:		emit(name_of(id), "E", ts, ""); break;
+		case TRACE_REC_COUNTER:
+			snprintf(extra, sizeof(extra), ",\"args\":{\"value\":%d}", (int32_t)value);
+			emit(name_of(id), "C", ts, extra);
+			break;
+		case TRACE_REC_EVENT:
+			snprintf(extra, sizeof(extra), ",\"s\":\"t\",\"args\":{\"arg\":%u}", value);
+			emit(name_of(id), "i", ts, extra);
+			break;
+		case TRACE_REC_FRAME:
+			snprintf(extra, sizeof(extra), ",\"s\":\"g\",\"args\":{\"frame\":%u}", aux);
+			emit("frame", "i", ts, extra);
+			break;
+		case TRACE_REC_DROPPED:
+			dropped += value;
+			snprintf(extra, sizeof(extra), ",\"s\":\"g\",\"args\":{\"records\":%u}", value);
+			emit("dropped", "i", ts, extra);
+			break;
+		case TRACE_REC_UNDERRUN:
+			underruns++;
+			snprintf(extra, sizeof(extra), ",\"s\":\"g\",\"args\":{\"count\":%u}", aux);
+			emit("audio underrun", "i", ts, extra);
+			break;
+		default:
+			fprintf(stderr, "trace2json: unknown record type %u - stream corrupted\n", type);
+			fprintf(out, "\n]}\n");
+			return 1;
+		}
+	}
+	fprintf(out, "\n]}\n");
+	fprintf(stderr, "trace2json: %u records, %u dropped on device, %u audio underruns\n", records, dropped, underruns);
+	return 0;
+}
@@ -0,0 +1,49 @@
+/*****************************************************************
+ * MiniConsole V3 - Host application runner
+ *
+ * Runs app_init() and app_main() from Src/main.c on top of host
+ * BSP stand-in and reports per call and per frame statistics.
+ *
+ * Usage: app_host [-d rootdir] [-f frames] [-v vsync_hz] [-o frame.ppm] [-c cdc.bin] [-q]
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "BSP_Host.h"
+
+extern void app_init(void);
+extern void app_main(void);
+
+int main(int argc, char ** argv) {
+	const char * outfile = NULL;
+	int opt;
+
+	Host_Config.frames = 100;
+
+	while ((opt = getopt(argc, argv, "d:f:v:o:c:q")) != -1) {
+		switch (opt) {
+		case 'd': Host_Config.rootdir = optarg; break;
+		case 'f': Host_Config.frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'v': Host_Config.vsync_hz = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 'o': outfile = optarg; break;
+		case 'c': Host_Config.cdc_file = optarg; break;
+		case 'q': Host_Config.quiet = 1; break;
+		default:
+			fprintf(stderr, "Usage: %s [-d rootdir] [-f frames] [-v vsync_hz] [-o frame.ppm] [-c cdc.bin] [-q]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	Host_Init();
+	Host_Run(app_init, app_main);
+	Host_PrintStats();
+
+	if ((outfile) && (Host_SaveFrame(outfile) != BSP_OK)) {
+		fprintf(stderr, "Cannot write %s\n", outfile);
+		return 1;
+	}
+	return 0;
+}
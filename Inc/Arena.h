@@ -0,0 +1,78 @@
+/*****************************************************************
+ * MiniConsole V3 - Arena and Pool Allocators
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Arena - linear allocator carved from one Res_Alloc block (or from
+ * static buffer, e.g. DTC_MRAM). Memory is released in O(1) by
+ * returning to mark taken earlier (level, frame scope).
+ * Pool - fixed size objects with O(1) alloc/free (particles,
+ * entities). Pool storage can come from arena.
+ * Both report high-water mark, which helps to size Res_Init region.
+ *
+ * Usage:
+ * 	static ARENA level;
+ * 	Arena_Init(&level, 4 * 1024 * 1024);
+ * 	ARENA_MARK m = Arena_GetMark(&level);
+ * 	map = Arena_Alloc(&level, map_size);
+ * 	...
+ * 	Arena_Release(&level, m);			// whole level freed
+ *******************************************************************/
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include "BSP_Driver.h"
+
+#define ARENA_ALIGN			8			// Default alignment
+
+typedef uint32_t ARENA_MARK;
+
+typedef struct {
+	uint8_t *	base;
+	uint32_t	size;
+	uint32_t	top;				// Used bytes
+	uint32_t	high_water;			// Maximum of top
+	uint32_t	failed;				// Allocations which did not fit
+	uint8_t		owned;				// Memory allocated with Res_Alloc
+} ARENA;
+
+typedef struct {
+	uint8_t *	base;
+	void *		free_list;
+	uint32_t	obj_size;
+	uint32_t	count;
+	uint32_t	used;
+	uint32_t	high_water;
+	uint8_t		owned;
+} POOL;
+
+// Arena
+uint8_t Arena_Init(ARENA * a, uint32_t size);
+void Arena_InitStatic(ARENA * a, void * mem, uint32_t size);
+void Arena_Destroy(ARENA * a);
+void * Arena_Alloc(ARENA * a, uint32_t size);
+void * Arena_AllocAligned(ARENA * a, uint32_t size, uint32_t align);
+void * Arena_Calloc(ARENA * a, uint32_t size);
+ARENA_MARK Arena_GetMark(const ARENA * a);
+void Arena_Release(ARENA * a, ARENA_MARK mark);
+void Arena_Reset(ARENA * a);
+uint32_t Arena_GetUsed(const ARENA * a);
+uint32_t Arena_GetFree(const ARENA * a);
+uint32_t Arena_GetHighWater(const ARENA * a);
+
+// Pool
+uint8_t Pool_Init(POOL * p, uint32_t obj_size, uint32_t count, ARENA * a);
+void Pool_Destroy(POOL * p);
+void * Pool_Alloc(POOL * p);
+void Pool_Free(POOL * p, void * obj);
+void Pool_Reset(POOL * p);
+uint32_t Pool_GetUsed(const POOL * p);
+uint32_t Pool_GetHighWater(const POOL * p);
+
+#endif /* ARENA_H_ */
@@ -19,6 +19,7 @@
 
 // Driver constants
 #define DTC_MRAM	__attribute__((section(".dtc_mram")))
+#define DTC_BSS		__attribute__((section(".dtc_bss")))		// Zero initialised, not stored in flash
 #define ITC_MRAM	__attribute__((section(".itc_mram")))
 #define SH0_RAM		__attribute__((section(".sh0_ram")))
 #define SH1_RAM		__attribute__((section(".sh1_ram")))
@@ -0,0 +1,89 @@
+/*****************************************************************
+ * MiniConsole V3 - Dirty Rectangles
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Tracks areas touched by G2D calls and carries unchanged areas
+ * forward from previous frame, so frame does not have to be cleared
+ * and fully redrawn every time.
+ *
+ * Usage:
+ * 	DR_Init(LCD_COLOR_MODE_RGB888, LCD_BUFFER_MODE_DOUBLE);
+ * 	while (1) {
+ * 		while (!BSP->LCD_GetEditPermission()) continue;
+ * 		DR_BeginFrame();			// edit frame = previous frame
+ * 		DR_DrawFillRect(...);		// erase old object position
+ * 		DR_TextBlend(...);			// draw new content
+ * 		DR_EndFrame();
+ * 		BSP->LCD_FrameReady();
+ * 	}
+ *******************************************************************/
+
+#ifndef DIRTYRECT_H_
+#define DIRTYRECT_H_
+
+#include "BSP_Driver.h"
+
+#define DR_MAX_RECTS		32		// Rectangles tracked per frame (merged when exceeded)
+#define DR_MAX_HISTORY		2		// Previous frames kept (triple buffering needs 2)
+#define DR_FULL_COPY_PCT	60		// Copy whole frame if carried area exceeds this percentage
+
+typedef struct {
+	int16_t		x;
+	int16_t		y;
+	uint16_t	w;
+	uint16_t	h;
+} DR_RECT;
+
+typedef struct {
+	uint32_t	rects;				// Rectangles after merging (current frame)
+	uint32_t	dirty_pixels;		// Area marked dirty in current frame
+	uint32_t	copied_pixels;		// Area carried forward from previous frame
+	uint32_t	full_copies;		// Frames where whole previous frame was copied
+	uint32_t	merges;				// Rectangles merged in current frame
+} DR_STATS;
+
+// Frame control
+void DR_Init(uint8_t color_mode, uint8_t buffer_mode);
+void DR_BeginFrame(void);
+void DR_EndFrame(void);
+void DR_Invalidate(int16_t x, int16_t y, uint16_t width, uint16_t height);
+void DR_InvalidateAll(void);
+uint8_t DR_GetRects(const DR_RECT ** rects);
+const DR_STATS * DR_GetStats(void);
+
+// Tracked G2D calls (same parameters as BSP->G2D_*)
+void DR_ClearFrame(void);
+void DR_FillFrame(uint32_t color);
+void DR_DrawPixel(int16_t x, int16_t y, uint32_t color);
+void DR_DrawHLine(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DR_DrawHLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DR_DrawVLine(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DR_DrawVLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DR_DrawLine(int16_t X1, int16_t Y1, int16_t X2, int16_t Y2, uint32_t color);
+void DR_DrawRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color);
+void DR_DrawFillRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color);
+void DR_DrawFillRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color);
+void DR_DrawCircle(int16_t x, int16_t y, uint16_t r, uint32_t color);
+void DR_DrawFillCircle(int16_t x, int16_t y, uint16_t r, uint32_t color);
+void DR_DrawFillCircleBlend(int16_t x, int16_t y, uint16_t r, uint32_t color);
+void DR_DrawRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color);
+void DR_DrawFillRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color);
+void DR_DrawFillRoundRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color);
+uint16_t DR_Text(int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color, uint32_t bgcolor);
+uint16_t DR_TextBlend(int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color);
+void DR_DrawBitmap(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height);
+void DR_DrawBitmapC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height);
+void DR_DrawBitmapBlend(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha);
+void DR_DrawBitmapBlendC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha);
+void DR_DrawIcon(const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor);
+void DR_DrawIconBlend(const void * iconsource, int16_t x, int16_t y, uint32_t color);
+void DR_CopyBuf(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height);
+void DR_CopyBufBlend(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height, uint8_t alpha);
+
+#endif /* DIRTYRECT_H_ */
@@ -0,0 +1,150 @@
+/*****************************************************************
+ * MiniConsole V3 - Display List
+ *
+ * Author: Marek Ryn
+ * Version: 1.1
+ *
+ * Changelog:
+ *
+ * - 1.1	- Tiled render mode (DL_SetTiled, TileRender.h)
+ * - 1.0	- First release
+ *******************************************************************
+ * Records G2D draw commands for a frame and replays them through BSP
+ * after optimisation:
+ *  - commands fully covered by later opaque commands are culled,
+ *  - non-overlapping commands are grouped by type and sorted by
+ *    position (drawing order of overlapping commands is kept),
+ *  - adjacent fills of the same colour are merged into one.
+ * Last optimised list is kept and can be replayed into next edit
+ * frame without running application drawing code again.
+ *
+ * Usage:
+ * 	if (scene_changed) {
+ * 		DL_Begin();
+ * 		DL_DrawFillRect(...);
+ * 		DL_TextBlend(...);
+ * 		DL_End();					// optimise and execute
+ * 	} else {
+ * 		DL_Replay();				// execute cached list
+ * 	}
+ *
+ * With DL_SetTiled(1) optimised list is rasterised by TileRender
+ * into on-chip tile buffers and every tile is written to frame
+ * once, instead of issuing BSP calls into frame buffer.
+ *
+ * Data passed by pointer (fonts, bitmaps, icons, buffers) must stay
+ * valid as long as the list is cached. Strings are copied.
+ *******************************************************************/
+
+#ifndef DISPLAYLIST_H_
+#define DISPLAYLIST_H_
+
+#include "BSP_Driver.h"
+
+#define DL_MAX_CMDS			256		// Commands per frame (list is flushed when exceeded)
+#define DL_STR_POOL_SIZE	2048	// Bytes for copied strings per frame
+
+// Recorded commands - read by TileRender when list is rasterised in tiles
+
+// Command types (order defines batch priority only inside non-overlapping groups)
+#define DL_CMD_CLEAR				0
+#define DL_CMD_FILLFRAME			1
+#define DL_CMD_PIXEL				2
+#define DL_CMD_HLINE				3
+#define DL_CMD_HLINE_BLEND			4
+#define DL_CMD_VLINE				5
+#define DL_CMD_VLINE_BLEND			6
+#define DL_CMD_LINE					7
+#define DL_CMD_RECT					8
+#define DL_CMD_FILLRECT				9
+#define DL_CMD_FILLRECT_BLEND		10
+#define DL_CMD_CIRCLE				11
+#define DL_CMD_FILLCIRCLE			12
+#define DL_CMD_FILLCIRCLE_BLEND		13
+#define DL_CMD_ROUNDRECT			14
+#define DL_CMD_FILLROUNDRECT		15
+#define DL_CMD_FILLROUNDRECT_BLEND	16
+#define DL_CMD_TEXT					17
+#define DL_CMD_TEXT_BLEND			18
+#define DL_CMD_BITMAP				19
+#define DL_CMD_BITMAP_BLEND			20
+#define DL_CMD_ICON					21
+#define DL_CMD_ICON_BLEND			22
+#define DL_CMD_COPYBUF				23
+#define DL_CMD_COPYBUF_BLEND		24
+
+#define DL_FLAG_OPAQUE				0x01	// Command overwrites every pixel of its bounding box
+#define DL_FLAG_CULLED				0x02
+
+typedef struct {
+	int16_t		x;					// Bounding box clipped to screen
+	int16_t		y;
+	int16_t		w;
+	int16_t		h;
+} DL_BOX;
+
+typedef struct {
+	uint8_t		type;
+	uint8_t		flags;
+	uint8_t		alpha;
+	int16_t		x;					// Call parameters
+	int16_t		y;
+	int16_t		w;					// Width / length / X2
+	int16_t		h;					// Height / Y2
+	uint16_t	p;					// Radius / offsline
+	uint32_t	color;
+	uint32_t	bgcolor;
+	const void *src;				// Font / bitmap / icon / buffer
+	const char *str;
+	DL_BOX		box;
+} DL_CMD;
+
+typedef struct {
+	uint32_t	submitted;			// Commands recorded
+	uint32_t	culled;				// Commands removed as fully covered
+	uint32_t	merged;				// Commands merged into neighbouring fill
+	uint32_t	reordered;			// Commands moved to join batch of same type
+	uint32_t	executed;			// BSP calls issued
+	uint32_t	flushes;			// Early flushes caused by full list
+	uint32_t	replays;			// Frames replayed from cache (cumulative)
+} DL_STATS;
+
+// List control
+void DL_Begin(void);
+uint8_t DL_End(void);
+uint8_t DL_Replay(void);
+uint8_t DL_IsCached(void);
+void DL_Invalidate(void);
+const DL_STATS * DL_GetStats(void);
+void DL_SetTiled(uint8_t enable);
+
+// Recorded G2D calls (same parameters as BSP->G2D_*)
+void DL_ClearFrame(void);
+void DL_FillFrame(uint32_t color);
+void DL_DrawPixel(int16_t x, int16_t y, uint32_t color);
+void DL_DrawHLine(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DL_DrawHLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DL_DrawVLine(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DL_DrawVLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color);
+void DL_DrawLine(int16_t X1, int16_t Y1, int16_t X2, int16_t Y2, uint32_t color);
+void DL_DrawRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color);
+void DL_DrawFillRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color);
+void DL_DrawFillRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color);
+void DL_DrawCircle(int16_t x, int16_t y, uint16_t r, uint32_t color);
+void DL_DrawFillCircle(int16_t x, int16_t y, uint16_t r, uint32_t color);
+void DL_DrawFillCircleBlend(int16_t x, int16_t y, uint16_t r, uint32_t color);
+void DL_DrawRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color);
+void DL_DrawFillRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color);
+void DL_DrawFillRoundRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color);
+uint16_t DL_Text(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, uint32_t bgcolor);
+uint16_t DL_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color);
+void DL_DrawBitmap(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height);
+void DL_DrawBitmapC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height);
+void DL_DrawBitmapBlend(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha);
+void DL_DrawBitmapBlendC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha);
+void DL_DrawIcon(const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor);
+void DL_DrawIconBlend(const void * iconsource, int16_t x, int16_t y, uint32_t color);
+void DL_CopyBuf(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height);
+void DL_CopyBufBlend(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height, uint8_t alpha);
+
+#endif /* DISPLAYLIST_H_ */
@@ -0,0 +1,109 @@
+/*****************************************************************
+ * MiniConsole V3 - Font Access
+ *
+ * Author: Marek Ryn
+ * Version: 1.2
+ *
+ * Changelog:
+ *
+ * - 1.2	- Font_TextIcons (glyphs drawn by custom icon function)
+ * - 1.1	- Unicode font format (v2), UTF-8 text, kerning, fallback fonts
+ * - 1.0	- First release
+ *******************************************************************
+ * Font layout v1 (fonts.c, ASCII only):
+ *  [0]		- height
+ *  [1]		- advance of space and unsupported characters
+ *  [2..]	- 95 x uint16 (LE) offsets of glyphs '!'..'~', last one
+ *			  marks end of font data
+ *
+ * Font layout v2 (Host/Tools/fontgen, Unicode BMP), little endian:
+ *  [0]		- 0 (v1 fonts start with height, never 0)
+ *  [1]		- version (2)
+ *  [2]		- height
+ *  [3]		- advance of space and missing glyphs
+ *  [4]		- uint16 glyph count
+ *  [6]		- uint16 kerning pair count
+ *  [8]		- uint32 offset of pages
+ *  [12]	- uint32 offset of glyph offsets (count + 1 x uint32, last
+ *			  one marks end of glyph data)
+ *  [16]	- uint32 offset of kerning keys (count x uint32,
+ *			  left glyph << 16 | right glyph, sorted), followed by
+ *			  count x int8 adjustments
+ *  [20]	- uint32 font size
+ *  [24]	- 256 x uint16 page directory for codepoint >> 8
+ *			  (0 - no glyphs, n - page n-1)
+ * Page: 256 x uint16 for codepoint & 0xFF (0 - missing, n - glyph n-1).
+ * Lookup is O(1): directory -> page -> glyph offset.
+ *
+ * Glyph (both versions): [0] - advance width, followed by pixel
+ * stream (row major, advance width x height):
+ *  00nnnnnn - n transparent pixels, 11nnnnnn - n opaque pixels,
+ *  otherwise four pixels with 2-bit alpha (msb first).
+ *
+ * Text is UTF-8. Glyphs missing in font are taken from fallback
+ * chain (Font_SetFallback), centred vertically on line of first font.
+ * BSP->G2D_Text* accept only v1 fonts and ASCII - use Font_Text and
+ * Font_TextBlend (or GC_TextBlend/TS_TextBlend), which pass v1 ASCII
+ * text to BSP unchanged and draw other text glyph by glyph.
+ * Font_TextIcons passes decoded glyphs to own icon function instead
+ * of BSP (used by tiled renderer to draw into tile buffers).
+ *******************************************************************/
+
+#ifndef FONT_H_
+#define FONT_H_
+
+#include "BSP_Driver.h"
+
+#define FONT_FIRST_CHAR		33
+#define FONT_LAST_CHAR		126
+
+#define FONT_V2_VERSION		2
+#define FONT_V2_HEADER		24
+#define FONT_MAX_FALLBACKS	8
+#define FONT_MAX_GLYPH_PIXELS	8192	// Largest glyph drawn by Font_TextBlend (width x height)
+#define FONT_REPLACEMENT	0xFFFD		// Returned for malformed UTF-8
+
+// Glyph drawing function for Font_TextIcons (same parameters as BSP->G2D_DrawIconBlend)
+typedef void (* FONT_ICON_FN)(const void * iconsource, int16_t x, int16_t y, uint32_t color);
+
+// Decodes next UTF-8 codepoint and advances string pointer. ASCII takes single compare.
+static inline uint32_t Font_UTF8Next(const char ** str) {
+	const uint8_t * s = (const uint8_t *)*str;
+	uint32_t c = s[0];
+
+	if (c < 0x80) {
+		*str += 1;
+		return c;
+	}
+	if (((c & 0xE0) == 0xC0) && ((s[1] & 0xC0) == 0x80)) {
+		*str += 2;
+		return ((c & 0x1F) << 6) | (s[1] & 0x3F);
+	}
+	if (((c & 0xF0) == 0xE0) && ((s[1] & 0xC0) == 0x80) && ((s[2] & 0xC0) == 0x80)) {
+		*str += 3;
+		return ((c & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+	}
+	if (((c & 0xF8) == 0xF0) && ((s[1] & 0xC0) == 0x80) && ((s[2] & 0xC0) == 0x80) && ((s[3] & 0xC0) == 0x80)) {
+		*str += 4;
+		return ((c & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+	}
+	*str += 1;
+	return FONT_REPLACEMENT;
+}
+
+uint8_t Font_IsUnicode(const uint8_t *font);
+uint8_t Font_GetHeight(const uint8_t *font);
+uint8_t Font_HasGlyph(const uint8_t *font, uint32_t cp);
+uint8_t Font_GetCharWidth(const uint8_t *font, char ch);
+uint8_t Font_GetCodepointWidth(const uint8_t *font, uint32_t cp);
+int8_t Font_GetKerning(const uint8_t *font, uint32_t left, uint32_t right);
+uint16_t Font_GetTextWidth(const uint8_t *font, const char *str);
+uint16_t Font_GetTextWidthN(const uint8_t *font, const char *str, uint16_t len);
+uint8_t Font_DecodeGlyph(const uint8_t *font, char ch, uint8_t *mask);
+uint8_t Font_DecodeCodepoint(const uint8_t *font, uint32_t cp, uint8_t *mask);
+uint16_t Font_TextIcons(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, int16_t x0, int16_t x1, FONT_ICON_FN draw);
+uint16_t Font_Text(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, uint32_t bgcolor);
+uint16_t Font_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color);
+uint8_t Font_SetFallback(const uint8_t *font, const uint8_t *fallback);
+
+#endif /* FONT_H_ */
@@ -0,0 +1,67 @@
+/*****************************************************************
+ * MiniConsole V3 - Font Registry
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Keeps list of fonts used by application and where their data is:
+ *  - flash - array from fonts.c, referenced only when registered,
+ *    so fonts that are never registered or used directly are removed
+ *    by linker (each font has own .rodata.font_* section, link with
+ *    --gc-sections),
+ *  - file - loaded on first FontReg_Get with RC_Load (plain or
+ *    compressed, see Host/Tools/fontexport) into resource memory,
+ *  - copy - hot font promoted into arena (AXI SRAM or DTCM), so glyph
+ *    decoding does not read scattered bytes over QSPI.
+ * Each FontReg_Get is counted; FontReg_Report logs size, location
+ * and access count of every registered font.
+ *
+ * Usage:
+ * 	FR_FONT title = FontReg_AddFlash("verdana26", FONT_26_verdana, sizeof(FONT_26_verdana));
+ * 	FR_FONT big = FontReg_AddFile("verdana64", "fonts/FONT_64_verdana.fnt");
+ * 	FontReg_Promote(title, &axi_arena);
+ * 	...
+ * 	BSP->G2D_TextBlend(10, 10, FontReg_Get(big), "SCORE", color);
+ *******************************************************************/
+
+#ifndef FONTREG_H_
+#define FONTREG_H_
+
+#include "BSP_Driver.h"
+#include "Arena.h"
+
+#define FR_MAX_FONTS		32
+#define FR_INVALID			0xFF
+
+#define FR_LOC_NONE			0			// File font not loaded yet
+#define FR_LOC_FLASH		1
+#define FR_LOC_RES			2			// Loaded from file into resource memory
+#define FR_LOC_COPY			3			// Promoted copy in arena
+
+typedef uint8_t FR_FONT;
+
+typedef struct {
+	const char *	name;
+	const uint8_t *	flash;			// Data linked into flash (or NULL)
+	const char *	path;			// File with font data (or NULL)
+	const uint8_t *	data;			// Current data (NULL - not loaded)
+	uint32_t		size;
+	uint8_t			location;
+	uint32_t		accesses;		// FontReg_Get calls
+	uint32_t		loads;			// File loads (more than 1 - font was unloaded and loaded again)
+} FR_INFO;
+
+FR_FONT FontReg_AddFlash(const char *name, const uint8_t *data, uint32_t size);
+FR_FONT FontReg_AddFile(const char *name, const char *path);
+FR_FONT FontReg_Find(const char *name);
+const uint8_t * FontReg_Get(FR_FONT font);
+uint8_t FontReg_Promote(FR_FONT font, ARENA * arena);
+void FontReg_Unload(FR_FONT font);
+const FR_INFO * FontReg_GetInfo(FR_FONT font);
+void FontReg_Report(void);
+
+#endif /* FONTREG_H_ */
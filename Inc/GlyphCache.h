@@ -0,0 +1,54 @@
+/*****************************************************************
+ * MiniConsole V3 - Glyph Cache
+ *
+ * Author: Marek Ryn
+ * Version: 1.2
+ *
+ * Changelog:
+ *
+ * - 1.2	- GC_Release, DTCM buffers rejected (DMA2D can not read them)
+ * - 1.1	- Glyphs keyed by Unicode codepoint, UTF-8 text with kerning
+ * - 1.0	- First release
+ *******************************************************************
+ * Keeps decoded glyphs as A8 masks (icon layout: uint16 width,
+ * uint16 height, width x height alpha bytes) in fixed size slots
+ * with LRU replacement. Cached text is drawn glyph by glyph with
+ * G2D_DrawIconBlend, so packed font data is decoded only once.
+ *
+ * Slot size limits the largest glyph which can be cached
+ * (4 + width * height bytes). Larger glyphs are drawn with
+ * Font_TextBlend. Memory can be provided by application or allocated
+ * with Res_Alloc (freed by GC_Release or next GC_Init). It must be
+ * readable by DMA2D, so GC_Init rejects buffers in DTCM.
+ *
+ * Usage:
+ * 	GC_Init(NULL, 64 * 1024, 4 + 26 * 26);	// 96 slots in Res memory
+ * 	GC_TextBlend(10, 10, FONT_26_verdana, "SCORE", 0xFFFFFFFF);
+ *******************************************************************/
+
+#ifndef GLYPHCACHE_H_
+#define GLYPHCACHE_H_
+
+#include "BSP_Driver.h"
+
+#define GC_MAX_SLOTS		512		// Upper limit of cached glyphs
+#define GC_HASH_SIZE		256		// Hash buckets (power of 2)
+
+typedef struct {
+	uint32_t	hits;
+	uint32_t	misses;
+	uint32_t	evictions;
+	uint32_t	uncached;			// Glyphs too big for slot
+	uint16_t	slots;				// Slots available
+	uint16_t	used;				// Slots holding glyph
+} GC_STATS;
+
+uint8_t GC_Init(void * mem, uint32_t size, uint16_t slot_size);
+void GC_Release(void);
+void GC_Flush(void);
+const void * GC_GetGlyph(const uint8_t *font, uint32_t cp);
+uint16_t GC_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color);
+const GC_STATS * GC_GetStats(void);
+void GC_ResetStats(void);
+
+#endif /* GLYPHCACHE_H_ */
@@ -0,0 +1,114 @@
+/*****************************************************************
+ * MiniConsole V3 - Dual Core Jobs
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Offloads work (audio synthesis, physics, decompression, path
+ * finding) from CM7 to idle CM4 through two single-producer /
+ * single-consumer lock-free rings in SH1_RAM:
+ *  - request ring - CM7 posts jobs, CM4 takes them,
+ *  - completion ring - CM4 returns finished jobs, CM7 collects them.
+ * Block is placed at start of SH1_RAM (JOB_SHARED_ADDR, see .ld file),
+ * so CM4 image finds it at fixed address.
+ *
+ * Descriptors, head and tail indexes occupy separate 32-byte cache
+ * lines. On CM7 (D-cache) written lines are cleaned and lines written
+ * by other core are invalidated before reading. Job buffers follow
+ * descriptor flags:
+ *  - JOB_FLAG_CLEAN_IN - input buffer is cleaned before posting,
+ *  - JOB_FLAG_INV_OUT - output buffer is invalidated when job is
+ *    collected (buffer must be 32-byte aligned and padded).
+ * Buffers must be visible to both cores (SDRAM, AXI SRAM, SH0/SH1),
+ * not in DTCM/ITCM.
+ *
+ * CM7 usage:
+ * 	JOB_Init();
+ * 	JOB_DESC job = { .type = JOB_DECOMPRESS, .flags = JOB_FLAG_CLEAN_IN | JOB_FLAG_INV_OUT, ... };
+ * 	JOB_Post(&job);
+ * 	...
+ * 	while (JOB_Poll(&job)) ...			// job.result holds handler return value
+ *
+ * CM4 usage (compiled with JOB_CORE_CM4):
+ * 	JOB_RegisterHandler(JOB_DECOMPRESS, Decompress);
+ * 	while (1) if (!JOB_WorkerPoll()) __WFE();
+ *
+ * When CM4 is not running (JOB_WorkerAlive), CM7 may call
+ * JOB_WorkerPoll itself (e.g. as Sched task). Worker never waits for
+ * space in completion ring - it returns 0 and leaves job queued until
+ * JOB_Poll collects completions.
+ *******************************************************************/
+
+#ifndef JOB_H_
+#define JOB_H_
+
+#include "BSP_Driver.h"
+
+#define JOB_RING_SIZE		32			// Descriptors per ring (power of 2)
+#define JOB_MAX_TYPES		16
+#define JOB_CACHE_LINE		32
+#define JOB_SHARED_ADDR		0x38008000	// Start of SH1_RAM
+#define JOB_MAGIC			0x4A4F4253	// "JOBS"
+
+#define JOB_FLAG_CLEAN_IN	0x0001
+#define JOB_FLAG_INV_OUT	0x0002
+#define JOB_FLAG_NOHANDLER	0x8000		// Set by worker when type has no handler
+
+#define JOB_CACHE_ALIGNED	__attribute__((aligned(JOB_CACHE_LINE)))
+
+typedef struct {
+	uint16_t	type;
+	uint16_t	flags;
+	uint32_t	id;					// Sequence number assigned by JOB_Post
+	const void *in;
+	uint32_t	in_size;
+	void *		out;
+	uint32_t	out_size;
+	uint32_t	arg;
+	int32_t		result;				// Handler return value
+} JOB_CACHE_ALIGNED JOB_DESC;
+
+typedef struct {
+	volatile uint32_t	head JOB_CACHE_ALIGNED;		// Written by producer
+	volatile uint32_t	tail JOB_CACHE_ALIGNED;		// Written by consumer
+	JOB_DESC			slot[JOB_RING_SIZE];
+} JOB_RING;
+
+typedef struct {
+	volatile uint32_t	magic JOB_CACHE_ALIGNED;	// Written by CM7
+	volatile uint32_t	heartbeat JOB_CACHE_ALIGNED;	// Incremented by worker
+	JOB_RING			request;
+	JOB_RING			done;
+} JOB_SHARED;
+
+typedef int32_t (* JOB_HANDLER)(JOB_DESC * job);
+
+typedef struct {
+	uint32_t	posted;
+	uint32_t	completed;			// Completions collected by JOB_Poll
+	uint32_t	full;				// JOB_Post rejected - ring full
+	uint32_t	peak;				// Maximum jobs in flight
+	uint32_t	executed;			// Jobs run by JOB_WorkerPoll (worker side)
+} JOB_STATS;
+
+// Producer side (CM7)
+void JOB_Init(void);
+uint8_t JOB_Post(JOB_DESC * job);
+uint8_t JOB_Poll(JOB_DESC * job);
+uint32_t JOB_InFlight(void);
+uint8_t JOB_WorkerAlive(void);
+const JOB_STATS * JOB_GetStats(void);
+
+// Worker side (CM4 or CM7 fallback)
+void JOB_RegisterHandler(uint16_t type, JOB_HANDLER handler);
+uint8_t JOB_WorkerPoll(void);
+
+// Cache maintenance (no operation on CM4 and host)
+void JOB_CacheClean(const void * addr, uint32_t size);
+void JOB_CacheInvalidate(void * addr, uint32_t size);
+
+#endif /* JOB_H_ */
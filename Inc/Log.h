@@ -0,0 +1,113 @@
+/*****************************************************************
+ * MiniConsole V3 - Logging
+ *
+ * Author: Marek Ryn
+ * Version: 1.1
+ *
+ * Changelog:
+ *
+ * - 1.1	- Deferred formats restricted to integer conversions (no %p)
+ * - 1.0	- First release
+ *******************************************************************
+ * Log records are put into lock-free ring (safe from interrupts)
+ * and sent in large chunks by LOG_Drain, called from one place in
+ * main loop (e.g. after LCD_FrameReady).
+ *
+ * LOG_ERR/WRN/INF/DBG store only format id and integer arguments
+ * (deferred formatting). Text is produced in LOG_Drain (text output)
+ * or on PC by Host/Tools/logdec (binary output - format string is
+ * sent once, on first use). Arguments are stored as 32-bit integers:
+ * use %d %i %u %x %X %o %c only (with flags/width). Pointers (%p, %s)
+ * do not fit 32 bits on 64-bit host - format with other conversions
+ * is reported once as error and its records are not stored.
+ * LOG_Printf formats immediately and accepts any printf arguments.
+ *
+ * Levels above LOG_MAX_LEVEL and categories outside LOG_CATEGORIES
+ * are removed at compile time.
+ *
+ * Usage:
+ * 	LOG_SetOutput(LOG_SINK_CDC, LOG_FORMAT_BINARY);
+ * 	LOG_INF(LOG_CAT_RES, "loaded %u bytes in %u ms", size, time);
+ * 	...
+ * 	BSP->LCD_FrameReady();
+ * 	LOG_Drain(0);
+ *******************************************************************/
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include "BSP_Driver.h"
+
+#define LOG_BUFFER_WORDS	1024		// Ring size in 32-bit words (power of 2)
+#define LOG_MAX_FORMATS		128			// Distinct deferred format strings
+#define LOG_MAX_ARGS		8
+#define LOG_LINE_SIZE		128			// Longest formatted line
+
+// Levels
+#define LOG_LEVEL_ERR		0
+#define LOG_LEVEL_WRN		1
+#define LOG_LEVEL_INF		2
+#define LOG_LEVEL_DBG		3
+
+// Categories (bit mask)
+#define LOG_CAT_APP			0x01
+#define LOG_CAT_GFX			0x02
+#define LOG_CAT_RES			0x04
+#define LOG_CAT_AUDIO		0x08
+#define LOG_CAT_SYS			0x10
+#define LOG_CAT_STDOUT		0x80		// printf output
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL		LOG_LEVEL_INF
+#endif
+
+#ifndef LOG_CATEGORIES
+#define LOG_CATEGORIES		0xFF
+#endif
+
+// Output
+#define LOG_SINK_SERIAL		0
+#define LOG_SINK_CDC		1
+#define LOG_FORMAT_TEXT		0
+#define LOG_FORMAT_BINARY	1
+
+// Record header (ring and binary stream):
+//  [31] committed (ring only), [30:28] type, [27:26] level, [25:18] category,
+//  [17:14] argument count, [13:0] record length in words
+#define LOG_REC_DEFERRED	0			// header, tick, format id, args
+#define LOG_REC_TEXT		1			// header, tick, byte count, text
+#define LOG_REC_FORMAT		2			// header, format id, byte count, text (stream only)
+#define LOG_REC_DROPPED		3			// header, count (stream only)
+
+#define LOG_NOID			0xFFFF
+#define LOG_BADID			0xFFFE		// Format rejected (not integer only)
+
+#define LOG_DEFERRED(level, cat, fmt, ...)	do { \
+		if (((level) <= LOG_MAX_LEVEL) && ((cat) & LOG_CATEGORIES)) { \
+			static uint16_t log_id_ = LOG_NOID; \
+			const uint32_t log_args_[] = { 0, ##__VA_ARGS__ }; \
+			LOG_Write((level), (cat), &log_id_, (fmt), &log_args_[1], sizeof(log_args_) / sizeof(uint32_t) - 1); \
+		} \
+	} while (0)
+
+#define LOG_ERR(cat, fmt, ...)		LOG_DEFERRED(LOG_LEVEL_ERR, cat, fmt, ##__VA_ARGS__)
+#define LOG_WRN(cat, fmt, ...)		LOG_DEFERRED(LOG_LEVEL_WRN, cat, fmt, ##__VA_ARGS__)
+#define LOG_INF(cat, fmt, ...)		LOG_DEFERRED(LOG_LEVEL_INF, cat, fmt, ##__VA_ARGS__)
+#define LOG_DBG(cat, fmt, ...)		LOG_DEFERRED(LOG_LEVEL_DBG, cat, fmt, ##__VA_ARGS__)
+
+typedef struct {
+	uint32_t	records;			// Records written
+	uint32_t	dropped;			// Records lost because ring was full
+	uint32_t	sent;				// Bytes passed to sink
+	uint32_t	peak;				// Maximum ring fill in words
+} LOG_STATS;
+
+void LOG_SetOutput(uint8_t sink, uint8_t format);
+void LOG_Write(uint8_t level, uint8_t cat, uint16_t * id, const char *fmt, const uint32_t * args, uint32_t nargs);
+void LOG_Text(uint8_t level, uint8_t cat, const char *text, uint32_t len);
+void LOG_Printf(uint8_t level, uint8_t cat, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+void LOG_PutChar(char ch);
+uint32_t LOG_Drain(uint32_t max_bytes);
+const LOG_STATS * LOG_GetStats(void);
+
+#endif /* LOG_H_ */
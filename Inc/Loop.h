@@ -0,0 +1,76 @@
+/*****************************************************************
+ * MiniConsole V3 - Fixed Timestep Loop
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Game loop running simulation at fixed tick rate independent of
+ * rendering cost. Elapsed time is measured with DWT cycle counter
+ * and accumulated; update() is called once per whole tick and
+ * render() gets interpolation alpha (fraction of next tick, 0..65535)
+ * to blend between previous and current state.
+ *
+ * When simulation is behind and LCD_GetFrameTime exceeds frame budget,
+ * rendering is skipped (up to max_skip frames in a row) so updates
+ * can catch up. At most max_updates ticks are run per loop pass,
+ * remaining time is dropped (simulation slows down instead of
+ * spiralling).
+ *
+ * Deterministic mode ignores wall clock - every rendered frame
+ * advances simulation by exactly det_ticks ticks with alpha 0, so runs
+ * can be replayed bit-exactly (e.g. on host with recorded input).
+ * Ticks are never dropped there: when det_ticks > max_updates, ticks
+ * above limit are carried over and run in following passes.
+ *
+ * Loop_Init rejects config with tick_hz, max_updates or det_ticks
+ * (deterministic mode) equal to 0 or without callbacks; Loop_Run then
+ * returns immediately.
+ * Simulation time should be taken from Loop_GetTick, not GetTick.
+ *
+ * Usage:
+ * 	static const LOOP_CONFIG cfg = { .tick_hz = 120, .max_updates = 8,
+ * 		.max_skip = 2, .budget_ms = 17, .update = Update, .render = Render };
+ * 	Loop_Init(&cfg);
+ * 	Loop_Run();							// does not return
+ *******************************************************************/
+
+#ifndef LOOP_H_
+#define LOOP_H_
+
+#include "BSP_Driver.h"
+
+#define LOOP_ALPHA_ONE		65536
+#define LOOP_MAX_DT_US		250000		// Longer gaps (debugger, loading) are cut to this
+
+typedef struct {
+	uint16_t	tick_hz;						// Simulation rate
+	uint8_t		max_updates;					// Catch-up limit per loop pass
+	uint8_t		max_skip;						// Consecutive frames that may be skipped (0 - never skip)
+	uint16_t	budget_ms;						// Frame time above which rendering may be skipped (0 - never skip)
+	uint8_t		deterministic;					// 1 - fixed det_ticks per frame, wall clock ignored
+	uint8_t		det_ticks;						// Ticks per frame in deterministic mode
+	void		(* update)(uint32_t tick);		// Advances simulation by one tick
+	void		(* render)(uint32_t alpha);		// Draws frame, alpha 0..LOOP_ALPHA_ONE-1
+} LOOP_CONFIG;
+
+typedef struct {
+	uint32_t	ticks;				// Updates run
+	uint32_t	frames;				// Frames rendered
+	uint32_t	skipped;			// Frames skipped to catch up
+	uint32_t	dropped_ticks;		// Ticks lost to catch-up limit (real time mode only)
+	uint8_t		last_updates;		// Updates in last loop pass
+	uint8_t		peak_updates;		// Maximum updates in one loop pass
+} LOOP_STATS;
+
+uint8_t Loop_Init(const LOOP_CONFIG * cfg);
+uint8_t Loop_Step(void);
+void Loop_Run(void);
+uint32_t Loop_GetTick(void);
+uint32_t Loop_GetTimeMs(void);
+const LOOP_STATS * Loop_GetStats(void);
+
+#endif /* LOOP_H_ */
@@ -0,0 +1,22 @@
+/*****************************************************************
+ * MiniConsole V3 - LZ4 Block Decoder
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Decoder for LZ4 block format (no frame header). Output buffer
+ * doubles as dictionary, so no extra window memory is needed.
+ *******************************************************************/
+
+#ifndef LZ4_H_
+#define LZ4_H_
+
+#include "BSP_Driver.h"
+
+uint32_t LZ4_DecodeBlock(const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size);
+
+#endif /* LZ4_H_ */
@@ -0,0 +1,99 @@
+/*****************************************************************
+ * MiniConsole V3 - Particles
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Particle pool stored as structure of arrays in DTCM (position,
+ * velocity, life, decay) and updated with fixed-point arithmetic:
+ *  - position and velocity are two Q10.6 lanes packed in one word
+ *    (pixels relative to screen centre), so x / y are advanced with
+ *    one QADD16 each (Simd.h); particle reaching saturation is more
+ *    than 512 pixels from centre and is removed,
+ *  - life is Q0.16 fraction left, alpha between birth and end of
+ *    life is interpolated with one SMLAD.
+ * Each emitter owns contiguous part of pool with living particles
+ * kept dense (dead particle is replaced by last one), so update and
+ * drawing are single linear passes. Pool is DTC_BSS (zeroed by
+ * startup, no copy in flash image).
+ *
+ * PART_Draw writes particles (size x size squares of emitter colour)
+ * directly into edit frame (LCD_GetEditFrameAddr) with one blend
+ * pass per emitter - no G2D call per particle. Blending follows
+ * G2D_DrawFillRectBlend. Supported colour modes are ARGB8888 and
+ * RGB888, in other modes G2D_DrawFillRectBlend is called for each
+ * particle. Before writing frame PART_Draw waits until DMA2D finished
+ * previous G2D call and after drawing cleans D-cache (PK_SyncForCPU /
+ * PK_SyncForDMA), so G2D calls can be mixed freely around it.
+ *
+ * Usage:
+ * 	PART_Init(LCD_COLOR_MODE_RGB888, seed);
+ * 	PART_CONFIG fire = { .color = 0xFFA020, .alpha0 = 255, .alpha1 = 0, .size = 2,
+ * 		.life_min = 20, .life_max = 40, .speed_min = PART_FX(1), .speed_max = PART_FX(3),
+ * 		.spread = 128, .gravity_y = PART_FX(0.05) };
+ * 	PART_EMITTER boom = PART_AddEmitter(&fire, 300);
+ * 	...
+ * 	PART_Emit(boom, x, y, 200);				// explosion at x, y
+ * 	PART_Update();							// every game tick
+ * 	PART_Draw();							// after background
+ *******************************************************************/
+
+#ifndef PARTICLE_H_
+#define PARTICLE_H_
+
+#include "BSP_Driver.h"
+
+#ifndef PART_MAX
+#define PART_MAX			2048		// Particles in pool (12 bytes each in DTCM)
+#endif
+#define PART_MAX_EMITTERS	16
+#define PART_MAX_SIZE		8
+
+#define PART_INVALID		0xFF
+
+#define PART_FX(v)			((int16_t)((v) * 64))		// Pixels to Q10.6
+
+typedef uint8_t PART_EMITTER;
+
+typedef struct {
+	uint32_t	color;				// RGB (alpha byte ignored)
+	uint8_t		alpha0;				// Alpha at birth
+	uint8_t		alpha1;				// Alpha at end of life
+	uint8_t		size;				// Square size in pixels (1 - PART_MAX_SIZE)
+	uint8_t		drag;				// Velocity loses 1 / 2^drag every update (0 - none)
+	uint16_t	life_min;			// Life in updates
+	uint16_t	life_max;
+	int16_t		speed_min;			// Q10.6 pixels / update
+	int16_t		speed_max;
+	uint8_t		angle;				// Direction (256 - full circle, 0 - right, 64 - down)
+	uint8_t		spread;				// Random +- range around angle (128 - all directions)
+	uint8_t		radius;				// Random spawn offset in pixels (+- in x and y)
+	int16_t		gravity_x;			// Q10.6 pixels / update^2
+	int16_t		gravity_y;
+} PART_CONFIG;
+
+typedef struct {
+	uint32_t	alive;				// Particles in all emitters
+	uint32_t	spawned;			// Particles emitted since last PART_Update
+	uint32_t	killed;				// Particles removed in last PART_Update
+	uint32_t	drawn;				// Particles drawn in last PART_Draw
+	uint32_t	pixels;				// Pixels blended in last PART_Draw
+} PART_STATS;
+
+void PART_Init(uint8_t color_mode, uint32_t seed);
+PART_EMITTER PART_AddEmitter(const PART_CONFIG *cfg, uint16_t capacity);
+void PART_SetConfig(PART_EMITTER e, const PART_CONFIG *cfg);
+uint16_t PART_Emit(PART_EMITTER e, int16_t x, int16_t y, uint16_t count);
+void PART_Clear(PART_EMITTER e);
+uint16_t PART_GetCount(PART_EMITTER e);
+uint8_t PART_Get(PART_EMITTER e, uint16_t index, int16_t *x, int16_t *y, uint8_t *alpha);
+
+void PART_Update(void);
+void PART_Draw(void);
+const PART_STATS * PART_GetStats(void);
+
+#endif /* PARTICLE_H_ */
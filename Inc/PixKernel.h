@@ -0,0 +1,94 @@
+/*****************************************************************
+ * MiniConsole V3 - Pixel Kernels
+ *
+ * Author: Marek Ryn
+ * Version: 1.1
+ *
+ * Changelog:
+ *
+ * - 1.1	- PK_SyncForCPU / PK_SyncForDMA (CPU access to G2D buffers)
+ * - 1.0	- First release
+ *******************************************************************
+ * CPU kernels for spans of pixels in application buffers (off-screen
+ * layers, atlases, tiles), specialised for each colour mode:
+ *
+ *  Fill(dst, count, argb)				- solid colour
+ *  FillBlend(dst, count, argb)			- colour blended with its alpha
+ *  Blend(dst, src, count, alpha)		- ARGB8888 source over dst
+ *  BlendPM(dst, src, count, alpha)		- premultiplied ARGB8888 over dst
+ *  Add(dst, src, count, alpha)			- additive, saturated (light, fire)
+ *  FromARGB(dst, src, count)			- ARGB8888 -> colour mode
+ *  ToARGB(dst, src, count)				- colour mode -> ARGB8888
+ *
+ * and PK_Premultiply for ARGB8888 buffers. Blending kernels round as
+ * G2D does and Blend gives the same result as G2D_CopyBufBlend, so
+ * CPU and DMA2D drawing can be mixed.
+ *
+ * Every kernel is one generic body expanded for each colour mode at
+ * compile time (no mode test per pixel). Channels are processed two
+ * at a time in 16-bit lanes of one word (red / blue and green /
+ * alpha) with division by 255 done exactly with shifts. UXTB16,
+ * UQADD8 and USAT16 come from Simd.h (plain C on host).
+ *
+ * Supported modes are ARGB8888, RGB888, ARGB4444 and ARGB1555
+ * (PK_GetKernels returns NULL for L8 and AL88 - CLUT modes are left
+ * to G2D). ARGB8888 buffers must be 4-byte aligned, 16-bit buffers
+ * 2-byte aligned.
+ *
+ * Frame and buffers drawn by G2D are written by DMA2D, which works in
+ * background and bypasses CM7 D-cache. Before CPU reads or writes such
+ * range, call PK_SyncForCPU (waits for DMA2D, cleans and invalidates
+ * lines); after CPU writes, call PK_SyncForDMA (cleans lines) before
+ * next G2D call or LCD_FrameReady. Wait assumes G2D calls return with
+ * at most one DMA2D transfer running (DMA2D_CR START bit). Both are
+ * no operation on host.
+ *
+ * Usage:
+ * 	// Mode known at compile time - direct call
+ * 	PK_FN(Blend, RGB888)(layer + y * w * 3, sprite, 32, 255);
+ *
+ * 	// Mode selected at runtime
+ * 	const PK_KERNELS * pk = PK_GetKernels(LCD_COLOR_MODE_ARGB4444);
+ * 	pk->Fill(line, LCD_WIDTH, 0xFF203040);
+ *******************************************************************/
+
+#ifndef PIXKERNEL_H_
+#define PIXKERNEL_H_
+
+#include "BSP_Driver.h"
+
+typedef struct {
+	void		(* Fill)(void *dst, uint32_t count, uint32_t argb);
+	void		(* FillBlend)(void *dst, uint32_t count, uint32_t argb);
+	void		(* Blend)(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha);
+	void		(* BlendPM)(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha);
+	void		(* Add)(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha);
+	void		(* FromARGB)(void *dst, const uint32_t *src, uint32_t count);
+	void		(* ToARGB)(uint32_t *dst, const void *src, uint32_t count);
+	uint8_t		bpp;
+	uint8_t		color_mode;
+} PK_KERNELS;
+
+// Kernel specialised for colour mode, e.g. PK_FN(Blend, ARGB8888)
+#define PK_FN(kernel, mode)		PK_##kernel##_##mode
+
+#define PK_DECLARE(mode) \
+	void PK_Fill_##mode(void *dst, uint32_t count, uint32_t argb); \
+	void PK_FillBlend_##mode(void *dst, uint32_t count, uint32_t argb); \
+	void PK_Blend_##mode(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha); \
+	void PK_BlendPM_##mode(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha); \
+	void PK_Add_##mode(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha); \
+	void PK_FromARGB_##mode(void *dst, const uint32_t *src, uint32_t count); \
+	void PK_ToARGB_##mode(uint32_t *dst, const void *src, uint32_t count);
+
+PK_DECLARE(ARGB8888)
+PK_DECLARE(RGB888)
+PK_DECLARE(ARGB4444)
+PK_DECLARE(ARGB1555)
+
+const PK_KERNELS * PK_GetKernels(uint8_t color_mode);
+void PK_Premultiply(uint32_t *dst, const uint32_t *src, uint32_t count);
+void PK_SyncForCPU(const void * addr, uint32_t size);
+void PK_SyncForDMA(const void * addr, uint32_t size);
+
+#endif /* PIXKERNEL_H_ */
@@ -0,0 +1,104 @@
+/*****************************************************************
+ * MiniConsole V3 - Frame Profiler
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Named zones timed with Cortex-M7 DWT cycle counter (clock_gettime
+ * in host build, 1 cycle = 1 ns). Zone events go to ring buffer in
+ * DTCM and are aggregated per frame in PROF_FrameEnd.
+ * Define PROF_ENABLE as 0 to compile all zones out.
+ * PROF_Init can be called again to restart profiling - statistics
+ * are cleared, zones registered by PROF_BEGIN stay valid.
+ *
+ * Usage:
+ * 	PROF_Init();
+ * 	while (1) {
+ * 		PROF_FrameBegin();
+ * 		PROF_BEGIN(draw);
+ * 		...
+ * 		PROF_END();
+ * 		PROF_DrawOverlay(600, 0, FONT_12_verdana);
+ * 		PROF_FrameEnd();
+ * 	}
+ *******************************************************************/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "BSP_Driver.h"
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE			1
+#endif
+
+#define PROF_MAX_ZONES		32
+#define PROF_MAX_DEPTH		8
+#define PROF_RING_SIZE		512			// Events (power of 2)
+
+#ifdef HOST_BUILD
+#define PROF_CYCLES_PER_US	1000
+#else
+#define PROF_CYCLES_PER_US	480			// CPU clock [MHz]
+#endif
+
+#define PROF_INVALID		0xFF
+
+typedef struct {
+	uint8_t		zone;
+	uint8_t		depth;
+	uint16_t	frame;				// Low bits of frame number
+	uint32_t	start;				// Cycle counter at zone begin
+	uint32_t	cycles;
+} PROF_EVENT;
+
+typedef struct {
+	const char *	name;
+	uint32_t		calls;			// Calls in last frame
+	uint32_t		cycles;			// Total in last frame
+	uint32_t		min;			// Minimum frame total (frames where zone was entered)
+	uint32_t		max;
+	uint64_t		sum;
+	uint32_t		frames;			// Frames where zone was entered
+} PROF_ZONE;
+
+typedef struct {
+	uint32_t		frame;			// Frames since reset
+	uint32_t		frame_cycles;	// Duration of last frame
+	uint32_t		events;			// Events in last frame
+	uint32_t		dropped;		// Events overwritten before aggregation
+} PROF_STATS;
+
+#if PROF_ENABLE
+
+#define PROF_BEGIN(name)	do { static uint8_t prof_id_ = PROF_INVALID; if (prof_id_ == PROF_INVALID) prof_id_ = PROF_Register(#name); PROF_Begin(prof_id_); } while (0)
+#define PROF_END()			PROF_End()
+
+#else
+
+#define PROF_BEGIN(name)	do { } while (0)
+#define PROF_END()			do { } while (0)
+
+#endif
+
+void PROF_Init(void);
+void PROF_Reset(void);
+uint8_t PROF_Register(const char *name);
+void PROF_Begin(uint8_t zone);
+void PROF_End(void);
+void PROF_FrameBegin(void);
+void PROF_FrameEnd(void);
+uint32_t PROF_GetCycles(void);
+void PROF_StartCounter(void);
+uint8_t PROF_GetZoneCount(void);
+const PROF_ZONE * PROF_GetZone(uint8_t zone);
+const PROF_STATS * PROF_GetStats(void);
+uint32_t PROF_GetEvents(const PROF_EVENT ** ring, uint32_t * head);
+void PROF_DrawOverlay(int16_t x, int16_t y, const uint8_t *font);
+void PROF_Dump(void);
+
+#endif /* PROFILER_H_ */
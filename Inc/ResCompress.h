@@ -0,0 +1,55 @@
+/*****************************************************************
+ * MiniConsole V3 - Compressed Resources
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Container of independent LZ4 blocks (built by Host/Tools/rescomp).
+ * RC_Load recognises container by header and decompresses block by
+ * block while reading, straight into final Res_Alloc buffer. Only
+ * one compressed block is buffered (RC_BLOCK_SIZE window). Files
+ * without header are loaded into Res_Alloc buffer as they are,
+ * from the same open file.
+ *
+ * File layout (little endian):
+ *  RC_HEADER						16 bytes
+ *  block[block_count]:
+ *   uint32 size					bit 31 set - block stored raw
+ *   data[size & 0x7FFFFFFF]
+ *******************************************************************/
+
+#ifndef RESCOMPRESS_H_
+#define RESCOMPRESS_H_
+
+#include "BSP_Driver.h"
+
+#define RC_MAGIC			0x5A4C434D		// 'MCLZ'
+#define RC_VERSION			1
+#define RC_BLOCK_SIZE		16384			// Maximum raw size of block
+#define RC_BLOCK_STORED		0x80000000
+
+typedef struct {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	reserved;
+	uint32_t	raw_size;
+	uint32_t	block_size;
+} RC_HEADER;
+
+typedef struct {
+	uint32_t	file_bytes;			// Bytes read from file in last load
+	uint32_t	raw_bytes;			// Bytes produced in last load
+	uint32_t	blocks;
+	uint32_t	time;				// Duration of last load [ms]
+} RC_STATS;
+
+void * RC_Load(char *filename);
+uint32_t RC_GetRawSize(const void * data, uint32_t size);
+uint8_t RC_Decode(const void * data, uint32_t size, void * dst, uint32_t dst_size);
+const RC_STATS * RC_GetStats(void);
+
+#endif /* RESCOMPRESS_H_ */
@@ -0,0 +1,66 @@
+/*****************************************************************
+ * MiniConsole V3 - Asynchronous Resource Loader
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Queues resource loads and reads them in RL_CHUNK_SIZE f_read calls
+ * within per-frame time budget, so loading does not stall rendering.
+ * Memory for each resource is allocated with Res_Alloc (same as
+ * Res_Load), so data can be released with Res_Free.
+ *
+ * Usage:
+ * 	RL_HANDLE h = RL_Request("level2.bin");
+ * 	while (1) {
+ * 		while (!BSP->LCD_GetEditPermission()) continue;
+ * 		...draw...
+ * 		BSP->LCD_FrameReady();
+ * 		RL_Service(4);				// up to 4 ms of file reading
+ * 		if (RL_GetState(h) == RL_STATE_READY) data = RL_GetData(h);
+ * 	}
+ *******************************************************************/
+
+#ifndef RESLOADER_H_
+#define RESLOADER_H_
+
+#include "BSP_Driver.h"
+
+#define RL_MAX_REQUESTS		16
+#define RL_MAX_PATH			64
+#define RL_CHUNK_SIZE		16384	// Bytes per f_read call
+
+#define RL_INVALID			0xFF
+
+#define RL_STATE_FREE		0
+#define RL_STATE_QUEUED		1
+#define RL_STATE_LOADING	2
+#define RL_STATE_READY		3
+#define RL_STATE_ERROR		4
+
+typedef uint8_t RL_HANDLE;
+
+typedef struct {
+	uint32_t	bytes;				// Bytes read in last RL_Service call
+	uint32_t	chunks;				// f_read calls in last RL_Service call
+	uint32_t	time;				// Time spent in last RL_Service call [ms]
+	uint32_t	total_bytes;		// Bytes read since start
+	uint8_t		pending;			// Requests queued or loading
+} RL_STATS;
+
+RL_HANDLE RL_Request(const char *filename);
+uint8_t RL_Service(uint32_t budget_ms);
+uint8_t RL_ServiceIdle(uint32_t budget_ms);
+uint8_t RL_GetState(RL_HANDLE handle);
+uint8_t RL_GetProgress(RL_HANDLE handle);
+void * RL_GetData(RL_HANDLE handle);
+uint32_t RL_GetSize(RL_HANDLE handle);
+void RL_Release(RL_HANDLE handle);
+void RL_Cancel(RL_HANDLE handle);
+void * RL_Wait(RL_HANDLE handle);
+const RL_STATS * RL_GetStats(void);
+
+#endif /* RESLOADER_H_ */
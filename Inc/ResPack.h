@@ -0,0 +1,95 @@
+/*****************************************************************
+ * MiniConsole V3 - Resource Pack
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Many resources in one file (built by Host/Tools/respack). Pack is
+ * opened once, table of contents is kept in Res memory and entries
+ * are read with f_lseek/f_read.
+ *
+ * File layout (little endian):
+ *  RP_HEADER						32 bytes
+ *  RP_ENTRY[count]					sorted by name hash
+ *  names							zero terminated
+ *  payloads						32 byte aligned, grouped by group id
+ *
+ * Names are hashed with FNV-1a after conversion to lower case (FAT
+ * names are case insensitive). Entries of one group are stored next
+ * to each other, so whole group is loaded with single f_read.
+ *
+ * Usage:
+ * 	static RP_PACK pack;
+ * 	RP_Open(&pack, "game.pak");
+ * 	void * thumb = RP_Load(&pack, "thumbnail.bin");
+ *
+ * 	RP_GROUP level;
+ * 	RP_LoadGroup(&pack, 1, &level);
+ * 	void * map = RP_GroupGet(&pack, &level, "map.bin");
+ *******************************************************************/
+
+#ifndef RESPACK_H_
+#define RESPACK_H_
+
+#include "BSP_Driver.h"
+
+#define RP_MAGIC			0x4B50434D		// 'MCPK'
+#define RP_VERSION			1
+#define RP_ALIGN			32
+
+#define RP_CODEC_NONE		0
+#define RP_CODEC_LZ4		1				// LZ4 block (Src/Lz4.c)
+
+typedef struct {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	count;				// Number of entries
+	uint32_t	toc_offset;
+	uint32_t	names_offset;
+	uint32_t	names_size;
+	uint32_t	data_offset;
+	uint32_t	reserved[2];
+} RP_HEADER;
+
+typedef struct {
+	uint32_t	hash;				// FNV-1a of lower case name
+	uint32_t	offset;				// Payload offset in file
+	uint32_t	size;				// Stored size
+	uint32_t	raw_size;			// Size after decompression
+	uint32_t	name;				// Name offset in names table
+	uint16_t	group;
+	uint8_t		codec;
+	uint8_t		flags;
+} RP_ENTRY;
+
+typedef struct {
+	FIL			file;
+	RP_HEADER	hdr;
+	RP_ENTRY *	toc;
+	char *		names;
+	uint8_t		open;
+} RP_PACK;
+
+typedef struct {
+	uint8_t *	base;				// Group data in Res memory
+	uint32_t	offset;				// File offset of first byte
+	uint32_t	size;
+	uint16_t	group;
+} RP_GROUP;
+
+uint8_t RP_Open(RP_PACK * pack, const char *filename);
+void RP_Close(RP_PACK * pack);
+uint32_t RP_Hash(const char *name);
+int32_t RP_Find(const RP_PACK * pack, const char *name);
+const RP_ENTRY * RP_GetEntry(const RP_PACK * pack, int32_t index);
+uint8_t RP_ReadEntry(RP_PACK * pack, int32_t index, void * dst);
+void * RP_Load(RP_PACK * pack, const char *name);
+uint8_t RP_LoadGroup(RP_PACK * pack, uint16_t group, RP_GROUP * g);
+void * RP_GroupGet(const RP_PACK * pack, const RP_GROUP * g, const char *name);
+void RP_FreeGroup(RP_GROUP * g);
+
+#endif /* RESPACK_H_ */
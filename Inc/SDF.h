@@ -0,0 +1,70 @@
+/*****************************************************************
+ * MiniConsole V3 - Signed Distance Field Fonts
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * One SDF font is drawn at any size (anti-aliased), optionally with
+ * outline and glow, instead of separate bitmap font per size.
+ * Fonts are generated on host from largest bitmap font
+ * (Host/Tools/sdfgen).
+ *
+ * Font layout (little endian):
+ *  [0]		- 0
+ *  [1]		- version (3, Font.h uses 1 and 2)
+ *  [2]		- line height of field (pixels, without padding)
+ *  [3]		- spread (pixels of field), also padding around glyphs
+ *  [4]		- uint16 first codepoint
+ *  [6]		- uint16 glyph count
+ *  [8]		- uint16 advance of space and missing glyphs (1/16 px)
+ *  [10]	- reserved
+ *  [12]	- uint32 font size
+ *  [16]	- count x glyph: uint32 offset of field, uint16 advance
+ *			  (1/16 px of field), uint8 field width, uint8 reserved
+ * Field: width x (height + 2 x spread) bytes, 128 on glyph edge,
+ * +/-127 at spread distance (inside is above 128).
+ *
+ * Glyphs are sampled bilinearly in 16.16 fixed point. Coverage ramp
+ * is one output pixel wide, so edges stay sharp at any size. Plain
+ * text is drawn as A8 icons (G2D_DrawIconBlend), styled text as
+ * ARGB8888 bitmaps (G2D_DrawBitmapBlend), in bands of at most
+ * SDF_BAND_PIXELS pixels. Outline + glow can not exceed spread of
+ * field scaled to output size.
+ *
+ * Usage:
+ * 	SDF_TextBlend(10, 10, SDF_verdana, "SCORE", 40, 0xFFFFFFFF);
+ * 	SDF_STYLE st = { 0xFFFFFFFF, 0xFF000000, 2, 0x80FFA000, 4 };
+ * 	SDF_TextStyled(10, 60, SDF_verdana, "GAME OVER", 72, &st);
+ *******************************************************************/
+
+#ifndef SDF_H_
+#define SDF_H_
+
+#include "BSP_Driver.h"
+
+#define SDF_VERSION			3
+#define SDF_HEADER			16
+#define SDF_GLYPH_ENTRY		8
+#define SDF_EDGE			128
+#define SDF_BAND_PIXELS		2048	// Pixels rendered per draw call (per buffer)
+#define SDF_MAX_WIDTH		256		// Widest glyph box in output pixels
+
+typedef struct {
+	uint32_t	color;				// Fill (ARGB)
+	uint32_t	outline_color;
+	uint8_t		outline;			// Outline width (output pixels, 0 - none)
+	uint32_t	glow_color;
+	uint8_t		glow;				// Glow radius outside outline (output pixels, 0 - none)
+} SDF_STYLE;
+
+uint8_t SDF_IsSDF(const uint8_t *font);
+uint16_t SDF_GetTextWidth(const uint8_t *font, const char *str, uint16_t size);
+uint16_t SDF_RenderMask(const uint8_t *font, uint32_t cp, uint16_t size, uint8_t *mask, uint16_t *height);
+uint16_t SDF_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint16_t size, uint32_t color);
+uint16_t SDF_TextStyled(int16_t x, int16_t y, const uint8_t *font, const char *str, uint16_t size, const SDF_STYLE *style);
+
+#endif /* SDF_H_ */
@@ -0,0 +1,72 @@
+/*****************************************************************
+ * MiniConsole V3 - Frame Scheduler
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Replaces busy waiting for LCD_GetEditPermission. Time of next edit
+ * window is predicted from frame time history (refresh period is the
+ * shortest interval between edit windows, LCD_GetFrameTime is used
+ * until history is collected) and from moment when edit permission
+ * was last observed. Slack until
+ * that moment (minus guard time) is given to registered background
+ * tasks (asset streaming, audio refill, save writes, garbage
+ * collection). When no task fits, core sleeps with WFI (woken by
+ * SysTick or LTDC interrupt).
+ *
+ * Task is called repeatedly while there is time left. It should do
+ * small step of work, check Sched_TimeLeft() and return SCHED_MORE
+ * when it has more work or SCHED_IDLE when it has nothing to do in
+ * this frame. Task is started only if at least min_us is left.
+ *
+ * Usage:
+ * 	Sched_AddTask(AudioRefill, NULL, 200);
+ * 	while (1) {
+ * 		Sched_WaitEditPermission();	// instead of while (!BSP->LCD_GetEditPermission());
+ * 		...
+ * 		BSP->LCD_FrameReady();
+ * 	}
+ *******************************************************************/
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include "BSP_Driver.h"
+
+#define SCHED_MAX_TASKS		8
+#define SCHED_HISTORY		16			// Frame intervals used for period estimation
+#define SCHED_GUARD_US		300			// Safety margin before predicted edit window
+#define SCHED_INVALID		0xFF
+
+#define SCHED_IDLE			0			// Task has nothing to do in this frame
+#define SCHED_MORE			1			// Task has more work
+
+typedef uint8_t (* SCHED_TASK_FN)(void * arg);
+
+typedef struct {
+	uint32_t	frames;				// Frames waited for
+	uint32_t	period_us;			// Estimated refresh period
+	uint32_t	slack_us;			// Slack predicted in last frame
+	uint32_t	used_us;			// Slack used by tasks in last frame
+	uint32_t	idle_us;			// Slack spent in WFI in last frame
+	uint32_t	slack_total;		// Cumulative values [us]
+	uint32_t	used_total;
+	uint32_t	idle_total;
+	uint32_t	task_runs;			// Task calls (cumulative)
+	uint32_t	deadline_misses;	// Task calls that ended after deadline (cumulative)
+	uint32_t	late_frames;		// Frames where permission came while task was running (cumulative)
+	uint32_t	no_slack;			// Frames rendered too slow to have any slack (cumulative)
+} SCHED_STATS;
+
+uint8_t Sched_AddTask(SCHED_TASK_FN fn, void * arg, uint16_t min_us);
+void Sched_RemoveTask(uint8_t id);
+void Sched_WaitEditPermission(void);
+uint32_t Sched_TimeLeft(void);
+const SCHED_STATS * Sched_GetStats(void);
+void Sched_ResetStats(void);
+
+#endif /* SCHED_H_ */
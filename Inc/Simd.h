@@ -0,0 +1,109 @@
+/*****************************************************************
+ * MiniConsole V3 - SIMD Helpers
+ *
+ * Author: Marek Ryn
+ * Version: 1.1
+ *
+ * Changelog:
+ *
+ * - 1.1	- Byte lanes (UXTB16, UQADD8) and USAT16
+ * - 1.0	- First release
+ *******************************************************************
+ * Cortex-M7 DSP instructions working on two 16-bit lanes packed in
+ * one 32-bit word (low half - lane 0, high half - lane 1). On device
+ * ACLE intrinsics are used, on host (HOST_BUILD) plain C with the
+ * same results, so fixed-point code can be checked and benchmarked
+ * on Linux.
+ *
+ *  SIMD_QADD16(a, b)		- lane-wise signed add, saturated to int16
+ *  SIMD_SMLAD(a, b, acc)	- a0 * b0 + a1 * b1 + acc (signed lanes)
+ *  SIMD_USAT16(a, bits)	- signed lanes saturated to 0 .. 2^bits - 1
+ *  SIMD_UXTB16(a)			- bytes 0 and 2 zero-extended to lanes
+ *  SIMD_UQADD8(a, b)		- byte-wise unsigned add, saturated to 255
+ *  SIMD_PACK16(lo, hi)		- packs two 16-bit values
+ *  SIMD_LO16(a), SIMD_HI16(a)	- signed lanes
+ *
+ * Usage:
+ * 	uint32_t pos = SIMD_PACK16(x, y);
+ * 	pos = SIMD_QADD16(pos, vel);				// x += vx, y += vy
+ * 	uint32_t rb = SIMD_UXTB16(argb) * a;		// red and blue times a
+ *******************************************************************/
+
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_SIMD32) && !defined(HOST_BUILD)
+
+#include <arm_acle.h>
+
+static inline uint32_t SIMD_QADD16(uint32_t a, uint32_t b) {
+	return (uint32_t)__qadd16((int16x2_t)a, (int16x2_t)b);
+}
+
+static inline int32_t SIMD_SMLAD(uint32_t a, uint32_t b, int32_t acc) {
+	return __smlad((int16x2_t)a, (int16x2_t)b, acc);
+}
+
+// Saturation width must be constant
+#define SIMD_USAT16(a, bits)	((uint32_t)__usat16((int16x2_t)(a), (bits)))
+
+static inline uint32_t SIMD_UXTB16(uint32_t a) {
+	return (uint32_t)__uxtb16((uint8x4_t)a);
+}
+
+static inline uint32_t SIMD_UQADD8(uint32_t a, uint32_t b) {
+	return (uint32_t)__uqadd8((uint8x4_t)a, (uint8x4_t)b);
+}
+
+#else
+
+static inline int32_t SIMD_Sat16(int32_t v) {
+	return (v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : v;
+}
+
+static inline uint32_t SIMD_QADD16(uint32_t a, uint32_t b) {
+	int32_t lo = SIMD_Sat16((int16_t)a + (int16_t)b);
+	int32_t hi = SIMD_Sat16((int16_t)(a >> 16) + (int16_t)(b >> 16));
+	return ((uint32_t)lo & 0xFFFF) | ((uint32_t)hi << 16);
+}
+
+static inline int32_t SIMD_SMLAD(uint32_t a, uint32_t b, int32_t acc) {
+	return (int32_t)((int16_t)a * (int16_t)b) + (int32_t)((int16_t)(a >> 16) * (int16_t)(b >> 16)) + acc;
+}
+
+static inline uint32_t SIMD_USAT16(uint32_t a, uint8_t bits) {
+	int32_t max = (1 << bits) - 1, lo = (int16_t)a, hi = (int16_t)(a >> 16);
+	lo = (lo < 0) ? 0 : (lo > max) ? max : lo;
+	hi = (hi < 0) ? 0 : (hi > max) ? max : hi;
+	return (uint32_t)lo | ((uint32_t)hi << 16);
+}
+
+static inline uint32_t SIMD_UXTB16(uint32_t a) {
+	return a & 0x00FF00FF;
+}
+
+static inline uint32_t SIMD_UQADD8(uint32_t a, uint32_t b) {
+	uint32_t lo = (a & 0x00FF00FF) + (b & 0x00FF00FF);
+	uint32_t hi = ((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF);
+	lo |= ((lo >> 8) & 0x00010001) * 0xFF;		// Lane overflow -> 255
+	hi |= ((hi >> 8) & 0x00010001) * 0xFF;
+	return (lo & 0x00FF00FF) | ((hi & 0x00FF00FF) << 8);
+}
+
+#endif
+
+static inline uint32_t SIMD_PACK16(int32_t lo, int32_t hi) {
+	return ((uint32_t)lo & 0xFFFF) | ((uint32_t)hi << 16);
+}
+
+static inline int16_t SIMD_LO16(uint32_t a) {
+	return (int16_t)a;
+}
+
+static inline int16_t SIMD_HI16(uint32_t a) {
+	return (int16_t)(a >> 16);
+}
+
+#endif /* SIMD_H_ */
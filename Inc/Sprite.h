@@ -0,0 +1,91 @@
+/*****************************************************************
+ * MiniConsole V3 - Sprite Atlas and Batching
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Sprite images are packed into atlas pages (ARGB8888, Res memory)
+ * with skyline bottom-left packing. Transparent borders are trimmed,
+ * so only visible rectangle is stored and blended.
+ *
+ * Image file (Host/Tools/imgconv, optionally compressed - loaded with
+ * RC_Load):
+ *  [0]		- uint16 width
+ *  [2]		- uint16 height
+ *  [4]		- width x height ARGB8888 pixels (not premultiplied)
+ * Sprite sheets are cut into frames of given size, row by row.
+ *
+ * Sprites of a frame are queued with layer and alpha. Offscreen
+ * sprites are culled when queued. SPR_End sorts queue by layer,
+ * atlas page and frame (stable radix sort - order of identical keys
+ * is kept, order of different sprites inside layer is not) and
+ * draws it with G2D_CopyBufBlend directly from atlas page (line
+ * offset of page), so consecutive DMA2D transfers share source
+ * page, size and offset. Partially visible sprites are clipped in
+ * source rectangle.
+ *
+ * Usage:
+ * 	SPR_AtlasInit(NULL, 512, 512, 2);				// 2 pages in Res memory
+ * 	SPR_ID ship = SPR_AtlasLoad("0:/gfx/ship.img", 32, 32);	// 32x32 frames
+ * 	...
+ * 	SPR_Begin();
+ * 	SPR_Draw(ship + anim, x, y, 1, 255);
+ * 	SPR_End();
+ *******************************************************************/
+
+#ifndef SPRITE_H_
+#define SPRITE_H_
+
+#include "BSP_Driver.h"
+
+#define SPR_MAX_PAGES		4
+#define SPR_MAX_FRAMES		1024	// Frames in atlas (all pages)
+#define SPR_MAX_SKYLINE		128		// Skyline segments per page
+#define SPR_MAX_SPRITES		1024	// Sprites queued per frame
+
+#define SPR_INVALID			0xFFFF
+
+typedef uint16_t SPR_ID;
+
+typedef struct {
+	uint8_t		page;
+	uint16_t	x;					// Trimmed rectangle in page
+	uint16_t	y;
+	uint16_t	w;
+	uint16_t	h;
+	uint16_t	ox;					// Position of trimmed rectangle in image
+	uint16_t	oy;
+	uint16_t	width;				// Image size
+	uint16_t	height;
+} SPR_FRAME;
+
+typedef struct {
+	uint32_t	queued;				// Sprites passed to SPR_Draw
+	uint32_t	culled;				// Sprites outside of screen
+	uint32_t	drawn;				// DMA2D transfers
+	uint32_t	batches;			// Runs of transfers from same layer and page
+	uint32_t	pixels;				// Pixels blended
+	uint32_t	atlas_frames;		// Frames in atlas
+	uint32_t	atlas_used;			// Pixels of atlas occupied by trimmed frames
+	uint32_t	atlas_area;			// Pixels of atlas pages
+} SPR_STATS;
+
+// Atlas
+uint8_t SPR_AtlasInit(void * mem, uint16_t page_w, uint16_t page_h, uint8_t pages);
+SPR_ID SPR_AtlasAdd(const uint32_t *argb, uint16_t width, uint16_t height, uint16_t stride);
+SPR_ID SPR_AtlasLoad(const char *filename, uint16_t frame_w, uint16_t frame_h);
+void SPR_AtlasClear(void);
+void SPR_AtlasRelease(void);
+const SPR_FRAME * SPR_GetFrame(SPR_ID id);
+
+// Sprites of frame
+void SPR_Begin(void);
+uint8_t SPR_Draw(SPR_ID id, int16_t x, int16_t y, uint8_t layer, uint8_t alpha);
+uint16_t SPR_End(void);
+const SPR_STATS * SPR_GetStats(void);
+
+#endif /* SPRITE_H_ */
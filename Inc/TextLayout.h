@@ -0,0 +1,77 @@
+/*****************************************************************
+ * MiniConsole V3 - Text Layout
+ *
+ * Author: Marek Ryn
+ * Version: 1.1
+ *
+ * Changelog:
+ *
+ * - 1.1	- UTF-8 text (lines never split multi-byte sequences), kerning
+ * - 1.0	- First release
+ *******************************************************************
+ * Measures text and lays it out in a box (word wrapping, alignment,
+ * ellipsis) using advance widths from font data, without drawing.
+ * Layouts are memoised by (font, string hash, length, box, flags),
+ * so static labels are laid out once.
+ *
+ * Usage:
+ * 	const TL_LAYOUT * l = TL_Layout(FONT_16_verdana, str, 200, 60, TL_WRAP | TL_ELLIPSIS | TL_ALIGN_CENTER);
+ * 	TL_DrawBlend(l, str, 100, 50, 0xFFFFFFFF);
+ *******************************************************************/
+
+#ifndef TEXTLAYOUT_H_
+#define TEXTLAYOUT_H_
+
+#include "BSP_Driver.h"
+
+#define TL_MAX_LINES		16		// Lines per layout
+#define TL_MAX_LINE_CHARS	128		// Longer lines are drawn in pieces (bytes of UTF-8)
+#define TL_CACHE_SIZE		32		// Memoised layouts
+
+// Layout flags
+#define TL_ALIGN_LEFT		0x00
+#define TL_ALIGN_CENTER		0x01
+#define TL_ALIGN_RIGHT		0x02
+#define TL_VALIGN_TOP		0x00
+#define TL_VALIGN_MIDDLE	0x04
+#define TL_VALIGN_BOTTOM	0x08
+#define TL_WRAP				0x10	// Break lines at spaces to fit box width
+#define TL_ELLIPSIS			0x20	// End truncated text with "..."
+
+typedef struct {
+	uint16_t	start;				// Offset of first character in string
+	uint16_t	len;				// Characters drawn (without ellipsis)
+	uint16_t	width;				// Width in pixels (with ellipsis)
+	int16_t		x;					// Offset from box left edge
+	uint8_t		ellipsis;
+} TL_LINE;
+
+typedef struct {
+	const uint8_t *	font;
+	uint32_t		hash;
+	uint16_t		length;
+	uint16_t		box_w;
+	uint16_t		box_h;
+	uint8_t			flags;
+	uint8_t			line_count;
+	uint16_t		width;			// Widest line
+	uint16_t		height;			// Lines * font height
+	int16_t			y;				// Offset of first line from box top edge
+	uint32_t		age;
+	TL_LINE			line[TL_MAX_LINES];
+} TL_LAYOUT;
+
+typedef struct {
+	uint32_t	hits;
+	uint32_t	misses;
+} TL_STATS;
+
+uint16_t TL_MeasureText(const uint8_t *font, const char *str);
+uint16_t TL_MeasureChars(const uint8_t *font, const char *str, uint16_t len);
+const TL_LAYOUT * TL_Layout(const uint8_t *font, const char *str, uint16_t box_w, uint16_t box_h, uint8_t flags);
+void TL_Draw(const TL_LAYOUT * layout, const char *str, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor);
+void TL_DrawBlend(const TL_LAYOUT * layout, const char *str, int16_t x, int16_t y, uint32_t color);
+void TL_Flush(void);
+const TL_STATS * TL_GetStats(void);
+
+#endif /* TEXTLAYOUT_H_ */
@@ -0,0 +1,67 @@
+/*****************************************************************
+ * MiniConsole V3 - Text Sprites
+ *
+ * Author: Marek Ryn
+ * Version: 1.2
+ *
+ * Changelog:
+ *
+ * - 1.2	- TS_Init with frame colour mode, native colours of 16-bit modes
+ * - 1.1	- UTF-8 text, kerning and fallback fonts
+ * - 1.0	- First release
+ *******************************************************************
+ * Renders (font, string, color) once into ARGB8888 surface allocated
+ * with Res_Alloc. Following frames draw it with single
+ * G2D_DrawBitmapBlend. Sprite is rendered again automatically when
+ * string, font or color changes.
+ *
+ * Color is native value as for G2D_TextBlend (G2D_Color). TS_Init
+ * takes colour mode of frame (ARGB8888, RGB888, ARGB4444 and ARGB1555
+ * are supported). In CLUT modes (L8, AL88) and before TS_Init text is
+ * not cached - TS_TextBlend draws it with Font_TextBlend every time.
+ *
+ * ARGB8888 and RGB888 colours are expected as 0xAARRGGBB, with alpha in
+ * bits 31..24 also for RGB888. This is what G2D_Color returns in host
+ * BSP model (Host/BSP_Host.h); device BSP sources are not part of this
+ * tree, so it is an assumption to check against the device BSP.
+ *
+ * Surfaces are ARGB8888 only. AL88 surfaces are not implemented -
+ * G2D_DrawBitmapBlend takes ARGB8888 sources.
+ *
+ * Usage:
+ * 	static TS_SPRITE title;
+ * 	TS_Init(LCD_COLOR_MODE_RGB888);
+ * 	...
+ * 	TS_TextBlend(&title, 10, 10, FONT_26_verdana, "EXAMPLE APPLICATION", 0xFFFFFFFF);
+ *******************************************************************/
+
+#ifndef TEXTSPRITE_H_
+#define TEXTSPRITE_H_
+
+#include "BSP_Driver.h"
+
+typedef struct {
+	const uint8_t *	font;
+	uint32_t		color;
+	uint32_t		hash;
+	uint16_t		length;
+	uint16_t		width;
+	uint16_t		height;
+	uint32_t		capacity;		// Allocated surface size in bytes
+	uint32_t *		surface;		// ARGB8888 pixels (width x height)
+} TS_SPRITE;
+
+typedef struct {
+	uint32_t	renders;			// Sprites rasterised
+	uint32_t	glyphs;				// Glyphs decoded while rasterising
+	uint32_t	blits;				// Sprites drawn from surface
+} TS_STATS;
+
+uint8_t TS_Init(uint8_t color_mode);
+uint8_t TS_Update(TS_SPRITE * sprite, const uint8_t *font, const char *str, uint32_t color);
+uint16_t TS_TextBlend(TS_SPRITE * sprite, int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color);
+uint16_t TS_TextBlendC(TS_SPRITE * sprite, int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color);
+void TS_Release(TS_SPRITE * sprite);
+const TS_STATS * TS_GetStats(void);
+
+#endif /* TEXTSPRITE_H_ */
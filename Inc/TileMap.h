@@ -0,0 +1,127 @@
+/*****************************************************************
+ * MiniConsole V3 - Tile Map
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Scrolling tile map with up to TM_MAX_LAYERS layers (same grid and
+ * scroll), streamed in chunks from resource pack (ResPack.h).
+ *
+ * Every frame previous frame is shifted by camera movement with
+ * G2D_CopyScrollPrevFrame and only following areas are drawn:
+ *  - edge strips exposed by scrolling,
+ *  - cells with animated tiles whose animation frame changed,
+ *  - cells changed with TM_SetTile,
+ *  - areas passed to TM_Invalidate (sprites, HUD drawn over map).
+ * Whole screen is drawn after TM_Open / TM_Refresh and when camera
+ * moves by a screen or more. Previous frame must be the frame drawn
+ * by TM_Draw one frame before (double buffering, TM_Draw called every
+ * frame). Anything drawn over the map must be passed to
+ * TM_Invalidate in the same frame, so it is erased in the next one.
+ *
+ * Inside a cell, layers below the topmost opaque tile are skipped.
+ * Opaque tiles are copied with G2D_CopyBuf from tileset converted to
+ * frame format (ARGB8888, RGB888), tiles with transparency are drawn
+ * with G2D_CopyBufBlend. Cells without opaque tile are filled with
+ * background colour first.
+ *
+ * Pack entries of map "name" (Host/Tools/tmconv):
+ *  name				- TM_HEADER, TM_ANIM[anims]
+ *  name.tiles			- tileset image (Sprite.h image format), tiles
+ *  					  row by row, tile 1 is top left (0 - empty)
+ *  name.<cx>.<cy>		- chunk: layers x chunk x chunk uint16 tiles,
+ *  					  layer after layer, row by row (missing - empty)
+ * Chunks are kept in TM_MAX_CHUNKS slots (one Res_Alloc block) and
+ * replaced least recently used first. Chunks under screen are loaded
+ * in TM_Draw, chunks up to TM_PREFETCH cells around screen by
+ * TM_Stream (spare time of frame), nearest first and only into slots
+ * not needed for screen. TM_Open fails when chunks under screen do
+ * not fit into slots (e.g. 8 cell chunks of 16 px tiles).
+ *
+ * Animation: anim frames are consecutive tiles starting with tile
+ * used in map, each shown for given number of TM_Tick calls.
+ *
+ * Usage:
+ * 	RP_Open(&pack, "world.pak");
+ * 	TM_Open(&pack, "level1", LCD_COLOR_MODE_RGB888);
+ * 	while (1) {
+ * 		Sched_WaitEditPermission();
+ * 		TM_Tick();
+ * 		TM_Draw(cam_x, cam_y);
+ * 		draw sprites, TM_Invalidate(x, y, w, h) for each;
+ * 		BSP->LCD_FrameReady();
+ * 		TM_Stream(2);
+ * 	}
+ *******************************************************************/
+
+#ifndef TILEMAP_H_
+#define TILEMAP_H_
+
+#include "BSP_Driver.h"
+#include "ResPack.h"
+
+#define TM_MAGIC			0x4D54434D		// 'MCTM'
+#define TM_VERSION			1
+
+#define TM_MAX_LAYERS		4
+#define TM_MAX_CHUNKS		24				// Chunk slots in memory
+#define TM_MAX_DIRTY		32				// Dirty areas per frame (merged when exceeded)
+#define TM_MAX_ANIMS		32
+#define TM_PREFETCH			16				// Cells around screen loaded by TM_Stream
+
+#define TM_EMPTY			0
+
+typedef struct {
+	uint32_t	magic;
+	uint16_t	version;
+	uint8_t		layers;
+	uint8_t		chunk;				// Cells per chunk side (power of 2)
+	uint16_t	width;				// Map size in cells
+	uint16_t	height;
+	uint16_t	tile_w;				// Tile size in pixels
+	uint16_t	tile_h;
+	uint32_t	bgcolor;			// Colour of cells without opaque tile
+	uint16_t	anims;				// Number of TM_ANIM after header
+	uint16_t	reserved[3];
+} TM_HEADER;
+
+typedef struct {
+	uint16_t	tile;				// First frame (tile used in map)
+	uint8_t		frames;
+	uint8_t		ticks;				// TM_Tick calls per frame
+} TM_ANIM;
+
+typedef struct {
+	uint32_t	tiles;				// Tiles drawn (G2D_CopyBuf / G2D_CopyBufBlend)
+	uint32_t	fills;				// Background fills
+	uint32_t	pixels;				// Pixels drawn
+	uint32_t	scrolled;			// Pixels reused from previous frame
+	uint32_t	anim_cells;			// Cells redrawn because of animation
+	uint32_t	dirty;				// Dirty areas drawn
+	uint8_t		full;				// Whole screen drawn
+	uint32_t	full_draws;			// Frames drawn whole (since TM_Open)
+	uint32_t	loads;				// Chunks read from pack (since TM_Open)
+	uint32_t	stalls;				// Chunks read in TM_Draw - not prefetched (since TM_Open)
+	uint8_t		resident;			// Chunks in memory
+} TM_STATS;
+
+uint8_t TM_Open(RP_PACK * pack, const char *name, uint8_t color_mode);
+void TM_Close(void);
+const TM_HEADER * TM_GetHeader(void);
+
+uint16_t TM_GetTile(uint8_t layer, int32_t tx, int32_t ty);
+uint8_t TM_SetTile(uint8_t layer, int32_t tx, int32_t ty, uint16_t tile);
+
+void TM_Tick(void);
+void TM_Draw(int32_t cam_x, int32_t cam_y);
+void TM_Invalidate(int16_t x, int16_t y, uint16_t width, uint16_t height);
+void TM_Refresh(void);
+uint8_t TM_Stream(uint8_t max_loads);
+
+const TM_STATS * TM_GetStats(void);
+
+#endif /* TILEMAP_H_ */
@@ -0,0 +1,74 @@
+/*****************************************************************
+ * MiniConsole V3 - Tiled Renderer
+ *
+ * Author: Marek Ryn
+ * Version: 1.0
+ *
+ * Changelog:
+ *
+ * - 1.0	- First release
+ *******************************************************************
+ * Rasterises optimised display list (DisplayList.h) tile by tile in
+ * on-chip buffer, so overdraw of backgrounds, sprites and text stays
+ * in internal SRAM and every tile reaches SDRAM frame buffer once
+ * (one G2D_CopyBuf per tile).
+ *
+ *  - commands are binned by tile row (order of list is kept),
+ *  - inside a tile, commands before last opaque command covering
+ *    whole tile are skipped,
+ *  - tile not covered by opaque command is first read from frame,
+ *  - tiles without commands are not touched.
+ *
+ * Tile is w x h pixels (e.g. 64 x 64 or 128 x 32 strip segment) and
+ * must fit TR_TILE_BYTES in frame colour format. Two tile buffers
+ * are used alternately - next tile is drawn while DMA2D copies
+ * previous one. Buffers are in AXI SRAM (DMA2D can not read DTCM).
+ * Tile read from frame waits for DMA2D and invalidates D-cache lines
+ * of its rows first (PK_SyncForCPU), finished tile is cleaned from
+ * D-cache before G2D_CopyBuf (PK_SyncForDMA).
+ *
+ * Rasteriser follows G2D algorithms and blending of host stand-in
+ * bit-exactly (Host/Bench/tiled compares both paths). This is checked
+ * against host model only - device BSP sources are not part of this
+ * tree. On device compare frames drawn with DL_SetTiled(1) and
+ * DL_SetTiled(0) before relying on exact output. Supported
+ * colour modes are ARGB8888 and RGB888, in other modes TR_Render
+ * returns BSP_ERROR and list is executed directly.
+ *
+ * Usage:
+ * 	TR_Init(LCD_COLOR_MODE_RGB888, bgcolor, 64, 64);
+ * 	DL_SetTiled(1);
+ * 	...
+ * 	DL_Begin(); ... DL_End();		// list is drawn in tiles
+ * 	const TR_STATS * st = TR_GetStats();
+ *******************************************************************/
+
+#ifndef TILERENDER_H_
+#define TILERENDER_H_
+
+#include "BSP_Driver.h"
+#include "DisplayList.h"
+
+#define TR_TILE_BYTES		16384	// Size of each of two tile buffers
+#define TR_MAX_ROWS			60		// Tile rows (tile height at least LCD_HEIGHT / TR_MAX_ROWS)
+#define TR_MAX_BINS			2048	// Command references in all tile rows (list is drawn directly when exceeded)
+
+typedef struct {
+	uint32_t	tiles;				// Tiles rasterised and written to frame
+	uint32_t	loaded;				// Tiles read from frame first (not covered by opaque command)
+	uint32_t	binned;				// Command references in tile rows
+	uint32_t	skipped;			// Commands skipped in tiles as covered by opaque command
+	uint32_t	pixels;				// Pixels written into tile buffers
+	uint32_t	area;				// Pixels of rasterised tiles
+	uint32_t	overdraw;			// pixels x 100 / area (100 - every pixel written once)
+	uint32_t	fb_written;			// Bytes written to frame buffer
+	uint32_t	fb_read;			// Bytes read from frame buffer
+	uint32_t	fallbacks;			// Lists executed directly (bins full)
+} TR_STATS;
+
+uint8_t TR_Init(uint8_t color_mode, uint32_t bgcolor, uint16_t tile_w, uint16_t tile_h);
+uint8_t TR_Render(const DL_CMD *cmd, const uint16_t *order, uint16_t count);
+void TR_ResetStats(void);
+const TR_STATS * TR_GetStats(void);
+
+#endif /* TILERENDER_H_ */
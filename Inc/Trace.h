@@ -0,0 +1,91 @@
+/*****************************************************************
+ * MiniConsole V3 - Binary Trace
+ *
+ * Author: Marek Ryn
+ * Version: 1.1
+ *
+ * Changelog:
+ *
+ * - 1.1	- Audio underrun records, writers safe to call from interrupts
+ * - 1.0	- First release
+ *******************************************************************
+ * Compact binary event trace (zones, counters, events, frames)
+ * buffered in SH1_RAM and sent in bulk with USB_CDC_Write from
+ * TRACE_Flush, which should be called outside render window (after
+ * LCD_FrameReady). Host/Tools/trace2json converts captured stream to
+ * Chrome trace JSON (chrome://tracing, Perfetto).
+ * Define TRACE_ENABLE as 0 to compile all trace points out.
+ * Trace points can be used in interrupts (records are written with
+ * interrupts masked). TRACE_Start registers AUDIO_STATUS_BUF_UNDERRUN
+ * callback, so every audio buffer underrun gives TRACE_REC_UNDERRUN.
+ *
+ * Stream is sequence of 32-bit words (little endian). Record header:
+ *  byte 0 - type, byte 1 - id, bytes 2..3 - aux, word 1 - timestamp
+ * TRACE_REC_COUNTER and TRACE_REC_EVENT carry one more word (value),
+ * TRACE_REC_NAME carries aux bytes of name padded to 4.
+ * Timestamps are cycles of PROF_GetCycles (TRACE_REC_START gives
+ * cycles per microsecond).
+ *******************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "BSP_Driver.h"
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE		1
+#endif
+
+#define TRACE_BUFFER_SIZE	16384		// Bytes in SH1_RAM (power of 2)
+#define TRACE_MAX_NAMES		64
+#define TRACE_INVALID		0xFF
+
+#define TRACE_REC_START		0x01		// aux - version, ts - cycles per us
+#define TRACE_REC_NAME		0x02		// id - name id, aux - length
+#define TRACE_REC_BEGIN		0x03		// id - zone
+#define TRACE_REC_END		0x04		// id - zone
+#define TRACE_REC_COUNTER	0x05		// id - counter, value - int32
+#define TRACE_REC_EVENT		0x06		// id - event, value - uint32 argument
+#define TRACE_REC_FRAME		0x07		// aux - frame number (low bits)
+#define TRACE_REC_DROPPED	0x08		// value - records lost since last flush
+#define TRACE_REC_UNDERRUN	0x09		// aux - audio underruns since TRACE_Start (low bits)
+
+#define TRACE_VERSION		2
+
+typedef struct {
+	uint32_t	records;			// Records written since start
+	uint32_t	dropped;			// Records lost because buffer was full
+	uint32_t	sent;				// Bytes accepted by USB_CDC_Write
+	uint32_t	peak;				// Maximum buffer fill in bytes
+	uint32_t	underruns;			// Audio buffer underruns since start
+} TRACE_STATS;
+
+#if TRACE_ENABLE
+
+#define TRACE_ID(name)				({ static uint8_t trace_id_ = TRACE_INVALID; if (trace_id_ == TRACE_INVALID) trace_id_ = TRACE_Register(#name); trace_id_; })
+#define TRACE_BEGIN(name)			TRACE_Write(TRACE_REC_BEGIN, TRACE_ID(name), 0)
+#define TRACE_END(name)				TRACE_Write(TRACE_REC_END, TRACE_ID(name), 0)
+#define TRACE_COUNTER(name, value)	TRACE_WriteValue(TRACE_REC_COUNTER, TRACE_ID(name), (uint32_t)(value))
+#define TRACE_EVENT(name, arg)		TRACE_WriteValue(TRACE_REC_EVENT, TRACE_ID(name), (uint32_t)(arg))
+#define TRACE_FRAME(frame)			TRACE_Write(TRACE_REC_FRAME, 0, (uint16_t)(frame))
+
+#else
+
+#define TRACE_BEGIN(name)			do { } while (0)
+#define TRACE_END(name)				do { } while (0)
+#define TRACE_COUNTER(name, value)	do { } while (0)
+#define TRACE_EVENT(name, arg)		do { } while (0)
+#define TRACE_FRAME(frame)			do { } while (0)
+
+#endif
+
+void TRACE_Start(void);
+void TRACE_Stop(void);
+uint8_t TRACE_Register(const char *name);
+void TRACE_Write(uint8_t type, uint8_t id, uint16_t aux);
+void TRACE_WriteValue(uint8_t type, uint8_t id, uint32_t value);
+uint32_t TRACE_Flush(uint32_t max_bytes);
+uint32_t TRACE_GetPending(void);
+const TRACE_STATS * TRACE_GetStats(void);
+
+#endif /* TRACE_H_ */
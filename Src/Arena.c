@@ -0,0 +1,153 @@
+/*****************************************************************
+ * MiniConsole V3 - Arena and Pool Allocators
+ *******************************************************************/
+
+#include "Arena.h"
+
+
+// Arena
+
+uint8_t Arena_Init(ARENA * a, uint32_t size) {
+	Arena_InitStatic(a, BSP->Res_Alloc(size), size);
+	if (a->base == NULL) return BSP_ERROR;
+	a->owned = 1;
+	return BSP_OK;
+}
+
+void Arena_InitStatic(ARENA * a, void * mem, uint32_t size) {
+	a->base = mem;
+	a->size = (mem) ? size : 0;
+	a->top = 0;
+	a->high_water = 0;
+	a->failed = 0;
+	a->owned = 0;
+}
+
+void Arena_Destroy(ARENA * a) {
+	if ((a->owned) && (a->base)) BSP->Res_Free(a->base);
+	Arena_InitStatic(a, NULL, 0);
+}
+
+// Align must be power of 2
+void * Arena_AllocAligned(ARENA * a, uint32_t size, uint32_t align) {
+	uintptr_t addr = (uintptr_t)a->base + a->top;
+	uint32_t pad = (uint32_t)((align - (addr & (align - 1))) & (align - 1));
+
+	if ((size > a->size) || (a->top + pad > a->size - size)) {
+		a->failed++;
+		return NULL;
+	}
+	a->top += pad;
+	void * p = a->base + a->top;
+	a->top += size;
+	if (a->top > a->high_water) a->high_water = a->top;
+	return p;
+}
+
+void * Arena_Alloc(ARENA * a, uint32_t size) {
+	return Arena_AllocAligned(a, size, ARENA_ALIGN);
+}
+
+void * Arena_Calloc(ARENA * a, uint32_t size) {
+	uint32_t * p = Arena_AllocAligned(a, size, 4);
+	if (p == NULL) return NULL;
+	for (uint32_t i = 0; i < size / 4; i++) p[i] = 0;
+	for (uint32_t i = size & ~3; i < size; i++) ((uint8_t *)p)[i] = 0;
+	return p;
+}
+
+ARENA_MARK Arena_GetMark(const ARENA * a) {
+	return a->top;
+}
+
+// Frees everything allocated after mark was taken
+void Arena_Release(ARENA * a, ARENA_MARK mark) {
+	if (mark < a->top) a->top = mark;
+}
+
+void Arena_Reset(ARENA * a) {
+	a->top = 0;
+}
+
+uint32_t Arena_GetUsed(const ARENA * a) {
+	return a->top;
+}
+
+uint32_t Arena_GetFree(const ARENA * a) {
+	return a->size - a->top;
+}
+
+uint32_t Arena_GetHighWater(const ARENA * a) {
+	return a->high_water;
+}
+
+
+// Pool
+
+// Storage is taken from arena when given, otherwise from Res_Alloc. Returns BSP_ERROR
+// when obj_size * count does not fit 32 bits or memory is not available.
+uint8_t Pool_Init(POOL * p, uint32_t obj_size, uint32_t count, ARENA * a) {
+	uint8_t overflow = (obj_size > UINT32_MAX - (sizeof(void *) - 1));
+
+	// Free list link is stored inside free objects
+	obj_size = (obj_size + sizeof(void *) - 1) & ~(uint32_t)(sizeof(void *) - 1);
+	if (obj_size < sizeof(void *)) obj_size = sizeof(void *);
+	if ((count) && (obj_size > UINT32_MAX / count)) overflow = 1;
+
+	p->obj_size = obj_size;
+	p->count = count;
+	p->owned = (a == NULL);
+	p->base = (overflow) ? NULL : (a) ? Arena_Alloc(a, obj_size * count) : BSP->Res_Alloc(obj_size * count);
+	p->high_water = 0;
+	if (p->base == NULL) {
+		p->count = 0;
+		p->free_list = NULL;
+		p->used = 0;
+		return BSP_ERROR;
+	}
+	Pool_Reset(p);
+	return BSP_OK;
+}
+
+void Pool_Destroy(POOL * p) {
+	if ((p->owned) && (p->base)) BSP->Res_Free(p->base);
+	p->base = NULL;
+	p->free_list = NULL;
+	p->count = 0;
+	p->used = 0;
+}
+
+void * Pool_Alloc(POOL * p) {
+	void ** obj = p->free_list;
+	if (obj == NULL) return NULL;
+	p->free_list = *obj;
+	p->used++;
+	if (p->used > p->high_water) p->high_water = p->used;
+	return obj;
+}
+
+void Pool_Free(POOL * p, void * obj) {
+	if (obj == NULL) return;
+	*(void **)obj = p->free_list;
+	p->free_list = obj;
+	p->used--;
+}
+
+// Returns all objects to pool (objects are linked in address order)
+void Pool_Reset(POOL * p) {
+	p->free_list = NULL;
+	for (uint32_t i = p->count; i > 0; i--) {
+		void ** obj = (void **)(p->base + (i - 1) * p->obj_size);
+		*obj = p->free_list;
+		p->free_list = obj;
+	}
+	p->used = 0;
+}
+
+uint32_t Pool_GetUsed(const POOL * p) {
+	return p->used;
+}
+
+uint32_t Pool_GetHighWater(const POOL * p) {
+	return p->high_water;
+}
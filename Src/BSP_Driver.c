@@ -3,12 +3,20 @@
  *******************************************************************/
 
 #include "BSP_Driver.h"
+#include "Log.h"
 
 BSP_Driver_TypeDef * BSP = (BSP_Driver_TypeDef *)0x08000400;
 
-// Overriding syscall __io_putchar(int ch) for redirecting printf output to USART2
+// Overriding syscall __io_putchar(int ch) - printf output is buffered in log ring
+// and sent to USART2 (or USB CDC) by LOG_Drain
 int __io_putchar(int ch) {
-	uint8_t * pData = (uint8_t *)&ch;
-	BSP->Serial_Transmit(pData, 1);
+	LOG_PutChar((char)ch);
 	return ch;
 }
+
+// Overriding syscall _write - whole printf buffer is stored as one record
+int _write(int file, char *ptr, int len) {
+	(void)file;
+	LOG_Text(LOG_LEVEL_INF, LOG_CAT_STDOUT, ptr, len);
+	return len;
+}
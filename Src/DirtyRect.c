@@ -0,0 +1,345 @@
+/*****************************************************************
+ * MiniConsole V3 - Dirty Rectangles
+ *******************************************************************/
+
+#include "DirtyRect.h"
+
+#define DR_FRAME_PIXELS		((uint32_t)LCD_WIDTH * LCD_HEIGHT)
+
+typedef struct {
+	DR_RECT		rect[DR_MAX_RECTS];
+	uint8_t		count;
+	uint8_t		full;
+} DR_LIST;
+
+static struct {
+	uint8_t		bpp;
+	uint8_t		buffer_mode;
+	uint32_t	frame_no;
+	uint8_t *	edit_addr;
+	uint8_t *	prev_addr;
+	DR_LIST		current;
+	DR_LIST		history[DR_MAX_HISTORY];
+	DR_STATS	stats;
+} dr;
+
+static const uint8_t dr_bpp[7] = { 0, 1, 2, 3, 2, 2, 4 };
+
+
+// Rectangle list management
+
+static inline uint32_t DR_Area(const DR_RECT * r) {
+	return (uint32_t)r->w * r->h;
+}
+
+static DR_RECT DR_Union(const DR_RECT * a, const DR_RECT * b) {
+	DR_RECT u;
+	int32_t x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+	int32_t y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+	u.x = (a->x < b->x) ? a->x : b->x;
+	u.y = (a->y < b->y) ? a->y : b->y;
+	u.w = (uint16_t)(x1 - u.x);
+	u.h = (uint16_t)(y1 - u.y);
+	return u;
+}
+
+static inline uint8_t DR_Contains(const DR_RECT * a, const DR_RECT * b) {
+	return (b->x >= a->x) && (b->y >= a->y) && (b->x + b->w <= a->x + a->w) && (b->y + b->h <= a->y + a->h);
+}
+
+// Adds rectangle to list, merging it with existing ones when union does not waste area
+static void DR_ListAdd(DR_LIST * list, DR_RECT r) {
+	uint8_t i = 0;
+
+	if (list->full) return;
+
+	while (i < list->count) {
+		DR_RECT * e = &list->rect[i];
+		if (DR_Contains(e, &r)) return;
+		DR_RECT u = DR_Union(e, &r);
+		if ((DR_Contains(&r, e)) || (DR_Area(&u) <= DR_Area(e) + DR_Area(&r))) {
+			// Merged rectangle may now overlap others - remove and restart
+			r = u;
+			list->rect[i] = list->rect[--list->count];
+			dr.stats.merges++;
+			i = 0;
+			continue;
+		}
+		i++;
+	}
+
+	if (list->count < DR_MAX_RECTS) {
+		list->rect[list->count++] = r;
+		return;
+	}
+
+	// List is full - merge with rectangle giving smallest growth
+	uint8_t best = 0;
+	uint32_t best_growth = 0xFFFFFFFF;
+	for (i = 0; i < list->count; i++) {
+		DR_RECT u = DR_Union(&list->rect[i], &r);
+		uint32_t growth = DR_Area(&u) - DR_Area(&list->rect[i]);
+		if (growth < best_growth) {
+			best_growth = growth;
+			best = i;
+		}
+	}
+	r = DR_Union(&list->rect[best], &r);
+	list->rect[best] = list->rect[--list->count];
+	dr.stats.merges++;
+	DR_ListAdd(list, r);
+}
+
+static void DR_Mark(int32_t x, int32_t y, int32_t w, int32_t h) {
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > LCD_WIDTH) w = LCD_WIDTH - x;
+	if (y + h > LCD_HEIGHT) h = LCD_HEIGHT - y;
+	if ((w <= 0) || (h <= 0)) return;
+
+	DR_RECT r = { (int16_t)x, (int16_t)y, (uint16_t)w, (uint16_t)h };
+	DR_ListAdd(&dr.current, r);
+}
+
+
+// Frame control
+
+void DR_Init(uint8_t color_mode, uint8_t buffer_mode) {
+	dr.bpp = (color_mode <= LCD_COLOR_MODE_ARGB8888) ? dr_bpp[color_mode] : 0;
+	dr.buffer_mode = (buffer_mode == LCD_BUFFER_MODE_TRIPLE) ? LCD_BUFFER_MODE_TRIPLE : LCD_BUFFER_MODE_DOUBLE;
+	dr.frame_no = 0;
+	dr.edit_addr = NULL;
+	dr.prev_addr = NULL;
+	dr.current.count = 0;
+	dr.current.full = 0;
+	for (uint8_t i = 0; i < DR_MAX_HISTORY; i++) {
+		dr.history[i].count = 0;
+		dr.history[i].full = 0;
+	}
+	dr.stats = (DR_STATS){0};
+}
+
+// Brings edit frame up to date with previous frame by copying areas changed since edit frame was last shown
+void DR_BeginFrame(void) {
+	DR_LIST carry;
+	uint32_t area = 0;
+	uint8_t frames = dr.buffer_mode - 1;
+
+	dr.edit_addr = BSP->LCD_GetEditFrameAddr();
+	dr.current.count = 0;
+	dr.current.full = 0;
+	dr.stats.rects = 0;
+	dr.stats.dirty_pixels = 0;
+	dr.stats.copied_pixels = 0;
+	dr.stats.merges = 0;
+
+	if ((dr.frame_no == 0) || (dr.prev_addr == NULL) || (dr.prev_addr == dr.edit_addr)) return;
+	if (frames > dr.frame_no) frames = (uint8_t)dr.frame_no;
+
+	carry.count = 0;
+	carry.full = 0;
+	for (uint8_t i = 0; i < frames; i++) {
+		if (dr.history[i].full) {
+			carry.full = 1;
+			break;
+		}
+		for (uint8_t j = 0; j < dr.history[i].count; j++) DR_ListAdd(&carry, dr.history[i].rect[j]);
+	}
+	dr.stats.merges = 0;
+
+	if (!carry.full) {
+		for (uint8_t i = 0; i < carry.count; i++) area += DR_Area(&carry.rect[i]);
+		if (area * 100 > DR_FRAME_PIXELS * DR_FULL_COPY_PCT) carry.full = 1;
+	}
+
+	if (carry.full) {
+		BSP->G2D_CopyPrevFrame();
+		dr.stats.copied_pixels = DR_FRAME_PIXELS;
+		dr.stats.full_copies++;
+		return;
+	}
+
+	for (uint8_t i = 0; i < carry.count; i++) {
+		DR_RECT * r = &carry.rect[i];
+		const uint8_t * src = dr.prev_addr + ((uint32_t)r->y * LCD_WIDTH + (uint32_t)r->x) * dr.bpp;
+		BSP->G2D_CopyBuf(src, (uint16_t)(LCD_WIDTH - r->w), (uint16_t)r->x, (uint16_t)r->y, r->w, r->h);
+	}
+	dr.stats.copied_pixels = area;
+}
+
+// Stores dirty areas of current frame - call before LCD_FrameReady
+void DR_EndFrame(void) {
+	for (uint8_t i = DR_MAX_HISTORY - 1; i > 0; i--) dr.history[i] = dr.history[i - 1];
+	dr.history[0] = dr.current;
+
+	dr.stats.rects = dr.current.count;
+	dr.stats.dirty_pixels = 0;
+	if (dr.current.full) {
+		dr.stats.dirty_pixels = DR_FRAME_PIXELS;
+	} else {
+		for (uint8_t i = 0; i < dr.current.count; i++) dr.stats.dirty_pixels += DR_Area(&dr.current.rect[i]);
+	}
+
+	dr.prev_addr = dr.edit_addr;
+	dr.frame_no++;
+}
+
+void DR_Invalidate(int16_t x, int16_t y, uint16_t width, uint16_t height) {
+	DR_Mark(x, y, width, height);
+}
+
+void DR_InvalidateAll(void) {
+	dr.current.full = 1;
+	dr.current.count = 0;
+}
+
+uint8_t DR_GetRects(const DR_RECT ** rects) {
+	if (rects) *rects = dr.current.rect;
+	return dr.current.count;
+}
+
+const DR_STATS * DR_GetStats(void) {
+	return &dr.stats;
+}
+
+
+// Tracked G2D calls
+
+void DR_ClearFrame(void) {
+	BSP->G2D_ClearFrame();
+	DR_InvalidateAll();
+}
+
+void DR_FillFrame(uint32_t color) {
+	BSP->G2D_FillFrame(color);
+	DR_InvalidateAll();
+}
+
+void DR_DrawPixel(int16_t x, int16_t y, uint32_t color) {
+	BSP->G2D_DrawPixel(x, y, color);
+	DR_Mark(x, y, 1, 1);
+}
+
+void DR_DrawHLine(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	BSP->G2D_DrawHLine(x, y, length, color);
+	DR_Mark(x, y, length, 1);
+}
+
+void DR_DrawHLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	BSP->G2D_DrawHLineBlend(x, y, length, color);
+	DR_Mark(x, y, length, 1);
+}
+
+void DR_DrawVLine(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	BSP->G2D_DrawVLine(x, y, length, color);
+	DR_Mark(x, y, 1, length);
+}
+
+void DR_DrawVLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	BSP->G2D_DrawVLineBlend(x, y, length, color);
+	DR_Mark(x, y, 1, length);
+}
+
+void DR_DrawLine(int16_t X1, int16_t Y1, int16_t X2, int16_t Y2, uint32_t color) {
+	BSP->G2D_DrawLine(X1, Y1, X2, Y2, color);
+	int16_t x0 = (X1 < X2) ? X1 : X2;
+	int16_t y0 = (Y1 < Y2) ? Y1 : Y2;
+	DR_Mark(x0, y0, ((X1 < X2) ? X2 : X1) - x0 + 1, ((Y1 < Y2) ? Y2 : Y1) - y0 + 1);
+}
+
+void DR_DrawRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	BSP->G2D_DrawRect(x, y, width, height, color);
+	DR_Mark(x, y, width, height);
+}
+
+void DR_DrawFillRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	BSP->G2D_DrawFillRect(x, y, width, height, color);
+	DR_Mark(x, y, width, height);
+}
+
+void DR_DrawFillRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	BSP->G2D_DrawFillRectBlend(x, y, width, height, color);
+	DR_Mark(x, y, width, height);
+}
+
+void DR_DrawCircle(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	BSP->G2D_DrawCircle(x, y, r, color);
+	DR_Mark(x - r, y - r, 2 * r + 1, 2 * r + 1);
+}
+
+void DR_DrawFillCircle(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	BSP->G2D_DrawFillCircle(x, y, r, color);
+	DR_Mark(x - r, y - r, 2 * r + 1, 2 * r + 1);
+}
+
+void DR_DrawFillCircleBlend(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	BSP->G2D_DrawFillCircleBlend(x, y, r, color);
+	DR_Mark(x - r, y - r, 2 * r + 1, 2 * r + 1);
+}
+
+void DR_DrawRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	BSP->G2D_DrawRoundRect(x, y, width, height, radius, color);
+	DR_Mark(x, y, width, height);
+}
+
+void DR_DrawFillRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	BSP->G2D_DrawFillRoundRect(x, y, width, height, radius, color);
+	DR_Mark(x, y, width, height);
+}
+
+void DR_DrawFillRoundRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	BSP->G2D_DrawFillRoundRectBlend(x, y, width, height, radius, color);
+	DR_Mark(x, y, width, height);
+}
+
+uint16_t DR_Text(int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color, uint32_t bgcolor) {
+	uint16_t w = BSP->G2D_Text(x, y, font, str, color, bgcolor);
+	DR_Mark(x, y, w, BSP->G2D_GetTextHeight(font));
+	return w;
+}
+
+uint16_t DR_TextBlend(int16_t x, int16_t y, const uint8_t *font, char *str, uint32_t color) {
+	uint16_t w = BSP->G2D_TextBlend(x, y, font, str, color);
+	DR_Mark(x, y, w, BSP->G2D_GetTextHeight(font));
+	return w;
+}
+
+void DR_DrawBitmap(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height) {
+	BSP->G2D_DrawBitmap(sourcedata, x, y, width, height);
+	DR_Mark(x, y, width, height);
+}
+
+void DR_DrawBitmapC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height) {
+	BSP->G2D_DrawBitmapC(sourcedata, x, y, width, height);
+	DR_Mark(x - width / 2, y - height / 2, width, height);
+}
+
+void DR_DrawBitmapBlend(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha) {
+	BSP->G2D_DrawBitmapBlend(sourcedata, x, y, width, height, alpha);
+	DR_Mark(x, y, width, height);
+}
+
+void DR_DrawBitmapBlendC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha) {
+	BSP->G2D_DrawBitmapBlendC(sourcedata, x, y, width, height, alpha);
+	DR_Mark(x - width / 2, y - height / 2, width, height);
+}
+
+void DR_DrawIcon(const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor) {
+	BSP->G2D_DrawIcon(iconsource, x, y, color, bgcolor);
+	DR_Mark(x, y, BSP->G2D_GetIconWidth(iconsource), BSP->G2D_GetIconHeight(iconsource));
+}
+
+void DR_DrawIconBlend(const void * iconsource, int16_t x, int16_t y, uint32_t color) {
+	BSP->G2D_DrawIconBlend(iconsource, x, y, color);
+	DR_Mark(x, y, BSP->G2D_GetIconWidth(iconsource), BSP->G2D_GetIconHeight(iconsource));
+}
+
+void DR_CopyBuf(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height) {
+	BSP->G2D_CopyBuf(src_addr, offsline_src, x_dest, y_dest, width, height);
+	DR_Mark(x_dest, y_dest, width, height);
+}
+
+void DR_CopyBufBlend(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height, uint8_t alpha) {
+	BSP->G2D_CopyBufBlend(src_addr, offsline_src, x_dest, y_dest, width, height, alpha);
+	DR_Mark(x_dest, y_dest, width, height);
+}
@@ -0,0 +1,466 @@
+/*****************************************************************
+ * MiniConsole V3 - Display List
+ *******************************************************************/
+
+#include "DisplayList.h"
+#include "Font.h"
+#include "TileRender.h"
+
+typedef struct {
+	DL_CMD		cmd[DL_MAX_CMDS];
+	uint16_t	order[DL_MAX_CMDS];
+	uint16_t	count;
+	uint16_t	exec_count;
+	uint16_t	str_used;
+	uint8_t		valid;
+	char		str[DL_STR_POOL_SIZE];
+} DL_LIST;
+
+static DL_LIST dl_list[2];
+static DL_LIST * dl_rec = &dl_list[0];
+static DL_LIST * dl_cache = NULL;
+static uint8_t dl_overflow = 0;
+static DL_STATS dl_stats;
+static uint8_t dl_tiled = 0;
+
+
+// Helpers
+
+static inline uint8_t DL_BoxOverlap(const DL_BOX * a, const DL_BOX * b) {
+	return (a->x < b->x + b->w) && (b->x < a->x + a->w) && (a->y < b->y + b->h) && (b->y < a->y + a->h);
+}
+
+static inline uint8_t DL_BoxContains(const DL_BOX * a, const DL_BOX * b) {
+	return (b->x >= a->x) && (b->y >= a->y) && (b->x + b->w <= a->x + a->w) && (b->y + b->h <= a->y + a->h);
+}
+
+static inline uint8_t DL_IsFill(uint8_t type) {
+	return (type == DL_CMD_FILLRECT) || (type == DL_CMD_FILLRECT_BLEND);
+}
+
+static void DL_Execute(const DL_CMD * c) {
+	switch (c->type) {
+	case DL_CMD_CLEAR:					BSP->G2D_ClearFrame(); break;
+	case DL_CMD_FILLFRAME:				BSP->G2D_FillFrame(c->color); break;
+	case DL_CMD_PIXEL:					BSP->G2D_DrawPixel(c->x, c->y, c->color); break;
+	case DL_CMD_HLINE:					BSP->G2D_DrawHLine(c->x, c->y, c->w, c->color); break;
+	case DL_CMD_HLINE_BLEND:			BSP->G2D_DrawHLineBlend(c->x, c->y, c->w, c->color); break;
+	case DL_CMD_VLINE:					BSP->G2D_DrawVLine(c->x, c->y, c->h, c->color); break;
+	case DL_CMD_VLINE_BLEND:			BSP->G2D_DrawVLineBlend(c->x, c->y, c->h, c->color); break;
+	case DL_CMD_LINE:					BSP->G2D_DrawLine(c->x, c->y, c->w, c->h, c->color); break;
+	case DL_CMD_RECT:					BSP->G2D_DrawRect(c->x, c->y, c->w, c->h, c->color); break;
+	case DL_CMD_FILLRECT:				BSP->G2D_DrawFillRect(c->x, c->y, c->w, c->h, c->color); break;
+	case DL_CMD_FILLRECT_BLEND:			BSP->G2D_DrawFillRectBlend(c->x, c->y, c->w, c->h, c->color); break;
+	case DL_CMD_CIRCLE:					BSP->G2D_DrawCircle(c->x, c->y, c->p, c->color); break;
+	case DL_CMD_FILLCIRCLE:				BSP->G2D_DrawFillCircle(c->x, c->y, c->p, c->color); break;
+	case DL_CMD_FILLCIRCLE_BLEND:		BSP->G2D_DrawFillCircleBlend(c->x, c->y, c->p, c->color); break;
+	case DL_CMD_ROUNDRECT:				BSP->G2D_DrawRoundRect(c->x, c->y, c->w, c->h, c->p, c->color); break;
+	case DL_CMD_FILLROUNDRECT:			BSP->G2D_DrawFillRoundRect(c->x, c->y, c->w, c->h, c->p, c->color); break;
+	case DL_CMD_FILLROUNDRECT_BLEND:	BSP->G2D_DrawFillRoundRectBlend(c->x, c->y, c->w, c->h, c->p, c->color); break;
+	case DL_CMD_TEXT:					Font_Text(c->x, c->y, c->src, c->str, c->color, c->bgcolor); break;
+	case DL_CMD_TEXT_BLEND:				Font_TextBlend(c->x, c->y, c->src, c->str, c->color); break;
+	case DL_CMD_BITMAP:					BSP->G2D_DrawBitmap(c->src, c->x, c->y, c->w, c->h); break;
+	case DL_CMD_BITMAP_BLEND:			BSP->G2D_DrawBitmapBlend(c->src, c->x, c->y, c->w, c->h, c->alpha); break;
+	case DL_CMD_ICON:					BSP->G2D_DrawIcon(c->src, c->x, c->y, c->color, c->bgcolor); break;
+	case DL_CMD_ICON_BLEND:				BSP->G2D_DrawIconBlend(c->src, c->x, c->y, c->color); break;
+	case DL_CMD_COPYBUF:				BSP->G2D_CopyBuf(c->src, c->p, c->x, c->y, c->w, c->h); break;
+	case DL_CMD_COPYBUF_BLEND:			BSP->G2D_CopyBufBlend(c->src, c->p, c->x, c->y, c->w, c->h, c->alpha); break;
+	}
+}
+
+
+// Optimisation
+
+// Removes commands fully covered by later opaque commands
+static void DL_Cull(DL_LIST * list) {
+	for (int32_t j = list->count - 1; j > 0; j--) {
+		DL_CMD * o = &list->cmd[j];
+		if ((o->flags & (DL_FLAG_OPAQUE | DL_FLAG_CULLED)) != DL_FLAG_OPAQUE) continue;
+		for (int32_t i = 0; i < j; i++) {
+			DL_CMD * c = &list->cmd[i];
+			if (c->flags & DL_FLAG_CULLED) continue;
+			if (DL_BoxContains(&o->box, &c->box)) {
+				c->flags |= DL_FLAG_CULLED;
+				dl_stats.culled++;
+			}
+		}
+	}
+}
+
+// Returns 1 if command a should be placed before b when they do not overlap
+static inline uint8_t DL_Before(const DL_CMD * a, const DL_CMD * b) {
+	if (a->type != b->type) return a->type < b->type;
+	if (a->box.y != b->box.y) return a->box.y < b->box.y;
+	return a->box.x < b->box.x;
+}
+
+// Builds execution order: each command is moved back over commands it does not overlap,
+// so commands of the same type form batches sorted by position
+static void DL_Sort(DL_LIST * list) {
+	uint16_t n = 0;
+
+	for (uint16_t i = 0; i < list->count; i++) {
+		DL_CMD * c = &list->cmd[i];
+		if (c->flags & DL_FLAG_CULLED) continue;
+
+		uint16_t pos = n;
+		while (pos > 0) {
+			DL_CMD * p = &list->cmd[list->order[pos - 1]];
+			if (DL_BoxOverlap(&p->box, &c->box)) break;
+			if (!DL_Before(c, p)) break;
+			pos--;
+		}
+		// Move only to join a batch of the same type - otherwise keep recorded position
+		if ((pos < n) && !((pos > 0) && (list->cmd[list->order[pos - 1]].type == c->type)) && (list->cmd[list->order[pos]].type != c->type)) pos = n;
+		if (pos < n) dl_stats.reordered++;
+		for (uint16_t k = n; k > pos; k--) list->order[k] = list->order[k - 1];
+		list->order[pos] = i;
+		n++;
+	}
+	list->exec_count = n;
+}
+
+// Merges neighbouring fills of same colour sharing whole edge
+static void DL_Merge(DL_LIST * list) {
+	uint16_t n = 0;
+
+	for (uint16_t i = 0; i < list->exec_count; i++) {
+		DL_CMD * c = &list->cmd[list->order[i]];
+		if ((n > 0) && DL_IsFill(c->type)) {
+			DL_CMD * p = &list->cmd[list->order[n - 1]];
+			if ((p->type == c->type) && (p->color == c->color)) {
+				if ((p->y == c->y) && (p->h == c->h) && (p->x + p->w == c->x)) {
+					p->w += c->w;
+				} else if ((p->x == c->x) && (p->w == c->w) && (p->y + p->h == c->y)) {
+					p->h += c->h;
+				} else {
+					list->order[n++] = list->order[i];
+					continue;
+				}
+				int16_t x1 = (p->box.x + p->box.w > c->box.x + c->box.w) ? p->box.x + p->box.w : c->box.x + c->box.w;
+				int16_t y1 = (p->box.y + p->box.h > c->box.y + c->box.h) ? p->box.y + p->box.h : c->box.y + c->box.h;
+				p->box.x = (p->box.x < c->box.x) ? p->box.x : c->box.x;
+				p->box.y = (p->box.y < c->box.y) ? p->box.y : c->box.y;
+				p->box.w = x1 - p->box.x;
+				p->box.h = y1 - p->box.y;
+				dl_stats.merged++;
+				continue;
+			}
+		}
+		list->order[n++] = list->order[i];
+	}
+	list->exec_count = n;
+}
+
+// Executes list through tiled renderer or directly with BSP calls
+static void DL_Run(DL_LIST * list) {
+	if ((dl_tiled) && (TR_Render(list->cmd, list->order, list->exec_count) == BSP_OK)) return;
+	for (uint16_t i = 0; i < list->exec_count; i++) DL_Execute(&list->cmd[list->order[i]]);
+}
+
+static void DL_Flush(DL_LIST * list) {
+	DL_Cull(list);
+	DL_Sort(list);
+	DL_Merge(list);
+	DL_Run(list);
+	dl_stats.executed += list->exec_count;
+}
+
+
+// Recording
+
+static DL_CMD * DL_Add(uint8_t type, int32_t bx, int32_t by, int32_t bw, int32_t bh) {
+	if (bx < 0) { bw += bx; bx = 0; }
+	if (by < 0) { bh += by; by = 0; }
+	if (bx + bw > LCD_WIDTH) bw = LCD_WIDTH - bx;
+	if (by + bh > LCD_HEIGHT) bh = LCD_HEIGHT - by;
+	dl_stats.submitted++;
+
+	// Nothing visible
+	if ((bw <= 0) || (bh <= 0)) {
+		dl_stats.culled++;
+		return NULL;
+	}
+
+	if (dl_rec->count == DL_MAX_CMDS) {
+		// List full - execute what was recorded so far and continue with empty list (frame is not cached)
+		DL_Flush(dl_rec);
+		dl_rec->count = 0;
+		dl_rec->str_used = 0;
+		dl_overflow = 1;
+		dl_stats.flushes++;
+	}
+
+	DL_CMD * c = &dl_rec->cmd[dl_rec->count++];
+	c->type = type;
+	c->flags = 0;
+	c->alpha = 0xFF;
+	c->src = NULL;
+	c->str = NULL;
+	c->p = 0;
+	c->color = 0;
+	c->bgcolor = 0;
+	c->box.x = (int16_t)bx;
+	c->box.y = (int16_t)by;
+	c->box.w = (int16_t)bw;
+	c->box.h = (int16_t)bh;
+	return c;
+}
+
+static DL_CMD * DL_AddRect(uint8_t type, int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+	DL_CMD * c = DL_Add(type, x, y, w, h);
+	if (c == NULL) return NULL;
+	c->x = x;
+	c->y = y;
+	c->w = w;
+	c->h = h;
+	c->color = color;
+	return c;
+}
+
+static const char * DL_CopyStr(const char * str) {
+	uint16_t len = 0;
+	while (str[len]) len++;
+	if (dl_rec->str_used + len + 1 > DL_STR_POOL_SIZE) return NULL;
+	char * dst = &dl_rec->str[dl_rec->str_used];
+	for (uint16_t i = 0; i <= len; i++) dst[i] = str[i];
+	dl_rec->str_used += len + 1;
+	return dst;
+}
+
+static uint16_t DL_AddText(uint8_t type, int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, uint32_t bgcolor) {
+	if ((font == NULL) || (str == NULL)) return 0;
+	uint16_t width = Font_GetTextWidth(font, str);
+	DL_CMD * c = DL_AddRect(type, x, y, width, Font_GetHeight(font), color);
+	if (c == NULL) return width;
+	c->src = font;
+	c->bgcolor = bgcolor;
+	c->str = DL_CopyStr(str);
+	if (c->str == NULL) {
+		// String pool exhausted - draw immediately
+		dl_rec->count--;
+		if (type == DL_CMD_TEXT) Font_Text(x, y, font, str, color, bgcolor);
+		else Font_TextBlend(x, y, font, str, color);
+		dl_stats.executed++;
+		dl_overflow = 1;
+		return width;
+	}
+	if (type == DL_CMD_TEXT) c->flags |= DL_FLAG_OPAQUE;
+	return width;
+}
+
+
+// List control
+
+void DL_Begin(void) {
+	// Record into list which is not cached
+	dl_rec = (dl_cache == &dl_list[0]) ? &dl_list[1] : &dl_list[0];
+	dl_rec->count = 0;
+	dl_rec->exec_count = 0;
+	dl_rec->str_used = 0;
+	dl_rec->valid = 0;
+	dl_overflow = 0;
+
+	dl_stats.submitted = 0;
+	dl_stats.culled = 0;
+	dl_stats.merged = 0;
+	dl_stats.reordered = 0;
+	dl_stats.executed = 0;
+	dl_stats.flushes = 0;
+	if (dl_tiled) TR_ResetStats();
+}
+
+uint8_t DL_End(void) {
+	DL_Flush(dl_rec);
+
+	if (dl_overflow) {
+		// Frame was executed in parts - it can not be replayed
+		dl_cache = NULL;
+		return BSP_ERROR;
+	}
+
+	dl_rec->valid = 1;
+	dl_cache = dl_rec;
+	return BSP_OK;
+}
+
+uint8_t DL_Replay(void) {
+	if ((dl_cache == NULL) || (!dl_cache->valid)) return BSP_ERROR;
+	if (dl_tiled) TR_ResetStats();
+	DL_Run(dl_cache);
+	dl_stats.executed = dl_cache->exec_count;
+	dl_stats.replays++;
+	return BSP_OK;
+}
+
+uint8_t DL_IsCached(void) {
+	return (dl_cache != NULL) && (dl_cache->valid);
+}
+
+void DL_Invalidate(void) {
+	dl_cache = NULL;
+}
+
+const DL_STATS * DL_GetStats(void) {
+	return &dl_stats;
+}
+
+// Lists are rasterised by TileRender (TR_Init must be called first) instead of BSP calls
+void DL_SetTiled(uint8_t enable) {
+	dl_tiled = enable;
+}
+
+
+// Recorded G2D calls
+
+void DL_ClearFrame(void) {
+	DL_CMD * c = DL_Add(DL_CMD_CLEAR, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+	c->flags |= DL_FLAG_OPAQUE;
+}
+
+void DL_FillFrame(uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_FILLFRAME, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+	c->color = color;
+	c->flags |= DL_FLAG_OPAQUE;
+}
+
+void DL_DrawPixel(int16_t x, int16_t y, uint32_t color) {
+	DL_AddRect(DL_CMD_PIXEL, x, y, 1, 1, color);
+}
+
+void DL_DrawHLine(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_HLINE, x, y, length, 1);
+	if (c == NULL) return;
+	c->x = x; c->y = y; c->w = length; c->color = color;
+}
+
+void DL_DrawHLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_HLINE_BLEND, x, y, length, 1);
+	if (c == NULL) return;
+	c->x = x; c->y = y; c->w = length; c->color = color;
+}
+
+void DL_DrawVLine(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_VLINE, x, y, 1, length);
+	if (c == NULL) return;
+	c->x = x; c->y = y; c->h = length; c->color = color;
+}
+
+void DL_DrawVLineBlend(int16_t x, int16_t y, int16_t length, uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_VLINE_BLEND, x, y, 1, length);
+	if (c == NULL) return;
+	c->x = x; c->y = y; c->h = length; c->color = color;
+}
+
+void DL_DrawLine(int16_t X1, int16_t Y1, int16_t X2, int16_t Y2, uint32_t color) {
+	int16_t x0 = (X1 < X2) ? X1 : X2;
+	int16_t y0 = (Y1 < Y2) ? Y1 : Y2;
+	DL_CMD * c = DL_Add(DL_CMD_LINE, x0, y0, ((X1 < X2) ? X2 : X1) - x0 + 1, ((Y1 < Y2) ? Y2 : Y1) - y0 + 1);
+	if (c == NULL) return;
+	c->x = X1; c->y = Y1; c->w = X2; c->h = Y2; c->color = color;
+}
+
+void DL_DrawRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	DL_AddRect(DL_CMD_RECT, x, y, width, height, color);
+}
+
+void DL_DrawFillRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	DL_CMD * c = DL_AddRect(DL_CMD_FILLRECT, x, y, width, height, color);
+	if (c) c->flags |= DL_FLAG_OPAQUE;
+}
+
+void DL_DrawFillRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint32_t color) {
+	DL_AddRect(DL_CMD_FILLRECT_BLEND, x, y, width, height, color);
+}
+
+void DL_DrawCircle(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_CIRCLE, x - r, y - r, 2 * r + 1, 2 * r + 1);
+	if (c == NULL) return;
+	c->x = x; c->y = y; c->p = r; c->color = color;
+}
+
+void DL_DrawFillCircle(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_FILLCIRCLE, x - r, y - r, 2 * r + 1, 2 * r + 1);
+	if (c == NULL) return;
+	c->x = x; c->y = y; c->p = r; c->color = color;
+}
+
+void DL_DrawFillCircleBlend(int16_t x, int16_t y, uint16_t r, uint32_t color) {
+	DL_CMD * c = DL_Add(DL_CMD_FILLCIRCLE_BLEND, x - r, y - r, 2 * r + 1, 2 * r + 1);
+	if (c == NULL) return;
+	c->x = x; c->y = y; c->p = r; c->color = color;
+}
+
+void DL_DrawRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	DL_CMD * c = DL_AddRect(DL_CMD_ROUNDRECT, x, y, width, height, color);
+	if (c) c->p = radius;
+}
+
+void DL_DrawFillRoundRect(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	DL_CMD * c = DL_AddRect(DL_CMD_FILLROUNDRECT, x, y, width, height, color);
+	if (c) c->p = radius;
+}
+
+void DL_DrawFillRoundRectBlend(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t color) {
+	DL_CMD * c = DL_AddRect(DL_CMD_FILLROUNDRECT_BLEND, x, y, width, height, color);
+	if (c) c->p = radius;
+}
+
+uint16_t DL_Text(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, uint32_t bgcolor) {
+	return DL_AddText(DL_CMD_TEXT, x, y, font, str, color, bgcolor);
+}
+
+uint16_t DL_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color) {
+	return DL_AddText(DL_CMD_TEXT_BLEND, x, y, font, str, color, 0);
+}
+
+void DL_DrawBitmap(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height) {
+	DL_CMD * c = DL_AddRect(DL_CMD_BITMAP, x, y, width, height, 0);
+	if (c == NULL) return;
+	c->src = sourcedata;
+	c->flags |= DL_FLAG_OPAQUE;
+}
+
+void DL_DrawBitmapC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height) {
+	DL_DrawBitmap(sourcedata, x - width / 2, y - height / 2, width, height);
+}
+
+void DL_DrawBitmapBlend(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha) {
+	DL_CMD * c = DL_AddRect(DL_CMD_BITMAP_BLEND, x, y, width, height, 0);
+	if (c == NULL) return;
+	c->src = sourcedata;
+	c->alpha = alpha;
+}
+
+void DL_DrawBitmapBlendC(const void * sourcedata, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t alpha) {
+	DL_DrawBitmapBlend(sourcedata, x - width / 2, y - height / 2, width, height, alpha);
+}
+
+void DL_DrawIcon(const void * iconsource, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor) {
+	DL_CMD * c = DL_AddRect(DL_CMD_ICON, x, y, BSP->G2D_GetIconWidth(iconsource), BSP->G2D_GetIconHeight(iconsource), color);
+	if (c == NULL) return;
+	c->src = iconsource;
+	c->bgcolor = bgcolor;
+	c->flags |= DL_FLAG_OPAQUE;
+}
+
+void DL_DrawIconBlend(const void * iconsource, int16_t x, int16_t y, uint32_t color) {
+	DL_CMD * c = DL_AddRect(DL_CMD_ICON_BLEND, x, y, BSP->G2D_GetIconWidth(iconsource), BSP->G2D_GetIconHeight(iconsource), color);
+	if (c) c->src = iconsource;
+}
+
+void DL_CopyBuf(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height) {
+	DL_CMD * c = DL_AddRect(DL_CMD_COPYBUF, x_dest, y_dest, width, height, 0);
+	if (c == NULL) return;
+	c->src = src_addr;
+	c->p = offsline_src;
+	c->flags |= DL_FLAG_OPAQUE;
+}
+
+void DL_CopyBufBlend(const void * src_addr, uint16_t offsline_src, uint16_t x_dest, uint16_t y_dest, uint16_t width, uint16_t height, uint8_t alpha) {
+	DL_CMD * c = DL_AddRect(DL_CMD_COPYBUF_BLEND, x_dest, y_dest, width, height, 0);
+	if (c == NULL) return;
+	c->src = src_addr;
+	c->p = offsline_src;
+	c->alpha = alpha;
+}
@@ -0,0 +1,345 @@
+/*****************************************************************
+ * MiniConsole V3 - Font Access
+ *******************************************************************/
+
+#include <string.h>
+#include "Font.h"
+
+typedef struct {
+	const uint8_t *	font;			// Font containing glyph (first font or fallback)
+	const uint8_t *	data;			// Advance width followed by pixel stream
+	const uint8_t *	end;
+	int32_t			index;			// Glyph index in font
+} FONT_GLYPH;
+
+typedef struct {
+	const uint8_t *	font;
+	const uint8_t *	fallback;
+} FONT_FALLBACK;
+
+static FONT_FALLBACK font_fallback[FONT_MAX_FALLBACKS];
+static uint8_t font_icon[2][4 + FONT_MAX_GLYPH_PIXELS] __attribute__((aligned(4)));
+static uint8_t font_icon_sel = 0;
+
+
+static inline uint16_t Font_Rd16(const uint8_t *p) {
+	uint16_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t Font_Rd32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint8_t Font_IsV2(const uint8_t *font) {
+	return (font[0] == 0) && (font[1] == FONT_V2_VERSION);
+}
+
+static inline uint8_t Font_SpaceAdvance(const uint8_t *font) {
+	return (Font_IsV2(font)) ? font[3] : font[1];
+}
+
+// Looks glyph up in single font (no fallback)
+static uint8_t Font_Find(const uint8_t *font, uint32_t cp, FONT_GLYPH * g) {
+	if (!Font_IsV2(font)) {
+		if ((cp < FONT_FIRST_CHAR) || (cp > FONT_LAST_CHAR)) return 0;
+		uint32_t idx = cp - FONT_FIRST_CHAR;
+		g->font = font;
+		g->data = font + Font_Rd16(font + 2 + 2 * idx);
+		g->end = font + Font_Rd16(font + 4 + 2 * idx);
+		g->index = idx;
+		return 1;
+	}
+
+	if (cp > 0xFFFF) return 0;
+	uint16_t page = Font_Rd16(font + FONT_V2_HEADER + 2 * (cp >> 8));
+	if (page == 0) return 0;
+	uint16_t gi = Font_Rd16(font + Font_Rd32(font + 8) + (uint32_t)(page - 1) * 512 + 2 * (cp & 0xFF));
+	if (gi == 0) return 0;
+
+	const uint8_t * offs = font + Font_Rd32(font + 12) + 4 * (uint32_t)(gi - 1);
+	g->font = font;
+	g->data = font + Font_Rd32(offs);
+	g->end = font + Font_Rd32(offs + 4);
+	g->index = gi - 1;
+	return 1;
+}
+
+static const uint8_t * Font_GetFallback(const uint8_t *font) {
+	for (uint8_t i = 0; i < FONT_MAX_FALLBACKS; i++) {
+		if (font_fallback[i].font == font) return font_fallback[i].fallback;
+	}
+	return NULL;
+}
+
+// Looks glyph up in font and its fallback chain
+static uint8_t Font_Resolve(const uint8_t *font, uint32_t cp, FONT_GLYPH * g) {
+	for (uint8_t depth = 0; (font) && (depth <= FONT_MAX_FALLBACKS); depth++) {
+		if (Font_Find(font, cp, g)) return 1;
+		font = Font_GetFallback(font);
+	}
+	return 0;
+}
+
+// Kerning between two glyphs of same v2 font (binary search in sorted pairs)
+static int8_t Font_KernPair(const uint8_t *font, int32_t left, int32_t right) {
+	uint16_t count = Font_Rd16(font + 6);
+	const uint8_t * keys = font + Font_Rd32(font + 16);
+	uint32_t key = ((uint32_t)left << 16) | (uint32_t)right;
+	uint32_t lo = 0, hi = count;
+
+	while (lo < hi) {
+		uint32_t mid = (lo + hi) / 2;
+		uint32_t k = Font_Rd32(keys + 4 * mid);
+		if (k == key) return (int8_t)keys[4 * (uint32_t)count + mid];
+		if (k < key) lo = mid + 1; else hi = mid;
+	}
+	return 0;
+}
+
+static uint8_t Font_IsASCII(const char *str) {
+	for (; *str; str++) if ((uint8_t)*str >= 0x80) return 0;
+	return 1;
+}
+
+
+// Font properties
+
+// Returns 1 for v2 (Unicode) fonts
+uint8_t Font_IsUnicode(const uint8_t *font) {
+	return (font) ? Font_IsV2(font) : 0;
+}
+
+uint8_t Font_GetHeight(const uint8_t *font) {
+	if (font == NULL) return 0;
+	return (Font_IsV2(font)) ? font[2] : font[0];
+}
+
+// Returns 1 when font or any of its fallbacks has glyph for codepoint
+uint8_t Font_HasGlyph(const uint8_t *font, uint32_t cp) {
+	FONT_GLYPH g;
+	if (font == NULL) return 0;
+	return Font_Resolve(font, cp, &g);
+}
+
+uint8_t Font_GetCharWidth(const uint8_t *font, char ch) {
+	return Font_GetCodepointWidth(font, (uint8_t)ch);
+}
+
+uint8_t Font_GetCodepointWidth(const uint8_t *font, uint32_t cp) {
+	FONT_GLYPH g;
+	if (!Font_Resolve(font, cp, &g)) return Font_SpaceAdvance(font);
+	return g.data[0];
+}
+
+// Returns kerning adjustment for pair of codepoints (v2 fonts, 0 when pair is not kerned)
+int8_t Font_GetKerning(const uint8_t *font, uint32_t left, uint32_t right) {
+	FONT_GLYPH l, r;
+	if ((font == NULL) || (!Font_IsV2(font)) || (Font_Rd16(font + 6) == 0)) return 0;
+	if ((!Font_Find(font, left, &l)) || (!Font_Find(font, right, &r))) return 0;
+	return Font_KernPair(font, l.index, r.index);
+}
+
+// Width of v1 glyphs in bytes 33 - 126 (and other ASCII as space when plain). Stops at byte
+// that needs UTF-8 decoding or fallback lookup, at terminating zero or at end.
+static int32_t Font_WidthV1(const uint8_t *font, const char **str, const char *end, uint8_t plain) {
+	const uint8_t * p = (const uint8_t *)*str;
+	int32_t width = 0;
+	while (p < (const uint8_t *)end) {
+		uint32_t idx = (uint32_t)*p - FONT_FIRST_CHAR;
+		if (idx <= FONT_LAST_CHAR - FONT_FIRST_CHAR) {
+			width += font[Font_Rd16(font + 2 + 2 * idx)];
+		} else {
+			if ((*p == 0) || (*p >= 0x80) || (!plain)) break;
+			width += font[1];
+		}
+		p++;
+	}
+	*str = (const char *)p;
+	return width;
+}
+
+// Width of UTF-8 text including kerning
+uint16_t Font_GetTextWidthN(const uint8_t *font, const char *str, uint16_t len) {
+	const char * end = str + len;
+	int32_t width = 0;
+	int32_t prev = -1;
+	uint8_t kern, v1, plain;
+
+	if ((font == NULL) || (str == NULL)) return 0;
+	kern = (Font_IsV2(font)) && (Font_Rd16(font + 6) > 0);
+	v1 = !Font_IsV2(font);
+	plain = (Font_GetFallback(font) == NULL);
+
+	while ((str < end) && (*str)) {
+		// v1 - byte loop over table, leaves only for bytes >= 0x80 (or for fallback)
+		if (v1) {
+			width += Font_WidthV1(font, &str, end, plain);
+			if ((str >= end) || (*str == 0)) break;
+		}
+
+		uint32_t cp = Font_UTF8Next(&str);
+		FONT_GLYPH g;
+		if (!Font_Resolve(font, cp, &g)) {
+			width += Font_SpaceAdvance(font);
+			prev = -1;
+			continue;
+		}
+		if ((kern) && (g.font == font)) {
+			if (prev >= 0) width += Font_KernPair(font, prev, g.index);
+			prev = g.index;
+		} else {
+			prev = -1;
+		}
+		width += g.data[0];
+	}
+	return (width > 0) ? (uint16_t)width : 0;
+}
+
+uint16_t Font_GetTextWidth(const uint8_t *font, const char *str) {
+	return Font_GetTextWidthN(font, str, 0xFFFF);
+}
+
+
+// Glyph decoding
+
+// Decodes pixel stream of glyph with src_h rows into mask of dst_h rows, shifted by row_off
+static void Font_Decode(const FONT_GLYPH * g, uint8_t src_h, uint8_t *mask, uint8_t dst_h, int32_t row_off) {
+	uint8_t width = g->data[0];
+	uint32_t total = (uint32_t)width * src_h;
+	uint32_t pos = 0;
+
+	if ((row_off == 0) && (src_h == dst_h)) {
+		for (const uint8_t * p = g->data + 1; (p < g->end) && (pos < total); p++) {
+			uint8_t op = *p >> 6;
+			if (op == 0) {
+				for (uint32_t n = *p & 0x3F; n && (pos < total); n--) mask[pos++] = 0;
+			} else if (op == 3) {
+				for (uint32_t n = *p & 0x3F; n && (pos < total); n--) mask[pos++] = 0xFF;
+			} else {
+				for (int32_t s = 6; (s >= 0) && (pos < total); s -= 2) mask[pos++] = ((*p >> s) & 0x03) * 85;
+			}
+		}
+		while (pos < total) mask[pos++] = 0;
+		return;
+	}
+
+	// Fallback glyph of other height - rows outside of mask are clipped
+	for (uint32_t i = 0; i < (uint32_t)width * dst_h; i++) mask[i] = 0;
+	int32_t first = (row_off < 0) ? -row_off * width : 0;
+	int32_t last = (int32_t)(dst_h - row_off) * width;
+	int32_t shift = row_off * width;
+	for (const uint8_t * p = g->data + 1; (p < g->end) && (pos < total); p++) {
+		uint8_t op = *p >> 6;
+		uint32_t n = (op == 0) || (op == 3) ? (*p & 0x3Fu) : 4;
+		for (uint32_t k = 0; (k < n) && (pos < total); k++, pos++) {
+			uint8_t a = (op == 0) ? 0 : (op == 3) ? 0xFF : ((*p >> (6 - 2 * k)) & 0x03) * 85;
+			if (((int32_t)pos >= first) && ((int32_t)pos < last)) mask[pos + shift] = a;
+		}
+	}
+}
+
+// Decodes glyph into A8 mask (advance width x height bytes). Returns advance width.
+uint8_t Font_DecodeGlyph(const uint8_t *font, char ch, uint8_t *mask) {
+	return Font_DecodeCodepoint(font, (uint8_t)ch, mask);
+}
+
+// Decodes glyph (from font or its fallbacks) into A8 mask (advance width x height of font).
+// Returns advance width.
+uint8_t Font_DecodeCodepoint(const uint8_t *font, uint32_t cp, uint8_t *mask) {
+	uint8_t height = Font_GetHeight(font);
+	FONT_GLYPH g;
+
+	if (!Font_Resolve(font, cp, &g)) {
+		uint8_t w = Font_SpaceAdvance(font);
+		for (uint32_t i = 0; i < (uint32_t)w * height; i++) mask[i] = 0;
+		return w;
+	}
+	uint8_t gh = Font_GetHeight(g.font);
+	Font_Decode(&g, gh, mask, height, ((int32_t)height - gh) / 2);
+	return g.data[0];
+}
+
+
+// Drawing
+
+// Draws UTF-8 text glyph by glyph with icon function (parameters of G2D_DrawIconBlend). Glyphs
+// outside of columns x0..x1-1 are skipped without decoding. Returns width.
+uint16_t Font_TextIcons(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, int16_t x0, int16_t x1, FONT_ICON_FN draw) {
+	int32_t cx = x;
+	int32_t prev = -1;
+	uint8_t height, kern;
+
+	if ((font == NULL) || (str == NULL) || (draw == NULL)) return 0;
+	height = Font_GetHeight(font);
+	kern = (Font_IsV2(font)) && (Font_Rd16(font + 6) > 0);
+
+	while (*str) {
+		uint32_t cp = Font_UTF8Next(&str);
+		FONT_GLYPH g;
+		if ((cp == ' ') || (!Font_Resolve(font, cp, &g))) {
+			cx += Font_SpaceAdvance(font);
+			prev = -1;
+			continue;
+		}
+		if ((kern) && (g.font == font)) {
+			if (prev >= 0) cx += Font_KernPair(font, prev, g.index);
+			prev = g.index;
+		} else {
+			prev = -1;
+		}
+
+		uint8_t w = g.data[0];
+		if (((uint32_t)w * height <= FONT_MAX_GLYPH_PIXELS) && (cx + w > x0) && (cx < x1)) {
+			// Two buffers - glyph is decoded while previous one may still be read by DMA2D
+			uint8_t * icon = font_icon[font_icon_sel];
+			font_icon_sel ^= 1;
+			((uint16_t *)icon)[0] = w;
+			((uint16_t *)icon)[1] = height;
+			uint8_t gh = Font_GetHeight(g.font);
+			Font_Decode(&g, gh, icon + 4, height, ((int32_t)height - gh) / 2);
+			draw(icon, cx, y, color);
+		}
+		cx += w;
+	}
+	return (uint16_t)(cx - x);
+}
+
+// Draws UTF-8 text with G2D_DrawIconBlend. v1 fonts with ASCII text go directly
+// to G2D_TextBlend. Returns width.
+uint16_t Font_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color) {
+	if ((font == NULL) || (str == NULL)) return 0;
+	if ((!Font_IsV2(font)) && (Font_IsASCII(str))) return BSP->G2D_TextBlend(x, y, font, (char *)str, color);
+	return Font_TextIcons(x, y, font, str, color, INT16_MIN, INT16_MAX, BSP->G2D_DrawIconBlend);
+}
+
+// As Font_TextBlend, with background filled with bgcolor
+uint16_t Font_Text(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color, uint32_t bgcolor) {
+	if ((font == NULL) || (str == NULL)) return 0;
+	if ((!Font_IsV2(font)) && (Font_IsASCII(str))) return BSP->G2D_Text(x, y, font, (char *)str, color, bgcolor);
+
+	uint16_t width = Font_GetTextWidth(font, str);
+	BSP->G2D_DrawFillRect(x, y, width, Font_GetHeight(font), bgcolor);
+	return Font_TextBlend(x, y, font, str, color);
+}
+
+// Glyphs missing in font are taken from fallback (chains are followed). Returns BSP_ERROR when table is full.
+uint8_t Font_SetFallback(const uint8_t *font, const uint8_t *fallback) {
+	FONT_FALLBACK * free_entry = NULL;
+	for (uint8_t i = 0; i < FONT_MAX_FALLBACKS; i++) {
+		if (font_fallback[i].font == font) {
+			font_fallback[i].fallback = fallback;
+			if (fallback == NULL) font_fallback[i].font = NULL;
+			return BSP_OK;
+		}
+		if ((font_fallback[i].font == NULL) && (free_entry == NULL)) free_entry = &font_fallback[i];
+	}
+	if (fallback == NULL) return BSP_OK;
+	if (free_entry == NULL) return BSP_ERROR;
+	free_entry->font = font;
+	free_entry->fallback = fallback;
+	return BSP_OK;
+}
@@ -0,0 +1,115 @@
+/*****************************************************************
+ * MiniConsole V3 - Font Registry
+ *******************************************************************/
+
+#include <string.h>
+#include "FontReg.h"
+#include "ResCompress.h"
+#include "Log.h"
+
+static FR_INFO fr_font[FR_MAX_FONTS];
+static uint8_t fr_count = 0;
+
+
+static FR_FONT FontReg_Add(const char *name) {
+	if (fr_count == FR_MAX_FONTS) return FR_INVALID;
+	FR_INFO * f = &fr_font[fr_count];
+	memset(f, 0, sizeof(FR_INFO));
+	f->name = name;
+	return fr_count++;
+}
+
+FR_FONT FontReg_AddFlash(const char *name, const uint8_t *data, uint32_t size) {
+	FR_FONT id = FontReg_Add(name);
+	if (id == FR_INVALID) return id;
+	fr_font[id].flash = data;
+	fr_font[id].data = data;
+	fr_font[id].size = size;
+	fr_font[id].location = FR_LOC_FLASH;
+	return id;
+}
+
+// File is loaded on first use
+FR_FONT FontReg_AddFile(const char *name, const char *path) {
+	FR_FONT id = FontReg_Add(name);
+	if (id == FR_INVALID) return id;
+	fr_font[id].path = path;
+	return id;
+}
+
+FR_FONT FontReg_Find(const char *name) {
+	for (uint8_t i = 0; i < fr_count; i++) {
+		if (strcmp(fr_font[i].name, name) == 0) return i;
+	}
+	return FR_INVALID;
+}
+
+// Returns font data for G2D_Text/Font_* calls, loads file font if needed (NULL on error)
+const uint8_t * FontReg_Get(FR_FONT font) {
+	if (font >= fr_count) return NULL;
+	FR_INFO * f = &fr_font[font];
+	f->accesses++;
+	if (f->data) return f->data;
+
+	if (f->path == NULL) return NULL;
+	uint8_t * data = RC_Load((char *)f->path);
+	if (data == NULL) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "font %s: can not load %s", f->name, f->path);
+		return NULL;
+	}
+	f->data = data;
+	f->size = BSP->Res_GetSize(data);
+	f->location = FR_LOC_RES;
+	f->loads++;
+	return f->data;
+}
+
+// Copies font into arena memory (e.g. AXI SRAM or DTC_MRAM buffer). File fonts are loaded
+// first and their resource memory is released after copy.
+uint8_t FontReg_Promote(FR_FONT font, ARENA * arena) {
+	if (font >= fr_count) return BSP_ERROR;
+	FR_INFO * f = &fr_font[font];
+	if (f->location == FR_LOC_COPY) return BSP_OK;
+
+	uint32_t accesses = f->accesses;
+	const uint8_t * src = FontReg_Get(font);
+	f->accesses = accesses;
+	if (src == NULL) return BSP_ERROR;
+
+	uint8_t * dst = Arena_AllocAligned(arena, f->size, 32);
+	if (dst == NULL) return BSP_ERROR;
+	memcpy(dst, src, f->size);
+	if (f->location == FR_LOC_RES) BSP->Res_Free((void *)src);
+	f->data = dst;
+	f->location = FR_LOC_COPY;
+	return BSP_OK;
+}
+
+// Releases loaded file data and drops promoted copy (its memory returns with Arena_Release).
+// Flash fonts fall back to flash data, file fonts are loaded again on next use.
+void FontReg_Unload(FR_FONT font) {
+	if (font >= fr_count) return;
+	FR_INFO * f = &fr_font[font];
+	if (f->location == FR_LOC_RES) BSP->Res_Free((void *)f->data);
+	f->data = f->flash;
+	f->location = (f->flash) ? FR_LOC_FLASH : FR_LOC_NONE;
+	if (f->flash == NULL) f->size = 0;
+}
+
+const FR_INFO * FontReg_GetInfo(FR_FONT font) {
+	if (font >= fr_count) return NULL;
+	return &fr_font[font];
+}
+
+// Logs per font size, location and access count
+void FontReg_Report(void) {
+	static const char * const loc[4] = {"-", "flash", "res", "copy"};
+	uint32_t total = 0;
+
+	for (uint8_t i = 0; i < fr_count; i++) {
+		FR_INFO * f = &fr_font[i];
+		LOG_Printf(LOG_LEVEL_INF, LOG_CAT_GFX, "font %-12s %6lu B %-5s accesses %lu loads %lu", f->name, (unsigned long)f->size, loc[f->location], (unsigned long)f->accesses, (unsigned long)f->loads);
+		if (f->location != FR_LOC_NONE) total += f->size;
+	}
+	LOG_Printf(LOG_LEVEL_INF, LOG_CAT_GFX, "fonts %u registered, %lu B resident", fr_count, (unsigned long)total);
+}
@@ -0,0 +1,203 @@
+/*****************************************************************
+ * MiniConsole V3 - Glyph Cache
+ *******************************************************************/
+
+#include "GlyphCache.h"
+#include "Font.h"
+
+#define GC_NONE		0xFFFF
+
+#ifndef HOST_BUILD
+#define GC_DTCM_START	0x20000000		// DTCM (128 KB) is not accessible by DMA2D
+#define GC_DTCM_END		0x20020000
+#endif
+
+typedef struct {
+	const uint8_t *	font;
+	uint32_t		cp;
+	uint16_t		hnext;			// Next entry in hash bucket
+	uint16_t		prev;			// LRU list (head - most recent)
+	uint16_t		next;
+} GC_ENTRY;
+
+static struct {
+	uint8_t *		mem;
+	uint8_t			owned;			// Memory allocated with Res_Alloc
+	uint16_t		slot_size;
+	uint16_t		slots;
+	uint16_t		used;
+	uint16_t		head;
+	uint16_t		tail;
+	uint16_t		bucket[GC_HASH_SIZE];
+	GC_ENTRY		entry[GC_MAX_SLOTS];
+	GC_STATS		stats;
+} gc;
+
+
+static inline uint32_t GC_Hash(const uint8_t *font, uint32_t cp) {
+	uint32_t h = ((uint32_t)(uintptr_t)font >> 2) * 2654435761u + cp * 40503u;
+	return (h >> 16) & (GC_HASH_SIZE - 1);
+}
+
+static inline uint8_t * GC_Slot(uint16_t idx) {
+	return gc.mem + (uint32_t)idx * gc.slot_size;
+}
+
+static void GC_LRUUnlink(uint16_t idx) {
+	GC_ENTRY * e = &gc.entry[idx];
+	if (e->prev != GC_NONE) gc.entry[e->prev].next = e->next; else gc.head = e->next;
+	if (e->next != GC_NONE) gc.entry[e->next].prev = e->prev; else gc.tail = e->prev;
+}
+
+static void GC_LRUPush(uint16_t idx) {
+	GC_ENTRY * e = &gc.entry[idx];
+	e->prev = GC_NONE;
+	e->next = gc.head;
+	if (gc.head != GC_NONE) gc.entry[gc.head].prev = idx; else gc.tail = idx;
+	gc.head = idx;
+}
+
+static void GC_HashRemove(uint16_t idx) {
+	GC_ENTRY * e = &gc.entry[idx];
+	uint16_t * link = &gc.bucket[GC_Hash(e->font, e->cp)];
+	while (*link != GC_NONE) {
+		if (*link == idx) {
+			*link = e->hnext;
+			return;
+		}
+		link = &gc.entry[*link].hnext;
+	}
+}
+
+// Memory must be readable by DMA2D (glyphs are drawn with G2D_DrawIconBlend) - DTCM is rejected
+uint8_t GC_Init(void * mem, uint32_t size, uint16_t slot_size) {
+	GC_Release();
+	// Slots are 4-byte aligned so icon header can be accessed as uint16_t
+	slot_size = (slot_size + 3) & ~3;
+	if (slot_size < 8) return BSP_ERROR;
+#ifdef GC_DTCM_START
+	if ((mem) && ((uintptr_t)mem < GC_DTCM_END) && ((uintptr_t)mem + size > GC_DTCM_START)) return BSP_ERROR;
+#endif
+
+	gc.owned = (mem == NULL);
+	if (mem == NULL) mem = BSP->Res_Alloc(size);
+	if (mem == NULL) return BSP_ERROR;
+
+	gc.mem = mem;
+	gc.slot_size = slot_size;
+	gc.slots = (size / slot_size > GC_MAX_SLOTS) ? GC_MAX_SLOTS : (uint16_t)(size / slot_size);
+	GC_Flush();
+	GC_ResetStats();
+	return (gc.slots) ? BSP_OK : BSP_ERROR;
+}
+
+// Frees memory allocated by GC_Init - cache is empty until next GC_Init
+void GC_Release(void) {
+	if ((gc.owned) && (gc.mem)) BSP->Res_Free(gc.mem);
+	gc.mem = NULL;
+	gc.owned = 0;
+	gc.slots = 0;
+	GC_Flush();
+}
+
+void GC_Flush(void) {
+	gc.used = 0;
+	gc.head = GC_NONE;
+	gc.tail = GC_NONE;
+	for (uint16_t i = 0; i < GC_HASH_SIZE; i++) gc.bucket[i] = GC_NONE;
+}
+
+// Returns glyph in icon layout or NULL if glyph does not fit into slot
+const void * GC_GetGlyph(const uint8_t *font, uint32_t cp) {
+	uint32_t h = GC_Hash(font, cp);
+
+	for (uint16_t idx = gc.bucket[h]; idx != GC_NONE; idx = gc.entry[idx].hnext) {
+		GC_ENTRY * e = &gc.entry[idx];
+		if ((e->font == font) && (e->cp == cp)) {
+			if (gc.head != idx) {
+				GC_LRUUnlink(idx);
+				GC_LRUPush(idx);
+			}
+			gc.stats.hits++;
+			return GC_Slot(idx);
+		}
+	}
+
+	uint8_t height = Font_GetHeight(font);
+	uint8_t width = Font_GetCodepointWidth(font, cp);
+	if ((gc.slots == 0) || (4 + (uint32_t)width * height > gc.slot_size)) {
+		gc.stats.uncached++;
+		return NULL;
+	}
+
+	gc.stats.misses++;
+
+	uint16_t idx;
+	if (gc.used < gc.slots) {
+		idx = gc.used++;
+	} else {
+		idx = gc.tail;
+		GC_LRUUnlink(idx);
+		GC_HashRemove(idx);
+		gc.stats.evictions++;
+	}
+
+	uint8_t * slot = GC_Slot(idx);
+	((uint16_t *)slot)[0] = width;
+	((uint16_t *)slot)[1] = height;
+	Font_DecodeCodepoint(font, cp, slot + 4);
+
+	GC_ENTRY * e = &gc.entry[idx];
+	e->font = font;
+	e->cp = cp;
+	e->hnext = gc.bucket[h];
+	gc.bucket[h] = idx;
+	GC_LRUPush(idx);
+
+	return slot;
+}
+
+uint16_t GC_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color) {
+	int16_t cx = x;
+	uint32_t prev = 0;
+	char single[5];
+
+	if ((font == NULL) || (str == NULL)) return 0;
+
+	while (*str) {
+		const char * start = str;
+		uint32_t cp = Font_UTF8Next(&str);
+		if ((cp == ' ') || (!Font_HasGlyph(font, cp))) {
+			cx += Font_GetCodepointWidth(font, cp);
+			prev = 0;
+			continue;
+		}
+		if (prev) cx += Font_GetKerning(font, prev, cp);
+		prev = cp;
+
+		const void * glyph = GC_GetGlyph(font, cp);
+		if (glyph) {
+			BSP->G2D_DrawIconBlend(glyph, cx, y, color);
+			cx += ((const uint16_t *)glyph)[0];
+		} else {
+			uint8_t n = 0;
+			while (start < str) single[n++] = *start++;
+			single[n] = 0;
+			cx += Font_TextBlend(cx, y, font, single, color);
+		}
+	}
+	return (uint16_t)(cx - x);
+}
+
+const GC_STATS * GC_GetStats(void) {
+	gc.stats.slots = gc.slots;
+	gc.stats.used = gc.used;
+	return &gc.stats;
+}
+
+void GC_ResetStats(void) {
+	gc.stats.hits = 0;
+	gc.stats.misses = 0;
+	gc.stats.evictions = 0;
+	gc.stats.uncached = 0;
+}
@@ -0,0 +1,181 @@
+/*****************************************************************
+ * MiniConsole V3 - Dual Core Jobs
+ *******************************************************************/
+
+#include "Job.h"
+
+#if !defined(HOST_BUILD) && !defined(JOB_CORE_CM4)
+#define JOB_DCACHE			1
+#define JOB_SCB_DCIMVAC		(*(volatile uint32_t *)0xE000EF5C)
+#define JOB_SCB_DCCMVAC		(*(volatile uint32_t *)0xE000EF68)
+#endif
+
+#ifdef JOB_CORE_CM4
+#define JOB_BLOCK			((JOB_SHARED *)JOB_SHARED_ADDR)
+#else
+static JOB_SHARED job_block __attribute__((section(".sh1_ram.jobs")));
+#define JOB_BLOCK			(&job_block)
+#endif
+
+#define JOB_MASK			(JOB_RING_SIZE - 1)
+
+static JOB_HANDLER job_handler[JOB_MAX_TYPES];
+static uint32_t job_seq = 0;
+static uint32_t job_heartbeat = 0;
+static JOB_STATS job_stats;
+
+
+void JOB_CacheClean(const void * addr, uint32_t size) {
+#ifdef JOB_DCACHE
+	uint32_t a = (uint32_t)addr & ~(JOB_CACHE_LINE - 1);
+	uint32_t end = (uint32_t)addr + size;
+	__asm volatile ("dsb" ::: "memory");
+	for (; a < end; a += JOB_CACHE_LINE) JOB_SCB_DCCMVAC = a;
+	__asm volatile ("dsb\n\tisb" ::: "memory");
+#else
+	(void)addr;
+	(void)size;
+#endif
+}
+
+// Lines are discarded - any data written by this core to them is lost
+void JOB_CacheInvalidate(void * addr, uint32_t size) {
+#ifdef JOB_DCACHE
+	uint32_t a = (uint32_t)addr & ~(JOB_CACHE_LINE - 1);
+	uint32_t end = (uint32_t)addr + size;
+	__asm volatile ("dsb" ::: "memory");
+	for (; a < end; a += JOB_CACHE_LINE) JOB_SCB_DCIMVAC = a;
+	__asm volatile ("dsb\n\tisb" ::: "memory");
+#else
+	(void)addr;
+	(void)size;
+#endif
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+// Single producer push. Descriptor is published before head.
+static uint8_t JOB_Push(JOB_RING * r, const JOB_DESC * job) {
+	uint32_t head = r->head;
+	JOB_CacheInvalidate((void *)&r->tail, sizeof(r->tail));
+	uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+	if (head - tail >= JOB_RING_SIZE) return BSP_ERROR;
+
+	JOB_DESC * slot = &r->slot[head & JOB_MASK];
+	*slot = *job;
+	JOB_CacheClean(slot, sizeof(JOB_DESC));
+	__atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+	JOB_CacheClean((const void *)&r->head, sizeof(r->head));
+	return BSP_OK;
+}
+
+// Producer side check that push will succeed
+static uint8_t JOB_HasSpace(JOB_RING * r) {
+	JOB_CacheInvalidate((void *)&r->tail, sizeof(r->tail));
+	return (r->head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) < JOB_RING_SIZE;
+}
+
+// Single consumer pop. Slot is released after descriptor is copied.
+static uint8_t JOB_Pop(JOB_RING * r, JOB_DESC * job) {
+	uint32_t tail = r->tail;
+	JOB_CacheInvalidate((void *)&r->head, sizeof(r->head));
+	uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+	if (head == tail) return 0;
+
+	JOB_DESC * slot = &r->slot[tail & JOB_MASK];
+	JOB_CacheInvalidate(slot, sizeof(JOB_DESC));
+	*job = *slot;
+	__atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+	JOB_CacheClean((const void *)&r->tail, sizeof(r->tail));
+	return 1;
+}
+
+// Clears both rings (call before CM4 worker is started or while it is idle)
+void JOB_Init(void) {
+	JOB_SHARED * sh = JOB_BLOCK;
+	sh->request.head = 0;
+	sh->request.tail = 0;
+	sh->done.head = 0;
+	sh->done.tail = 0;
+	sh->heartbeat = 0;
+	__atomic_store_n(&sh->magic, JOB_MAGIC, __ATOMIC_RELEASE);
+	JOB_CacheClean(sh, sizeof(JOB_SHARED));
+	job_seq = 0;
+	job_heartbeat = 0;
+	job_stats = (JOB_STATS){0};
+}
+
+// Posts job to worker. Returns BSP_ERROR when request ring is full or output buffer is not cache aligned.
+uint8_t JOB_Post(JOB_DESC * job) {
+	if ((job->flags & JOB_FLAG_INV_OUT) && ((((uintptr_t)job->out | job->out_size) & (JOB_CACHE_LINE - 1)) != 0)) return BSP_ERROR;
+
+	job->id = job_seq;
+	job->flags &= ~JOB_FLAG_NOHANDLER;
+	if (job->flags & JOB_FLAG_CLEAN_IN) JOB_CacheClean(job->in, job->in_size);
+	if (JOB_Push(&JOB_BLOCK->request, job) != BSP_OK) {
+		job_stats.full++;
+		return BSP_ERROR;
+	}
+	job_seq++;
+	job_stats.posted++;
+	if (JOB_InFlight() > job_stats.peak) job_stats.peak = JOB_InFlight();
+	return BSP_OK;
+}
+
+// Collects one finished job. Returns 1 when job was copied to *job.
+uint8_t JOB_Poll(JOB_DESC * job) {
+	if (!JOB_Pop(&JOB_BLOCK->done, job)) return 0;
+	if (job->flags & JOB_FLAG_INV_OUT) JOB_CacheInvalidate(job->out, job->out_size);
+	job_stats.completed++;
+	return 1;
+}
+
+// Jobs posted and not yet collected
+uint32_t JOB_InFlight(void) {
+	return job_stats.posted - job_stats.completed;
+}
+
+// Returns 1 when worker made progress since previous call
+uint8_t JOB_WorkerAlive(void) {
+	JOB_SHARED * sh = JOB_BLOCK;
+	JOB_CacheInvalidate((void *)&sh->heartbeat, sizeof(sh->heartbeat));
+	uint32_t hb = __atomic_load_n(&sh->heartbeat, __ATOMIC_RELAXED);
+	uint8_t alive = (hb != job_heartbeat);
+	job_heartbeat = hb;
+	return alive;
+}
+
+const JOB_STATS * JOB_GetStats(void) {
+	return &job_stats;
+}
+
+void JOB_RegisterHandler(uint16_t type, JOB_HANDLER handler) {
+	if (type < JOB_MAX_TYPES) job_handler[type] = handler;
+}
+
+// Runs one pending job. Returns 1 when job was executed, 0 when no job is pending
+// or completion ring is full (job stays queued until CM7 collects completions).
+uint8_t JOB_WorkerPoll(void) {
+	JOB_SHARED * sh = JOB_BLOCK;
+	JOB_DESC job;
+
+	__atomic_store_n(&sh->heartbeat, sh->heartbeat + 1, __ATOMIC_RELAXED);
+	JOB_CacheClean((const void *)&sh->heartbeat, sizeof(sh->heartbeat));
+
+	JOB_CacheInvalidate((void *)&sh->magic, sizeof(sh->magic));
+	if (sh->magic != JOB_MAGIC) return 0;
+	// Worker is the only producer of completions, so space checked here cannot disappear
+	if (!JOB_HasSpace(&sh->done)) return 0;
+	if (!JOB_Pop(&sh->request, &job)) return 0;
+
+	if ((job.type < JOB_MAX_TYPES) && (job_handler[job.type])) {
+		job.result = job_handler[job.type](&job);
+	} else {
+		job.result = -1;
+		job.flags |= JOB_FLAG_NOHANDLER;
+	}
+	if (job.flags & JOB_FLAG_INV_OUT) JOB_CacheClean(job.out, job.out_size);
+
+	JOB_Push(&sh->done, &job);
+	job_stats.executed++;
+	return 1;
+}
@@ -0,0 +1,347 @@
+/*****************************************************************
+ * MiniConsole V3 - Logging
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "Log.h"
+
+#define LOG_MASK			(LOG_BUFFER_WORDS - 1)
+#define LOG_COMMIT			0x80000000
+#define LOG_OUT_SIZE		1024			// Bytes staged for one sink call
+#define LOG_TEXT_MAX		512				// Longest text record in bytes
+
+#define LOG_HDR(type, level, cat, nargs, words)	(((uint32_t)(type) << 28) | ((uint32_t)(level) << 26) | ((uint32_t)(cat) << 18) | ((uint32_t)(nargs) << 14) | (uint32_t)(words))
+#define LOG_HDR_TYPE(h)		(((h) >> 28) & 0x07)
+#define LOG_HDR_LEVEL(h)	(((h) >> 26) & 0x03)
+#define LOG_HDR_CAT(h)		(((h) >> 18) & 0xFF)
+#define LOG_HDR_NARGS(h)	(((h) >> 14) & 0x0F)
+#define LOG_HDR_WORDS(h)	((h) & 0x3FFF)
+
+static uint32_t log_buf[LOG_BUFFER_WORDS] SH1_RAM;
+static volatile uint32_t log_head = 0;		// Words reserved (free running)
+static volatile uint32_t log_tail = 0;		// Words consumed (free running)
+static volatile uint32_t log_drops = 0;		// Records lost since last drain
+
+static const char * volatile log_fmt[LOG_MAX_FORMATS];
+static volatile uint16_t log_nfmt = 0;
+static uint32_t log_fmt_sent[(LOG_MAX_FORMATS + 31) / 32];
+
+static uint8_t log_sink = LOG_SINK_SERIAL;
+static uint8_t log_format = LOG_FORMAT_TEXT;
+static uint8_t log_out[LOG_OUT_SIZE];
+static uint32_t log_out_len = 0;
+static uint32_t log_out_pos = 0;
+
+static char log_line[LOG_LINE_SIZE];
+static uint32_t log_line_len = 0;
+
+static LOG_STATS log_stats;
+
+static const char log_level_char[4] = {'E', 'W', 'I', 'D'};
+static const char * const log_cat_name[8] = {"APP", "GFX", "RES", "AUD", "SYS", "CAT5", "CAT6", "OUT"};
+
+
+// Reserves words in ring. Returns first word index or -1 when ring is full.
+// Safe to call from interrupts - record is visible to LOG_Drain only after header is committed.
+static int32_t LOG_Reserve(uint32_t words) {
+	uint32_t head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+	do {
+		if (head + words - log_tail > LOG_BUFFER_WORDS) {
+			__atomic_fetch_add(&log_drops, 1, __ATOMIC_RELAXED);
+			log_stats.dropped++;
+			return -1;
+		}
+	} while (!__atomic_compare_exchange_n(&log_head, &head, head + words, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	if (head + words - log_tail > log_stats.peak) log_stats.peak = head + words - log_tail;
+	log_stats.records++;
+	return (int32_t)head;
+}
+
+static inline void LOG_Commit(uint32_t pos, uint32_t header) {
+	__atomic_store_n(&log_buf[pos & LOG_MASK], header | LOG_COMMIT, __ATOMIC_RELEASE);
+}
+
+void LOG_SetOutput(uint8_t sink, uint8_t format) {
+	log_sink = sink;
+	if (format != log_format) memset(log_fmt_sent, 0, sizeof(log_fmt_sent));
+	log_format = format;
+}
+
+// Returns 1 when format has only integer conversions (%d %i %u %x %X %o %c)
+static uint8_t LOG_IsIntegerFormat(const char *fmt) {
+	while (*fmt) {
+		if (*fmt++ != '%') continue;
+		if (*fmt == '%') {
+			fmt++;
+			continue;
+		}
+		while ((*fmt) && strchr("-+ #0123456789.hlzjt", *fmt)) fmt++;
+		if ((*fmt == 0) || (strchr("diuxXoc", *fmt) == NULL)) return 0;
+		fmt++;
+	}
+	return 1;
+}
+
+// Stores format id and integer arguments (called by LOG_ERR/WRN/INF/DBG). Format with
+// other conversions (%s, %p - pointer would not fit 32-bit argument) is reported once
+// with LOG_Printf and its records are not stored.
+void LOG_Write(uint8_t level, uint8_t cat, uint16_t * id, const char *fmt, const uint32_t * args, uint32_t nargs) {
+	if (*id == LOG_BADID) return;
+	if (*id == LOG_NOID) {
+		if (!LOG_IsIntegerFormat(fmt)) {
+			*id = LOG_BADID;
+			LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_SYS, "deferred log format is not integer only (use LOG_Printf): %s", fmt);
+			return;
+		}
+		uint16_t n = __atomic_fetch_add(&log_nfmt, 1, __ATOMIC_RELAXED);
+		if (n >= LOG_MAX_FORMATS) {
+			log_nfmt = LOG_MAX_FORMATS;
+			return;
+		}
+		log_fmt[n] = fmt;
+		__atomic_store_n(id, n, __ATOMIC_RELEASE);
+	}
+	if (nargs > LOG_MAX_ARGS) nargs = LOG_MAX_ARGS;
+
+	uint32_t words = 3 + nargs;
+	int32_t pos = LOG_Reserve(words);
+	if (pos < 0) return;
+
+	log_buf[(pos + 1) & LOG_MASK] = BSP->GetTick();
+	log_buf[(pos + 2) & LOG_MASK] = *id;
+	for (uint32_t i = 0; i < nargs; i++) log_buf[(pos + 3 + i) & LOG_MASK] = args[i];
+	LOG_Commit(pos, LOG_HDR(LOG_REC_DEFERRED, level, cat, nargs, words));
+}
+
+// Stores already formatted text (long text is split into several records)
+void LOG_Text(uint8_t level, uint8_t cat, const char *text, uint32_t len) {
+	if (!(cat & LOG_CATEGORIES)) return;
+
+	do {
+		uint32_t bytes = (len > LOG_TEXT_MAX) ? LOG_TEXT_MAX : len;
+		uint32_t words = 3 + (bytes + 3) / 4;
+		int32_t pos = LOG_Reserve(words);
+		if (pos < 0) return;
+
+		log_buf[(pos + 1) & LOG_MASK] = BSP->GetTick();
+		log_buf[(pos + 2) & LOG_MASK] = bytes;
+		for (uint32_t i = 0; i < bytes; i += 4) {
+			uint32_t w = 0;
+			for (uint32_t j = 0; (j < 4) && (i + j < bytes); j++) w |= (uint32_t)(uint8_t)text[i + j] << (8 * j);
+			log_buf[(pos + 3 + i / 4) & LOG_MASK] = w;
+		}
+		LOG_Commit(pos, LOG_HDR(LOG_REC_TEXT, level, cat, 0, words));
+		text += bytes;
+		len -= bytes;
+	} while (len);
+}
+
+// Formats immediately (any printf arguments) and stores text
+void LOG_Printf(uint8_t level, uint8_t cat, const char *fmt, ...) {
+	if ((level > LOG_MAX_LEVEL) || !(cat & LOG_CATEGORIES)) return;
+
+	char line[LOG_LINE_SIZE];
+	va_list ap;
+	va_start(ap, fmt);
+	int len = vsnprintf(line, sizeof(line), fmt, ap);
+	va_end(ap);
+	if (len < 0) return;
+	if (len >= (int)sizeof(line)) len = sizeof(line) - 1;
+	LOG_Text(level, cat, line, len);
+}
+
+// Character output for printf - collected into lines
+void LOG_PutChar(char ch) {
+	log_line[log_line_len++] = ch;
+	if ((ch == '\n') || (log_line_len == LOG_LINE_SIZE)) {
+		LOG_Text(LOG_LEVEL_INF, LOG_CAT_STDOUT, log_line, log_line_len);
+		log_line_len = 0;
+	}
+}
+
+// Formats deferred record. Conversion is done per specifier, arguments are 32-bit integers.
+static uint32_t LOG_Format(char * dst, uint32_t size, const char * fmt, const uint32_t * args, uint32_t nargs) {
+	uint32_t len = 0;
+	uint32_t arg = 0;
+	char spec[16];
+
+	while ((*fmt) && (len + 1 < size)) {
+		if (*fmt != '%') {
+			dst[len++] = *fmt++;
+			continue;
+		}
+		if (fmt[1] == '%') {
+			dst[len++] = '%';
+			fmt += 2;
+			continue;
+		}
+
+		// Copy flags, width and precision, skip length modifiers
+		uint8_t n = 0;
+		spec[n++] = *fmt++;
+		while ((*fmt) && strchr("-+ #0123456789.", *fmt) && (n < sizeof(spec) - 2)) spec[n++] = *fmt++;
+		while ((*fmt) && strchr("hlzjt", *fmt)) fmt++;
+		if (!*fmt) break;
+		char conv = *fmt++;
+		spec[n++] = conv;
+		spec[n] = 0;
+
+		uint32_t v = (arg < nargs) ? args[arg] : 0;
+		arg++;
+		int r;
+		switch (conv) {
+		case 'd':
+		case 'i':
+			r = snprintf(dst + len, size - len, spec, (int)(int32_t)v);
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			r = snprintf(dst + len, size - len, spec, (unsigned int)v);
+			break;
+		case 'c':
+			r = snprintf(dst + len, size - len, spec, (int)(uint8_t)v);
+			break;
+		default:
+			r = snprintf(dst + len, size - len, "<%%%c?>", conv);
+			break;
+		}
+		if (r < 0) break;
+		len += r;
+		if (len >= size) len = size - 1;
+	}
+	dst[len] = 0;
+	return len;
+}
+
+// Sends staged output. Returns 0 when sink did not accept everything.
+static uint8_t LOG_SendOut(void) {
+	if (log_out_pos < log_out_len) {
+		uint32_t bytes = log_out_len - log_out_pos;
+		uint32_t written;
+		if (log_sink == LOG_SINK_CDC) {
+			if (!BSP->USB_IsConnected()) return 0;
+			written = BSP->USB_CDC_Write(log_out + log_out_pos, bytes);
+			if (written) BSP->USB_CDC_WriteFlush();
+		} else {
+			BSP->Serial_Transmit(log_out + log_out_pos, bytes);
+			written = bytes;
+		}
+		log_out_pos += written;
+		log_stats.sent += written;
+		if (log_out_pos < log_out_len) return 0;
+	}
+	log_out_pos = 0;
+	log_out_len = 0;
+	return 1;
+}
+
+// Appends bytes to staged output, sending when full. Returns 0 when there is no room.
+static uint8_t LOG_Out(const void * data, uint32_t bytes) {
+	if (log_out_len + bytes > LOG_OUT_SIZE) {
+		if (!LOG_SendOut()) return 0;
+	}
+	memcpy(log_out + log_out_len, data, bytes);
+	log_out_len += bytes;
+	return 1;
+}
+
+static uint32_t LOG_Prefix(char * dst, uint32_t size, uint32_t header, uint32_t tick) {
+	uint8_t cat = LOG_HDR_CAT(header);
+	uint8_t c = 0;
+	while ((c < 7) && !(cat & (1 << c))) c++;
+	return snprintf(dst, size, "%5lu.%03lu %c %s: ", (unsigned long)(tick / 1000), (unsigned long)(tick % 1000), log_level_char[LOG_HDR_LEVEL(header)], log_cat_name[c]);
+}
+
+// Converts record at ring position to output. Returns 0 when output is full.
+static uint8_t LOG_Emit(uint32_t pos, uint32_t header) {
+	uint32_t words = LOG_HDR_WORDS(header);
+	uint8_t type = LOG_HDR_TYPE(header);
+
+	if (log_format == LOG_FORMAT_BINARY) {
+		uint32_t rec[3 + LOG_TEXT_MAX / 4];
+
+		if (type == LOG_REC_DEFERRED) {
+			uint16_t id = log_buf[(pos + 2) & LOG_MASK];
+			if (!(log_fmt_sent[id / 32] & (1 << (id % 32)))) {
+				const char * fmt = log_fmt[id];
+				uint32_t len = strlen(fmt);
+				if (len > LOG_TEXT_MAX) len = LOG_TEXT_MAX;
+				uint32_t fwords = 3 + (len + 3) / 4;
+				memset(rec, 0, fwords * 4);
+				rec[0] = LOG_HDR(LOG_REC_FORMAT, 0, 0, 0, fwords);
+				rec[1] = id;
+				rec[2] = len;
+				memcpy(&rec[3], fmt, len);
+				if (!LOG_Out(rec, fwords * 4)) return 0;
+				log_fmt_sent[id / 32] |= (1 << (id % 32));
+			}
+		}
+		rec[0] = header & ~LOG_COMMIT;
+		for (uint32_t i = 1; i < words; i++) rec[i] = log_buf[(pos + i) & LOG_MASK];
+		return LOG_Out(rec, words * 4);
+	}
+
+	char line[LOG_LINE_SIZE + LOG_TEXT_MAX];
+	uint32_t len = 0;
+	uint32_t tick = log_buf[(pos + 1) & LOG_MASK];
+
+	if (type == LOG_REC_DEFERRED) {
+		uint32_t args[LOG_MAX_ARGS];
+		uint32_t nargs = LOG_HDR_NARGS(header);
+		for (uint32_t i = 0; i < nargs; i++) args[i] = log_buf[(pos + 3 + i) & LOG_MASK];
+		len = LOG_Prefix(line, LOG_LINE_SIZE, header, tick);
+		len += LOG_Format(line + len, LOG_LINE_SIZE - len - 1, log_fmt[log_buf[(pos + 2) & LOG_MASK]], args, nargs);
+		line[len++] = '\n';
+	} else {
+		uint32_t bytes = log_buf[(pos + 2) & LOG_MASK];
+		if (LOG_HDR_CAT(header) != LOG_CAT_STDOUT) len = LOG_Prefix(line, LOG_LINE_SIZE, header, tick);
+		for (uint32_t i = 0; i < bytes; i++) line[len++] = (char)(log_buf[(pos + 3 + i / 4) & LOG_MASK] >> (8 * (i % 4)));
+		if ((LOG_HDR_CAT(header) != LOG_CAT_STDOUT) && ((bytes == 0) || (line[len - 1] != '\n'))) line[len++] = '\n';
+	}
+	return LOG_Out(line, len);
+}
+
+// Single drain point - formats committed records and sends them to selected sink
+// in large chunks (up to max_bytes of records, 0 - all). Returns bytes sent.
+uint32_t LOG_Drain(uint32_t max_bytes) {
+	uint32_t sent = log_stats.sent;
+	uint32_t consumed = 0;
+
+	if (!LOG_SendOut()) return log_stats.sent - sent;
+
+	uint32_t drops = __atomic_exchange_n(&log_drops, 0, __ATOMIC_RELAXED);
+	if (drops) {
+		if (log_format == LOG_FORMAT_BINARY) {
+			uint32_t rec[2] = {LOG_HDR(LOG_REC_DROPPED, 0, 0, 0, 2), drops};
+			LOG_Out(rec, sizeof(rec));
+		} else {
+			char line[48];
+			LOG_Out(line, snprintf(line, sizeof(line), "[log] %lu records dropped\n", (unsigned long)drops));
+		}
+	}
+
+	while (log_tail != log_head) {
+		uint32_t pos = log_tail;
+		uint32_t header = __atomic_load_n(&log_buf[pos & LOG_MASK], __ATOMIC_ACQUIRE);
+		if (!(header & LOG_COMMIT)) break;			// Record still being written
+		uint32_t words = LOG_HDR_WORDS(header);
+		if ((max_bytes) && (consumed) && (consumed + words * 4 > max_bytes)) break;
+		if (!LOG_Emit(pos, header)) break;
+
+		for (uint32_t i = 0; i < words; i++) log_buf[(pos + i) & LOG_MASK] = 0;
+		__atomic_store_n(&log_tail, pos + words, __ATOMIC_RELEASE);
+		consumed += words * 4;
+	}
+	LOG_SendOut();
+
+	return log_stats.sent - sent;
+}
+
+const LOG_STATS * LOG_GetStats(void) {
+	return &log_stats;
+}
@@ -0,0 +1,102 @@
+/*****************************************************************
+ * MiniConsole V3 - Fixed Timestep Loop
+ *******************************************************************/
+
+#include "Loop.h"
+#include "Sched.h"
+#include "Profiler.h"
+
+#define LOOP_SECOND_US		1000000
+
+static const LOOP_CONFIG * loop_cfg = NULL;
+static uint32_t loop_last = 0;				// Cycles at previous pass
+static uint64_t loop_acc = 0;				// Accumulated time [us * tick_hz]
+static uint32_t loop_tick = 0;
+static uint8_t loop_skipped = 0;			// Frames skipped in a row
+static LOOP_STATS loop_stats;
+
+
+// Returns BSP_ERROR (loop does not run) when tick_hz, max_updates or det_ticks
+// (deterministic mode) is 0 or callback is missing.
+uint8_t Loop_Init(const LOOP_CONFIG * cfg) {
+	PROF_StartCounter();
+	loop_cfg = NULL;
+	if ((cfg == NULL) || (cfg->tick_hz == 0) || (cfg->max_updates == 0) || (cfg->update == NULL) || (cfg->render == NULL)) return BSP_ERROR;
+	if ((cfg->deterministic) && (cfg->det_ticks == 0)) return BSP_ERROR;
+	loop_cfg = cfg;
+	loop_last = PROF_GetCycles();
+	loop_acc = 0;
+	loop_tick = 0;
+	loop_skipped = 0;
+	loop_stats = (LOOP_STATS){0};
+	return BSP_OK;
+}
+
+// One loop pass - waits for edit window (unless previous frame was skipped),
+// runs due updates and renders. Returns 1 when frame was rendered.
+uint8_t Loop_Step(void) {
+	const LOOP_CONFIG * cfg = loop_cfg;
+	if (cfg == NULL) return 0;
+
+	if (!loop_skipped) Sched_WaitEditPermission();
+
+	if (cfg->deterministic) {
+		loop_acc += (uint64_t)cfg->det_ticks * LOOP_SECOND_US;
+	} else {
+		uint32_t now = PROF_GetCycles();
+		uint32_t dt = (now - loop_last) / PROF_CYCLES_PER_US;
+		loop_last = now;
+		if (dt > LOOP_MAX_DT_US) dt = LOOP_MAX_DT_US;
+		loop_acc += (uint64_t)dt * cfg->tick_hz;
+	}
+
+	uint8_t n = 0;
+	while ((loop_acc >= LOOP_SECOND_US) && (n < cfg->max_updates)) {
+		cfg->update(loop_tick);
+		loop_tick++;
+		loop_acc -= LOOP_SECOND_US;
+		n++;
+	}
+	loop_stats.ticks += n;
+	loop_stats.last_updates = n;
+	if (n > loop_stats.peak_updates) loop_stats.peak_updates = n;
+
+	// Deterministic mode never drops ticks - ticks above max_updates run in following passes
+	if ((loop_acc >= LOOP_SECOND_US) && (!cfg->deterministic)) {
+		// Behind schedule - skip frame if rendering is too slow, otherwise drop time
+		if ((!cfg->deterministic) && (cfg->budget_ms) && (loop_skipped < cfg->max_skip) && (BSP->LCD_GetFrameTime() > cfg->budget_ms)) {
+			loop_skipped++;
+			loop_stats.skipped++;
+			return 0;
+		}
+		loop_stats.dropped_ticks += (uint32_t)(loop_acc / LOOP_SECOND_US);
+		loop_acc %= LOOP_SECOND_US;
+	}
+	loop_skipped = 0;
+
+	uint32_t alpha = (uint32_t)(((loop_acc % LOOP_SECOND_US) * LOOP_ALPHA_ONE) / LOOP_SECOND_US);
+	cfg->render(alpha);
+	BSP->LCD_FrameReady();
+	loop_stats.frames++;
+	return 1;
+}
+
+// Returns only when Loop_Init failed
+void Loop_Run(void) {
+	while (loop_cfg) Loop_Step();
+}
+
+// Ticks run since Loop_Init
+uint32_t Loop_GetTick(void) {
+	return loop_tick;
+}
+
+// Simulation time (tick count converted to milliseconds)
+uint32_t Loop_GetTimeMs(void) {
+	if (loop_cfg == NULL) return 0;
+	return (uint32_t)(((uint64_t)loop_tick * 1000) / loop_cfg->tick_hz);
+}
+
+const LOOP_STATS * Loop_GetStats(void) {
+	return &loop_stats;
+}
@@ -0,0 +1,66 @@
+/*****************************************************************
+ * MiniConsole V3 - LZ4 Block Decoder
+ *******************************************************************/
+
+#include "Lz4.h"
+
+// Decodes LZ4 block. Returns number of bytes written to dst or 0 on corrupted input.
+// Matches may reference anything already written to dst (dst + dst_size is not exceeded).
+uint32_t LZ4_DecodeBlock(const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size) {
+	const uint8_t * ip = src;
+	const uint8_t * iend = src + src_size;
+	uint8_t * op = dst;
+	uint8_t * oend = dst + dst_size;
+
+	while (ip < iend) {
+		uint8_t token = *ip++;
+
+		// Literals
+		uint32_t len = token >> 4;
+		if (len == 15) {
+			uint8_t b;
+			do {
+				if (ip >= iend) return 0;
+				b = *ip++;
+				len += b;
+			} while (b == 255);
+		}
+		if (((uint32_t)(iend - ip) < len) || ((uint32_t)(oend - op) < len)) return 0;
+		for (uint32_t i = 0; i < len; i++) op[i] = ip[i];
+		ip += len;
+		op += len;
+
+		// Last sequence has literals only
+		if (ip >= iend) break;
+
+		// Match
+		if (iend - ip < 2) return 0;
+		uint32_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if ((offset == 0) || (offset > (uint32_t)(op - dst))) return 0;
+
+		len = token & 0x0F;
+		if (len == 15) {
+			uint8_t b;
+			do {
+				if (ip >= iend) return 0;
+				b = *ip++;
+				len += b;
+			} while (b == 255);
+		}
+		len += 4;
+		if ((uint32_t)(oend - op) < len) return 0;
+
+		const uint8_t * ref = op - offset;
+		if (offset >= 4) {
+			// Non-overlapping in 4-byte steps
+			while (len >= 4) {
+				op[0] = ref[0]; op[1] = ref[1]; op[2] = ref[2]; op[3] = ref[3];
+				op += 4; ref += 4; len -= 4;
+			}
+		}
+		while (len--) *op++ = *ref++;
+	}
+
+	return (uint32_t)(op - dst);
+}
@@ -0,0 +1,254 @@
+/*****************************************************************
+ * MiniConsole V3 - Particles
+ *******************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "Particle.h"
+#include "Simd.h"
+#include "PixKernel.h"
+
+#define PART_CX				(LCD_WIDTH / 2)
+#define PART_CY				(LCD_HEIGHT / 2)
+
+typedef struct {
+	PART_CONFIG	cfg;
+	uint16_t	base;				// First particle in pool
+	uint16_t	capacity;
+	uint16_t	count;				// Living particles (base .. base + count - 1)
+	uint32_t	gravity;			// Packed Q10.6
+	uint32_t	alpha;				// Packed alpha0, alpha1
+} PART_EMITTER_INFO;
+
+// Structure of arrays
+static uint32_t part_pos[PART_MAX] DTC_BSS;		// Packed Q10.6 x, y relative to screen centre
+static uint32_t part_vel[PART_MAX] DTC_BSS;		// Packed Q10.6 vx, vy
+static uint16_t part_life[PART_MAX] DTC_BSS;		// Q0.16 part of life left
+static uint16_t part_decay[PART_MAX] DTC_BSS;		// Life lost every update
+
+static struct {
+	PART_EMITTER_INFO	em[PART_MAX_EMITTERS];
+	uint8_t				emitters;
+	uint16_t			used;				// Pool particles given to emitters
+	uint8_t				color_mode;
+	uint8_t				bpp;				// 0 - draw with G2D
+	uint32_t			rng;
+	int16_t				sin[256];			// Q1.14
+	PART_STATS			stats;
+} part;
+
+
+static inline uint32_t PART_Rand(void) {
+	part.rng ^= part.rng << 13;
+	part.rng ^= part.rng >> 17;
+	part.rng ^= part.rng << 5;
+	return part.rng;
+}
+
+static inline int32_t PART_Range(int32_t min, int32_t max) {
+	return (max > min) ? min + (int32_t)(PART_Rand() % (uint32_t)(max - min + 1)) : min;
+}
+
+static inline int32_t PART_ClampQ(int32_t v) {
+	return (v > INT16_MAX - 1) ? INT16_MAX - 1 : (v < INT16_MIN + 1) ? INT16_MIN + 1 : v;
+}
+
+// Alpha of particle i (SMLAD: life * alpha0 + (255 - life) * alpha1)
+static inline uint32_t PART_Alpha(const PART_EMITTER_INFO * em, uint16_t i) {
+	uint32_t l = part_life[i] >> 8;
+	return (uint32_t)SIMD_SMLAD(SIMD_PACK16((int32_t)l, 255 - (int32_t)l), em->alpha, 127) / 255;
+}
+
+
+// Pool and emitters
+
+void PART_Init(uint8_t color_mode, uint32_t seed) {
+	memset(&part.em, 0, sizeof(part.em));
+	part.emitters = 0;
+	part.used = 0;
+	part.color_mode = color_mode;
+	part.bpp = (color_mode == LCD_COLOR_MODE_ARGB8888) ? 4 : (color_mode == LCD_COLOR_MODE_RGB888) ? 3 : 0;
+	part.rng = (seed) ? seed : 0x2545F491u;
+	for (uint16_t a = 0; a < 256; a++) part.sin[a] = (int16_t)lrintf(sinf((float)a * 6.2831853f / 256.0f) * 16384.0f);
+	memset(&part.stats, 0, sizeof(PART_STATS));
+}
+
+// Reserves capacity particles of pool for new emitter
+PART_EMITTER PART_AddEmitter(const PART_CONFIG *cfg, uint16_t capacity) {
+	if ((part.emitters == PART_MAX_EMITTERS) || (capacity == 0) || ((uint32_t)part.used + capacity > PART_MAX)) return PART_INVALID;
+	PART_EMITTER_INFO * em = &part.em[part.emitters];
+	em->base = part.used;
+	em->capacity = capacity;
+	em->count = 0;
+	part.used += capacity;
+	part.emitters++;
+	PART_SetConfig(part.emitters - 1, cfg);
+	return part.emitters - 1;
+}
+
+// Changes parameters of emitter (living particles keep velocity and life)
+void PART_SetConfig(PART_EMITTER e, const PART_CONFIG *cfg) {
+	if (e >= part.emitters) return;
+	PART_EMITTER_INFO * em = &part.em[e];
+	em->cfg = *cfg;
+	if (em->cfg.size == 0) em->cfg.size = 1;
+	if (em->cfg.size > PART_MAX_SIZE) em->cfg.size = PART_MAX_SIZE;
+	if (em->cfg.life_min == 0) em->cfg.life_min = 1;
+	if (em->cfg.life_max < em->cfg.life_min) em->cfg.life_max = em->cfg.life_min;
+	em->gravity = SIMD_PACK16(cfg->gravity_x, cfg->gravity_y);
+	em->alpha = SIMD_PACK16(cfg->alpha0, cfg->alpha1);
+}
+
+// Emits up to count particles at screen position x, y. Returns number emitted.
+uint16_t PART_Emit(PART_EMITTER e, int16_t x, int16_t y, uint16_t count) {
+	if (e >= part.emitters) return 0;
+	PART_EMITTER_INFO * em = &part.em[e];
+	const PART_CONFIG * c = &em->cfg;
+	if (count > em->capacity - em->count) count = em->capacity - em->count;
+
+	for (uint16_t k = 0; k < count; k++) {
+		uint16_t i = em->base + em->count++;
+		uint8_t angle = (uint8_t)(c->angle + PART_Range(-c->spread, c->spread));
+		int32_t speed = PART_Range(c->speed_min, c->speed_max);
+		int32_t px = (x - PART_CX) * 64 + PART_Range(-c->radius * 64, c->radius * 64);
+		int32_t py = (y - PART_CY) * 64 + PART_Range(-c->radius * 64, c->radius * 64);
+		part_pos[i] = SIMD_PACK16(PART_ClampQ(px), PART_ClampQ(py));
+		part_vel[i] = SIMD_PACK16((speed * part.sin[(uint8_t)(angle + 64)]) >> 14, (speed * part.sin[angle]) >> 14);
+		part_life[i] = 0xFFFF;
+		part_decay[i] = (uint16_t)(0xFFFF / (uint32_t)PART_Range(c->life_min, c->life_max));
+		if (part_decay[i] == 0) part_decay[i] = 1;
+	}
+	part.stats.spawned += count;
+	part.stats.alive += count;
+	return count;
+}
+
+void PART_Clear(PART_EMITTER e) {
+	if (e >= part.emitters) return;
+	part.stats.alive -= part.em[e].count;
+	part.em[e].count = 0;
+}
+
+uint16_t PART_GetCount(PART_EMITTER e) {
+	return (e < part.emitters) ? part.em[e].count : 0;
+}
+
+// Screen position (centre) and alpha of living particle
+uint8_t PART_Get(PART_EMITTER e, uint16_t index, int16_t *x, int16_t *y, uint8_t *alpha) {
+	if ((e >= part.emitters) || (index >= part.em[e].count)) return BSP_ERROR;
+	uint16_t i = part.em[e].base + index;
+	*x = (int16_t)((SIMD_LO16(part_pos[i]) >> 6) + PART_CX);
+	*y = (int16_t)((SIMD_HI16(part_pos[i]) >> 6) + PART_CY);
+	*alpha = (uint8_t)PART_Alpha(&part.em[e], i);
+	return BSP_OK;
+}
+
+
+// Update
+
+static void PART_UpdateEmitter(PART_EMITTER_INFO * em) {
+	uint16_t i = em->base, end = em->base + em->count;
+	const uint32_t g = em->gravity;
+	const uint8_t drag = em->cfg.drag;
+
+	while (i < end) {
+		uint32_t life = part_life[i];
+		uint32_t v = SIMD_QADD16(part_vel[i], g);
+		if (drag) {
+			int32_t vx = SIMD_LO16(v), vy = SIMD_HI16(v);
+			v = SIMD_PACK16(vx - (vx >> drag), vy - (vy >> drag));
+		}
+		uint32_t p = SIMD_QADD16(part_pos[i], v);
+		int16_t x = SIMD_LO16(p), y = SIMD_HI16(p);
+
+		if ((life <= part_decay[i]) || (x == INT16_MAX) || (x == INT16_MIN) || (y == INT16_MAX) || (y == INT16_MIN)) {
+			// Replace with last living particle
+			end--;
+			part_pos[i] = part_pos[end];
+			part_vel[i] = part_vel[end];
+			part_life[i] = part_life[end];
+			part_decay[i] = part_decay[end];
+			continue;
+		}
+		part_pos[i] = p;
+		part_vel[i] = v;
+		part_life[i] = (uint16_t)(life - part_decay[i]);
+		i++;
+	}
+	part.stats.killed += em->count - (end - em->base);
+	em->count = end - em->base;
+}
+
+// Advances all particles by one update
+void PART_Update(void) {
+	part.stats.killed = 0;
+	part.stats.alive = 0;
+	for (uint8_t e = 0; e < part.emitters; e++) {
+		PART_UpdateEmitter(&part.em[e]);
+		part.stats.alive += part.em[e].count;
+	}
+	part.stats.spawned = 0;
+}
+
+
+// Drawing
+
+static void PART_DrawEmitter(PART_EMITTER_INFO * em, uint8_t * frame) {
+	const uint32_t rgb = em->cfg.color & 0x00FFFFFF;
+	const uint32_t cr = (rgb >> 16) & 0xFF, cg = (rgb >> 8) & 0xFF, cb = rgb & 0xFF;
+	const int32_t size = em->cfg.size, half = size / 2;
+	const uint32_t stride = LCD_WIDTH * part.bpp;
+
+	for (uint16_t i = em->base; i < em->base + em->count; i++) {
+		uint32_t a = PART_Alpha(em, i);
+		if (a == 0) continue;
+		int32_t x0 = (SIMD_LO16(part_pos[i]) >> 6) + PART_CX - half;
+		int32_t y0 = (SIMD_HI16(part_pos[i]) >> 6) + PART_CY - half;
+		int32_t x1 = x0 + size, y1 = y0 + size;
+		if (x0 < 0) x0 = 0;
+		if (y0 < 0) y0 = 0;
+		if (x1 > LCD_WIDTH) x1 = LCD_WIDTH;
+		if (y1 > LCD_HEIGHT) y1 = LCD_HEIGHT;
+		if ((x1 <= x0) || (y1 <= y0)) continue;
+
+		if (part.bpp == 0) {
+			BSP->G2D_DrawFillRectBlend((int16_t)x0, (int16_t)y0, (uint16_t)(x1 - x0), (uint16_t)(y1 - y0), a << 24 | rgb);
+		} else {
+			const uint32_t na = 255 - a, sr = cr * a + 127, sg = cg * a + 127, sb = cb * a + 127;
+			for (int32_t y = y0; y < y1; y++) {
+				uint8_t * p = frame + (uint32_t)y * stride + (uint32_t)x0 * part.bpp;
+				for (int32_t x = x0; x < x1; x++, p += part.bpp) {
+					if (a == 255) {
+						p[0] = (uint8_t)cb;
+						p[1] = (uint8_t)cg;
+						p[2] = (uint8_t)cr;
+						if (part.bpp == 4) p[3] = 0xFF;
+						continue;
+					}
+					p[0] = (uint8_t)((sb + p[0] * na) / 255);
+					p[1] = (uint8_t)((sg + p[1] * na) / 255);
+					p[2] = (uint8_t)((sr + p[2] * na) / 255);
+					if (part.bpp == 4) p[3] = (uint8_t)(a + (p[3] * na + 127) / 255);
+				}
+			}
+		}
+		part.stats.drawn++;
+		part.stats.pixels += (uint32_t)((x1 - x0) * (y1 - y0));
+	}
+}
+
+// Draws all emitters into edit frame. CPU drawing waits for DMA2D first and cleans D-cache after.
+void PART_Draw(void) {
+	uint8_t * frame = BSP->LCD_GetEditFrameAddr();
+	uint32_t size = (uint32_t)LCD_WIDTH * LCD_HEIGHT * part.bpp;
+	part.stats.drawn = 0;
+	part.stats.pixels = 0;
+	if ((frame == NULL) && (part.bpp)) return;
+	if (part.bpp) PK_SyncForCPU(frame, size);
+	for (uint8_t e = 0; e < part.emitters; e++) PART_DrawEmitter(&part.em[e], frame);
+	if (part.bpp) PK_SyncForDMA(frame, size);
+}
+
+const PART_STATS * PART_GetStats(void) {
+	return &part.stats;
+}
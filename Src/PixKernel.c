@@ -0,0 +1,311 @@
+/*****************************************************************
+ * MiniConsole V3 - Pixel Kernels
+ *******************************************************************/
+
+#include <string.h>
+#include "PixKernel.h"
+#include "Simd.h"
+
+#define PK_INLINE		static inline __attribute__((always_inline))
+
+#define PK_ROUND		0x007F007F		// +127 in both lanes
+
+#ifndef HOST_BUILD
+#define PK_DCACHE			1
+#define PK_DCACHE_LINE		32
+#define PK_DCACHE_SIZE		16384			// CM7 D-cache (4 ways x 128 sets x 32 bytes)
+#define PK_DMA2D_CR			(*(volatile uint32_t *)0x52001000)
+#define PK_DMA2D_START		0x00000001
+#define PK_SCB_CCSIDR		(*(volatile uint32_t *)0xE000ED80)
+#define PK_SCB_CSSELR		(*(volatile uint32_t *)0xE000ED84)
+#define PK_SCB_DCCSW		(*(volatile uint32_t *)0xE000EF6C)
+#define PK_SCB_DCCMVAC		(*(volatile uint32_t *)0xE000EF68)
+#define PK_SCB_DCCIMVAC		(*(volatile uint32_t *)0xE000EF70)
+#define PK_SCB_DCCISW		(*(volatile uint32_t *)0xE000EF74)
+#endif
+
+
+// Lane helpers (two channels in 16-bit lanes)
+
+// Exact x / 255 of both lanes for x < 65535 (rounding already added)
+PK_INLINE uint32_t PK_Div255x2(uint32_t t) {
+	return ((t + ((t >> 8) & 0x00FF00FF) + 0x00010001) >> 8) & 0x00FF00FF;
+}
+
+PK_INLINE uint32_t PK_Div255(uint32_t t) {
+	return (t + 1 + (t >> 8)) >> 8;
+}
+
+// Green lane and alpha lane replaced by 255 (alpha * a / 255 = a)
+PK_INLINE uint32_t PK_G255(uint32_t c) {
+	return ((c >> 8) & 0xFF) | 0x00FF0000;
+}
+
+// All four channels times a / 255
+PK_INLINE uint32_t PK_Scale(uint32_t c, uint32_t a) {
+	return PK_Div255x2(SIMD_UXTB16(c) * a + PK_ROUND) | PK_Div255x2(SIMD_UXTB16(c >> 8) * a + PK_ROUND) << 8;
+}
+
+// Effective source alpha as in G2D blending
+PK_INLINE uint32_t PK_Alpha(uint32_t s, uint8_t alpha) {
+	return (alpha == 255) ? s >> 24 : PK_Div255((s >> 24) * alpha + 127);
+}
+
+
+// Native pixel access (mode is compile-time constant in every kernel)
+
+PK_INLINE uint32_t PK_Load(uint8_t mode, const void *p, uint32_t i) {
+	const uint8_t * b;
+	uint32_t c;
+	switch (mode) {
+	case LCD_COLOR_MODE_ARGB8888:
+		return ((const uint32_t *)p)[i];
+	case LCD_COLOR_MODE_RGB888:
+		b = (const uint8_t *)p + i * 3;
+		return 0xFF000000 | (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16);
+	case LCD_COLOR_MODE_ARGB4444:
+		c = ((const uint16_t *)p)[i];
+		c = (c & 0x000F) | ((c & 0x00F0) << 4) | ((c & 0x0F00) << 8) | ((c & 0xF000) << 12);
+		return c * 0x11;
+	default:
+		c = ((const uint16_t *)p)[i];
+		uint32_t x = ((c & 0x7C00) << 6) | ((c & 0x03E0) << 3) | (c & 0x001F);
+		return ((c & 0x8000) ? 0xFF000000 : 0) | (x << 3) | ((x >> 2) & 0x00070707);
+	}
+}
+
+PK_INLINE uint32_t PK_Native(uint8_t mode, uint32_t c) {
+	switch (mode) {
+	case LCD_COLOR_MODE_ARGB4444:
+		c = (c >> 4) & 0x0F0F0F0F;
+		return (c & 0x000F) | ((c >> 4) & 0x00F0) | ((c >> 8) & 0x0F00) | ((c >> 12) & 0xF000);
+	case LCD_COLOR_MODE_ARGB1555:
+		return ((c >= 0x80000000) ? 0x8000 : 0) | ((c >> 9) & 0x7C00) | ((c >> 6) & 0x03E0) | ((c >> 3) & 0x001F);
+	default:
+		return c;
+	}
+}
+
+PK_INLINE void PK_Store(uint8_t mode, void *p, uint32_t i, uint32_t c) {
+	uint8_t * b;
+	switch (mode) {
+	case LCD_COLOR_MODE_ARGB8888:
+		((uint32_t *)p)[i] = c;
+		break;
+	case LCD_COLOR_MODE_RGB888:
+		b = (uint8_t *)p + i * 3;
+		b[0] = (uint8_t)c;
+		b[1] = (uint8_t)(c >> 8);
+		b[2] = (uint8_t)(c >> 16);
+		break;
+	default:
+		((uint16_t *)p)[i] = (uint16_t)PK_Native(mode, c);
+		break;
+	}
+}
+
+// Non-premultiplied s over d with alpha a (1 - 254)
+PK_INLINE uint32_t PK_Over(uint32_t d, uint32_t s, uint32_t a) {
+	uint32_t na = 255 - a;
+	uint32_t rb = SIMD_UXTB16(s) * a + SIMD_UXTB16(d) * na + PK_ROUND;
+	uint32_t ag = PK_G255(s) * a + SIMD_UXTB16(d >> 8) * na + PK_ROUND;
+	return PK_Div255x2(rb) | PK_Div255x2(ag) << 8;
+}
+
+
+// Generic kernels
+
+PK_INLINE void PK_FillT(uint8_t mode, void *dst, uint32_t count, uint32_t argb) {
+	uint32_t i = 0;
+	if (mode == LCD_COLOR_MODE_ARGB8888) {
+		uint32_t * d = dst;
+		for (; i + 4 <= count; i += 4) d[i] = d[i + 1] = d[i + 2] = d[i + 3] = argb;
+	} else if (mode == LCD_COLOR_MODE_RGB888) {
+		// 4 pixels in 3 words
+		uint32_t c = argb & 0x00FFFFFF, w[3] = { c | c << 24, c >> 8 | c << 16, c >> 16 | c << 8 };
+		uint8_t * d = dst;
+		for (; i + 4 <= count; i += 4, d += 12) memcpy(d, w, 12);
+	} else {
+		uint16_t * d = dst;
+		uint32_t n = PK_Native(mode, argb), w = n | n << 16;
+		if ((count) && ((uintptr_t)d & 2)) d[i++] = (uint16_t)n;
+		for (; i + 2 <= count; i += 2) memcpy(&d[i], &w, 4);
+	}
+	for (; i < count; i++) PK_Store(mode, dst, i, argb);
+}
+
+PK_INLINE void PK_FillBlendT(uint8_t mode, void *dst, uint32_t count, uint32_t argb) {
+	uint32_t a = argb >> 24;
+	if (a == 0) return;
+	if (a == 255) {
+		PK_FillT(mode, dst, count, argb);
+		return;
+	}
+	// Source part of both lanes is the same for all pixels
+	uint32_t na = 255 - a, rb = SIMD_UXTB16(argb) * a + PK_ROUND, ag = PK_G255(argb) * a + PK_ROUND;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t d = PK_Load(mode, dst, i);
+		PK_Store(mode, dst, i, PK_Div255x2(rb + SIMD_UXTB16(d) * na) | PK_Div255x2(ag + SIMD_UXTB16(d >> 8) * na) << 8);
+	}
+}
+
+PK_INLINE void PK_BlendT(uint8_t mode, void *dst, const uint32_t *src, uint32_t count, uint8_t alpha) {
+	if (alpha == 0) return;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t s = src[i], a = PK_Alpha(s, alpha);
+		if (a == 0) continue;
+		PK_Store(mode, dst, i, (a == 255) ? s | 0xFF000000 : PK_Over(PK_Load(mode, dst, i), s, a));
+	}
+}
+
+PK_INLINE void PK_BlendPMT(uint8_t mode, void *dst, const uint32_t *src, uint32_t count, uint8_t alpha) {
+	if (alpha == 0) return;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t s = (alpha == 255) ? src[i] : PK_Scale(src[i], alpha), a = s >> 24;
+		if (s == 0) continue;
+		PK_Store(mode, dst, i, (a == 255) ? s : SIMD_UQADD8(s, PK_Scale(PK_Load(mode, dst, i), 255 - a)));
+	}
+}
+
+PK_INLINE void PK_AddT(uint8_t mode, void *dst, const uint32_t *src, uint32_t count, uint8_t alpha) {
+	if (alpha == 0) return;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t s = src[i], a = PK_Alpha(s, alpha);
+		if (a == 0) continue;
+		uint32_t d = PK_Load(mode, dst, i);
+		uint32_t rb = PK_Div255x2(SIMD_UXTB16(s) * a + PK_ROUND) + SIMD_UXTB16(d);
+		uint32_t ag = PK_Div255x2(PK_G255(s) * a + PK_ROUND) + SIMD_UXTB16(d >> 8);
+		PK_Store(mode, dst, i, SIMD_USAT16(rb, 8) | SIMD_USAT16(ag, 8) << 8);
+	}
+}
+
+PK_INLINE void PK_FromARGBT(uint8_t mode, void *dst, const uint32_t *src, uint32_t count) {
+	uint32_t i = 0;
+	if (mode == LCD_COLOR_MODE_ARGB8888) {
+		memcpy(dst, src, count * 4);
+		return;
+	}
+	if (mode != LCD_COLOR_MODE_RGB888) {
+		// Two 16-bit pixels per word
+		uint16_t * d = dst;
+		if ((count) && ((uintptr_t)d & 2)) {
+			d[0] = (uint16_t)PK_Native(mode, src[0]);
+			i = 1;
+		}
+		for (; i + 2 <= count; i += 2) {
+			uint32_t w = PK_Native(mode, src[i]) | PK_Native(mode, src[i + 1]) << 16;
+			memcpy(&d[i], &w, 4);
+		}
+	}
+	for (; i < count; i++) PK_Store(mode, dst, i, src[i]);
+}
+
+PK_INLINE void PK_ToARGBT(uint8_t mode, uint32_t *dst, const void *src, uint32_t count) {
+	if (mode == LCD_COLOR_MODE_ARGB8888) {
+		memcpy(dst, src, count * 4);
+		return;
+	}
+	for (uint32_t i = 0; i < count; i++) dst[i] = PK_Load(mode, src, i);
+}
+
+
+// Specialisations
+
+#define PK_INSTANCE(mode, bpp) \
+	void PK_Fill_##mode(void *dst, uint32_t count, uint32_t argb) { \
+		PK_FillT(LCD_COLOR_MODE_##mode, dst, count, argb); \
+	} \
+	void PK_FillBlend_##mode(void *dst, uint32_t count, uint32_t argb) { \
+		PK_FillBlendT(LCD_COLOR_MODE_##mode, dst, count, argb); \
+	} \
+	void PK_Blend_##mode(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha) { \
+		PK_BlendT(LCD_COLOR_MODE_##mode, dst, src, count, alpha); \
+	} \
+	void PK_BlendPM_##mode(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha) { \
+		PK_BlendPMT(LCD_COLOR_MODE_##mode, dst, src, count, alpha); \
+	} \
+	void PK_Add_##mode(void *dst, const uint32_t *src, uint32_t count, uint8_t alpha) { \
+		PK_AddT(LCD_COLOR_MODE_##mode, dst, src, count, alpha); \
+	} \
+	void PK_FromARGB_##mode(void *dst, const uint32_t *src, uint32_t count) { \
+		PK_FromARGBT(LCD_COLOR_MODE_##mode, dst, src, count); \
+	} \
+	void PK_ToARGB_##mode(uint32_t *dst, const void *src, uint32_t count) { \
+		PK_ToARGBT(LCD_COLOR_MODE_##mode, dst, src, count); \
+	} \
+	static const PK_KERNELS pk_##mode = { PK_Fill_##mode, PK_FillBlend_##mode, PK_Blend_##mode, PK_BlendPM_##mode, \
+		PK_Add_##mode, PK_FromARGB_##mode, PK_ToARGB_##mode, bpp, LCD_COLOR_MODE_##mode };
+
+PK_INSTANCE(ARGB8888, 4)
+PK_INSTANCE(RGB888, 3)
+PK_INSTANCE(ARGB4444, 2)
+PK_INSTANCE(ARGB1555, 2)
+
+const PK_KERNELS * PK_GetKernels(uint8_t color_mode) {
+	switch (color_mode) {
+	case LCD_COLOR_MODE_ARGB8888:	return &pk_ARGB8888;
+	case LCD_COLOR_MODE_RGB888:		return &pk_RGB888;
+	case LCD_COLOR_MODE_ARGB4444:	return &pk_ARGB4444;
+	case LCD_COLOR_MODE_ARGB1555:	return &pk_ARGB1555;
+	default:						return NULL;
+	}
+}
+
+// Colour channels times alpha (dst may be src)
+void PK_Premultiply(uint32_t *dst, const uint32_t *src, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t s = src[i], a = s >> 24;
+		dst[i] = (a == 255) ? s : PK_Div255x2(SIMD_UXTB16(s) * a + PK_ROUND) | PK_Div255x2(PK_G255(s) * a + PK_ROUND) << 8;
+	}
+}
+
+
+// CPU and DMA2D access to shared buffers
+
+// Cleans (and invalidates) D-cache lines of range. Ranges larger than cache are
+// handled by set / way for whole cache, which is cheaper than line by line.
+static void PK_CacheOp(const void * addr, uint32_t size, uint8_t invalidate) {
+#ifdef PK_DCACHE
+	__asm volatile ("dsb" ::: "memory");
+	if (size >= PK_DCACHE_SIZE) {
+		PK_SCB_CSSELR = 0;
+		__asm volatile ("dsb" ::: "memory");
+		uint32_t ccsidr = PK_SCB_CCSIDR;
+		for (int32_t set = (ccsidr >> 13) & 0x7FFF; set >= 0; set--) {
+			for (int32_t way = (ccsidr >> 3) & 0x3FF; way >= 0; way--) {
+				uint32_t sw = ((uint32_t)set << 5) | ((uint32_t)way << 30);
+				if (invalidate) PK_SCB_DCCISW = sw;
+				else PK_SCB_DCCSW = sw;
+			}
+		}
+	} else {
+		uint32_t a = (uint32_t)addr & ~(PK_DCACHE_LINE - 1);
+		uint32_t end = (uint32_t)addr + size;
+		for (; a < end; a += PK_DCACHE_LINE) {
+			if (invalidate) PK_SCB_DCCIMVAC = a;
+			else PK_SCB_DCCMVAC = a;
+		}
+	}
+	__asm volatile ("dsb\n\tisb" ::: "memory");
+#else
+	(void)addr;
+	(void)size;
+	(void)invalidate;
+#endif
+}
+
+// Call before CPU reads or writes range of frame (or other buffer drawn by G2D). Waits until
+// DMA2D finished transfer started by last G2D call and drops stale cache lines of range
+// (lines are cleaned first, so earlier CPU writes are kept).
+void PK_SyncForCPU(const void * addr, uint32_t size) {
+#ifdef PK_DCACHE
+	while (PK_DMA2D_CR & PK_DMA2D_START) continue;
+#endif
+	PK_CacheOp(addr, size, 1);
+}
+
+// Call after CPU wrote range, before next G2D call or LCD_FrameReady - DMA2D and LTDC
+// read memory, not D-cache.
+void PK_SyncForDMA(const void * addr, uint32_t size) {
+	PK_CacheOp(addr, size, 0);
+}
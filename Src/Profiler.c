@@ -0,0 +1,254 @@
+/*****************************************************************
+ * MiniConsole V3 - Frame Profiler
+ *******************************************************************/
+
+#include "Profiler.h"
+#include "Log.h"
+
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#define PROF_DEMCR			(*(volatile uint32_t *)0xE000EDFC)
+#define PROF_DWT_CTRL		(*(volatile uint32_t *)0xE0001000)
+#define PROF_DWT_CYCCNT		(*(volatile uint32_t *)0xE0001004)
+#define PROF_DWT_LAR		(*(volatile uint32_t *)0xE0001FB0)
+#define PROF_DEMCR_TRCENA	(1 << 24)
+#define PROF_DWT_CYCCNTENA	(1 << 0)
+#define PROF_DWT_UNLOCK		0xC5ACCE55
+#endif
+
+typedef struct {
+	uint8_t		zone;
+	uint32_t	start;
+} PROF_FRAME;
+
+static PROF_EVENT prof_ring[PROF_RING_SIZE] DTC_BSS;
+static PROF_FRAME prof_stack[PROF_MAX_DEPTH] DTC_BSS;
+static PROF_ZONE prof_zone[PROF_MAX_ZONES];
+static uint8_t prof_zones = 0;
+static uint8_t prof_depth = 0;
+static uint32_t prof_head = 0;				// Events written since init
+static uint32_t prof_frame_head = 0;
+static uint32_t prof_frame_start = 0;
+static PROF_STATS prof_stats;
+
+
+uint32_t PROF_GetCycles(void) {
+#ifdef HOST_BUILD
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+#else
+	return PROF_DWT_CYCCNT;
+#endif
+}
+
+// Enables cycle counter (keeps counting if already running)
+void PROF_StartCounter(void) {
+#ifndef HOST_BUILD
+	if (PROF_DWT_CTRL & PROF_DWT_CYCCNTENA) return;
+	PROF_DEMCR |= PROF_DEMCR_TRCENA;
+	PROF_DWT_LAR = PROF_DWT_UNLOCK;
+	PROF_DWT_CYCCNT = 0;
+	PROF_DWT_CTRL |= PROF_DWT_CYCCNTENA;
+#endif
+}
+
+// Zones stay registered - PROF_BEGIN call sites keep their id in static variable
+void PROF_Init(void) {
+	PROF_StartCounter();
+	prof_depth = 0;
+	prof_head = 0;
+	prof_frame_head = 0;
+	PROF_Reset();
+	prof_frame_start = PROF_GetCycles();
+}
+
+// Clears aggregated statistics (registered zones are kept)
+void PROF_Reset(void) {
+	for (uint8_t i = 0; i < prof_zones; i++) {
+		prof_zone[i].calls = 0;
+		prof_zone[i].cycles = 0;
+		prof_zone[i].min = 0xFFFFFFFF;
+		prof_zone[i].max = 0;
+		prof_zone[i].sum = 0;
+		prof_zone[i].frames = 0;
+	}
+	prof_stats.frame = 0;
+	prof_stats.frame_cycles = 0;
+	prof_stats.events = 0;
+	prof_stats.dropped = 0;
+}
+
+// Returns zone id (existing one if name was registered before)
+uint8_t PROF_Register(const char *name) {
+	for (uint8_t i = 0; i < prof_zones; i++) {
+		if (prof_zone[i].name == name) return i;
+	}
+	if (prof_zones == PROF_MAX_ZONES) return PROF_INVALID;
+
+	PROF_ZONE * z = &prof_zone[prof_zones];
+	z->name = name;
+	z->calls = 0;
+	z->cycles = 0;
+	z->min = 0xFFFFFFFF;
+	z->max = 0;
+	z->sum = 0;
+	z->frames = 0;
+	return prof_zones++;
+}
+
+void PROF_Begin(uint8_t zone) {
+	if (prof_depth < PROF_MAX_DEPTH) {
+		prof_stack[prof_depth].zone = zone;
+		prof_stack[prof_depth].start = PROF_GetCycles();
+	}
+	prof_depth++;
+}
+
+void PROF_End(void) {
+	uint32_t now = PROF_GetCycles();
+
+	if (prof_depth == 0) return;
+	prof_depth--;
+	if (prof_depth >= PROF_MAX_DEPTH) return;
+
+	PROF_FRAME * f = &prof_stack[prof_depth];
+	if (f->zone == PROF_INVALID) return;
+
+	PROF_EVENT * e = &prof_ring[prof_head & (PROF_RING_SIZE - 1)];
+	e->zone = f->zone;
+	e->depth = prof_depth;
+	e->frame = (uint16_t)prof_stats.frame;
+	e->start = f->start;
+	e->cycles = now - f->start;
+	prof_head++;
+}
+
+void PROF_FrameBegin(void) {
+	prof_frame_head = prof_head;
+	prof_frame_start = PROF_GetCycles();
+}
+
+// Aggregates events recorded since PROF_FrameBegin
+void PROF_FrameEnd(void) {
+	uint32_t n = prof_head - prof_frame_head;
+
+	prof_stats.frame_cycles = PROF_GetCycles() - prof_frame_start;
+	prof_stats.events = n;
+	if (n > PROF_RING_SIZE) {
+		prof_stats.dropped += n - PROF_RING_SIZE;
+		n = PROF_RING_SIZE;
+	}
+
+	for (uint8_t i = 0; i < prof_zones; i++) {
+		prof_zone[i].calls = 0;
+		prof_zone[i].cycles = 0;
+	}
+
+	for (uint32_t i = prof_head - n; i != prof_head; i++) {
+		PROF_EVENT * e = &prof_ring[i & (PROF_RING_SIZE - 1)];
+		PROF_ZONE * z = &prof_zone[e->zone];
+		z->calls++;
+		z->cycles += e->cycles;
+	}
+
+	for (uint8_t i = 0; i < prof_zones; i++) {
+		PROF_ZONE * z = &prof_zone[i];
+		if (z->calls == 0) continue;
+		if (z->cycles < z->min) z->min = z->cycles;
+		if (z->cycles > z->max) z->max = z->cycles;
+		z->sum += z->cycles;
+		z->frames++;
+	}
+
+	prof_stats.frame++;
+	prof_frame_head = prof_head;
+	prof_frame_start = PROF_GetCycles();
+}
+
+// Writes zone averages to log ("prof frame <cycles>", "prof zone <name> <avg cycles> <frames>")
+// for Host/Tools/placement. Zones named after functions are matched to symbols.
+void PROF_Dump(void) {
+	LOG_Printf(LOG_LEVEL_INF, LOG_CAT_SYS, "prof frame %lu %lu", (unsigned long)prof_stats.frame_cycles, (unsigned long)prof_stats.frame);
+	for (uint8_t i = 0; i < prof_zones; i++) {
+		PROF_ZONE * z = &prof_zone[i];
+		if (z->frames == 0) continue;
+		LOG_Printf(LOG_LEVEL_INF, LOG_CAT_SYS, "prof zone %s %lu %lu", z->name, (unsigned long)(z->sum / z->frames), (unsigned long)z->frames);
+	}
+}
+
+uint8_t PROF_GetZoneCount(void) {
+	return prof_zones;
+}
+
+const PROF_ZONE * PROF_GetZone(uint8_t zone) {
+	return (zone < prof_zones) ? &prof_zone[zone] : NULL;
+}
+
+const PROF_STATS * PROF_GetStats(void) {
+	return &prof_stats;
+}
+
+// Gives access to raw event ring. Returns number of valid events, head is index of next write.
+uint32_t PROF_GetEvents(const PROF_EVENT ** ring, uint32_t * head) {
+	if (ring) *ring = prof_ring;
+	if (head) *head = prof_head;
+	return (prof_head < PROF_RING_SIZE) ? prof_head : PROF_RING_SIZE;
+}
+
+
+// Overlay
+
+// Appends value in microseconds with one decimal
+static char * PROF_FormatUs(char * p, uint32_t cycles) {
+	uint32_t v = (uint32_t)(((uint64_t)cycles * 10) / PROF_CYCLES_PER_US);
+	char tmp[12];
+	uint8_t n = 0;
+	uint32_t i = v / 10;
+
+	do {
+		tmp[n++] = '0' + (i % 10);
+		i /= 10;
+	} while (i);
+	while (n) *p++ = tmp[--n];
+	*p++ = '.';
+	*p++ = '0' + (v % 10);
+	return p;
+}
+
+static char * PROF_Append(char * p, const char * s) {
+	while (*s) *p++ = *s++;
+	return p;
+}
+
+void PROF_DrawOverlay(int16_t x, int16_t y, const uint8_t *font) {
+	char line[64];
+	char * p;
+	uint32_t fg = BSP->G2D_Color(C_WHITE, 255);
+	uint32_t bg = BSP->G2D_Color(C_BLACK, 255);
+	uint8_t h = BSP->G2D_GetTextHeight(font);
+
+	p = PROF_Append(line, "frame ");
+	p = PROF_FormatUs(p, prof_stats.frame_cycles);
+	p = PROF_Append(p, " us");
+	*p = 0;
+	BSP->G2D_Text(x, y, font, line, fg, bg);
+	y += h;
+
+	for (uint8_t i = 0; i < prof_zones; i++) {
+		PROF_ZONE * z = &prof_zone[i];
+		if (z->frames == 0) continue;
+		p = line;
+		for (const char * s = z->name; *s && (p < line + 16); s++) *p++ = *s;
+		*p++ = ' ';
+		p = PROF_FormatUs(p, z->cycles);
+		*p++ = ' ';
+		p = PROF_FormatUs(p, (uint32_t)(z->sum / z->frames));
+		*p++ = ' ';
+		p = PROF_FormatUs(p, z->max);
+		*p = 0;
+		BSP->G2D_Text(x, y, font, line, fg, bg);
+		y += h;
+	}
+}
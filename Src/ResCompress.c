@@ -0,0 +1,137 @@
+/*****************************************************************
+ * MiniConsole V3 - Compressed Resources
+ *******************************************************************/
+
+#include <string.h>
+#include "ResCompress.h"
+#include "Lz4.h"
+#include "Trace.h"
+
+// Compressed block never exceeds LZ4 worst case of RC_BLOCK_SIZE
+#define RC_BUFFER_SIZE		(RC_BLOCK_SIZE + RC_BLOCK_SIZE / 255 + 16)
+
+static uint8_t rc_buffer[RC_BUFFER_SIZE] __attribute__((aligned(32)));
+static RC_STATS rc_stats;
+
+static uint8_t RC_CheckHeader(const RC_HEADER * hdr) {
+	return (hdr->magic == RC_MAGIC) && (hdr->version == RC_VERSION) && (hdr->block_size > 0) && (hdr->block_size <= RC_BLOCK_SIZE);
+}
+
+// Loads plain file from open file. First head_size bytes were already read into head.
+static void * RC_ReadRaw(FIL * file, const void * head, uint32_t head_size) {
+	UINT br;
+	uint32_t size = (uint32_t)file->obj.objsize;
+	uint8_t * data = BSP->Res_Alloc((size) ? size : 1);
+	if (data == NULL) return NULL;
+
+	memcpy(data, head, head_size);
+	if ((size > head_size) && ((BSP->f_read(file, data + head_size, size - head_size, &br) != FR_OK) || (br != size - head_size))) {
+		BSP->Res_Free(data);
+		return NULL;
+	}
+	rc_stats.file_bytes = rc_stats.raw_bytes = size;
+	return data;
+}
+
+// Expands container or loads plain file from open file. Returns NULL on error.
+static void * RC_Read(FIL * file) {
+	RC_HEADER hdr;
+	UINT br;
+
+	if (BSP->f_read(file, &hdr, sizeof(hdr), &br) != FR_OK) return NULL;
+	if ((br != sizeof(hdr)) || !RC_CheckHeader(&hdr)) return RC_ReadRaw(file, &hdr, br);
+	rc_stats.file_bytes = sizeof(hdr);
+
+	uint8_t * data = BSP->Res_Alloc((hdr.raw_size) ? hdr.raw_size : 1);
+	uint32_t pos = 0;
+	if (data == NULL) return NULL;
+
+	while (pos < hdr.raw_size) {
+		uint32_t bsize;
+		uint32_t raw = hdr.raw_size - pos;
+		if (raw > hdr.block_size) raw = hdr.block_size;
+
+		if ((BSP->f_read(file, &bsize, 4, &br) != FR_OK) || (br != 4)) break;
+		uint32_t csize = bsize & ~RC_BLOCK_STORED;
+
+		if (bsize & RC_BLOCK_STORED) {
+			// Stored block - read directly into destination
+			if ((csize != raw) || (BSP->f_read(file, data + pos, csize, &br) != FR_OK) || (br != csize)) break;
+		} else {
+			if ((csize > RC_BUFFER_SIZE) || (BSP->f_read(file, rc_buffer, csize, &br) != FR_OK) || (br != csize)) break;
+			if (LZ4_DecodeBlock(rc_buffer, csize, data + pos, raw) != raw) break;
+		}
+		pos += raw;
+		rc_stats.file_bytes += 4 + csize;
+		rc_stats.blocks++;
+	}
+
+	if (pos != hdr.raw_size) {
+		BSP->Res_Free(data);
+		return NULL;
+	}
+	rc_stats.raw_bytes = pos;
+	TRACE_EVENT(res_load, pos);
+	return data;
+}
+
+// Loads resource. Compressed containers are expanded while reading, other files are loaded
+// as they are (file is opened once). Returns NULL on error. Load time is recorded on every return.
+void * RC_Load(char *filename) {
+	FIL file;
+	void * data = NULL;
+	uint32_t start = BSP->GetTick();
+
+	rc_stats.file_bytes = 0;
+	rc_stats.raw_bytes = 0;
+	rc_stats.blocks = 0;
+
+	if (BSP->f_open(&file, filename, FA_READ) == FR_OK) {
+		data = RC_Read(&file);
+		BSP->f_close(&file);
+	}
+	rc_stats.time = BSP->GetTick() - start;
+	return data;
+}
+
+// Returns expanded size of container in memory or 0 if data is not container
+uint32_t RC_GetRawSize(const void * data, uint32_t size) {
+	if ((data == NULL) || (size < sizeof(RC_HEADER)) || !RC_CheckHeader(data)) return 0;
+	return ((const RC_HEADER *)data)->raw_size;
+}
+
+// Expands container already in memory (e.g. resource pack entry)
+uint8_t RC_Decode(const void * data, uint32_t size, void * dst, uint32_t dst_size) {
+	const RC_HEADER * hdr = data;
+	const uint8_t * ip = (const uint8_t *)data + sizeof(RC_HEADER);
+	const uint8_t * iend = (const uint8_t *)data + size;
+	uint8_t * out = dst;
+	uint32_t pos = 0;
+
+	if ((RC_GetRawSize(data, size) == 0) || (hdr->raw_size > dst_size)) return BSP_ERROR;
+
+	while (pos < hdr->raw_size) {
+		uint32_t raw = hdr->raw_size - pos;
+		if (raw > hdr->block_size) raw = hdr->block_size;
+		if (iend - ip < 4) return BSP_ERROR;
+
+		uint32_t bsize = ip[0] | (ip[1] << 8) | (ip[2] << 16) | ((uint32_t)ip[3] << 24);
+		uint32_t csize = bsize & ~RC_BLOCK_STORED;
+		ip += 4;
+		if ((uint32_t)(iend - ip) < csize) return BSP_ERROR;
+
+		if (bsize & RC_BLOCK_STORED) {
+			if (csize != raw) return BSP_ERROR;
+			for (uint32_t i = 0; i < raw; i++) out[pos + i] = ip[i];
+		} else if (LZ4_DecodeBlock(ip, csize, out + pos, raw) != raw) {
+			return BSP_ERROR;
+		}
+		ip += csize;
+		pos += raw;
+	}
+	return BSP_OK;
+}
+
+const RC_STATS * RC_GetStats(void) {
+	return &rc_stats;
+}
@@ -0,0 +1,208 @@
+/*****************************************************************
+ * MiniConsole V3 - Asynchronous Resource Loader
+ *******************************************************************/
+
+#include "ResLoader.h"
+#include "Trace.h"
+
+typedef struct {
+	uint8_t		state;
+	uint32_t	seq;				// Request order
+	char		path[RL_MAX_PATH];
+	uint8_t *	data;
+	uint32_t	size;
+	uint32_t	loaded;
+} RL_REQUEST;
+
+static RL_REQUEST rl_req[RL_MAX_REQUESTS];
+static FIL rl_file;
+static RL_HANDLE rl_active = RL_INVALID;
+static uint32_t rl_seq = 0;
+static RL_STATS rl_stats;
+
+
+static void RL_Fail(RL_REQUEST * r) {
+	if (r->data) BSP->Res_Free(r->data);
+	r->data = NULL;
+	r->state = RL_STATE_ERROR;
+}
+
+// Opens oldest queued request
+static RL_HANDLE RL_Start(void) {
+	RL_HANDLE next = RL_INVALID;
+	FILINFO fno;
+
+	for (RL_HANDLE i = 0; i < RL_MAX_REQUESTS; i++) {
+		if (rl_req[i].state != RL_STATE_QUEUED) continue;
+		if ((next == RL_INVALID) || (rl_req[i].seq < rl_req[next].seq)) next = i;
+	}
+	if (next == RL_INVALID) return RL_INVALID;
+
+	RL_REQUEST * r = &rl_req[next];
+	if (BSP->f_stat(r->path, &fno) != FR_OK) {
+		RL_Fail(r);
+		return RL_Start();
+	}
+	r->size = (uint32_t)fno.fsize;
+	r->loaded = 0;
+	r->data = BSP->Res_Alloc((r->size) ? r->size : 1);
+	if ((r->data == NULL) || (BSP->f_open(&rl_file, r->path, FA_READ) != FR_OK)) {
+		RL_Fail(r);
+		return RL_Start();
+	}
+	r->state = RL_STATE_LOADING;
+	return next;
+}
+
+// Reads one chunk of active request. Returns 0 when there is nothing to do.
+static uint8_t RL_Step(void) {
+	UINT br = 0;
+
+	if (rl_active == RL_INVALID) rl_active = RL_Start();
+	if (rl_active == RL_INVALID) return 0;
+
+	RL_REQUEST * r = &rl_req[rl_active];
+	uint32_t btr = r->size - r->loaded;
+	if (btr > RL_CHUNK_SIZE) btr = RL_CHUNK_SIZE;
+
+	if (btr) {
+		if ((BSP->f_read(&rl_file, r->data + r->loaded, btr, &br) != FR_OK) || (br == 0)) {
+			BSP->f_close(&rl_file);
+			RL_Fail(r);
+			rl_active = RL_INVALID;
+			return 1;
+		}
+		r->loaded += br;
+		rl_stats.bytes += br;
+		rl_stats.total_bytes += br;
+		rl_stats.chunks++;
+	}
+
+	if (r->loaded >= r->size) {
+		BSP->f_close(&rl_file);
+		r->state = RL_STATE_READY;
+		TRACE_EVENT(res_load, r->size);
+		rl_active = RL_INVALID;
+	}
+	return 1;
+}
+
+static uint8_t RL_Pending(void) {
+	uint8_t n = 0;
+	for (RL_HANDLE i = 0; i < RL_MAX_REQUESTS; i++) {
+		if ((rl_req[i].state == RL_STATE_QUEUED) || (rl_req[i].state == RL_STATE_LOADING)) n++;
+	}
+	return n;
+}
+
+// Adds file to load queue. Returns RL_INVALID when queue is full or name is too long.
+RL_HANDLE RL_Request(const char *filename) {
+	uint32_t len = 0;
+
+	if (filename == NULL) return RL_INVALID;
+	while (filename[len]) len++;
+	if (len >= RL_MAX_PATH) return RL_INVALID;
+
+	for (RL_HANDLE i = 0; i < RL_MAX_REQUESTS; i++) {
+		RL_REQUEST * r = &rl_req[i];
+		if (r->state != RL_STATE_FREE) continue;
+		for (uint32_t n = 0; n <= len; n++) r->path[n] = filename[n];
+		r->seq = rl_seq++;
+		r->data = NULL;
+		r->size = 0;
+		r->loaded = 0;
+		r->state = RL_STATE_QUEUED;
+		return i;
+	}
+	return RL_INVALID;
+}
+
+// Reads chunks until budget is used. At least one chunk is read, so loading progresses
+// even when frame takes all the time. Returns number of pending requests.
+uint8_t RL_Service(uint32_t budget_ms) {
+	uint32_t start = BSP->GetTick();
+
+	rl_stats.bytes = 0;
+	rl_stats.chunks = 0;
+	while (RL_Step()) {
+		if (BSP->GetTick() - start >= budget_ms) break;
+	}
+	rl_stats.time = BSP->GetTick() - start;
+	rl_stats.pending = RL_Pending();
+	return rl_stats.pending;
+}
+
+// Reads chunks only while waiting for edit permission (after LCD_FrameReady), within budget.
+// Returns number of pending requests.
+uint8_t RL_ServiceIdle(uint32_t budget_ms) {
+	uint32_t start = BSP->GetTick();
+
+	rl_stats.bytes = 0;
+	rl_stats.chunks = 0;
+	while (!BSP->LCD_GetEditPermission()) {
+		if (BSP->GetTick() - start >= budget_ms) break;
+		if (!RL_Step()) break;
+	}
+	rl_stats.time = BSP->GetTick() - start;
+	rl_stats.pending = RL_Pending();
+	return rl_stats.pending;
+}
+
+uint8_t RL_GetState(RL_HANDLE handle) {
+	if (handle >= RL_MAX_REQUESTS) return RL_STATE_FREE;
+	return rl_req[handle].state;
+}
+
+// Returns progress in percent
+uint8_t RL_GetProgress(RL_HANDLE handle) {
+	if (handle >= RL_MAX_REQUESTS) return 0;
+	RL_REQUEST * r = &rl_req[handle];
+	if (r->state == RL_STATE_READY) return 100;
+	if ((r->state != RL_STATE_LOADING) || (r->size == 0)) return 0;
+	return (uint8_t)(((uint64_t)r->loaded * 100) / r->size);
+}
+
+void * RL_GetData(RL_HANDLE handle) {
+	if ((handle >= RL_MAX_REQUESTS) || (rl_req[handle].state != RL_STATE_READY)) return NULL;
+	return rl_req[handle].data;
+}
+
+uint32_t RL_GetSize(RL_HANDLE handle) {
+	if ((handle >= RL_MAX_REQUESTS) || (rl_req[handle].state != RL_STATE_READY)) return 0;
+	return rl_req[handle].size;
+}
+
+// Frees request slot. Loaded data stays allocated (owned by application).
+void RL_Release(RL_HANDLE handle) {
+	if (handle >= RL_MAX_REQUESTS) return;
+	if (rl_req[handle].state == RL_STATE_LOADING) return;
+	if (rl_req[handle].state == RL_STATE_QUEUED) return;
+	rl_req[handle].state = RL_STATE_FREE;
+}
+
+// Aborts request and frees its memory
+void RL_Cancel(RL_HANDLE handle) {
+	if (handle >= RL_MAX_REQUESTS) return;
+	RL_REQUEST * r = &rl_req[handle];
+	if (r->state == RL_STATE_FREE) return;
+	if (handle == rl_active) {
+		BSP->f_close(&rl_file);
+		rl_active = RL_INVALID;
+	}
+	if (r->data) BSP->Res_Free(r->data);
+	r->data = NULL;
+	r->state = RL_STATE_FREE;
+}
+
+// Blocks until request is completed. Returns data or NULL on error.
+void * RL_Wait(RL_HANDLE handle) {
+	if (handle >= RL_MAX_REQUESTS) return NULL;
+	while ((rl_req[handle].state == RL_STATE_QUEUED) || (rl_req[handle].state == RL_STATE_LOADING)) {
+		if (!RL_Step()) break;
+	}
+	return RL_GetData(handle);
+}
+
+const RL_STATS * RL_GetStats(void) {
+	return &rl_stats;
+}
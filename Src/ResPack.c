@@ -0,0 +1,184 @@
+/*****************************************************************
+ * MiniConsole V3 - Resource Pack
+ *******************************************************************/
+
+#include "ResPack.h"
+#include "Lz4.h"
+
+static uint8_t RP_Read(RP_PACK * pack, uint32_t offset, void * dst, uint32_t size) {
+	UINT br;
+	if (BSP->f_lseek(&pack->file, offset) != FR_OK) return BSP_ERROR;
+	if (BSP->f_read(&pack->file, dst, size, &br) != FR_OK) return BSP_ERROR;
+	return (br == size) ? BSP_OK : BSP_ERROR;
+}
+
+static uint8_t RP_NameEqual(const char *a, const char *b) {
+	for (;; a++, b++) {
+		char ca = ((*a >= 'A') && (*a <= 'Z')) ? *a + 32 : *a;
+		char cb = ((*b >= 'A') && (*b <= 'Z')) ? *b + 32 : *b;
+		if (ca != cb) return 0;
+		if (ca == 0) return 1;
+	}
+}
+
+uint32_t RP_Hash(const char *name) {
+	uint32_t h = 2166136261u;
+	for (; *name; name++) {
+		char c = ((*name >= 'A') && (*name <= 'Z')) ? *name + 32 : *name;
+		h = (h ^ (uint8_t)c) * 16777619u;
+	}
+	return h;
+}
+
+// Checks table of contents against file size and name table
+static uint8_t RP_Validate(const RP_PACK * pack) {
+	const RP_HEADER * h = &pack->hdr;
+	uint64_t file_size = pack->file.obj.objsize;
+	uint64_t toc_end = (uint64_t)h->toc_offset + (uint64_t)h->count * sizeof(RP_ENTRY);
+
+	if ((h->toc_offset < sizeof(RP_HEADER)) || (toc_end > h->names_offset)) return BSP_ERROR;
+	if ((uint64_t)h->names_offset + h->names_size > file_size) return BSP_ERROR;
+	if ((h->count) && ((h->names_size == 0) || (pack->names[h->names_size - 1] != 0))) return BSP_ERROR;
+
+	// Names are terminated inside table (last byte is zero), payloads inside file
+	for (uint16_t i = 0; i < h->count; i++) {
+		const RP_ENTRY * e = &pack->toc[i];
+		if (e->name >= h->names_size) return BSP_ERROR;
+		if ((uint64_t)e->offset + e->size > file_size) return BSP_ERROR;
+	}
+	return BSP_OK;
+}
+
+// Opens pack and loads table of contents with names (single read). Returns BSP_ERROR
+// for truncated or corrupt pack.
+uint8_t RP_Open(RP_PACK * pack, const char *filename) {
+	pack->open = 0;
+	pack->toc = NULL;
+	if (BSP->f_open(&pack->file, filename, FA_READ) != FR_OK) return BSP_ERROR;
+
+	if ((RP_Read(pack, 0, &pack->hdr, sizeof(RP_HEADER)) != BSP_OK) || (pack->hdr.magic != RP_MAGIC) || (pack->hdr.version != RP_VERSION) ||
+		(pack->hdr.names_offset < pack->hdr.toc_offset) || ((uint64_t)pack->hdr.names_offset + pack->hdr.names_size > pack->file.obj.objsize)) {
+		BSP->f_close(&pack->file);
+		return BSP_ERROR;
+	}
+
+	uint32_t size = pack->hdr.names_offset + pack->hdr.names_size - pack->hdr.toc_offset;
+	pack->toc = BSP->Res_Alloc((size) ? size : 1);
+	if ((pack->toc == NULL) || (RP_Read(pack, pack->hdr.toc_offset, pack->toc, size) != BSP_OK)) {
+		if (pack->toc) BSP->Res_Free(pack->toc);
+		pack->toc = NULL;
+		BSP->f_close(&pack->file);
+		return BSP_ERROR;
+	}
+	pack->names = (char *)pack->toc + (pack->hdr.names_offset - pack->hdr.toc_offset);
+	if (RP_Validate(pack) != BSP_OK) {
+		BSP->Res_Free(pack->toc);
+		pack->toc = NULL;
+		BSP->f_close(&pack->file);
+		return BSP_ERROR;
+	}
+	pack->open = 1;
+	return BSP_OK;
+}
+
+void RP_Close(RP_PACK * pack) {
+	if (!pack->open) return;
+	BSP->f_close(&pack->file);
+	BSP->Res_Free(pack->toc);
+	pack->toc = NULL;
+	pack->open = 0;
+}
+
+// Binary search on hash, then name compare for colliding hashes. Returns -1 if not found.
+int32_t RP_Find(const RP_PACK * pack, const char *name) {
+	if ((!pack->open) || (name == NULL)) return -1;
+
+	uint32_t h = RP_Hash(name);
+	int32_t lo = 0, hi = (int32_t)pack->hdr.count - 1;
+	while (lo <= hi) {
+		int32_t mid = (lo + hi) >> 1;
+		if (pack->toc[mid].hash < h) lo = mid + 1;
+		else hi = mid - 1;
+	}
+	for (int32_t i = lo; (i < pack->hdr.count) && (pack->toc[i].hash == h); i++) {
+		if (RP_NameEqual(pack->names + pack->toc[i].name, name)) return i;
+	}
+	return -1;
+}
+
+const RP_ENTRY * RP_GetEntry(const RP_PACK * pack, int32_t index) {
+	if ((!pack->open) || (index < 0) || (index >= pack->hdr.count)) return NULL;
+	return &pack->toc[index];
+}
+
+// Reads entry into dst (raw_size bytes), decompressing if needed
+uint8_t RP_ReadEntry(RP_PACK * pack, int32_t index, void * dst) {
+	const RP_ENTRY * e = RP_GetEntry(pack, index);
+	if ((e == NULL) || (dst == NULL)) return BSP_ERROR;
+
+	if (e->codec == RP_CODEC_NONE) return RP_Read(pack, e->offset, dst, e->size);
+	if (e->codec != RP_CODEC_LZ4) return BSP_ERROR;
+
+	uint8_t * tmp = BSP->Res_Alloc(e->size);
+	if (tmp == NULL) return BSP_ERROR;
+	uint8_t res = RP_Read(pack, e->offset, tmp, e->size);
+	if ((res == BSP_OK) && (LZ4_DecodeBlock(tmp, e->size, dst, e->raw_size) != e->raw_size)) res = BSP_ERROR;
+	BSP->Res_Free(tmp);
+	return res;
+}
+
+// Loads entry into newly allocated Res memory (release with Res_Free)
+void * RP_Load(RP_PACK * pack, const char *name) {
+	int32_t index = RP_Find(pack, name);
+	if (index < 0) return NULL;
+
+	void * data = BSP->Res_Alloc(pack->toc[index].raw_size);
+	if (data == NULL) return NULL;
+	if (RP_ReadEntry(pack, index, data) != BSP_OK) {
+		BSP->Res_Free(data);
+		return NULL;
+	}
+	return data;
+}
+
+// Loads all entries of group with one contiguous read
+uint8_t RP_LoadGroup(RP_PACK * pack, uint16_t group, RP_GROUP * g) {
+	uint32_t start = 0xFFFFFFFF, end = 0;
+
+	g->base = NULL;
+	g->group = group;
+	if (!pack->open) return BSP_ERROR;
+
+	for (uint16_t i = 0; i < pack->hdr.count; i++) {
+		RP_ENTRY * e = &pack->toc[i];
+		if (e->group != group) continue;
+		if (e->offset < start) start = e->offset;
+		if (e->offset + e->size > end) end = e->offset + e->size;
+	}
+	if (end <= start) return BSP_ERROR;
+
+	g->offset = start;
+	g->size = end - start;
+	g->base = BSP->Res_Alloc(g->size);
+	if (g->base == NULL) return BSP_ERROR;
+	if (RP_Read(pack, start, g->base, g->size) != BSP_OK) {
+		RP_FreeGroup(g);
+		return BSP_ERROR;
+	}
+	return BSP_OK;
+}
+
+// Returns entry data inside loaded group. Compressed entries are not expanded - use RP_Load for them.
+void * RP_GroupGet(const RP_PACK * pack, const RP_GROUP * g, const char *name) {
+	int32_t index = RP_Find(pack, name);
+	if ((index < 0) || (g->base == NULL)) return NULL;
+
+	const RP_ENTRY * e = &pack->toc[index];
+	if ((e->group != g->group) || (e->codec != RP_CODEC_NONE)) return NULL;
+	return g->base + (e->offset - g->offset);
+}
+
+void RP_FreeGroup(RP_GROUP * g) {
+	if (g->base) BSP->Res_Free(g->base);
+	g->base = NULL;
+}
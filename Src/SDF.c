@@ -0,0 +1,326 @@
+/*****************************************************************
+ * MiniConsole V3 - Signed Distance Field Fonts
+ *******************************************************************/
+
+#include <string.h>
+#include "SDF.h"
+#include "Font.h"
+
+typedef struct {
+	const uint8_t *	field;
+	uint16_t		fw;				// Field size
+	uint16_t		fh;
+	uint16_t		ox;				// First sampled pixel of output box
+	uint16_t		oy;
+	uint16_t		ow;				// Sampled part of output box
+	uint16_t		oh;
+	int16_t			pad;			// Padding in output pixels
+	uint32_t		inv;			// Field pixels per output pixel (16.16)
+	int32_t			gain;			// Distance to coverage (8.8)
+} SDF_GEOM;
+
+static uint16_t sdf_col_i[SDF_MAX_WIDTH];
+static uint8_t sdf_col_f[SDF_MAX_WIDTH];
+static int16_t sdf_row[SDF_MAX_WIDTH];
+static uint8_t sdf_icon[2][4 + SDF_BAND_PIXELS] __attribute__((aligned(4)));
+static uint32_t sdf_argb[2][SDF_BAND_PIXELS];
+static uint8_t sdf_sel = 0;
+static uint32_t sdf_recip[256];
+
+
+static inline uint16_t SDF_Rd16(const uint8_t *p) {
+	uint16_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t SDF_Rd32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint8_t SDF_Clamp(int32_t v) {
+	return (v < 0) ? 0 : (v > 255) ? 255 : (uint8_t)v;
+}
+
+// a * b / 255
+static inline uint32_t SDF_Mul(uint32_t a, uint32_t b) {
+	uint32_t t = a * b + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+static const uint8_t * SDF_Glyph(const uint8_t *font, uint32_t cp) {
+	uint16_t first = SDF_Rd16(font + 4);
+	uint16_t count = SDF_Rd16(font + 6);
+	if ((cp < first) || (cp >= (uint32_t)first + count)) return NULL;
+	return font + SDF_HEADER + SDF_GLYPH_ENTRY * (cp - first);
+}
+
+// Advance in 1/16 pixel of output
+static inline uint32_t SDF_Advance(const uint8_t *font, const uint8_t *glyph, uint16_t size) {
+	uint32_t adv = (glyph) ? SDF_Rd16(glyph + 4) : SDF_Rd16(font + 8);
+	return (adv * size + font[2] / 2) / font[2];
+}
+
+// Prepares sampling of glyph at given size (column table is shared by all rows). With trim
+// only part of box where coverage can be above 0 is sampled. Returns 0 if nothing is visible.
+static uint8_t SDF_Setup(const uint8_t *font, const uint8_t *glyph, uint16_t size, SDF_GEOM *g, uint8_t trim) {
+	uint8_t height = font[2];
+	uint8_t spread = font[3];
+
+	g->field = font + SDF_Rd32(glyph);
+	g->fw = glyph[6];
+	g->fh = height + 2 * spread;
+	if ((g->fw < 2) || (size == 0)) return 0;
+
+	g->ox = 0;
+	g->oy = 0;
+	g->ow = ((uint32_t)g->fw * size + height - 1) / height;
+	g->oh = ((uint32_t)g->fh * size + height - 1) / height;
+	g->pad = ((uint32_t)spread * size + height / 2) / height;
+	g->inv = ((uint32_t)height << 16) / size;
+
+	// Field unit is spread / 128 pixels of field, coverage ramp is 1 output pixel (255)
+	int32_t gain = ((int32_t)spread * size * 510) / height;
+	g->gain = (gain > 32767) ? 32767 : (gain < 1) ? 1 : gain;
+
+	if (trim) {
+		// Field values up to lo give no coverage
+		int32_t ramp = (32768 + g->gain - 1) / g->gain;
+		uint8_t lo = (ramp >= SDF_EDGE) ? 0 : SDF_EDGE - ramp;
+		int32_t fx0 = g->fw, fx1 = -1, fy0 = g->fh, fy1 = -1;
+		const uint8_t * f = g->field;
+		for (int32_t fy = 0; fy < g->fh; fy++) {
+			for (int32_t fx = 0; fx < g->fw; fx++, f++) {
+				if (*f <= lo) continue;
+				if (fx < fx0) fx0 = fx;
+				if (fx > fx1) fx1 = fx;
+				if (fy < fy0) fy0 = fy;
+				fy1 = fy;
+			}
+		}
+		if (fx1 < 0) return 0;
+
+		// Output pixels sampling field columns fx0 - 1 .. fx1 + 1 (with rounding margin)
+		int32_t x0 = ((fx0 - 1) * size) / height - 1, x1 = ((fx1 + 2) * size + height - 1) / height + 1;
+		int32_t y0 = ((fy0 - 1) * size) / height - 1, y1 = ((fy1 + 2) * size + height - 1) / height + 1;
+		if (x0 < 0) x0 = 0;
+		if (y0 < 0) y0 = 0;
+		if (x1 > g->ow) x1 = g->ow;
+		if (y1 > g->oh) y1 = g->oh;
+		g->ox = x0;
+		g->oy = y0;
+		g->ow = x1 - x0;
+		g->oh = y1 - y0;
+	}
+	if (g->ow > SDF_MAX_WIDTH) g->ow = SDF_MAX_WIDTH;
+
+	int32_t umax = ((int32_t)(g->fw - 1) << 16) - 1;
+	for (uint16_t ox = 0; ox < g->ow; ox++) {
+		int32_t u = (int32_t)((g->ox + ox) * g->inv + g->inv / 2) - 32768;
+		if (u < 0) u = 0;
+		if (u > umax) u = umax;
+		sdf_col_i[ox] = (uint16_t)(u >> 16);
+		sdf_col_f[ox] = (uint8_t)(u >> 8);
+	}
+	return 1;
+}
+
+// Field rows and weight for row of sampled box
+static inline const uint8_t * SDF_Row(const SDF_GEOM *g, uint16_t row, uint32_t *fv) {
+	int32_t vmax = ((int32_t)(g->fh - 1) << 16) - 1;
+	int32_t v = (int32_t)((g->oy + row) * g->inv + g->inv / 2) - 32768;
+	if (v < 0) v = 0;
+	if (v > vmax) v = vmax;
+	*fv = (uint8_t)(v >> 8);
+	return g->field + (uint32_t)(v >> 16) * g->fw;
+}
+
+// Samples row into signed distance (1/255 of output pixel, 0 on edge)
+static inline void SDF_SampleRow(const SDF_GEOM *g, uint16_t row) {
+	uint32_t fv;
+	const uint8_t * r0 = SDF_Row(g, row, &fv);
+	const uint8_t * r1 = r0 + g->fw;
+	int32_t gain = g->gain;
+	uint16_t ow = g->ow;
+
+	for (uint16_t ox = 0; ox < ow; ox++) {
+		uint32_t i = sdf_col_i[ox];
+		uint32_t fu = sdf_col_f[ox];
+		uint32_t a = r0[i] * (256 - fu) + r0[i + 1] * fu;
+		uint32_t b = r1[i] * (256 - fu) + r1[i + 1] * fu;
+		int32_t d = (int32_t)((a * (256 - fv) + b * fv) >> 8) - (SDF_EDGE << 8);
+		d = (d * gain) >> 16;
+		sdf_row[ox] = (int16_t)((d < -32767) ? -32767 : (d > 32767) ? 32767 : d);
+	}
+}
+
+// Samples row into coverage
+static inline void SDF_CoverRow(const SDF_GEOM *g, uint16_t row, uint8_t *dst) {
+	uint32_t fv;
+	const uint8_t * r0 = SDF_Row(g, row, &fv);
+	const uint8_t * r1 = r0 + g->fw;
+	int32_t gain = g->gain;
+	uint16_t ow = g->ow;
+
+	for (uint16_t ox = 0; ox < ow; ox++) {
+		uint32_t i = sdf_col_i[ox];
+		uint32_t fu = sdf_col_f[ox];
+		uint32_t a = r0[i] * (256 - fu) + r0[i + 1] * fu;
+		uint32_t b = r1[i] * (256 - fu) + r1[i + 1] * fu;
+		int32_t d = (int32_t)((a * (256 - fv) + b * fv) >> 8) - (SDF_EDGE << 8);
+		dst[ox] = SDF_Clamp(SDF_EDGE + ((d * gain) >> 16));
+	}
+}
+
+
+// Font properties
+
+uint8_t SDF_IsSDF(const uint8_t *font) {
+	return (font) && (font[0] == 0) && (font[1] == SDF_VERSION);
+}
+
+uint16_t SDF_GetTextWidth(const uint8_t *font, const char *str, uint16_t size) {
+	uint32_t pen = 0;
+	if ((!SDF_IsSDF(font)) || (str == NULL)) return 0;
+	while (*str) pen += SDF_Advance(font, SDF_Glyph(font, Font_UTF8Next(&str)), size);
+	return (uint16_t)((pen + 8) >> 4);
+}
+
+// Renders coverage of glyph box (glyph cell with padding) into mask. Returns box width, 0 if glyph is missing.
+uint16_t SDF_RenderMask(const uint8_t *font, uint32_t cp, uint16_t size, uint8_t *mask, uint16_t *height) {
+	SDF_GEOM g;
+	const uint8_t * glyph;
+
+	if ((!SDF_IsSDF(font)) || ((glyph = SDF_Glyph(font, cp)) == NULL) || (!SDF_Setup(font, glyph, size, &g, 0))) return 0;
+	for (uint16_t oy = 0; oy < g.oh; oy++) SDF_CoverRow(&g, oy, mask + (uint32_t)oy * g.ow);
+	if (height) *height = g.oh;
+	return g.ow;
+}
+
+
+// Drawing
+
+static void SDF_DrawPlain(const SDF_GEOM *g, int16_t x, int16_t y, uint32_t color) {
+	uint16_t band = SDF_BAND_PIXELS / g->ow;
+
+	for (uint16_t oy = 0; oy < g->oh; oy += band) {
+		uint16_t rows = (g->oh - oy < band) ? g->oh - oy : band;
+		uint8_t * icon = sdf_icon[sdf_sel];
+		uint8_t * dst = icon + 4;
+		uint32_t any = 0;
+
+		for (uint16_t r = 0; r < rows; r++) {
+			SDF_CoverRow(g, oy + r, dst);
+			for (uint16_t ox = 0; ox < g->ow; ox++) any |= dst[ox];
+			dst += g->ow;
+		}
+		if (any == 0) continue;
+
+		// Two buffers - band is rendered while previous one may still be read by DMA2D
+		sdf_sel ^= 1;
+		((uint16_t *)icon)[0] = g->ow;
+		((uint16_t *)icon)[1] = rows;
+		BSP->G2D_DrawIconBlend(icon, x, y + oy, color);
+	}
+}
+
+static void SDF_DrawStyled(const SDF_GEOM *g, int16_t x, int16_t y, const SDF_STYLE *st) {
+	uint16_t band = SDF_BAND_PIXELS / g->ow;
+	// Field saturates at spread - outline and glow have to fade out before it
+	int32_t usable = ((int32_t)g->pad * 255 * 127) / 128;
+	int32_t outline = (st->outline * 255 < usable - 128) ? st->outline * 255 : usable - 128;
+	int32_t glow = (st->glow * 255 < usable - outline) ? st->glow * 255 : usable - outline;
+	int32_t glow_rcp = (glow > 0) ? (255 << 16) / glow : 0;
+	if (outline < 0) outline = 0;
+	uint32_t ca_f = st->color >> 24, ca_o = st->outline_color >> 24, ca_g = st->glow_color >> 24;
+
+	if (sdf_recip[1] == 0) {
+		for (uint32_t a = 1; a < 256; a++) sdf_recip[a] = (255u << 16) / a;
+	}
+
+	for (uint16_t oy = 0; oy < g->oh; oy += band) {
+		uint16_t rows = (g->oh - oy < band) ? g->oh - oy : band;
+		uint32_t * dst = sdf_argb[sdf_sel];
+		uint32_t any = 0;
+
+		for (uint16_t r = 0; r < rows; r++) {
+			SDF_SampleRow(g, oy + r);
+			for (uint16_t ox = 0; ox < g->ow; ox++) {
+				int32_t d = sdf_row[ox];
+				uint32_t pr = 0, pg = 0, pb = 0, pa = 0;
+
+				// Layers bottom to top (premultiplied over): glow, outline, fill
+				if (glow_rcp) {
+					int32_t t = d + outline;
+					uint32_t a = (t >= 0) ? ca_g : (t <= -glow) ? 0 : SDF_Mul(SDF_Clamp(255 + ((t * glow_rcp) >> 16)), ca_g);
+					pr = SDF_Mul((st->glow_color >> 16) & 0xFF, a);
+					pg = SDF_Mul((st->glow_color >> 8) & 0xFF, a);
+					pb = SDF_Mul(st->glow_color & 0xFF, a);
+					pa = a;
+				}
+				if (outline) {
+					uint32_t a = SDF_Mul(SDF_Clamp(SDF_EDGE + d + outline), ca_o);
+					pr = SDF_Mul((st->outline_color >> 16) & 0xFF, a) + SDF_Mul(pr, 255 - a);
+					pg = SDF_Mul((st->outline_color >> 8) & 0xFF, a) + SDF_Mul(pg, 255 - a);
+					pb = SDF_Mul(st->outline_color & 0xFF, a) + SDF_Mul(pb, 255 - a);
+					pa = a + SDF_Mul(pa, 255 - a);
+				}
+				uint32_t a = SDF_Mul(SDF_Clamp(SDF_EDGE + d), ca_f);
+				pr = SDF_Mul((st->color >> 16) & 0xFF, a) + SDF_Mul(pr, 255 - a);
+				pg = SDF_Mul((st->color >> 8) & 0xFF, a) + SDF_Mul(pg, 255 - a);
+				pb = SDF_Mul(st->color & 0xFF, a) + SDF_Mul(pb, 255 - a);
+				pa = a + SDF_Mul(pa, 255 - a);
+
+				// Surface is not premultiplied (G2D_DrawBitmapBlend)
+				if (pa) {
+					uint32_t k = sdf_recip[pa];
+					pr = (pr * k + 32768) >> 16;
+					pg = (pg * k + 32768) >> 16;
+					pb = (pb * k + 32768) >> 16;
+					*dst++ = (pa << 24) | (SDF_Clamp(pr) << 16) | (SDF_Clamp(pg) << 8) | SDF_Clamp(pb);
+				} else {
+					*dst++ = 0;
+				}
+				any |= pa;
+			}
+		}
+		if (any == 0) continue;
+
+		BSP->G2D_DrawBitmapBlend(sdf_argb[sdf_sel], x, y + oy, g->ow, rows, 255);
+		sdf_sel ^= 1;
+	}
+}
+
+static uint16_t SDF_Draw(int16_t x, int16_t y, const uint8_t *font, const char *str, uint16_t size, uint32_t color, const SDF_STYLE *style) {
+	uint32_t pen = 0;
+
+	if ((!SDF_IsSDF(font)) || (str == NULL) || (size == 0)) return 0;
+
+	while (*str) {
+		uint32_t cp = Font_UTF8Next(&str);
+		const uint8_t * glyph = SDF_Glyph(font, cp);
+		SDF_GEOM g;
+
+		if ((cp != ' ') && (glyph) && (SDF_Setup(font, glyph, size, &g, style == NULL))) {
+			int16_t gx = x + (int16_t)((pen + 8) >> 4) - g.pad + g.ox;
+			int16_t gy = y - g.pad + g.oy;
+			if (style) SDF_DrawStyled(&g, gx, gy, style);
+			else SDF_DrawPlain(&g, gx, gy, color);
+		}
+		pen += SDF_Advance(font, glyph, size);
+	}
+	return (uint16_t)((pen + 8) >> 4);
+}
+
+// Draws text with line height of size pixels (top of line at y). Returns width.
+uint16_t SDF_TextBlend(int16_t x, int16_t y, const uint8_t *font, const char *str, uint16_t size, uint32_t color) {
+	return SDF_Draw(x, y, font, str, size, color, NULL);
+}
+
+// As SDF_TextBlend, with outline and glow
+uint16_t SDF_TextStyled(int16_t x, int16_t y, const uint8_t *font, const char *str, uint16_t size, const SDF_STYLE *style) {
+	if (style == NULL) return 0;
+	return SDF_Draw(x, y, font, str, size, 0, style);
+}
@@ -0,0 +1,176 @@
+/*****************************************************************
+ * MiniConsole V3 - Frame Scheduler
+ *******************************************************************/
+
+#include "Sched.h"
+#include "Profiler.h"
+
+#ifdef HOST_BUILD
+#include <time.h>
+#endif
+
+typedef struct {
+	SCHED_TASK_FN	fn;
+	void *			arg;
+	uint16_t		min_us;
+	uint8_t			idle;			// Task reported no work in current frame
+} SCHED_TASK;
+
+static SCHED_TASK sched_task[SCHED_MAX_TASKS];
+static uint8_t sched_next = 0;				// Round robin position
+static uint32_t sched_history[SCHED_HISTORY];		// Edit window intervals [us]
+static uint8_t sched_history_pos = 0;
+static uint32_t sched_last_edit = 0;		// Cycles when edit permission was last observed in wait loop
+static uint8_t sched_anchored = 0;
+static uint32_t sched_deadline = 0;
+static uint8_t sched_waiting = 0;
+static uint8_t sched_started = 0;
+static SCHED_STATS sched_stats;
+
+
+static inline uint32_t Sched_Us(uint32_t cycles) {
+	return cycles / PROF_CYCLES_PER_US;
+}
+
+// Sleeps until next interrupt (SysTick wakes core at least every 1 ms)
+static inline void Sched_Sleep(void) {
+#ifdef HOST_BUILD
+	struct timespec ts = {0, 100000};
+	nanosleep(&ts, NULL);
+#else
+	__asm volatile ("dsb\n\twfi" ::: "memory");
+#endif
+}
+
+// Refresh period is shortest interval between observed edit windows (measured with
+// cycle counter, vsync aligned). Until intervals are known LCD_GetFrameTime is used.
+static uint32_t Sched_EstimatePeriod(void) {
+	uint32_t period = 0xFFFFFFFF;
+	for (uint8_t i = 0; i < SCHED_HISTORY; i++) {
+		if ((sched_history[i]) && (sched_history[i] < period)) period = sched_history[i];
+	}
+	if (period != 0xFFFFFFFF) return period;
+	return BSP->LCD_GetFrameTime() * 1000;
+}
+
+static void Sched_AddHistory(uint32_t us) {
+	sched_history[sched_history_pos] = us;
+	sched_history_pos = (sched_history_pos + 1) % SCHED_HISTORY;
+}
+
+uint8_t Sched_AddTask(SCHED_TASK_FN fn, void * arg, uint16_t min_us) {
+	for (uint8_t i = 0; i < SCHED_MAX_TASKS; i++) {
+		if (sched_task[i].fn == NULL) {
+			sched_task[i].arg = arg;
+			sched_task[i].min_us = min_us;
+			sched_task[i].idle = 0;
+			sched_task[i].fn = fn;
+			return i;
+		}
+	}
+	return SCHED_INVALID;
+}
+
+void Sched_RemoveTask(uint8_t id) {
+	if (id < SCHED_MAX_TASKS) sched_task[id].fn = NULL;
+}
+
+// Returns microseconds left until predicted edit window (0 outside Sched_WaitEditPermission)
+uint32_t Sched_TimeLeft(void) {
+	if (!sched_waiting) return 0;
+	int32_t left = (int32_t)(sched_deadline - PROF_GetCycles());
+	return (left > 0) ? Sched_Us(left) : 0;
+}
+
+// Returns next task that fits into time left or SCHED_INVALID
+static uint8_t Sched_Pick(uint32_t left_us) {
+	for (uint8_t n = 0; n < SCHED_MAX_TASKS; n++) {
+		uint8_t i = (sched_next + n) % SCHED_MAX_TASKS;
+		if ((sched_task[i].fn) && (!sched_task[i].idle) && (sched_task[i].min_us <= left_us)) {
+			sched_next = (i + 1) % SCHED_MAX_TASKS;
+			return i;
+		}
+	}
+	return SCHED_INVALID;
+}
+
+// Runs background tasks in time left until next edit window, sleeps otherwise
+void Sched_WaitEditPermission(void) {
+	if (!sched_started) {
+		PROF_StartCounter();
+		sched_started = 1;
+	}
+
+	uint32_t start = PROF_GetCycles();
+	uint32_t period = Sched_EstimatePeriod();
+	uint32_t used = 0;
+	uint32_t idle = 0;
+	uint8_t late = 0;
+
+	sched_stats.frames++;
+	sched_stats.period_us = period;
+	sched_stats.slack_us = 0;
+
+	if (BSP->LCD_GetEditPermission()) {
+		sched_stats.no_slack++;
+	} else {
+		// Next window is first refresh after now, counted from last observed one
+		uint32_t deadline = start;
+		if ((period) && (sched_anchored)) {
+			uint32_t period_cycles = period * PROF_CYCLES_PER_US;
+			uint32_t since = start - sched_last_edit;
+			deadline = sched_last_edit + (since / period_cycles + 1) * period_cycles - SCHED_GUARD_US * PROF_CYCLES_PER_US;
+			if ((int32_t)(deadline - start) < 0) deadline = start;
+		}
+		sched_deadline = deadline;
+		sched_stats.slack_us = Sched_Us(deadline - start);
+		sched_waiting = 1;
+		for (uint8_t i = 0; i < SCHED_MAX_TASKS; i++) sched_task[i].idle = 0;
+
+		while (!BSP->LCD_GetEditPermission()) {
+			uint32_t now = PROF_GetCycles();
+			int32_t left = (int32_t)(deadline - now);
+			uint8_t id = (left > 0) ? Sched_Pick(Sched_Us(left)) : SCHED_INVALID;
+
+			if (id == SCHED_INVALID) {
+				Sched_Sleep();
+				idle += PROF_GetCycles() - now;
+				continue;
+			}
+
+			if (sched_task[id].fn(sched_task[id].arg) == SCHED_IDLE) sched_task[id].idle = 1;
+			uint32_t end = PROF_GetCycles();
+			used += end - now;
+			sched_stats.task_runs++;
+			if ((int32_t)(end - deadline) > 0) {
+				sched_stats.deadline_misses++;
+				if (BSP->LCD_GetEditPermission()) late = 1;
+			}
+		}
+		sched_waiting = 0;
+
+		// Permission observed while waiting is close to refresh - new anchor for prediction
+		uint32_t now = PROF_GetCycles();
+		uint32_t interval = Sched_Us(now - sched_last_edit);
+		if ((sched_anchored) && (interval < 1000000)) Sched_AddHistory(interval);
+		sched_last_edit = now;
+		sched_anchored = 1;
+	}
+
+	if (late) sched_stats.late_frames++;
+	sched_stats.used_us = Sched_Us(used);
+	sched_stats.idle_us = Sched_Us(idle);
+	sched_stats.slack_total += sched_stats.slack_us;
+	sched_stats.used_total += sched_stats.used_us;
+	sched_stats.idle_total += sched_stats.idle_us;
+}
+
+const SCHED_STATS * Sched_GetStats(void) {
+	return &sched_stats;
+}
+
+void Sched_ResetStats(void) {
+	uint32_t period = sched_stats.period_us;
+	sched_stats = (SCHED_STATS){0};
+	sched_stats.period_us = period;
+}
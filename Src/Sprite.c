@@ -0,0 +1,339 @@
+/*****************************************************************
+ * MiniConsole V3 - Sprite Atlas and Batching
+ *******************************************************************/
+
+#include <string.h>
+#include "Sprite.h"
+#include "ResCompress.h"
+#include "Log.h"
+
+#define SPR_KEY_FRAME_MASK	0x1FFF	// Sort key: layer << 16 | page << 13 | frame
+#define SPR_KEY_PAGE_SHIFT	13
+#define SPR_KEY_LAYER_SHIFT	16
+
+typedef struct {
+	uint16_t	x;
+	uint16_t	y;					// Top of used area below segment
+	uint16_t	w;
+} SPR_SEGMENT;
+
+typedef struct {
+	uint32_t	key;
+	int16_t		x;					// Position of image origin
+	int16_t		y;
+	uint8_t		alpha;
+} SPR_ITEM;
+
+static struct {
+	uint32_t *	mem;				// Pages one after another
+	uint8_t		owned;				// Memory allocated with Res_Alloc
+	uint8_t		pages;
+	uint16_t	page_w;
+	uint16_t	page_h;
+	uint16_t	frames;
+	uint16_t	segments[SPR_MAX_PAGES];
+	SPR_SEGMENT	sky[SPR_MAX_PAGES][SPR_MAX_SKYLINE];
+	SPR_FRAME	frame[SPR_MAX_FRAMES];
+	uint16_t	count;
+	SPR_ITEM	item[SPR_MAX_SPRITES];
+	SPR_ITEM	tmp[SPR_MAX_SPRITES];
+	SPR_STATS	stats;
+} spr;
+
+
+static inline uint32_t * SPR_Page(uint8_t page) {
+	return spr.mem + (uint32_t)page * spr.page_w * spr.page_h;
+}
+
+
+// Skyline packing
+
+// Lowest y where w x h rectangle fits with left edge at segment i (-1 if it does not fit)
+static int32_t SPR_SkyFit(uint8_t page, uint16_t i, uint16_t w, uint16_t h) {
+	const SPR_SEGMENT * s = spr.sky[page];
+	int32_t y = 0, left = w;
+
+	if ((uint32_t)s[i].x + w > spr.page_w) return -1;
+	for (uint16_t j = i; left > 0; j++) {
+		if (j >= spr.segments[page]) return -1;
+		if (s[j].y > y) y = s[j].y;
+		if (y + h > spr.page_h) return -1;
+		left -= s[j].w;
+	}
+	return y;
+}
+
+// Places rectangle at lowest position (narrowest segment on tie). Returns BSP_ERROR when page is full.
+static uint8_t SPR_SkyPlace(uint8_t page, uint16_t w, uint16_t h, uint16_t * px, uint16_t * py) {
+	SPR_SEGMENT * s = spr.sky[page];
+	uint16_t n = spr.segments[page];
+	int32_t best = -1, best_y = 0;
+	uint32_t best_top = 0xFFFFFFFF, best_w = 0xFFFFFFFF;
+
+	if (n >= SPR_MAX_SKYLINE) return BSP_ERROR;
+	for (uint16_t i = 0; i < n; i++) {
+		int32_t y = SPR_SkyFit(page, i, w, h);
+		if (y < 0) continue;
+		if (((uint32_t)(y + h) < best_top) || (((uint32_t)(y + h) == best_top) && (s[i].w < best_w))) {
+			best = i;
+			best_y = y;
+			best_top = y + h;
+			best_w = s[i].w;
+		}
+	}
+	if (best < 0) return BSP_ERROR;
+
+	// New segment on top of rectangle, segments below it are shortened or removed
+	uint16_t x = s[best].x;
+	memmove(&s[best + 1], &s[best], (n - best) * sizeof(SPR_SEGMENT));
+	n++;
+	s[best].x = x;
+	s[best].y = (uint16_t)(best_y + h);
+	s[best].w = w;
+	for (uint16_t i = best + 1; i < n;) {
+		uint16_t end = s[best].x + s[best].w;
+		if (s[i].x >= end) break;
+		uint16_t cut = end - s[i].x;
+		if (cut < s[i].w) {
+			s[i].x += cut;
+			s[i].w -= cut;
+			break;
+		}
+		memmove(&s[i], &s[i + 1], (n - i - 1) * sizeof(SPR_SEGMENT));
+		n--;
+	}
+	for (uint16_t i = 0; i + 1 < n;) {
+		if (s[i].y == s[i + 1].y) {
+			s[i].w += s[i + 1].w;
+			memmove(&s[i + 1], &s[i + 2], (n - i - 2) * sizeof(SPR_SEGMENT));
+			n--;
+		} else {
+			i++;
+		}
+	}
+	spr.segments[page] = n;
+	*px = x;
+	*py = (uint16_t)best_y;
+	return BSP_OK;
+}
+
+
+// Atlas
+
+// Atlas of page_w x page_h ARGB8888 pages in given memory (pages x page_w x page_h x 4 bytes)
+// or allocated with Res_Alloc when mem is NULL
+uint8_t SPR_AtlasInit(void * mem, uint16_t page_w, uint16_t page_h, uint8_t pages) {
+	SPR_AtlasRelease();
+	if ((pages == 0) || (pages > SPR_MAX_PAGES) || (page_w == 0) || (page_h == 0)) return BSP_ERROR;
+
+	spr.owned = (mem == NULL);
+	if (mem == NULL) mem = BSP->Res_Alloc((uint32_t)page_w * page_h * 4 * pages);
+	if (mem == NULL) return BSP_ERROR;
+
+	spr.mem = mem;
+	spr.page_w = page_w;
+	spr.page_h = page_h;
+	spr.pages = pages;
+	SPR_AtlasClear();
+	return BSP_OK;
+}
+
+// Adds image (ARGB8888, stride in pixels) as next frame. Returns SPR_INVALID when atlas is full.
+SPR_ID SPR_AtlasAdd(const uint32_t *argb, uint16_t width, uint16_t height, uint16_t stride) {
+	if ((spr.mem == NULL) || (argb == NULL) || (spr.frames >= SPR_MAX_FRAMES)) return SPR_INVALID;
+
+	// Trim transparent border
+	int32_t x0 = width, y0 = height, x1 = -1, y1 = -1;
+	for (int32_t y = 0; y < height; y++) {
+		const uint32_t * row = argb + (uint32_t)y * stride;
+		for (int32_t x = 0; x < width; x++) {
+			if ((row[x] >> 24) == 0) continue;
+			if (x < x0) x0 = x;
+			if (x > x1) x1 = x;
+			if (y < y0) y0 = y;
+			y1 = y;
+		}
+	}
+
+	SPR_FRAME * f = &spr.frame[spr.frames];
+	memset(f, 0, sizeof(SPR_FRAME));
+	f->width = width;
+	f->height = height;
+	if (x1 >= 0) {
+		uint16_t w = (uint16_t)(x1 - x0 + 1), h = (uint16_t)(y1 - y0 + 1);
+		uint8_t page = 0;
+		if ((w > spr.page_w) || (h > spr.page_h)) return SPR_INVALID;
+		while ((page < spr.pages) && (SPR_SkyPlace(page, w, h, &f->x, &f->y) != BSP_OK)) page++;
+		if (page == spr.pages) return SPR_INVALID;
+
+		uint32_t * dst = SPR_Page(page) + (uint32_t)f->y * spr.page_w + f->x;
+		for (uint16_t j = 0; j < h; j++) memcpy(dst + (uint32_t)j * spr.page_w, argb + (uint32_t)(y0 + j) * stride + x0, (uint32_t)w * 4);
+		f->page = page;
+		f->w = w;
+		f->h = h;
+		f->ox = (uint16_t)x0;
+		f->oy = (uint16_t)y0;
+		spr.stats.atlas_used += (uint32_t)w * h;
+	}
+	spr.stats.atlas_frames = ++spr.frames;
+	return spr.frames - 1;
+}
+
+// Loads image file (RC_Load) and adds it cut into frame_w x frame_h frames (0 - whole image).
+// Returns id of first frame, following frames have consecutive ids. On error returns
+// SPR_INVALID (frames added before atlas got full stay in atlas).
+SPR_ID SPR_AtlasLoad(const char *filename, uint16_t frame_w, uint16_t frame_h) {
+	SPR_ID first = SPR_INVALID;
+	uint8_t * data = RC_Load((char *)filename);
+	if (data == NULL) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "sprite: can not load %s", filename);
+		return SPR_INVALID;
+	}
+
+	uint16_t w, h;
+	memcpy(&w, data, 2);
+	memcpy(&h, data + 2, 2);
+	if (4 + (uint32_t)w * h * 4 > BSP->Res_GetSize(data)) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "sprite: %s is not an image", filename);
+		BSP->Res_Free(data);
+		return SPR_INVALID;
+	}
+	if ((frame_w == 0) || (frame_w > w)) frame_w = w;
+	if ((frame_h == 0) || (frame_h > h)) frame_h = h;
+
+	const uint32_t * pixels = (const uint32_t *)(data + 4);
+	for (uint32_t y = 0; y + frame_h <= h; y += frame_h) {
+		for (uint32_t x = 0; x + frame_w <= w; x += frame_w) {
+			SPR_ID id = SPR_AtlasAdd(pixels + y * w + x, frame_w, frame_h, w);
+			if (id == SPR_INVALID) {
+				LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "sprite: atlas full loading %s", filename);
+				BSP->Res_Free(data);
+				return SPR_INVALID;
+			}
+			if (first == SPR_INVALID) first = id;
+		}
+	}
+	BSP->Res_Free(data);
+	return first;
+}
+
+// Removes all frames (memory is kept)
+void SPR_AtlasClear(void) {
+	spr.frames = 0;
+	spr.count = 0;
+	for (uint8_t p = 0; p < spr.pages; p++) {
+		spr.segments[p] = 1;
+		spr.sky[p][0].x = 0;
+		spr.sky[p][0].y = 0;
+		spr.sky[p][0].w = spr.page_w;
+	}
+	spr.stats.atlas_frames = 0;
+	spr.stats.atlas_used = 0;
+	spr.stats.atlas_area = (uint32_t)spr.pages * spr.page_w * spr.page_h;
+}
+
+void SPR_AtlasRelease(void) {
+	if ((spr.owned) && (spr.mem)) BSP->Res_Free(spr.mem);
+	spr.mem = NULL;
+	spr.owned = 0;
+	spr.pages = 0;
+	spr.frames = 0;
+	spr.count = 0;
+}
+
+const SPR_FRAME * SPR_GetFrame(SPR_ID id) {
+	return (id < spr.frames) ? &spr.frame[id] : NULL;
+}
+
+
+// Sprites of frame
+
+void SPR_Begin(void) {
+	spr.count = 0;
+	spr.stats.queued = 0;
+	spr.stats.culled = 0;
+	spr.stats.drawn = 0;
+	spr.stats.batches = 0;
+	spr.stats.pixels = 0;
+}
+
+// Queues sprite with image origin at x, y. Returns BSP_ERROR for unknown frame or full queue.
+uint8_t SPR_Draw(SPR_ID id, int16_t x, int16_t y, uint8_t layer, uint8_t alpha) {
+	if (id >= spr.frames) return BSP_ERROR;
+	spr.stats.queued++;
+
+	const SPR_FRAME * f = &spr.frame[id];
+	int32_t sx = x + f->ox, sy = y + f->oy;
+	if ((f->w == 0) || (alpha == 0) || (sx >= LCD_WIDTH) || (sy >= LCD_HEIGHT) || (sx + f->w <= 0) || (sy + f->h <= 0)) {
+		spr.stats.culled++;
+		return BSP_OK;
+	}
+	if (spr.count >= SPR_MAX_SPRITES) return BSP_ERROR;
+
+	SPR_ITEM * it = &spr.item[spr.count++];
+	it->key = ((uint32_t)layer << SPR_KEY_LAYER_SHIFT) | ((uint32_t)f->page << SPR_KEY_PAGE_SHIFT) | id;
+	it->x = x;
+	it->y = y;
+	it->alpha = alpha;
+	return BSP_OK;
+}
+
+// Stable LSD radix sort of queue by key bytes (bytes equal for all sprites are skipped)
+static SPR_ITEM * SPR_Sort(void) {
+	SPR_ITEM * src = spr.item;
+	SPR_ITEM * dst = spr.tmp;
+	uint16_t count[256];
+
+	if (spr.count == 0) return src;
+	for (uint8_t shift = 0; shift < 24; shift += 8) {
+		memset(count, 0, sizeof(count));
+		for (uint16_t i = 0; i < spr.count; i++) count[(src[i].key >> shift) & 0xFF]++;
+		if (count[(src[0].key >> shift) & 0xFF] == spr.count) continue;
+
+		uint16_t pos = 0;
+		for (uint16_t b = 0; b < 256; b++) {
+			uint16_t c = count[b];
+			count[b] = pos;
+			pos += c;
+		}
+		for (uint16_t i = 0; i < spr.count; i++) dst[count[(src[i].key >> shift) & 0xFF]++] = src[i];
+		SPR_ITEM * t = src;
+		src = dst;
+		dst = t;
+	}
+	return src;
+}
+
+// Sorts and draws queued sprites. Returns number of DMA2D transfers.
+uint16_t SPR_End(void) {
+	const SPR_ITEM * list = SPR_Sort();
+	uint32_t run = 0xFFFFFFFF;
+
+	for (uint16_t i = 0; i < spr.count; i++) {
+		const SPR_ITEM * it = &list[i];
+		const SPR_FRAME * f = &spr.frame[it->key & SPR_KEY_FRAME_MASK];
+		int32_t x = it->x + f->ox, y = it->y + f->oy;
+		int32_t w = f->w, h = f->h, u = 0, v = 0;
+
+		// Clip in source rectangle (destination of G2D_CopyBufBlend is unsigned)
+		if (x < 0) { u = -x; w += x; x = 0; }
+		if (y < 0) { v = -y; h += y; y = 0; }
+		if (x + w > LCD_WIDTH) w = LCD_WIDTH - x;
+		if (y + h > LCD_HEIGHT) h = LCD_HEIGHT - y;
+
+		if ((it->key >> SPR_KEY_PAGE_SHIFT) != run) {
+			run = it->key >> SPR_KEY_PAGE_SHIFT;
+			spr.stats.batches++;
+		}
+		const uint32_t * src = SPR_Page(f->page) + (uint32_t)(f->y + v) * spr.page_w + f->x + u;
+		BSP->G2D_CopyBufBlend(src, (uint16_t)(spr.page_w - w), (uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h, it->alpha);
+		spr.stats.pixels += (uint32_t)(w * h);
+	}
+	spr.stats.drawn = spr.count;
+	spr.count = 0;
+	return (uint16_t)spr.stats.drawn;
+}
+
+const SPR_STATS * SPR_GetStats(void) {
+	return &spr.stats;
+}
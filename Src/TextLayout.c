@@ -0,0 +1,238 @@
+/*****************************************************************
+ * MiniConsole V3 - Text Layout
+ *******************************************************************/
+
+#include "TextLayout.h"
+#include "Font.h"
+
+static TL_LAYOUT tl_cache[TL_CACHE_SIZE];
+static uint32_t tl_age = 0;
+static TL_STATS tl_stats;
+
+
+// Measurement
+
+uint16_t TL_MeasureText(const uint8_t *font, const char *str) {
+	return Font_GetTextWidth(font, str);
+}
+
+// Width of first len bytes of UTF-8 text
+uint16_t TL_MeasureChars(const uint8_t *font, const char *str, uint16_t len) {
+	return Font_GetTextWidthN(font, str, len);
+}
+
+// FNV-1a
+static uint32_t TL_Hash(const char *str, uint16_t * length) {
+	uint32_t h = 2166136261u;
+	uint16_t len = 0;
+	for (; str[len]; len++) h = (h ^ (uint8_t)str[len]) * 16777619u;
+	*length = len;
+	return h;
+}
+
+
+// Layout
+
+// Shortens line until text with ellipsis fits in max_w
+static void TL_Truncate(const uint8_t *font, const char *str, TL_LINE * line, uint16_t max_w) {
+	uint16_t ew = 3 * Font_GetCharWidth(font, '.');
+	uint16_t width = TL_MeasureChars(font, str + line->start, line->len);
+
+	while ((line->len > 0) && ((width + ew > max_w) || (str[line->start + line->len - 1] == ' '))) {
+		// Remove whole UTF-8 sequence
+		line->len--;
+		while ((line->len > 0) && (((uint8_t)str[line->start + line->len] & 0xC0) == 0x80)) line->len--;
+		width = TL_MeasureChars(font, str + line->start, line->len);
+	}
+	line->width = width + ew;
+	line->ellipsis = 1;
+}
+
+static void TL_Build(TL_LAYOUT * l, const char *str) {
+	const uint8_t *font = l->font;
+	uint8_t height = Font_GetHeight(font);
+	uint16_t max_lines = TL_MAX_LINES;
+	uint8_t wrap = (l->flags & TL_WRAP) && (l->box_w > 0);
+	uint16_t pos = 0;
+
+	if ((l->box_h > 0) && (height > 0) && (l->box_h / height < max_lines)) max_lines = l->box_h / height;
+	if (max_lines == 0) max_lines = 1;
+
+	l->line_count = 0;
+	while (l->line_count < max_lines) {
+		TL_LINE * line = &l->line[l->line_count];
+		uint16_t start = pos;
+		uint16_t i = pos;
+		uint16_t width = 0;
+		int32_t space = -1;
+		uint16_t next;
+
+		for (;;) {
+			char c = str[i];
+			if (c == 0) { next = i; break; }
+			if (c == '\n') { next = i + 1; break; }
+			const char * p = &str[i];
+			uint8_t cw = Font_GetCodepointWidth(font, Font_UTF8Next(&p));
+			if (wrap && (width + cw > l->box_w) && (i > start)) {
+				if (c == ' ') {
+					next = i + 1;
+				} else if (space > start) {
+					i = (uint16_t)space;
+					next = i + 1;
+				} else {
+					next = i;
+				}
+				break;
+			}
+			if (c == ' ') space = i;
+			width += cw;
+			i = (uint16_t)(p - str);
+		}
+
+		// Trailing spaces do not count for alignment
+		while ((i > start) && (str[i - 1] == ' ')) i--;
+
+		line->start = start;
+		line->len = i - start;
+		line->width = TL_MeasureChars(font, str + start, line->len);
+		line->ellipsis = 0;
+		l->line_count++;
+
+		pos = next;
+		if (str[pos] == 0) break;
+	}
+
+	// Text did not fit - mark last line
+	if ((str[pos] != 0) && (l->flags & TL_ELLIPSIS)) {
+		TL_LINE * line = &l->line[l->line_count - 1];
+		TL_Truncate(font, str, line, (l->box_w) ? l->box_w : line->width + 3 * Font_GetCharWidth(font, '.'));
+	}
+
+	// Lines wider than box (no wrapping or single long word)
+	if ((l->box_w > 0) && (l->flags & TL_ELLIPSIS)) {
+		for (uint8_t n = 0; n < l->line_count; n++) {
+			if (l->line[n].width > l->box_w) TL_Truncate(font, str, &l->line[n], l->box_w);
+		}
+	}
+
+	// Alignment
+	l->width = 0;
+	for (uint8_t n = 0; n < l->line_count; n++) if (l->line[n].width > l->width) l->width = l->line[n].width;
+	l->height = l->line_count * height;
+
+	uint16_t box_w = (l->box_w) ? l->box_w : l->width;
+	uint16_t box_h = (l->box_h) ? l->box_h : l->height;
+	for (uint8_t n = 0; n < l->line_count; n++) {
+		TL_LINE * line = &l->line[n];
+		if (l->flags & TL_ALIGN_CENTER) line->x = ((int16_t)box_w - (int16_t)line->width) / 2;
+		else if (l->flags & TL_ALIGN_RIGHT) line->x = (int16_t)box_w - (int16_t)line->width;
+		else line->x = 0;
+	}
+	if (l->flags & TL_VALIGN_MIDDLE) l->y = ((int16_t)box_h - (int16_t)l->height) / 2;
+	else if (l->flags & TL_VALIGN_BOTTOM) l->y = (int16_t)box_h - (int16_t)l->height;
+	else l->y = 0;
+}
+
+// Returns memoised layout - valid until it is replaced by TL_CACHE_SIZE other layouts
+const TL_LAYOUT * TL_Layout(const uint8_t *font, const char *str, uint16_t box_w, uint16_t box_h, uint8_t flags) {
+	uint16_t length;
+	uint32_t hash;
+	TL_LAYOUT * victim = &tl_cache[0];
+
+	if ((font == NULL) || (str == NULL)) return NULL;
+	hash = TL_Hash(str, &length);
+	tl_age++;
+
+	for (uint8_t i = 0; i < TL_CACHE_SIZE; i++) {
+		TL_LAYOUT * l = &tl_cache[i];
+		if ((l->font == font) && (l->hash == hash) && (l->length == length) && (l->box_w == box_w) && (l->box_h == box_h) && (l->flags == flags)) {
+			l->age = tl_age;
+			tl_stats.hits++;
+			return l;
+		}
+		if (l->age < victim->age) victim = l;
+	}
+
+	tl_stats.misses++;
+	victim->font = font;
+	victim->hash = hash;
+	victim->length = length;
+	victim->box_w = box_w;
+	victim->box_h = box_h;
+	victim->flags = flags;
+	victim->age = tl_age;
+	TL_Build(victim, str);
+	return victim;
+}
+
+void TL_Flush(void) {
+	for (uint8_t i = 0; i < TL_CACHE_SIZE; i++) {
+		tl_cache[i].font = NULL;
+		tl_cache[i].age = 0;
+	}
+}
+
+const TL_STATS * TL_GetStats(void) {
+	return &tl_stats;
+}
+
+
+// Drawing
+
+// Code point which ends first len bytes of UTF-8 text
+static uint32_t TL_LastCodepoint(const char *str, uint16_t len) {
+	const char * p;
+	while ((len > 1) && (((uint8_t)str[len - 1] & 0xC0) == 0x80)) len--;
+	p = &str[len - 1];
+	return Font_UTF8Next(&p);
+}
+
+// Lines longer than TL_MAX_LINE_CHARS are drawn in pieces placed as in measured line
+static void TL_DrawLines(const TL_LAYOUT * layout, const char *str, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor, uint8_t blend) {
+	char buf[TL_MAX_LINE_CHARS + 4];
+	uint8_t height;
+
+	if ((layout == NULL) || (str == NULL)) return;
+	height = Font_GetHeight(layout->font);
+
+	for (uint8_t n = 0; n < layout->line_count; n++) {
+		const TL_LINE * line = &layout->line[n];
+		uint16_t pos = line->start;
+		uint16_t end = line->start + line->len;
+		int16_t lx = x + line->x;
+		int16_t ly = y + layout->y + n * height;
+
+		do {
+			uint16_t len = (end - pos > TL_MAX_LINE_CHARS) ? TL_MAX_LINE_CHARS : end - pos;
+			// Do not cut UTF-8 sequence
+			while ((pos + len < end) && (len > 0) && (((uint8_t)str[pos + len] & 0xC0) == 0x80)) len--;
+			if ((len == 0) && (pos < end)) break;
+			for (uint16_t i = 0; i < len; i++) buf[i] = str[pos + i];
+			uint16_t count = len;
+			if ((line->ellipsis) && (pos + len == end)) {
+				buf[count++] = '.';
+				buf[count++] = '.';
+				buf[count++] = '.';
+			}
+			buf[count] = 0;
+			if (count == 0) break;
+
+			if (blend) Font_TextBlend(lx, ly, layout->font, buf, color);
+			else Font_Text(lx, ly, layout->font, buf, color, bgcolor);
+
+			if (pos + len < end) {
+				const char * next = &str[pos + len];
+				lx += TL_MeasureChars(layout->font, &str[pos], len) + Font_GetKerning(layout->font, TL_LastCodepoint(&str[pos], len), Font_UTF8Next(&next));
+			}
+			pos += len;
+		} while (pos < end);
+	}
+}
+
+void TL_Draw(const TL_LAYOUT * layout, const char *str, int16_t x, int16_t y, uint32_t color, uint32_t bgcolor) {
+	TL_DrawLines(layout, str, x, y, color, bgcolor, 0);
+}
+
+void TL_DrawBlend(const TL_LAYOUT * layout, const char *str, int16_t x, int16_t y, uint32_t color) {
+	TL_DrawLines(layout, str, x, y, color, 0, 1);
+}
@@ -0,0 +1,145 @@
+/*****************************************************************
+ * MiniConsole V3 - Text Sprites
+ *******************************************************************/
+
+#include "TextSprite.h"
+#include "Font.h"
+#include "PixKernel.h"
+
+#define TS_MAX_GLYPH_PIXELS	8192	// Enough for 64 px fonts
+
+static uint8_t ts_mask[TS_MAX_GLYPH_PIXELS];
+static TS_STATS ts_stats;
+static uint8_t ts_color_mode = 0;			// Set by TS_Init (0 - not initialised, text is not cached)
+
+// FNV-1a
+static uint32_t TS_Hash(const char *str, uint16_t * length) {
+	uint32_t h = 2166136261u;
+	uint16_t len = 0;
+	for (; str[len]; len++) h = (h ^ (uint8_t)str[len]) * 16777619u;
+	*length = len;
+	return h;
+}
+
+// Native colour (G2D_Color) -> ARGB8888. Returns 0 for CLUT modes (L8, AL88) and before TS_Init.
+// ARGB8888 and RGB888 colours are taken as 0xAARRGGBB (see TextSprite.h).
+static uint8_t TS_ToARGB(uint32_t color, uint32_t * argb) {
+	if ((ts_color_mode == LCD_COLOR_MODE_ARGB8888) || (ts_color_mode == LCD_COLOR_MODE_RGB888)) {
+		*argb = color;
+		return 1;
+	}
+	const PK_KERNELS * pk = PK_GetKernels(ts_color_mode);
+	if (pk == NULL) return 0;
+	uint16_t native = (uint16_t)color;
+	pk->ToARGB(argb, &native, 1);
+	return 1;
+}
+
+// Sets colour mode of frame (colours passed to TS functions are native values of this mode).
+// Returns BSP_ERROR for modes without ARGB8888 equivalent (L8, AL88) - text is then not cached.
+uint8_t TS_Init(uint8_t color_mode) {
+	ts_color_mode = color_mode;
+	ts_stats = (TS_STATS){0};
+	if ((color_mode == LCD_COLOR_MODE_ARGB8888) || (color_mode == LCD_COLOR_MODE_RGB888)) return BSP_OK;
+	return (PK_GetKernels(color_mode)) ? BSP_OK : BSP_ERROR;
+}
+
+// Rasterises string into sprite surface. Glyph coverage is multiplied by alpha of color,
+// so blending surface gives same result as G2D_TextBlend.
+static void TS_Render(TS_SPRITE * sprite, const char *str, uint32_t argb) {
+	uint32_t rgb = argb & 0x00FFFFFF;
+	uint32_t alpha = argb >> 24;
+	uint16_t cx = 0;
+	uint8_t height = sprite->height;
+
+	for (uint32_t i = 0; i < (uint32_t)sprite->width * height; i++) sprite->surface[i] = 0;
+
+	uint32_t prev = 0;
+	while (*str) {
+		uint32_t cp = Font_UTF8Next(&str);
+		uint8_t w = Font_GetCodepointWidth(sprite->font, cp);
+		if ((cp == ' ') || (!Font_HasGlyph(sprite->font, cp))) {
+			cx += w;
+			prev = 0;
+			continue;
+		}
+		if (prev) cx += Font_GetKerning(sprite->font, prev, cp);
+		prev = cp;
+		if (((uint32_t)w * height <= TS_MAX_GLYPH_PIXELS) && (cx + w <= sprite->width)) {
+			Font_DecodeCodepoint(sprite->font, cp, ts_mask);
+			for (uint16_t y = 0; y < height; y++) {
+				uint32_t * dst = &sprite->surface[(uint32_t)y * sprite->width + cx];
+				const uint8_t * src = &ts_mask[(uint32_t)y * w];
+				for (uint16_t x = 0; x < w; x++) {
+					if (src[x] == 0) continue;
+					dst[x] = (((alpha * src[x] + 127) / 255) << 24) | rgb;
+				}
+			}
+			ts_stats.glyphs++;
+		}
+		cx += w;
+	}
+	ts_stats.renders++;
+}
+
+// Makes sure sprite holds given text. Returns BSP_ERROR if surface can not be allocated,
+// TS_Init was not called or colour mode has no ARGB8888 equivalent (CLUT).
+uint8_t TS_Update(TS_SPRITE * sprite, const uint8_t *font, const char *str, uint32_t color) {
+	uint16_t length;
+	uint32_t hash, argb;
+
+	if ((sprite == NULL) || (font == NULL) || (str == NULL)) return BSP_ERROR;
+	if (!TS_ToARGB(color, &argb)) return BSP_ERROR;
+	hash = TS_Hash(str, &length);
+
+	if ((sprite->surface != NULL) && (sprite->font == font) && (sprite->color == color) && (sprite->hash == hash) && (sprite->length == length)) return BSP_OK;
+
+	uint16_t width = Font_GetTextWidth(font, str);
+	uint16_t height = Font_GetHeight(font);
+	uint32_t size = (uint32_t)width * height * 4;
+
+	if ((sprite->surface == NULL) || (size > sprite->capacity)) {
+		if (sprite->surface) BSP->Res_Free(sprite->surface);
+		sprite->surface = (size) ? BSP->Res_Alloc(size) : NULL;
+		sprite->capacity = (sprite->surface) ? size : 0;
+	}
+
+	sprite->font = font;
+	sprite->color = color;
+	sprite->hash = hash;
+	sprite->length = length;
+	sprite->width = width;
+	sprite->height = height;
+	if (sprite->surface == NULL) return BSP_ERROR;
+
+	TS_Render(sprite, str, argb);
+	return BSP_OK;
+}
+
+uint16_t TS_TextBlend(TS_SPRITE * sprite, int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color) {
+	if (TS_Update(sprite, font, str, color) != BSP_OK) return Font_TextBlend(x, y, font, str, color);
+	BSP->G2D_DrawBitmapBlend(sprite->surface, x, y, sprite->width, sprite->height, 255);
+	ts_stats.blits++;
+	return sprite->width;
+}
+
+uint16_t TS_TextBlendC(TS_SPRITE * sprite, int16_t x, int16_t y, const uint8_t *font, const char *str, uint32_t color) {
+	if (TS_Update(sprite, font, str, color) != BSP_OK) {
+		uint16_t width = Font_GetTextWidth(font, str);
+		return Font_TextBlend(x - width / 2, y - Font_GetHeight(font) / 2, font, str, color);
+	}
+	BSP->G2D_DrawBitmapBlendC(sprite->surface, x, y, sprite->width, sprite->height, 255);
+	ts_stats.blits++;
+	return sprite->width;
+}
+
+void TS_Release(TS_SPRITE * sprite) {
+	if (sprite->surface) BSP->Res_Free(sprite->surface);
+	sprite->surface = NULL;
+	sprite->capacity = 0;
+	sprite->font = NULL;
+}
+
+const TS_STATS * TS_GetStats(void) {
+	return &ts_stats;
+}
@@ -0,0 +1,552 @@
+/*****************************************************************
+ * MiniConsole V3 - Tile Map
+ *******************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "TileMap.h"
+#include "Log.h"
+
+#define TM_MAX_NAME			40
+
+#define TM_SLOT_NONE		0xFF			// Chunk not in memory
+#define TM_SLOT_ABSENT		0xFE			// Chunk not in pack (empty)
+
+#define TM_TILE_EMPTY		0				// All pixels transparent
+#define TM_TILE_OPAQUE		1				// All pixels opaque
+#define TM_TILE_ALPHA		2
+
+#define TM_NO_ANIM			0xFF
+
+typedef struct {
+	int32_t		x;					// World coordinates
+	int32_t		y;
+	int32_t		w;
+	int32_t		h;
+} TM_AREA;
+
+static struct {
+	RP_PACK *	pack;
+	char		name[TM_MAX_NAME];
+	TM_HEADER	hdr;
+	TM_ANIM		anim[TM_MAX_ANIMS];
+	uint8_t		anim_frame[TM_MAX_ANIMS];	// Frames shown in last TM_Draw
+	uint32_t	clock;
+	uint8_t		shift;						// log2 of chunk
+	uint16_t	chunks_x;
+	uint16_t	chunks_y;
+	uint32_t	chunk_cells;				// Tiles of one layer of chunk
+	uint8_t *	slot_of;					// Slot of every chunk of map
+	uint16_t *	slots;						// TM_MAX_CHUNKS chunks
+	int32_t		slot_chunk[TM_MAX_CHUNKS];	// Chunk in slot (-1 free)
+	uint32_t	slot_used[TM_MAX_CHUNKS];	// Frame of last use
+	uint8_t *	tileset;					// Image from pack (ARGB8888)
+	uint8_t *	native;						// Tileset in frame format (NULL - blend all tiles)
+	uint8_t		bpp;
+	uint16_t	set_w;
+	uint16_t	cols;						// Tiles per tileset row
+	uint16_t	tiles;
+	uint8_t *	flags;						// TM_TILE_* of every tile
+	uint8_t *	anim_of;					// Animation of every tile (TM_NO_ANIM)
+	int32_t		cam_x;
+	int32_t		cam_y;
+	uint8_t		valid;						// Previous frame holds map at cam_x, cam_y
+	TM_AREA		dirty[TM_MAX_DIRTY];
+	uint8_t		dirty_count;
+	uint32_t	frame;
+	uint8_t		open;
+	TM_STATS	stats;
+} tm;
+
+
+static inline int32_t TM_FloorDiv(int32_t a, int32_t b) {
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+
+// Chunks
+
+static uint8_t TM_LoadChunk(uint32_t c) {
+	char entry[TM_MAX_NAME + 24];
+	snprintf(entry, sizeof(entry), "%s.%u.%u", tm.name, (unsigned)(c % tm.chunks_x), (unsigned)(c / tm.chunks_x));
+	int32_t index = RP_Find(tm.pack, entry);
+	uint32_t bytes = tm.chunk_cells * tm.hdr.layers * 2;
+	if (index < 0) {
+		tm.slot_of[c] = TM_SLOT_ABSENT;
+		return BSP_OK;
+	}
+	if (RP_GetEntry(tm.pack, index)->raw_size != bytes) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: chunk %s has wrong size", entry);
+		tm.slot_of[c] = TM_SLOT_ABSENT;
+		return BSP_ERROR;
+	}
+
+	// Free slot or least recently used slot not used in this frame
+	int32_t s = -1;
+	for (uint8_t i = 0; i < TM_MAX_CHUNKS; i++) {
+		if (tm.slot_chunk[i] < 0) { s = i; break; }
+		if (tm.slot_used[i] == tm.frame) continue;
+		if ((s < 0) || (tm.slot_used[i] < tm.slot_used[s])) s = i;
+	}
+	if (s < 0) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: no free chunk slot for %s", entry);
+		return BSP_ERROR;
+	}
+	if (tm.slot_chunk[s] >= 0) tm.slot_of[tm.slot_chunk[s]] = TM_SLOT_NONE;
+	else tm.stats.resident++;
+
+	uint16_t * dst = tm.slots + (uint32_t)s * tm.chunk_cells * tm.hdr.layers;
+	if (RP_ReadEntry(tm.pack, index, dst) != BSP_OK) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: can not read %s", entry);
+		tm.slot_chunk[s] = -1;
+		tm.stats.resident--;
+		return BSP_ERROR;
+	}
+	tm.slot_chunk[s] = (int32_t)c;
+	tm.slot_used[s] = tm.frame;
+	tm.slot_of[c] = (uint8_t)s;
+	tm.stats.loads++;
+	return BSP_OK;
+}
+
+// Marks chunks of cell area as used in this frame, loads up to max_loads missing ones
+static uint8_t TM_TouchChunks(int32_t tx0, int32_t ty0, int32_t tx1, int32_t ty1, uint8_t max_loads) {
+	uint32_t loads = tm.stats.loads;
+	if (tx0 < 0) tx0 = 0;
+	if (ty0 < 0) ty0 = 0;
+	if (tx1 >= tm.hdr.width) tx1 = tm.hdr.width - 1;
+	if (ty1 >= tm.hdr.height) ty1 = tm.hdr.height - 1;
+	if ((tx1 < tx0) || (ty1 < ty0)) return 0;
+
+	for (int32_t cy = ty0 >> tm.shift; cy <= (ty1 >> tm.shift); cy++) {
+		for (int32_t cx = tx0 >> tm.shift; cx <= (tx1 >> tm.shift); cx++) {
+			uint32_t c = (uint32_t)cy * tm.chunks_x + (uint32_t)cx;
+			if ((tm.slot_of[c] == TM_SLOT_NONE) && (tm.stats.loads - loads < max_loads)) TM_LoadChunk(c);
+			if (tm.slot_of[c] < TM_MAX_CHUNKS) tm.slot_used[tm.slot_of[c]] = tm.frame;
+		}
+	}
+	return (uint8_t)(tm.stats.loads - loads);
+}
+
+// Tile of resident chunk (TM_EMPTY outside of map or for chunk not in memory)
+static inline uint16_t TM_Cell(uint8_t layer, int32_t tx, int32_t ty) {
+	if ((tx < 0) || (ty < 0) || (tx >= tm.hdr.width) || (ty >= tm.hdr.height)) return TM_EMPTY;
+	uint8_t s = tm.slot_of[(uint32_t)(ty >> tm.shift) * tm.chunks_x + (uint32_t)(tx >> tm.shift)];
+	if (s >= TM_MAX_CHUNKS) return TM_EMPTY;
+	uint32_t mask = (1u << tm.shift) - 1;
+	return tm.slots[((uint32_t)s * tm.hdr.layers + layer) * tm.chunk_cells + (((uint32_t)ty & mask) << tm.shift) + ((uint32_t)tx & mask)];
+}
+
+static inline uint16_t TM_Resolve(uint16_t tile) {
+	if ((tile == TM_EMPTY) || (tile > tm.tiles)) return TM_EMPTY;
+	uint8_t a = tm.anim_of[tile];
+	return (a == TM_NO_ANIM) ? tile : tm.anim[a].tile + tm.anim_frame[a];
+}
+
+
+// Drawing
+
+// Part of tile inside clip area (screen, x1 / y1 exclusive)
+static void TM_DrawTile(uint16_t tile, int32_t sx, int32_t sy, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+	int32_t ix0 = (sx > x0) ? sx : x0, iy0 = (sy > y0) ? sy : y0;
+	int32_t ix1 = (sx + tm.hdr.tile_w < x1) ? sx + tm.hdr.tile_w : x1;
+	int32_t iy1 = (sy + tm.hdr.tile_h < y1) ? sy + tm.hdr.tile_h : y1;
+	uint16_t w = (uint16_t)(ix1 - ix0), h = (uint16_t)(iy1 - iy0);
+	uint32_t px = (uint32_t)((tile - 1) % tm.cols) * tm.hdr.tile_w + (uint32_t)(ix0 - sx);
+	uint32_t py = (uint32_t)((tile - 1) / tm.cols) * tm.hdr.tile_h + (uint32_t)(iy0 - sy);
+
+	if ((tm.flags[tile] == TM_TILE_OPAQUE) && (tm.native)) {
+		BSP->G2D_CopyBuf(tm.native + (py * tm.set_w + px) * tm.bpp, tm.set_w - w, (uint16_t)ix0, (uint16_t)iy0, w, h);
+	} else {
+		const uint32_t * argb = (const uint32_t *)(tm.tileset + 4);
+		BSP->G2D_CopyBufBlend(argb + py * tm.set_w + px, tm.set_w - w, (uint16_t)ix0, (uint16_t)iy0, w, h, 255);
+	}
+	tm.stats.tiles++;
+	tm.stats.pixels += (uint32_t)w * h;
+}
+
+// Draws all layers of cells in screen area (x1 / y1 exclusive)
+static void TM_DrawArea(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > LCD_WIDTH) x1 = LCD_WIDTH;
+	if (y1 > LCD_HEIGHT) y1 = LCD_HEIGHT;
+	if ((x1 <= x0) || (y1 <= y0)) return;
+
+	int32_t tx0 = TM_FloorDiv(tm.cam_x + x0, tm.hdr.tile_w), tx1 = TM_FloorDiv(tm.cam_x + x1 - 1, tm.hdr.tile_w);
+	int32_t ty0 = TM_FloorDiv(tm.cam_y + y0, tm.hdr.tile_h), ty1 = TM_FloorDiv(tm.cam_y + y1 - 1, tm.hdr.tile_h);
+	uint16_t tile[TM_MAX_LAYERS];
+
+	for (int32_t ty = ty0; ty <= ty1; ty++) {
+		int32_t sy = ty * tm.hdr.tile_h - tm.cam_y;
+		for (int32_t tx = tx0; tx <= tx1; tx++) {
+			int32_t sx = tx * tm.hdr.tile_w - tm.cam_x;
+			int8_t first = -1;
+			for (uint8_t l = 0; l < tm.hdr.layers; l++) {
+				tile[l] = TM_Resolve(TM_Cell(l, tx, ty));
+				if (tm.flags[tile[l]] == TM_TILE_OPAQUE) first = (int8_t)l;
+			}
+			if (first < 0) {
+				int32_t fx0 = (sx > x0) ? sx : x0, fy0 = (sy > y0) ? sy : y0;
+				int32_t fx1 = (sx + tm.hdr.tile_w < x1) ? sx + tm.hdr.tile_w : x1;
+				int32_t fy1 = (sy + tm.hdr.tile_h < y1) ? sy + tm.hdr.tile_h : y1;
+				BSP->G2D_DrawFillRect((int16_t)fx0, (int16_t)fy0, (uint16_t)(fx1 - fx0), (uint16_t)(fy1 - fy0), tm.hdr.bgcolor);
+				tm.stats.fills++;
+				tm.stats.pixels += (uint32_t)((fx1 - fx0) * (fy1 - fy0));
+				first = 0;
+			}
+			for (uint8_t l = (uint8_t)first; l < tm.hdr.layers; l++) {
+				if (tm.flags[tile[l]] != TM_TILE_EMPTY) TM_DrawTile(tile[l], sx, sy, x0, y0, x1, y1);
+			}
+		}
+	}
+}
+
+// Redraws visible cells containing animations that changed frame
+static void TM_DrawAnims(uint32_t changed) {
+	int32_t tx0 = TM_FloorDiv(tm.cam_x, tm.hdr.tile_w), tx1 = TM_FloorDiv(tm.cam_x + LCD_WIDTH - 1, tm.hdr.tile_w);
+	int32_t ty0 = TM_FloorDiv(tm.cam_y, tm.hdr.tile_h), ty1 = TM_FloorDiv(tm.cam_y + LCD_HEIGHT - 1, tm.hdr.tile_h);
+
+	for (int32_t ty = ty0; ty <= ty1; ty++) {
+		for (int32_t tx = tx0; tx <= tx1; tx++) {
+			uint8_t hit = 0;
+			for (uint8_t l = 0; l < tm.hdr.layers; l++) {
+				uint16_t t = TM_Cell(l, tx, ty);
+				if ((t == TM_EMPTY) || (t > tm.tiles) || (tm.anim_of[t] == TM_NO_ANIM)) continue;
+				if (changed & (1u << tm.anim_of[t])) hit = 1;
+			}
+			if (!hit) continue;
+			int32_t sx = tx * tm.hdr.tile_w - tm.cam_x, sy = ty * tm.hdr.tile_h - tm.cam_y;
+			TM_DrawArea(sx, sy, sx + tm.hdr.tile_w, sy + tm.hdr.tile_h);
+			tm.stats.anim_cells++;
+		}
+	}
+}
+
+static void TM_AddDirty(int32_t x, int32_t y, int32_t w, int32_t h) {
+	if ((w <= 0) || (h <= 0)) return;
+	if (tm.dirty_count < TM_MAX_DIRTY) {
+		tm.dirty[tm.dirty_count++] = (TM_AREA){ x, y, w, h };
+		return;
+	}
+
+	// Merge with area growing least
+	uint8_t best = 0;
+	int64_t best_growth = INT64_MAX;
+	for (uint8_t i = 0; i < TM_MAX_DIRTY; i++) {
+		TM_AREA * a = &tm.dirty[i];
+		int32_t ux0 = (a->x < x) ? a->x : x, uy0 = (a->y < y) ? a->y : y;
+		int32_t ux1 = (a->x + a->w > x + w) ? a->x + a->w : x + w;
+		int32_t uy1 = (a->y + a->h > y + h) ? a->y + a->h : y + h;
+		int64_t growth = (int64_t)(ux1 - ux0) * (uy1 - uy0) - (int64_t)a->w * a->h;
+		if (growth < best_growth) { best_growth = growth; best = i; }
+	}
+	TM_AREA * a = &tm.dirty[best];
+	int32_t ux0 = (a->x < x) ? a->x : x, uy0 = (a->y < y) ? a->y : y;
+	int32_t ux1 = (a->x + a->w > x + w) ? a->x + a->w : x + w;
+	int32_t uy1 = (a->y + a->h > y + h) ? a->y + a->h : y + h;
+	*a = (TM_AREA){ ux0, uy0, ux1 - ux0, uy1 - uy0 };
+}
+
+
+// Map
+
+// Opens map "name" of pack (pack must stay open until TM_Close)
+uint8_t TM_Open(RP_PACK * pack, const char *name, uint8_t color_mode) {
+	char entry[TM_MAX_NAME + 24];
+
+	TM_Close();
+	if (strlen(name) >= TM_MAX_NAME) return BSP_ERROR;
+	strcpy(tm.name, name);
+	tm.pack = pack;
+
+	// Header and animations
+	int32_t index = RP_Find(pack, name);
+	uint8_t * data = (index >= 0) ? RP_Load(pack, name) : NULL;
+	if (data == NULL) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: can not load %s", name);
+		return BSP_ERROR;
+	}
+	memcpy(&tm.hdr, data, sizeof(TM_HEADER));
+	const TM_HEADER * h = &tm.hdr;
+	uint32_t size = RP_GetEntry(pack, index)->raw_size;
+	if ((h->magic != TM_MAGIC) || (h->version != TM_VERSION) || (h->layers == 0) || (h->layers > TM_MAX_LAYERS) ||
+		(h->chunk == 0) || (h->chunk & (h->chunk - 1)) || (h->tile_w == 0) || (h->tile_h == 0) ||
+		(h->anims > TM_MAX_ANIMS) || (size < sizeof(TM_HEADER) + h->anims * sizeof(TM_ANIM))) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: %s is not a map", name);
+		BSP->Res_Free(data);
+		return BSP_ERROR;
+	}
+	memcpy(tm.anim, data + sizeof(TM_HEADER), h->anims * sizeof(TM_ANIM));
+	BSP->Res_Free(data);
+
+	// Tileset
+	snprintf(entry, sizeof(entry), "%s.tiles", name);
+	index = RP_Find(pack, entry);
+	tm.tileset = (index >= 0) ? RP_Load(pack, entry) : NULL;
+	if (tm.tileset == NULL) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: can not load %s", entry);
+		TM_Close();
+		return BSP_ERROR;
+	}
+	uint16_t set_w, set_h;
+	memcpy(&set_w, tm.tileset, 2);
+	memcpy(&set_h, tm.tileset + 2, 2);
+	tm.set_w = set_w;
+	tm.cols = set_w / h->tile_w;
+	tm.tiles = tm.cols * (set_h / h->tile_h);
+	if ((tm.tiles == 0) || (4 + (uint32_t)set_w * set_h * 4 > RP_GetEntry(pack, index)->raw_size)) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: %s is not a tileset", entry);
+		TM_Close();
+		return BSP_ERROR;
+	}
+
+	// Tile flags, animation lookup, tileset in frame format
+	tm.flags = BSP->Res_Alloc(((uint32_t)tm.tiles + 1) * 2);
+	tm.bpp = (color_mode == LCD_COLOR_MODE_ARGB8888) ? 4 : (color_mode == LCD_COLOR_MODE_RGB888) ? 3 : 0;
+	if (tm.bpp) tm.native = BSP->Res_Alloc((uint32_t)set_w * set_h * tm.bpp);
+	tm.shift = 0;
+	while ((1u << tm.shift) < h->chunk) tm.shift++;
+	tm.chunks_x = (uint16_t)((h->width + h->chunk - 1) / h->chunk);
+	tm.chunks_y = (uint16_t)((h->height + h->chunk - 1) / h->chunk);
+	tm.chunk_cells = (uint32_t)h->chunk * h->chunk;
+
+	// Chunks under screen in worst case must fit into slots
+	uint32_t span_x = (uint32_t)h->tile_w * h->chunk, span_y = (uint32_t)h->tile_h * h->chunk;
+	uint32_t screen_x = (LCD_WIDTH + span_x - 2) / span_x + 1, screen_y = (LCD_HEIGHT + span_y - 2) / span_y + 1;
+	if (screen_x > tm.chunks_x) screen_x = tm.chunks_x;
+	if (screen_y > tm.chunks_y) screen_y = tm.chunks_y;
+	if (screen_x * screen_y > TM_MAX_CHUNKS) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: %s needs %u chunk slots for screen (max %u)", name, screen_x * screen_y, TM_MAX_CHUNKS);
+		TM_Close();
+		return BSP_ERROR;
+	}
+	tm.slot_of = BSP->Res_Alloc((uint32_t)tm.chunks_x * tm.chunks_y);
+	tm.slots = BSP->Res_Alloc(TM_MAX_CHUNKS * tm.chunk_cells * h->layers * 2);
+	if ((tm.flags == NULL) || ((tm.bpp) && (tm.native == NULL)) || (tm.slot_of == NULL) || (tm.slots == NULL)) {
+		LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: out of memory for %s", name);
+		TM_Close();
+		return BSP_ERROR;
+	}
+	tm.anim_of = tm.flags + tm.tiles + 1;
+
+	const uint32_t * argb = (const uint32_t *)(tm.tileset + 4);
+	tm.flags[TM_EMPTY] = TM_TILE_EMPTY;
+	for (uint16_t t = 1; t <= tm.tiles; t++) {
+		uint32_t x0 = (uint32_t)((t - 1) % tm.cols) * h->tile_w, y0 = (uint32_t)((t - 1) / tm.cols) * h->tile_h;
+		uint32_t opaque = 0, clear = 0;
+		for (uint32_t y = y0; y < y0 + h->tile_h; y++) {
+			for (uint32_t x = x0; x < x0 + h->tile_w; x++) {
+				uint32_t a = argb[y * set_w + x] >> 24;
+				opaque += (a == 255);
+				clear += (a == 0);
+			}
+		}
+		uint32_t n = (uint32_t)h->tile_w * h->tile_h;
+		tm.flags[t] = (opaque == n) ? TM_TILE_OPAQUE : (clear == n) ? TM_TILE_EMPTY : TM_TILE_ALPHA;
+	}
+	for (uint32_t i = 0; (tm.native) && (i < (uint32_t)set_w * set_h); i++) {
+		for (uint8_t b = 0; b < tm.bpp; b++) tm.native[i * tm.bpp + b] = (uint8_t)(argb[i] >> (8 * b));
+	}
+
+	memset(tm.anim_of, TM_NO_ANIM, (uint32_t)tm.tiles + 1);
+	for (uint8_t a = 0; a < h->anims; a++) {
+		const TM_ANIM * an = &tm.anim[a];
+		if ((an->tile == TM_EMPTY) || (an->frames == 0) || (an->ticks == 0) || ((uint32_t)an->tile + an->frames - 1 > tm.tiles)) {
+			LOG_Printf(LOG_LEVEL_ERR, LOG_CAT_RES, "tilemap: %s has invalid animation %u", name, a);
+			TM_Close();
+			return BSP_ERROR;
+		}
+		tm.anim_of[an->tile] = a;
+		tm.anim_frame[a] = 0;
+	}
+
+	memset(tm.slot_of, TM_SLOT_NONE, (uint32_t)tm.chunks_x * tm.chunks_y);
+	for (uint8_t i = 0; i < TM_MAX_CHUNKS; i++) tm.slot_chunk[i] = -1;
+	memset(&tm.stats, 0, sizeof(TM_STATS));
+	tm.clock = 0;
+	tm.frame = 0;
+	tm.valid = 0;
+	tm.dirty_count = 0;
+	tm.open = 1;
+	return BSP_OK;
+}
+
+void TM_Close(void) {
+	if (tm.tileset) BSP->Res_Free(tm.tileset);
+	if (tm.native) BSP->Res_Free(tm.native);
+	if (tm.flags) BSP->Res_Free(tm.flags);
+	if (tm.slot_of) BSP->Res_Free(tm.slot_of);
+	if (tm.slots) BSP->Res_Free(tm.slots);
+	tm.tileset = NULL;
+	tm.native = NULL;
+	tm.flags = NULL;
+	tm.anim_of = NULL;
+	tm.slot_of = NULL;
+	tm.slots = NULL;
+	tm.open = 0;
+}
+
+const TM_HEADER * TM_GetHeader(void) {
+	return (tm.open) ? &tm.hdr : NULL;
+}
+
+// Tile in map (chunk is loaded if needed)
+uint16_t TM_GetTile(uint8_t layer, int32_t tx, int32_t ty) {
+	if ((!tm.open) || (layer >= tm.hdr.layers) || (tx < 0) || (ty < 0) || (tx >= tm.hdr.width) || (ty >= tm.hdr.height)) return TM_EMPTY;
+	TM_TouchChunks(tx, ty, tx, ty, 1);
+	return TM_Cell(layer, tx, ty);
+}
+
+// Changes tile of chunk in memory (change is lost when chunk is replaced by other chunk)
+uint8_t TM_SetTile(uint8_t layer, int32_t tx, int32_t ty, uint16_t tile) {
+	if ((!tm.open) || (layer >= tm.hdr.layers) || (tx < 0) || (ty < 0) || (tx >= tm.hdr.width) || (ty >= tm.hdr.height)) return BSP_ERROR;
+	TM_TouchChunks(tx, ty, tx, ty, 1);
+
+	uint32_t c = (uint32_t)(ty >> tm.shift) * tm.chunks_x + (uint32_t)(tx >> tm.shift);
+	if (tm.slot_of[c] == TM_SLOT_ABSENT) {
+		// Empty chunk gets zeroed slot
+		for (uint8_t i = 0; i < TM_MAX_CHUNKS; i++) {
+			if (tm.slot_chunk[i] >= 0) continue;
+			memset(tm.slots + (uint32_t)i * tm.chunk_cells * tm.hdr.layers, 0, tm.chunk_cells * tm.hdr.layers * 2);
+			tm.slot_chunk[i] = (int32_t)c;
+			tm.slot_used[i] = tm.frame;
+			tm.slot_of[c] = i;
+			tm.stats.resident++;
+			break;
+		}
+	}
+	uint8_t s = tm.slot_of[c];
+	if (s >= TM_MAX_CHUNKS) return BSP_ERROR;
+
+	uint32_t mask = (1u << tm.shift) - 1;
+	tm.slots[((uint32_t)s * tm.hdr.layers + layer) * tm.chunk_cells + (((uint32_t)ty & mask) << tm.shift) + ((uint32_t)tx & mask)] = tile;
+	TM_AddDirty(tx * tm.hdr.tile_w, ty * tm.hdr.tile_h, tm.hdr.tile_w, tm.hdr.tile_h);
+	return BSP_OK;
+}
+
+
+// Frame
+
+// Advances animations by one tick
+void TM_Tick(void) {
+	tm.clock++;
+}
+
+// Draws map with screen top left corner at world pixel cam_x, cam_y
+void TM_Draw(int32_t cam_x, int32_t cam_y) {
+	if (!tm.open) return;
+
+	tm.frame++;
+	tm.stats.tiles = 0;
+	tm.stats.fills = 0;
+	tm.stats.pixels = 0;
+	tm.stats.scrolled = 0;
+	tm.stats.anim_cells = 0;
+	tm.stats.dirty = 0;
+	tm.stats.full = 0;
+
+	int32_t dx = tm.cam_x - cam_x, dy = tm.cam_y - cam_y;
+	uint8_t full = (!tm.valid) || (dx >= LCD_WIDTH) || (-dx >= LCD_WIDTH) || (dy >= LCD_HEIGHT) || (-dy >= LCD_HEIGHT);
+	tm.cam_x = cam_x;
+	tm.cam_y = cam_y;
+
+	// Chunks under screen
+	uint8_t loads = TM_TouchChunks(TM_FloorDiv(cam_x, tm.hdr.tile_w), TM_FloorDiv(cam_y, tm.hdr.tile_h),
+		TM_FloorDiv(cam_x + LCD_WIDTH - 1, tm.hdr.tile_w), TM_FloorDiv(cam_y + LCD_HEIGHT - 1, tm.hdr.tile_h), 0xFF);
+	tm.stats.stalls += loads;
+
+	// Animations which changed frame
+	uint32_t changed = 0;
+	for (uint8_t a = 0; a < tm.hdr.anims; a++) {
+		uint8_t f = (uint8_t)((tm.clock / tm.anim[a].ticks) % tm.anim[a].frames);
+		if (f != tm.anim_frame[a]) changed |= 1u << a;
+		tm.anim_frame[a] = f;
+	}
+
+	if (full) {
+		TM_DrawArea(0, 0, LCD_WIDTH, LCD_HEIGHT);
+		tm.stats.full = 1;
+		tm.stats.full_draws++;
+	} else {
+		BSP->G2D_CopyScrollPrevFrame((int16_t)dx, (int16_t)dy);
+		tm.stats.scrolled = (uint32_t)(LCD_WIDTH - ((dx < 0) ? -dx : dx)) * (uint32_t)(LCD_HEIGHT - ((dy < 0) ? -dy : dy));
+
+		// Exposed strips (horizontal strip without columns of vertical one)
+		if (dx > 0) TM_DrawArea(0, 0, dx, LCD_HEIGHT);
+		if (dx < 0) TM_DrawArea(LCD_WIDTH + dx, 0, LCD_WIDTH, LCD_HEIGHT);
+		int32_t sx0 = (dx > 0) ? dx : 0, sx1 = (dx < 0) ? LCD_WIDTH + dx : LCD_WIDTH;
+		if (dy > 0) TM_DrawArea(sx0, 0, sx1, dy);
+		if (dy < 0) TM_DrawArea(sx0, LCD_HEIGHT + dy, sx1, LCD_HEIGHT);
+
+		for (uint8_t i = 0; i < tm.dirty_count; i++) {
+			const TM_AREA * a = &tm.dirty[i];
+			TM_DrawArea(a->x - cam_x, a->y - cam_y, a->x + a->w - cam_x, a->y + a->h - cam_y);
+		}
+		tm.stats.dirty = tm.dirty_count;
+		if (changed) TM_DrawAnims(changed);
+	}
+	tm.dirty_count = 0;
+	tm.valid = 1;
+}
+
+// Marks screen area of current frame to be redrawn in next frame (e.g. sprite drawn over map)
+void TM_Invalidate(int16_t x, int16_t y, uint16_t width, uint16_t height) {
+	if (!tm.open) return;
+	TM_AddDirty(x + tm.cam_x, y + tm.cam_y, width, height);
+}
+
+// Next TM_Draw draws whole screen
+void TM_Refresh(void) {
+	tm.valid = 0;
+}
+
+// Slots that can take another chunk in this frame (free or not used since TM_Draw)
+static uint8_t TM_SpareSlots(void) {
+	uint8_t n = 0;
+	for (uint8_t i = 0; i < TM_MAX_CHUNKS; i++) {
+		if ((tm.slot_chunk[i] < 0) || (tm.slot_used[i] != tm.frame)) n++;
+	}
+	return n;
+}
+
+// Loads up to max_loads chunks around screen (call after frame is finished). Returns chunks loaded.
+// Chunks are visited in rings around screen, nearest first, until TM_PREFETCH cells or spare
+// slots are used up - resident chunks keep their slot, so farther ones can not evict nearer ones.
+uint8_t TM_Stream(uint8_t max_loads) {
+	if (!tm.open) return 0;
+	uint32_t loads = tm.stats.loads;
+	uint8_t spare = TM_SpareSlots();
+	int32_t max_cx = tm.chunks_x - 1, max_cy = tm.chunks_y - 1;
+	int32_t cx0 = TM_FloorDiv(tm.cam_x, tm.hdr.tile_w) >> tm.shift, cy0 = TM_FloorDiv(tm.cam_y, tm.hdr.tile_h) >> tm.shift;
+	int32_t cx1 = TM_FloorDiv(tm.cam_x + LCD_WIDTH - 1, tm.hdr.tile_w) >> tm.shift;
+	int32_t cy1 = TM_FloorDiv(tm.cam_y + LCD_HEIGHT - 1, tm.hdr.tile_h) >> tm.shift;
+	int32_t rings = (TM_PREFETCH + (1 << tm.shift) - 1) >> tm.shift;
+
+	for (int32_t r = 1; (r <= rings) && (spare); r++) {
+		for (int32_t cy = cy0 - r; (cy <= cy1 + r) && (spare); cy++) {
+			if ((cy < 0) || (cy > max_cy)) continue;
+			// Inner rows of ring have only left and right chunk
+			int32_t step = ((cy == cy0 - r) || (cy == cy1 + r)) ? 1 : cx1 - cx0 + 2 * r;
+			for (int32_t cx = cx0 - r; (cx <= cx1 + r) && (spare); cx += step) {
+				if ((cx < 0) || (cx > max_cx)) continue;
+				uint32_t c = (uint32_t)cy * tm.chunks_x + (uint32_t)cx;
+				uint8_t s = tm.slot_of[c];
+				if (s == TM_SLOT_NONE) {
+					// Spare slot is known to exist, so load fails only on bad entry
+					if (tm.stats.loads - loads >= max_loads) continue;
+					TM_LoadChunk(c);
+					if (tm.slot_of[c] < TM_MAX_CHUNKS) spare--;
+				} else if ((s < TM_MAX_CHUNKS) && (tm.slot_used[s] != tm.frame)) {
+					tm.slot_used[s] = tm.frame;
+					spare--;
+				}
+			}
+		}
+	}
+	return (uint8_t)(tm.stats.loads - loads);
+}
+
+const TM_STATS * TM_GetStats(void) {
+	return &tm.stats;
+}
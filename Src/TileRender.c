@@ -0,0 +1,510 @@
+/*****************************************************************
+ * MiniConsole V3 - Tiled Renderer
+ *******************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include "TileRender.h"
+#include "Font.h"
+#include "PixKernel.h"
+
+// Icon drawing modes
+#define TR_ICON_BLEND		0
+#define TR_ICON_OPAQUE		1
+
+static struct {
+	uint8_t		bpp;				// 0 - not initialised
+	uint32_t	bgcolor;
+	uint16_t	tile_w;
+	uint16_t	tile_h;
+	uint16_t	rows;
+	uint16_t	cols;
+	uint8_t		sel;				// Buffer of next tile
+	uint8_t *	buf;				// Tile being drawn
+	uint32_t	stride;				// Bytes per row of tile
+	int32_t		x0;					// Tile area (x1, y1 exclusive)
+	int32_t		y0;
+	int32_t		x1;
+	int32_t		y1;
+	TR_STATS	stats;
+} tr;
+
+static uint8_t tr_buf[2][TR_TILE_BYTES] __attribute__((aligned(32)));
+static uint16_t tr_bins[TR_MAX_BINS];
+static uint16_t tr_row_start[TR_MAX_ROWS + 1];
+static uint16_t tr_row_fill[TR_MAX_ROWS];
+
+
+// Pixel access (tile buffer in frame colour format)
+
+// Rounded division by 255, same result as (v + 127) / 255 for v <= 65025
+static inline uint32_t TR_Div255(uint32_t v) {
+	v += 128;
+	return (v + (v >> 8)) >> 8;
+}
+
+static inline uint8_t TR_In(int32_t x, int32_t y) {
+	return (x >= tr.x0) && (y >= tr.y0) && (x < tr.x1) && (y < tr.y1);
+}
+
+static inline uint8_t * TR_Addr(int32_t x, int32_t y) {
+	return tr.buf + (uint32_t)(y - tr.y0) * tr.stride + (uint32_t)(x - tr.x0) * tr.bpp;
+}
+
+static inline uint32_t TR_Get(const uint8_t * p) {
+	uint32_t c = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+	return (tr.bpp == 4) ? c | ((uint32_t)p[3] << 24) : c;
+}
+
+static inline void TR_Set(uint8_t * p, uint32_t c) {
+	p[0] = (uint8_t)c;
+	p[1] = (uint8_t)(c >> 8);
+	p[2] = (uint8_t)(c >> 16);
+	if (tr.bpp == 4) p[3] = (uint8_t)(c >> 24);
+}
+
+static inline void TR_Put(int32_t x, int32_t y, uint32_t c) {
+	if (!TR_In(x, y)) return;
+	TR_Set(TR_Addr(x, y), c);
+	tr.stats.pixels++;
+}
+
+// Blends ARGB colour with additional alpha over pixel
+static inline void TR_Blend(int32_t x, int32_t y, uint32_t argb, uint32_t alpha) {
+	if (!TR_In(x, y)) return;
+	uint32_t a = TR_Div255((argb >> 24) * alpha);
+	if (a == 0) return;
+	uint8_t * p = TR_Addr(x, y);
+	if (a < 255) {
+		uint32_t d = TR_Get(p);
+		uint32_t na = 255 - a;
+		uint32_t r = TR_Div255(((argb >> 16) & 0xFF) * a + ((d >> 16) & 0xFF) * na);
+		uint32_t g = TR_Div255(((argb >> 8) & 0xFF) * a + ((d >> 8) & 0xFF) * na);
+		uint32_t b = TR_Div255((argb & 0xFF) * a + (d & 0xFF) * na);
+		argb = (a + TR_Div255((d >> 24) * na)) << 24 | r << 16 | g << 8 | b;
+	} else {
+		argb |= 0xFF000000;
+	}
+	TR_Set(p, argb);
+	tr.stats.pixels++;
+}
+
+
+// Primitives (clipped to tile)
+
+static void TR_FillSpan(int32_t x, int32_t y, int32_t len, uint32_t c) {
+	if ((y < tr.y0) || (y >= tr.y1)) return;
+	if (x < tr.x0) { len -= tr.x0 - x; x = tr.x0; }
+	if (x + len > tr.x1) len = tr.x1 - x;
+	if (len <= 0) return;
+	uint8_t * p = TR_Addr(x, y);
+	tr.stats.pixels += len;
+	if (tr.bpp == 4) {
+		uint32_t * q = (uint32_t *)p;
+		for (int32_t i = 0; i < len; i++) q[i] = c;
+	} else {
+		for (int32_t i = 0; i < len; i++, p += 3) { p[0] = (uint8_t)c; p[1] = (uint8_t)(c >> 8); p[2] = (uint8_t)(c >> 16); }
+	}
+}
+
+static void TR_BlendSpan(int32_t x, int32_t y, int32_t len, uint32_t c) {
+	if ((y < tr.y0) || (y >= tr.y1)) return;
+	if (x < tr.x0) { len -= tr.x0 - x; x = tr.x0; }
+	if (x + len > tr.x1) len = tr.x1 - x;
+	for (int32_t i = 0; i < len; i++) TR_Blend(x + i, y, c, 255);
+}
+
+static void TR_FillRect(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t c, uint8_t blend) {
+	int32_t j0 = (y < tr.y0) ? tr.y0 - y : 0;
+	int32_t j1 = (y + height > tr.y1) ? tr.y1 - y : height;
+	for (int32_t j = j0; j < j1; j++) {
+		if (blend) TR_BlendSpan(x, y + j, width, c);
+		else TR_FillSpan(x, y + j, width, c);
+	}
+}
+
+static void TR_VLine(int32_t x, int32_t y, int32_t length, uint32_t c, uint8_t blend) {
+	if ((x < tr.x0) || (x >= tr.x1)) return;
+	int32_t i0 = (y < tr.y0) ? tr.y0 - y : 0;
+	int32_t i1 = (y + length > tr.y1) ? tr.y1 - y : length;
+	for (int32_t i = i0; i < i1; i++) {
+		if (blend) TR_Blend(x, y + i, c, 255);
+		else TR_Put(x, y + i, c);
+	}
+}
+
+static void TR_Line(int32_t X1, int32_t Y1, int32_t X2, int32_t Y2, uint32_t c) {
+	int32_t x = X1, y = Y1;
+	int32_t dx = (X2 > X1) ? X2 - X1 : X1 - X2, sx = (X1 < X2) ? 1 : -1;
+	int32_t dy = (Y2 > Y1) ? Y1 - Y2 : Y2 - Y1, sy = (Y1 < Y2) ? 1 : -1;
+	int32_t err = dx + dy;
+	while (1) {
+		TR_Put(x, y, c);
+		if ((x == X2) && (y == Y2)) break;
+		int32_t e2 = 2 * err;
+		if (e2 >= dy) { err += dy; x += sx; }
+		if (e2 <= dx) { err += dx; y += sy; }
+	}
+}
+
+static void TR_Rect(int32_t x, int32_t y, uint16_t width, uint16_t height, uint32_t c) {
+	if ((width == 0) || (height == 0)) return;
+	TR_FillSpan(x, y, width, c);
+	TR_FillSpan(x, y + height - 1, width, c);
+	TR_VLine(x, y + 1, (int16_t)(height - 2), c, 0);
+	TR_VLine((int16_t)(x + width - 1), y + 1, (int16_t)(height - 2), c, 0);
+}
+
+static void TR_Circle(int32_t x, int32_t y, uint16_t r, uint32_t c) {
+	int32_t cx = r, cy = 0, err = 1 - (int32_t)r;
+	while (cx >= cy) {
+		TR_Put(x + cx, y + cy, c); TR_Put(x - cx, y + cy, c);
+		TR_Put(x + cx, y - cy, c); TR_Put(x - cx, y - cy, c);
+		TR_Put(x + cy, y + cx, c); TR_Put(x - cy, y + cx, c);
+		TR_Put(x + cy, y - cx, c); TR_Put(x - cy, y - cx, c);
+		cy++;
+		if (err < 0) {
+			err += 2 * cy + 1;
+		} else {
+			cx--;
+			err += 2 * (cy - cx) + 1;
+		}
+	}
+}
+
+// Filled circle as spans, every row once (only rows of tile are computed)
+static void TR_FillCircle(int32_t x, int32_t y, uint16_t r, uint32_t c, uint8_t blend) {
+	int32_t rr = (int32_t)r * r;
+	int32_t dy0 = (y - (int32_t)r < tr.y0) ? tr.y0 - y : -(int32_t)r;
+	int32_t dy1 = (y + (int32_t)r >= tr.y1) ? tr.y1 - 1 - y : (int32_t)r;
+	for (int32_t dy = dy0; dy <= dy1; dy++) {
+		int32_t dx = (int32_t)sqrt((double)(rr - dy * dy));
+		if (blend) TR_BlendSpan(x - dx, y + dy, 2 * dx + 1, c);
+		else TR_FillSpan(x - dx, y + dy, 2 * dx + 1, c);
+	}
+}
+
+// Horizontal inset of rounded corner at given row
+static int32_t TR_CornerInset(int32_t row, int32_t height, int32_t radius) {
+	int32_t d = -1;
+	if (row < radius) d = radius - row;
+	if (row >= height - radius) d = row - (height - radius - 1);
+	if (d < 0) return 0;
+	return radius - (int32_t)sqrt((double)(radius * radius - (d - 1) * (d - 1)));
+}
+
+static void TR_RoundRect(int32_t x, int32_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t c) {
+	if ((width == 0) || (height == 0)) return;
+	if (radius > width / 2) radius = width / 2;
+	if (radius > height / 2) radius = height / 2;
+	int32_t prev = TR_CornerInset(0, height, radius);
+	TR_FillSpan(x + prev, y, width - 2 * prev, c);
+	TR_FillSpan(x + prev, y + height - 1, width - 2 * prev, c);
+	int32_t row0 = (y + 1 < tr.y0) ? tr.y0 - y : 1;
+	int32_t row1 = (y + height - 1 > tr.y1) ? tr.y1 - y : height - 1;
+	for (int32_t row = row0; row < row1; row++) {
+		int32_t in = TR_CornerInset(row, height, radius);
+		int32_t ref = (row < height / 2) ? TR_CornerInset(row - 1, height, radius) : TR_CornerInset(row + 1, height, radius);
+		int32_t len = (ref > in) ? ref - in : 1;
+		TR_FillSpan(x + in, y + row, len, c);
+		TR_FillSpan(x + width - in - len, y + row, len, c);
+	}
+}
+
+static void TR_FillRoundRect(int32_t x, int32_t y, uint16_t width, uint16_t height, uint16_t radius, uint32_t c, uint8_t blend) {
+	if (radius > width / 2) radius = width / 2;
+	if (radius > height / 2) radius = height / 2;
+	int32_t row0 = (y < tr.y0) ? tr.y0 - y : 0;
+	int32_t row1 = (y + height > tr.y1) ? tr.y1 - y : height;
+	for (int32_t row = row0; row < row1; row++) {
+		int32_t in = TR_CornerInset(row, height, radius);
+		if (blend) TR_BlendSpan(x + in, y + row, width - 2 * in, c);
+		else TR_FillSpan(x + in, y + row, width - 2 * in, c);
+	}
+}
+
+
+// Bitmaps, icons and text
+
+// Copies native format pixels (bitmap, buffer)
+static void TR_Copy(const uint8_t * src, uint32_t stride, int32_t x, int32_t y, int32_t width, int32_t height) {
+	if (src == NULL) return;
+	int32_t i0 = (x < tr.x0) ? tr.x0 - x : 0;
+	int32_t i1 = (x + width > tr.x1) ? tr.x1 - x : width;
+	int32_t j0 = (y < tr.y0) ? tr.y0 - y : 0;
+	int32_t j1 = (y + height > tr.y1) ? tr.y1 - y : height;
+	if (i1 <= i0) return;
+	for (int32_t j = j0; j < j1; j++) {
+		memcpy(TR_Addr(x + i0, y + j), src + ((uint32_t)j * stride + (uint32_t)i0) * tr.bpp, (size_t)(i1 - i0) * tr.bpp);
+		tr.stats.pixels += i1 - i0;
+	}
+}
+
+// Blends ARGB8888 source (bitmap, buffer) with additional alpha
+static void TR_CopyBlend(const uint8_t * src, uint32_t stride, int32_t x, int32_t y, int32_t width, int32_t height, uint8_t alpha) {
+	if (src == NULL) return;
+	const uint32_t * s = (const uint32_t *)src;
+	int32_t i0 = (x < tr.x0) ? tr.x0 - x : 0;
+	int32_t i1 = (x + width > tr.x1) ? tr.x1 - x : width;
+	int32_t j0 = (y < tr.y0) ? tr.y0 - y : 0;
+	int32_t j1 = (y + height > tr.y1) ? tr.y1 - y : height;
+	for (int32_t j = j0; j < j1; j++) {
+		for (int32_t i = i0; i < i1; i++) {
+			TR_Blend(x + i, y + j, s[(uint32_t)j * stride + (uint32_t)i], alpha);
+		}
+	}
+}
+
+// A8 icon (uint16 width, uint16 height, mask), opaque icons fill background first
+static void TR_Icon(const void * iconsource, int32_t x, int32_t y, uint32_t color, uint32_t bgcolor, uint8_t mode) {
+	if (iconsource == NULL) return;
+	int32_t w = ((const uint16_t *)iconsource)[0], h = ((const uint16_t *)iconsource)[1];
+	const uint8_t * mask = (const uint8_t *)iconsource + 4;
+	uint32_t argb = (mode == TR_ICON_OPAQUE) ? color | 0xFF000000 : color;
+	int32_t i0 = (x < tr.x0) ? tr.x0 - x : 0;
+	int32_t i1 = (x + w > tr.x1) ? tr.x1 - x : w;
+	int32_t j0 = (y < tr.y0) ? tr.y0 - y : 0;
+	int32_t j1 = (y + h > tr.y1) ? tr.y1 - y : h;
+	for (int32_t j = j0; j < j1; j++) {
+		if (mode == TR_ICON_OPAQUE) TR_FillSpan(x, y + j, w, bgcolor);
+		for (int32_t i = i0; i < i1; i++) {
+			uint8_t a = mask[j * w + i];
+			if (a) TR_Blend(x + i, y + j, argb, a);
+		}
+	}
+}
+
+// Glyph of Font_TextIcons
+static void TR_Glyph(const void * iconsource, int16_t x, int16_t y, uint32_t color) {
+	TR_Icon(iconsource, x, y, color, 0, TR_ICON_BLEND);
+}
+
+// v1 font with ASCII text - glyph streams are drawn as G2D_Text / G2D_TextBlend do
+// (opaque text writes colour unchanged on fully covered pixels)
+static void TR_TextV1(int32_t x, int32_t y, const uint8_t * font, const char * str, uint32_t color, uint32_t bgcolor, uint8_t opaque) {
+	uint8_t height = font[0];
+	uint32_t argb = (opaque) ? color | 0xFF000000 : color;
+	int32_t cx = x;
+
+	for (; *str; str++) {
+		uint8_t ch = (uint8_t)*str;
+		if ((ch < FONT_FIRST_CHAR) || (ch > FONT_LAST_CHAR)) {
+			if (opaque) TR_FillRect(cx, y, font[1], height, bgcolor, 0);
+			cx += font[1];
+			continue;
+		}
+		uint32_t idx = ch - FONT_FIRST_CHAR;
+		const uint8_t * glyph = font + (font[2 + 2 * idx] | (font[3 + 2 * idx] << 8));
+		const uint8_t * end = font + (font[4 + 2 * idx] | (font[5 + 2 * idx] << 8));
+		uint8_t width = glyph[0];
+		if ((cx + width <= tr.x0) || (cx >= tr.x1)) {
+			cx += width;
+			continue;
+		}
+		if (opaque) TR_FillRect(cx, y, width, height, bgcolor, 0);
+
+		uint32_t total = (uint32_t)width * height;
+		uint32_t pos = 0;
+		int32_t col = 0, row = 0;
+		for (const uint8_t * p = glyph + 1; (p < end) && (pos < total) && (y + row < tr.y1); p++) {
+			uint8_t op = *p >> 6;
+			if (op == 0) {
+				pos += *p & 0x3F;
+				col = (int32_t)(pos % width);
+				row = (int32_t)(pos / width);
+				continue;
+			}
+			for (uint32_t n = (op == 3) ? (*p & 0x3Fu) : 4, k = 0; (k < n) && (pos < total); k++, pos++) {
+				uint32_t level = (op == 3) ? 3 : (*p >> (6 - 2 * k)) & 0x03;
+				if ((op == 3) && (opaque)) TR_Put(cx + col, y + row, color);
+				else if (level) TR_Blend(cx + col, y + row, argb, level * 85);
+				if (++col == width) { col = 0; row++; }
+			}
+		}
+		cx += width;
+	}
+}
+
+static void TR_Text(const DL_CMD * c, uint8_t opaque) {
+	const uint8_t * font = c->src;
+	const char * str = c->str;
+	if ((font == NULL) || (str == NULL)) return;
+
+	uint8_t ascii = 1;
+	for (const char * s = str; *s; s++) if ((uint8_t)*s >= 0x80) ascii = 0;
+	if ((!Font_IsUnicode(font)) && (ascii)) {
+		TR_TextV1(c->x, c->y, font, str, c->color, c->bgcolor, opaque);
+		return;
+	}
+	if (opaque) TR_FillRect(c->x, c->y, Font_GetTextWidth(font, str), Font_GetHeight(font), c->bgcolor, 0);
+	Font_TextIcons(c->x, c->y, font, str, c->color, (int16_t)tr.x0, (int16_t)tr.x1, TR_Glyph);
+}
+
+
+// Command execution (parameters converted as in DL_Execute)
+
+static void TR_Execute(const DL_CMD * c) {
+	switch (c->type) {
+	case DL_CMD_CLEAR:					TR_FillRect(tr.x0, tr.y0, tr.x1 - tr.x0, tr.y1 - tr.y0, tr.bgcolor, 0); break;
+	case DL_CMD_FILLFRAME:				TR_FillRect(tr.x0, tr.y0, tr.x1 - tr.x0, tr.y1 - tr.y0, c->color, 0); break;
+	case DL_CMD_PIXEL:					TR_Put(c->x, c->y, c->color); break;
+	case DL_CMD_HLINE:					TR_FillSpan(c->x, c->y, c->w, c->color); break;
+	case DL_CMD_HLINE_BLEND:			TR_BlendSpan(c->x, c->y, c->w, c->color); break;
+	case DL_CMD_VLINE:					TR_VLine(c->x, c->y, c->h, c->color, 0); break;
+	case DL_CMD_VLINE_BLEND:			TR_VLine(c->x, c->y, c->h, c->color, 1); break;
+	case DL_CMD_LINE:					TR_Line(c->x, c->y, c->w, c->h, c->color); break;
+	case DL_CMD_RECT:					TR_Rect(c->x, c->y, (uint16_t)c->w, (uint16_t)c->h, c->color); break;
+	case DL_CMD_FILLRECT:				TR_FillRect(c->x, c->y, (uint16_t)c->w, (uint16_t)c->h, c->color, 0); break;
+	case DL_CMD_FILLRECT_BLEND:			TR_FillRect(c->x, c->y, (uint16_t)c->w, (uint16_t)c->h, c->color, 1); break;
+	case DL_CMD_CIRCLE:					TR_Circle(c->x, c->y, c->p, c->color); break;
+	case DL_CMD_FILLCIRCLE:				TR_FillCircle(c->x, c->y, c->p, c->color, 0); break;
+	case DL_CMD_FILLCIRCLE_BLEND:		TR_FillCircle(c->x, c->y, c->p, c->color, 1); break;
+	case DL_CMD_ROUNDRECT:				TR_RoundRect(c->x, c->y, (uint16_t)c->w, (uint16_t)c->h, c->p, c->color); break;
+	case DL_CMD_FILLROUNDRECT:			TR_FillRoundRect(c->x, c->y, (uint16_t)c->w, (uint16_t)c->h, c->p, c->color, 0); break;
+	case DL_CMD_FILLROUNDRECT_BLEND:	TR_FillRoundRect(c->x, c->y, (uint16_t)c->w, (uint16_t)c->h, c->p, c->color, 1); break;
+	case DL_CMD_TEXT:					TR_Text(c, 1); break;
+	case DL_CMD_TEXT_BLEND:				TR_Text(c, 0); break;
+	case DL_CMD_BITMAP:					TR_Copy(c->src, (uint32_t)c->w, c->x, c->y, c->w, c->h); break;
+	case DL_CMD_BITMAP_BLEND:			TR_CopyBlend(c->src, (uint32_t)c->w, c->x, c->y, c->w, c->h, c->alpha); break;
+	case DL_CMD_ICON:					TR_Icon(c->src, c->x, c->y, c->color, c->bgcolor, TR_ICON_OPAQUE); break;
+	case DL_CMD_ICON_BLEND:				TR_Icon(c->src, c->x, c->y, c->color, 0, TR_ICON_BLEND); break;
+	case DL_CMD_COPYBUF:				TR_Copy(c->src, (uint32_t)(uint16_t)c->w + c->p, (uint16_t)c->x, (uint16_t)c->y, (uint16_t)c->w, (uint16_t)c->h); break;
+	case DL_CMD_COPYBUF_BLEND:			TR_CopyBlend(c->src, (uint32_t)(uint16_t)c->w + c->p, (uint16_t)c->x, (uint16_t)c->y, (uint16_t)c->w, (uint16_t)c->h, c->alpha); break;
+	}
+}
+
+
+// Tiles
+
+static inline uint8_t TR_Overlap(const DL_BOX * b, int32_t x, int32_t y, int32_t w, int32_t h) {
+	return (b->x < x + w) && (x < b->x + b->w) && (b->y < y + h) && (y < b->y + b->h);
+}
+
+static inline uint8_t TR_Covers(const DL_BOX * b, int32_t x, int32_t y, int32_t w, int32_t h) {
+	return (b->x <= x) && (b->y <= y) && (b->x + b->w >= x + w) && (b->y + b->h >= y + h);
+}
+
+static void TR_Tile(const DL_CMD * cmd, const uint16_t * bin, uint16_t n, const uint8_t * frame, int32_t x, int32_t y, int32_t w, int32_t h) {
+	int32_t first = -1;
+	uint32_t hits = 0;
+
+	// Commands before last opaque one covering whole tile are not visible in it
+	for (int32_t k = n - 1; k >= 0; k--) {
+		const DL_CMD * c = &cmd[bin[k]];
+		if (!TR_Overlap(&c->box, x, y, w, h)) continue;
+		if (first >= 0) {
+			tr.stats.skipped++;
+			continue;
+		}
+		hits++;
+		if ((c->flags & DL_FLAG_OPAQUE) && TR_Covers(&c->box, x, y, w, h)) first = k;
+	}
+	if (hits == 0) return;
+
+	tr.buf = tr_buf[tr.sel];
+	tr.sel ^= 1;
+	tr.stride = (uint32_t)w * tr.bpp;
+	tr.x0 = x;
+	tr.y0 = y;
+	tr.x1 = x + w;
+	tr.y1 = y + h;
+
+	if (first < 0) {
+		// Commands draw over current frame content - wait for DMA2D writes and drop stale lines first
+		const uint8_t * rows = frame + (uint32_t)y * LCD_WIDTH * tr.bpp;
+		PK_SyncForCPU(rows, (uint32_t)h * LCD_WIDTH * tr.bpp);
+		for (int32_t j = 0; j < h; j++) memcpy(tr.buf + j * tr.stride, frame + ((uint32_t)(y + j) * LCD_WIDTH + (uint32_t)x) * tr.bpp, tr.stride);
+		tr.stats.loaded++;
+		tr.stats.fb_read += tr.stride * h;
+		first = 0;
+	}
+	for (int32_t k = first; k < n; k++) {
+		const DL_CMD * c = &cmd[bin[k]];
+		if (TR_Overlap(&c->box, x, y, w, h)) TR_Execute(c);
+	}
+
+	// DMA2D reads tile buffer from memory
+	PK_SyncForDMA(tr.buf, tr.stride * h);
+	BSP->G2D_CopyBuf(tr.buf, 0, (uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h);
+	tr.stats.tiles++;
+	tr.stats.area += (uint32_t)(w * h);
+	tr.stats.fb_written += tr.stride * h;
+}
+
+
+// Renderer control
+
+// Returns BSP_ERROR for unsupported colour mode or tile not fitting TR_TILE_BYTES
+uint8_t TR_Init(uint8_t color_mode, uint32_t bgcolor, uint16_t tile_w, uint16_t tile_h) {
+	uint8_t bpp = (color_mode == LCD_COLOR_MODE_ARGB8888) ? 4 : (color_mode == LCD_COLOR_MODE_RGB888) ? 3 : 0;
+
+	tr.bpp = 0;
+	if ((bpp == 0) || (tile_w == 0) || (tile_w > LCD_WIDTH) || (tile_h == 0) || (tile_h > LCD_HEIGHT)) return BSP_ERROR;
+	if ((uint32_t)tile_w * tile_h * bpp > TR_TILE_BYTES) return BSP_ERROR;
+	if ((LCD_HEIGHT + tile_h - 1) / tile_h > TR_MAX_ROWS) return BSP_ERROR;
+
+	tr.bpp = bpp;
+	tr.bgcolor = bgcolor;
+	tr.tile_w = tile_w;
+	tr.tile_h = tile_h;
+	tr.rows = (LCD_HEIGHT + tile_h - 1) / tile_h;
+	tr.cols = (LCD_WIDTH + tile_w - 1) / tile_w;
+	tr.sel = 0;
+	TR_ResetStats();
+	return BSP_OK;
+}
+
+// Draws commands cmd[order[0..count-1]] into edit frame. Returns BSP_ERROR (nothing drawn) when
+// renderer is not initialised or bins are full.
+uint8_t TR_Render(const DL_CMD *cmd, const uint16_t *order, uint16_t count) {
+	uint32_t total = 0;
+
+	if (tr.bpp == 0) return BSP_ERROR;
+
+	// Bin commands by tile row - counting sort keeps list order inside each row
+	memset(tr_row_start, 0, sizeof(tr_row_start));
+	for (uint16_t i = 0; i < count; i++) {
+		const DL_BOX * b = &cmd[order[i]].box;
+		uint16_t r0 = b->y / tr.tile_h, r1 = (b->y + b->h - 1) / tr.tile_h;
+		for (uint16_t r = r0; r <= r1; r++) tr_row_start[r + 1]++;
+		total += r1 - r0 + 1;
+	}
+	if (total > TR_MAX_BINS) {
+		tr.stats.fallbacks++;
+		return BSP_ERROR;
+	}
+	for (uint16_t r = 0; r < tr.rows; r++) {
+		tr_row_start[r + 1] += tr_row_start[r];
+		tr_row_fill[r] = tr_row_start[r];
+	}
+	for (uint16_t i = 0; i < count; i++) {
+		const DL_BOX * b = &cmd[order[i]].box;
+		uint16_t r0 = b->y / tr.tile_h, r1 = (b->y + b->h - 1) / tr.tile_h;
+		for (uint16_t r = r0; r <= r1; r++) tr_bins[tr_row_fill[r]++] = order[i];
+	}
+	tr.stats.binned += total;
+
+	const uint8_t * frame = BSP->LCD_GetEditFrameAddr();
+	for (uint16_t r = 0; r < tr.rows; r++) {
+		uint16_t n = tr_row_start[r + 1] - tr_row_start[r];
+		if (n == 0) continue;
+		int32_t y = r * tr.tile_h;
+		int32_t h = (y + tr.tile_h > LCD_HEIGHT) ? LCD_HEIGHT - y : tr.tile_h;
+		for (uint16_t col = 0; col < tr.cols; col++) {
+			int32_t x = col * tr.tile_w;
+			int32_t w = (x + tr.tile_w > LCD_WIDTH) ? LCD_WIDTH - x : tr.tile_w;
+			TR_Tile(cmd, &tr_bins[tr_row_start[r]], n, frame, x, y, w, h);
+		}
+	}
+
+	tr.stats.overdraw = (tr.stats.area) ? (uint32_t)((uint64_t)tr.stats.pixels * 100 / tr.stats.area) : 0;
+	return BSP_OK;
+}
+
+void TR_ResetStats(void) {
+	memset(&tr.stats, 0, sizeof(tr.stats));
+}
+
+const TR_STATS * TR_GetStats(void) {
+	return &tr.stats;
+}
@@ -0,0 +1,204 @@
+/*****************************************************************
+ * MiniConsole V3 - Binary Trace
+ *******************************************************************/
+
+#include "Trace.h"
+#include "Profiler.h"
+
+#define TRACE_WORDS			(TRACE_BUFFER_SIZE / 4)
+
+static uint32_t trace_buf[TRACE_WORDS] SH1_RAM;
+static uint32_t trace_head = 0;				// Words written (free running)
+static uint32_t trace_tail = 0;				// Bytes sent (free running)
+static uint32_t trace_pending_drops = 0;
+static uint8_t trace_on = 0;
+static const char * trace_name[TRACE_MAX_NAMES];
+static uint8_t trace_names = 0;
+static TRACE_STATS trace_stats;
+
+// Writers can run in interrupts (audio callback) - record is reserved and written with
+// interrupts masked, so records are never interleaved and timestamps stay in order.
+#ifdef HOST_BUILD
+static inline uint32_t TRACE_Lock(void) { return 0; }
+static inline void TRACE_Unlock(uint32_t primask) { (void)primask; }
+#else
+static inline uint32_t TRACE_Lock(void) {
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+	return primask;
+}
+
+static inline void TRACE_Unlock(uint32_t primask) {
+	__asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+#endif
+
+static inline uint32_t TRACE_Header(uint8_t type, uint8_t id, uint16_t aux) {
+	return (uint32_t)type | ((uint32_t)id << 8) | ((uint32_t)aux << 16);
+}
+
+// Reserves space for record (call with TRACE_Lock held). Returns 0 and counts drop when buffer is full.
+static uint8_t TRACE_Reserve(uint32_t words) {
+	uint32_t used = (trace_head * 4 - trace_tail + 3) / 4;
+	if (used + words > TRACE_WORDS) {
+		trace_stats.dropped++;
+		trace_pending_drops++;
+		return 0;
+	}
+	if ((used + words) * 4 > trace_stats.peak) trace_stats.peak = (used + words) * 4;
+	trace_stats.records++;
+	return 1;
+}
+
+static inline void TRACE_Put(uint32_t word) {
+	trace_buf[trace_head & (TRACE_WORDS - 1)] = word;
+	trace_head++;
+}
+
+// Call with TRACE_Lock held
+static void TRACE_WriteName(uint8_t id) {
+	const char * name = trace_name[id];
+	uint16_t len = 0;
+	while (name[len] && (len < 255)) len++;
+
+	if (!TRACE_Reserve(2 + (len + 3) / 4)) return;
+	TRACE_Put(TRACE_Header(TRACE_REC_NAME, id, len));
+	TRACE_Put(0);
+	for (uint16_t i = 0; i < len; i += 4) {
+		uint32_t w = 0;
+		for (uint16_t j = 0; (j < 4) && (i + j < len); j++) w |= (uint32_t)(uint8_t)name[i + j] << (8 * j);
+		TRACE_Put(w);
+	}
+}
+
+// Audio status callback (interrupt) - aux is number of underruns since TRACE_Start
+static void TRACE_AudioUnderrun(void) {
+	if (!trace_on) return;
+	uint32_t primask = TRACE_Lock();
+	trace_stats.underruns++;
+	if (TRACE_Reserve(2)) {
+		TRACE_Put(TRACE_Header(TRACE_REC_UNDERRUN, 0, (uint16_t)trace_stats.underruns));
+		TRACE_Put(PROF_GetCycles());
+	}
+	TRACE_Unlock(primask);
+}
+
+// Clears buffer and starts stream with header and name table. Audio underruns are
+// traced from AUDIO_STATUS_BUF_UNDERRUN callback (replaces callback of application).
+void TRACE_Start(void) {
+	PROF_StartCounter();
+	uint32_t primask = TRACE_Lock();
+	trace_head = 0;
+	trace_tail = 0;
+	trace_pending_drops = 0;
+	trace_stats.records = 0;
+	trace_stats.dropped = 0;
+	trace_stats.sent = 0;
+	trace_stats.peak = 0;
+	trace_stats.underruns = 0;
+
+	TRACE_Reserve(2);
+	TRACE_Put(TRACE_Header(TRACE_REC_START, 0, TRACE_VERSION));
+	TRACE_Put(PROF_CYCLES_PER_US);
+	for (uint8_t i = 0; i < trace_names; i++) TRACE_WriteName(i);
+	trace_on = 1;
+	TRACE_Unlock(primask);
+	BSP->Audio_RegisterStatusCallback(AUDIO_STATUS_BUF_UNDERRUN, (void *)TRACE_AudioUnderrun);
+}
+
+void TRACE_Stop(void) {
+	BSP->Audio_RegisterStatusCallback(AUDIO_STATUS_BUF_UNDERRUN, NULL);
+	trace_on = 0;
+}
+
+// Returns id for name (same pointer gives same id). Name record is written when tracing.
+uint8_t TRACE_Register(const char *name) {
+	for (uint8_t i = 0; i < trace_names; i++) {
+		if (trace_name[i] == name) return i;
+	}
+	if (trace_names == TRACE_MAX_NAMES) return TRACE_INVALID;
+	trace_name[trace_names] = name;
+	if (trace_on) {
+		uint32_t primask = TRACE_Lock();
+		TRACE_WriteName(trace_names);
+		TRACE_Unlock(primask);
+	}
+	return trace_names++;
+}
+
+void TRACE_Write(uint8_t type, uint8_t id, uint16_t aux) {
+	if ((!trace_on) || (id == TRACE_INVALID)) return;
+	uint32_t primask = TRACE_Lock();
+	if (TRACE_Reserve(2)) {
+		TRACE_Put(TRACE_Header(type, id, aux));
+		TRACE_Put(PROF_GetCycles());
+	}
+	TRACE_Unlock(primask);
+}
+
+void TRACE_WriteValue(uint8_t type, uint8_t id, uint32_t value) {
+	if ((!trace_on) || (id == TRACE_INVALID)) return;
+	uint32_t primask = TRACE_Lock();
+	if (TRACE_Reserve(3)) {
+		TRACE_Put(TRACE_Header(type, id, 0));
+		TRACE_Put(PROF_GetCycles());
+		TRACE_Put(value);
+	}
+	TRACE_Unlock(primask);
+}
+
+// Writes DROPPED record when there is space. Pending count is kept until it fits.
+static void TRACE_WriteDrops(void) {
+	uint32_t primask = TRACE_Lock();
+	uint32_t used = (trace_head * 4 - trace_tail + 3) / 4;
+	if ((trace_pending_drops) && (used + 3 <= TRACE_WORDS)) {
+		uint32_t drops = trace_pending_drops;
+		TRACE_Reserve(3);
+		TRACE_Put(TRACE_Header(TRACE_REC_DROPPED, 0, 0));
+		TRACE_Put(PROF_GetCycles());
+		TRACE_Put(drops);
+		trace_pending_drops = 0;
+	}
+	TRACE_Unlock(primask);
+}
+
+// Sends buffered bytes with USB_CDC_Write until buffer is empty, budget is used or USB is busy
+static uint32_t TRACE_Send(uint32_t max_bytes, uint32_t sent) {
+	while (trace_head * 4 != trace_tail) {
+		uint32_t start = trace_tail & (TRACE_BUFFER_SIZE - 1);
+		uint32_t bytes = trace_head * 4 - trace_tail;
+		if (bytes > TRACE_BUFFER_SIZE - start) bytes = TRACE_BUFFER_SIZE - start;
+		if ((max_bytes) && (bytes > max_bytes - sent)) bytes = max_bytes - sent;
+		if (bytes == 0) break;
+
+		uint32_t written = BSP->USB_CDC_Write((uint8_t *)trace_buf + start, bytes);
+		trace_tail += written;
+		sent += written;
+		if (written < bytes) break;
+	}
+	return sent;
+}
+
+// Sends buffered records (up to max_bytes, 0 - all) with USB_CDC_Write. Returns bytes sent.
+// Records lost while buffer was full are reported by DROPPED record after buffered ones.
+uint32_t TRACE_Flush(uint32_t max_bytes) {
+	if (!BSP->USB_IsConnected()) return 0;
+
+	uint32_t sent = TRACE_Send(max_bytes, 0);
+	if (trace_pending_drops) {
+		TRACE_WriteDrops();
+		sent = TRACE_Send(max_bytes, sent);
+	}
+	if (sent) BSP->USB_CDC_WriteFlush();
+
+	trace_stats.sent += sent;
+	return sent;
+}
+
+uint32_t TRACE_GetPending(void) {
+	return trace_head * 4 - trace_tail;
+}
+
+const TRACE_STATS * TRACE_GetStats(void) {
+	return &trace_stats;
+}
@@ -3,9 +3,12 @@
 
 #include "stdint.h"
 
+// Each font in own section - fonts not referenced by application are removed by --gc-sections
+#define FONT_SECTION(name)	__attribute__((section(".rodata.font_" #name)))
+
 //----------- FONT_12_verdana -----------
 
-const uint8_t FONT_12_verdana [2311] = {
+const uint8_t FONT_12_verdana [2311] FONT_SECTION(FONT_12_verdana) = {
 0x0f, 0x07, 0xc0, 0x00, 0xcc, 0x00, 0xd5, 0x00, 0xed, 0x00, 0x09, 0x01, 0x31, 0x01, 0x51, 0x01, 
 0x59, 0x01, 0x72, 0x01, 0x8c, 0x01, 0x99, 0x01, 0xaa, 0x01, 0xb1, 0x01, 0xb6, 0x01, 0xbb, 0x01, 
 0xd6, 0x01, 0xed, 0x01, 0x03, 0x02, 0x1b, 0x02, 0x31, 0x02, 0x48, 0x02, 0x5e, 0x02, 0x77, 0x02, 
@@ -154,7 +157,7 @@ const uint8_t FONT_12_verdana [2311] = {
 
 //----------- FONT_14_verdana -----------
 
-const uint8_t FONT_14_verdana [2748] = {
+const uint8_t FONT_14_verdana [2748] FONT_SECTION(FONT_14_verdana) = {
 0x12, 0x08, 0xc0, 0x00, 0xcf, 0x00, 0xdc, 0x00, 0x00, 0x01, 0x24, 0x01, 0x59, 0x01, 0x81, 0x01, 
 0x89, 0x01, 0xa9, 0x01, 0xc9, 0x01, 0xdd, 0x01, 0xfb, 0x01, 0x04, 0x02, 0x09, 0x02, 0x0e, 0x02, 
 0x2b, 0x02, 0x45, 0x02, 0x64, 0x02, 0x7f, 0x02, 0x9a, 0x02, 0xb5, 0x02, 0xcf, 0x02, 0xed, 0x02, 
@@ -330,7 +333,7 @@ const uint8_t FONT_14_verdana [2748] = {
 
 //----------- FONT_16_verdana -----------
 
-const uint8_t FONT_16_verdana [3363] = {
+const uint8_t FONT_16_verdana [3363] FONT_SECTION(FONT_16_verdana) = {
 0x14, 0x09, 0xc0, 0x00, 0xd8, 0x00, 0xea, 0x00, 0x13, 0x01, 0x42, 0x01, 0x88, 0x01, 0xbb, 0x01, 
 0xc5, 0x01, 0xe8, 0x01, 0x0b, 0x02, 0x22, 0x02, 0x39, 0x02, 0x46, 0x02, 0x4c, 0x02, 0x52, 0x02, 
 0x78, 0x02, 0xa4, 0x02, 0xc0, 0x02, 0xdf, 0x02, 0x00, 0x03, 0x27, 0x03, 0x48, 0x03, 0x6e, 0x03, 
@@ -545,7 +548,7 @@ const uint8_t FONT_16_verdana [3363] = {
 
 //----------- FONT_18_verdana -----------
 
-const uint8_t FONT_18_verdana [3775] = {
+const uint8_t FONT_18_verdana [3775] FONT_SECTION(FONT_18_verdana) = {
 0x17, 0x0a, 0xc0, 0x00, 0xd8, 0x00, 0xe8, 0x00, 0x16, 0x01, 0x4d, 0x01, 0x9d, 0x01, 0xd6, 0x01, 
 0xde, 0x01, 0x05, 0x02, 0x2d, 0x02, 0x4b, 0x02, 0x68, 0x02, 0x76, 0x02, 0x80, 0x02, 0x8a, 0x02, 
 0xb2, 0x02, 0xe2, 0x02, 0x03, 0x03, 0x28, 0x03, 0x4f, 0x03, 0x76, 0x03, 0x9b, 0x03, 0xc6, 0x03, 
@@ -785,7 +788,7 @@ const uint8_t FONT_18_verdana [3775] = {
 
 //----------- FONT_20_verdana -----------
 
-const uint8_t FONT_20_verdana [4403] = {
+const uint8_t FONT_20_verdana [4403] FONT_SECTION(FONT_20_verdana) = {
 0x19, 0x0b, 0xc0, 0x00, 0xdc, 0x00, 0xee, 0x00, 0x25, 0x01, 0x5e, 0x01, 0xba, 0x01, 0x04, 0x02, 
 0x0f, 0x02, 0x3b, 0x02, 0x65, 0x02, 0x88, 0x02, 0xa6, 0x02, 0xb5, 0x02, 0xbf, 0x02, 0xc8, 0x02, 
 0xf2, 0x02, 0x2b, 0x03, 0x53, 0x03, 0x7c, 0x03, 0xad, 0x03, 0xda, 0x03, 0x0a, 0x04, 0x3e, 0x04, 
@@ -1065,7 +1068,7 @@ const uint8_t FONT_20_verdana [4403] = {
 
 //----------- FONT_22_verdana -----------
 
-const uint8_t FONT_22_verdana [5039] = {
+const uint8_t FONT_22_verdana [5039] FONT_SECTION(FONT_22_verdana) = {
 0x1b, 0x0c, 0xc0, 0x00, 0xdf, 0x00, 0xfb, 0x00, 0x3d, 0x01, 0x81, 0x01, 0xe7, 0x01, 0x39, 0x02, 
 0x48, 0x02, 0x7a, 0x02, 0xaa, 0x02, 0xd1, 0x02, 0xf2, 0x02, 0x04, 0x03, 0x0f, 0x03, 0x18, 0x03, 
 0x48, 0x03, 0x88, 0x03, 0xb9, 0x03, 0xe5, 0x03, 0x18, 0x04, 0x49, 0x04, 0x78, 0x04, 0xb3, 0x04, 
@@ -1384,7 +1387,7 @@ const uint8_t FONT_22_verdana [5039] = {
 
 //----------- FONT_24_verdana -----------
 
-const uint8_t FONT_24_verdana [5808] = {
+const uint8_t FONT_24_verdana [5808] FONT_SECTION(FONT_24_verdana) = {
 0x1e, 0x0d, 0xc0, 0x00, 0xe0, 0x00, 0x00, 0x01, 0x50, 0x01, 0xa3, 0x01, 0x22, 0x02, 0x82, 0x02, 
 0x94, 0x02, 0xd1, 0x02, 0x05, 0x03, 0x30, 0x03, 0x53, 0x03, 0x67, 0x03, 0x72, 0x03, 0x7c, 0x03, 
 0xb5, 0x03, 0x07, 0x04, 0x34, 0x04, 0x69, 0x04, 0xa6, 0x04, 0xeb, 0x04, 0x23, 0x05, 0x69, 0x05, 
@@ -1751,7 +1754,7 @@ const uint8_t FONT_24_verdana [5808] = {
 
 //----------- FONT_26_verdana -----------
 
-const uint8_t FONT_26_verdana [6197] = {
+const uint8_t FONT_26_verdana [6197] FONT_SECTION(FONT_26_verdana) = {
 0x20, 0x0e, 0xc0, 0x00, 0xe7, 0x00, 0x09, 0x01, 0x55, 0x01, 0xaa, 0x01, 0x33, 0x02, 0x9c, 0x02, 
 0xad, 0x02, 0xe7, 0x02, 0x27, 0x03, 0x59, 0x03, 0x81, 0x03, 0x96, 0x03, 0xa1, 0x03, 0xae, 0x03, 
 0xe8, 0x03, 0x3c, 0x04, 0x6b, 0x04, 0xa2, 0x04, 0xe4, 0x04, 0x31, 0x05, 0x6d, 0x05, 0xba, 0x05, 
@@ -2143,7 +2146,7 @@ const uint8_t FONT_26_verdana [6197] = {
 
 //----------- FONT_28_verdana -----------
 
-const uint8_t FONT_28_verdana [6874] = {
+const uint8_t FONT_28_verdana [6874] FONT_SECTION(FONT_28_verdana) = {
 0x23, 0x0f, 0xc0, 0x00, 0xe7, 0x00, 0x0d, 0x01, 0x67, 0x01, 0xcb, 0x01, 0x62, 0x02, 0xd7, 0x02, 
 0xea, 0x02, 0x28, 0x03, 0x69, 0x03, 0xa1, 0x03, 0xcb, 0x03, 0xe4, 0x03, 0xf0, 0x03, 0xfc, 0x03, 
 0x3d, 0x04, 0x98, 0x04, 0xdd, 0x04, 0x1d, 0x05, 0x66, 0x05, 0xaf, 0x05, 0xef, 0x05, 0x41, 0x06, 
@@ -2577,7 +2580,7 @@ const uint8_t FONT_28_verdana [6874] = {
 
 //----------- FONT_36_verdana -----------
 
-const uint8_t FONT_36_verdana [9814] = {
+const uint8_t FONT_36_verdana [9814] FONT_SECTION(FONT_36_verdana) = {
 0x2c, 0x13, 0xc0, 0x00, 0xf2, 0x00, 0x23, 0x01, 0x9a, 0x01, 0x20, 0x02, 0xef, 0x02, 0xa3, 0x03, 
 0xbd, 0x03, 0x1f, 0x04, 0x82, 0x04, 0xcf, 0x04, 0x1d, 0x05, 0x44, 0x05, 0x56, 0x05, 0x6b, 0x05, 
 0xbe, 0x05, 0x48, 0x06, 0x8e, 0x06, 0xf2, 0x06, 0x59, 0x07, 0xca, 0x07, 0x2b, 0x08, 0xa4, 0x08, 
@@ -3195,7 +3198,7 @@ const uint8_t FONT_36_verdana [9814] = {
 
 //----------- FONT_64_verdana -----------
 
-const uint8_t FONT_64_verdana [22070] = {
+const uint8_t FONT_64_verdana [22070] FONT_SECTION(FONT_64_verdana) = {
 0x4e, 0x21, 0xc0, 0x00, 0x4f, 0x01, 0xdd, 0x01, 0xfa, 0x02, 0x2d, 0x04, 0x3c, 0x06, 0xbe, 0x07, 
 0x03, 0x08, 0xe7, 0x08, 0xc9, 0x09, 0x8b, 0x0a, 0x1e, 0x0b, 0x73, 0x0b, 0xa5, 0x0b, 0xdc, 0x0b, 
 0xab, 0x0c, 0xe9, 0x0d, 0xb3, 0x0e, 0x7d, 0x0f, 0x51, 0x10, 0x33, 0x11, 0xff, 0x11, 0x17, 0x13, 
@@ -4579,7 +4582,7 @@ const uint8_t FONT_64_verdana [22070] = {
 
 //----------- FONT_12_yikes -----------
 
-const uint8_t FONT_12_yikes [2198] = {
+const uint8_t FONT_12_yikes [2198] FONT_SECTION(FONT_12_yikes) = {
 0x0d, 0x07, 0xc0, 0x00, 0xd5, 0x00, 0xdf, 0x00, 0xf3, 0x00, 0x07, 0x01, 0x27, 0x01, 0x3e, 0x01, 
 0x45, 0x01, 0x5d, 0x01, 0x75, 0x01, 0x81, 0x01, 0x91, 0x01, 0x99, 0x01, 0xa3, 0x01, 0xa8, 0x01, 
 0xc1, 0x01, 0xda, 0x01, 0xf0, 0x01, 0x08, 0x02, 0x21, 0x02, 0x3b, 0x02, 0x51, 0x02, 0x66, 0x02, 
@@ -4721,7 +4724,7 @@ const uint8_t FONT_12_yikes [2198] = {
 
 //----------- FONT_14_yikes -----------
 
-const uint8_t FONT_14_yikes [2756] = {
+const uint8_t FONT_14_yikes [2756] FONT_SECTION(FONT_14_yikes) = {
 0x10, 0x08, 0xc0, 0x00, 0xdb, 0x00, 0xe9, 0x00, 0x06, 0x01, 0x1c, 0x01, 0x49, 0x01, 0x5e, 0x01, 
 0x66, 0x01, 0x85, 0x01, 0xa1, 0x01, 0xb1, 0x01, 0xc4, 0x01, 0xcd, 0x01, 0xd6, 0x01, 0xdc, 0x01, 
 0xfb, 0x01, 0x1e, 0x02, 0x38, 0x02, 0x58, 0x02, 0x78, 0x02, 0x97, 0x02, 0xb5, 0x02, 0xcf, 0x02, 
@@ -4898,7 +4901,7 @@ const uint8_t FONT_14_yikes [2756] = {
 
 //----------- FONT_16_yikes -----------
 
-const uint8_t FONT_16_yikes [3367] = {
+const uint8_t FONT_16_yikes [3367] FONT_SECTION(FONT_16_yikes) = {
 0x11, 0x09, 0xc0, 0x00, 0xdc, 0x00, 0xf0, 0x00, 0x0f, 0x01, 0x2a, 0x01, 0x64, 0x01, 0x82, 0x01, 
 0x8e, 0x01, 0xb7, 0x01, 0xdc, 0x01, 0xf1, 0x01, 0x06, 0x02, 0x11, 0x02, 0x1c, 0x02, 0x23, 0x02, 
 0x49, 0x02, 0x74, 0x02, 0x95, 0x02, 0xba, 0x02, 0xde, 0x02, 0x06, 0x03, 0x27, 0x03, 0x47, 0x03, 
@@ -5113,7 +5116,7 @@ const uint8_t FONT_16_yikes [3367] = {
 
 //----------- FONT_18_yikes -----------
 
-const uint8_t FONT_18_yikes [3969] = {
+const uint8_t FONT_18_yikes [3969] FONT_SECTION(FONT_18_yikes) = {
 0x13, 0x0a, 0xc0, 0x00, 0xe0, 0x00, 0xf2, 0x00, 0x13, 0x01, 0x33, 0x01, 0x79, 0x01, 0x9d, 0x01, 
 0xab, 0x01, 0xd4, 0x01, 0xfe, 0x01, 0x11, 0x02, 0x28, 0x02, 0x34, 0x02, 0x43, 0x02, 0x4b, 0x02, 
 0x75, 0x02, 0xae, 0x02, 0xd1, 0x02, 0xff, 0x02, 0x30, 0x03, 0x5f, 0x03, 0x8a, 0x03, 0xb5, 0x03, 
@@ -5366,7 +5369,7 @@ const uint8_t FONT_18_yikes [3969] = {
 
 //----------- FONT_20_yikes -----------
 
-const uint8_t FONT_20_yikes [4744] = {
+const uint8_t FONT_20_yikes [4744] FONT_SECTION(FONT_20_yikes) = {
 0x16, 0x0b, 0xc0, 0x00, 0xe7, 0x00, 0x00, 0x01, 0x28, 0x01, 0x4a, 0x01, 0x9c, 0x01, 0xc2, 0x01, 
 0xd3, 0x01, 0x03, 0x02, 0x35, 0x02, 0x4e, 0x02, 0x68, 0x02, 0x79, 0x02, 0x88, 0x02, 0x93, 0x02, 
 0xc3, 0x02, 0x03, 0x03, 0x2e, 0x03, 0x68, 0x03, 0x9c, 0x03, 0xd1, 0x03, 0x01, 0x04, 0x36, 0x04, 
@@ -5667,7 +5670,7 @@ const uint8_t FONT_20_yikes [4744] = {
 
 //----------- FONT_22_yikes -----------
 
-const uint8_t FONT_22_yikes [5411] = {
+const uint8_t FONT_22_yikes [5411] FONT_SECTION(FONT_22_yikes) = {
 0x18, 0x0c, 0xc0, 0x00, 0xf1, 0x00, 0x0c, 0x01, 0x3d, 0x01, 0x6a, 0x01, 0xca, 0x01, 0xfa, 0x01, 
 0x0b, 0x02, 0x4a, 0x02, 0x84, 0x02, 0xa2, 0x02, 0xc3, 0x02, 0xd4, 0x02, 0xe4, 0x02, 0xf0, 0x02, 
 0x29, 0x03, 0x70, 0x03, 0xa2, 0x03, 0xe1, 0x03, 0x18, 0x04, 0x58, 0x04, 0x8b, 0x04, 0xc6, 0x04, 
@@ -6010,7 +6013,7 @@ const uint8_t FONT_22_yikes [5411] = {
 
 //----------- FONT_24_yikes -----------
 
-const uint8_t FONT_24_yikes [6210] = {
+const uint8_t FONT_24_yikes [6210] FONT_SECTION(FONT_24_yikes) = {
 0x1a, 0x0d, 0xc0, 0x00, 0xf5, 0x00, 0x15, 0x01, 0x4e, 0x01, 0x7d, 0x01, 0xec, 0x01, 0x23, 0x02, 
 0x39, 0x02, 0x7d, 0x02, 0xbd, 0x02, 0xde, 0x02, 0x02, 0x03, 0x17, 0x03, 0x2a, 0x03, 0x38, 0x03, 
 0x7b, 0x03, 0xd1, 0x03, 0x07, 0x04, 0x51, 0x04, 0x92, 0x04, 0xdc, 0x04, 0x17, 0x05, 0x5a, 0x05, 
@@ -6403,7 +6406,7 @@ const uint8_t FONT_24_yikes [6210] = {
 
 //----------- FONT_26_yikes -----------
 
-const uint8_t FONT_26_yikes [6916] = {
+const uint8_t FONT_26_yikes [6916] FONT_SECTION(FONT_26_yikes) = {
 0x1c, 0x0e, 0xc0, 0x00, 0xfa, 0x00, 0x23, 0x01, 0x62, 0x01, 0x97, 0x01, 0x16, 0x02, 0x54, 0x02, 
 0x68, 0x02, 0xb4, 0x02, 0xfe, 0x02, 0x23, 0x03, 0x4c, 0x03, 0x62, 0x03, 0x78, 0x03, 0x87, 0x03, 
 0xd3, 0x03, 0x35, 0x04, 0x76, 0x04, 0xc3, 0x04, 0x10, 0x05, 0x69, 0x05, 0xb2, 0x05, 0xfc, 0x05, 
@@ -6840,7 +6843,7 @@ const uint8_t FONT_26_yikes [6916] = {
 
 //----------- FONT_28_yikes -----------
 
-const uint8_t FONT_28_yikes [7723] = {
+const uint8_t FONT_28_yikes [7723] FONT_SECTION(FONT_28_yikes) = {
 0x1e, 0x0f, 0xc0, 0x00, 0x07, 0x01, 0x32, 0x01, 0x7c, 0x01, 0xb6, 0x01, 0x50, 0x02, 0x98, 0x02, 
 0xac, 0x02, 0x03, 0x03, 0x5b, 0x03, 0x85, 0x03, 0xb4, 0x03, 0xcb, 0x03, 0xe3, 0x03, 0xf2, 0x03, 
 0x49, 0x04, 0xb6, 0x04, 0x00, 0x05, 0x59, 0x05, 0xad, 0x05, 0x0b, 0x06, 0x5a, 0x06, 0xb2, 0x06, 
@@ -7327,7 +7330,7 @@ const uint8_t FONT_28_yikes [7723] = {
 
 //----------- FONT_36_yikes -----------
 
-const uint8_t FONT_36_yikes [11122] = {
+const uint8_t FONT_36_yikes [11122] FONT_SECTION(FONT_36_yikes) = {
 0x27, 0x13, 0xc0, 0x00, 0x20, 0x01, 0x60, 0x01, 0xc5, 0x01, 0x1d, 0x02, 0xef, 0x02, 0x50, 0x03, 
 0x75, 0x03, 0xea, 0x03, 0x64, 0x04, 0xa6, 0x04, 0xed, 0x04, 0x15, 0x05, 0x3b, 0x05, 0x54, 0x05, 
 0xc5, 0x05, 0x5b, 0x06, 0xc3, 0x06, 0x44, 0x07, 0xbd, 0x07, 0x3e, 0x08, 0xb4, 0x08, 0x2f, 0x09, 
@@ -8027,7 +8030,7 @@ const uint8_t FONT_36_yikes [11122] = {
 
 //----------- FONT_64_yikes -----------
 
-const uint8_t FONT_64_yikes [21820] = {
+const uint8_t FONT_64_yikes [21820] FONT_SECTION(FONT_64_yikes) = {
 0x44, 0x22, 0xc0, 0x00, 0x71, 0x01, 0x05, 0x02, 0xf8, 0x02, 0xba, 0x03, 0x9b, 0x05, 0x76, 0x06, 
 0xcb, 0x06, 0xa8, 0x07, 0x76, 0x08, 0xf9, 0x08, 0x87, 0x09, 0xd6, 0x09, 0x27, 0x0a, 0x5e, 0x0a, 
 0x31, 0x0b, 0x4d, 0x0c, 0x0f, 0x0d, 0x00, 0x0e, 0xec, 0x0e, 0xe4, 0x0f, 0xb8, 0x10, 0xab, 0x11, 
@@ -24,8 +24,12 @@
 
 #include "main.h"
 #include "fonts.h"
+#include "TextSprite.h"
+#include "Log.h"
+#include "Sched.h"
 
 static void * RES_THUMB;
+static TS_SPRITE TITLE;
 volatile uint32_t frametime;
 
 // Entry point 1 - Initialization function
@@ -37,6 +41,7 @@ void app_init(void) {
 
 	// Initializing graphical interface
 	BSP->LCD_Init(LCD_COLOR_MODE_RGB888, LCD_BUFFER_MODE_DOUBLE, BSP->G2D_Color(C_BLACK, 255), NULL);
+	TS_Init(LCD_COLOR_MODE_RGB888);
 
 	// Initialize resource memory
 	BSP->Res_Init((void *)0xC0000000, 32*1024*1024);
@@ -52,16 +57,18 @@ void app_main(void) {
 
 		// Routines in this section will be executed every time
 
-		while (!BSP->LCD_GetEditPermission()) continue;
+		// Waiting for edit window - background tasks run in the meantime
+		Sched_WaitEditPermission();
 
 		// Generate frame here
 		BSP->G2D_ClearFrame();
-		BSP->G2D_TextBlend(10, 10, FONT_26_verdana,"EXAMPLE APPLICATION", BSP->G2D_Color(C_WHITE, 255));
+		TS_TextBlend(&TITLE, 10, 10, FONT_26_verdana, "EXAMPLE APPLICATION", BSP->G2D_Color(C_WHITE, 255));
 		BSP->G2D_DrawBitmapC(RES_THUMB, 400, 240, 320, 200);
 		BSP->LCD_FrameReady();
 
 		// Routines in this section will be executed once per frame
 		frametime = BSP->LCD_GetFrameTime();
+		LOG_Drain(0);
 
 	}
 }
@@ -68,6 +68,20 @@ LoopCopyDTCInit:
   cmp r4, r1
   bcc CopyDTCInit
 
+/* Zero fill the DTCMRAM bss segment. */
+  ldr r2, =_sdtcbss
+  ldr r4, =_edtcbss
+  movs r3, #0
+  b LoopFillZeroDTC
+
+FillZeroDTC:
+  str  r3, [r2]
+  adds r2, r2, #4
+
+LoopFillZeroDTC:
+  cmp r2, r4
+  bcc FillZeroDTC
+
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
   ldr r4, =_ebss